@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 #include <unistd.h>
 #include <time.h>
 #include <sys/socket.h>
@@ -14,6 +15,8 @@
 #include "bacn_RTI.h"
 #include "../Modules/cJSON.h"
 #include "../Modules/IQ.h"
+#include "../Modules/band_registry.h"
+#include "../Modules/tdt_index.h"
 
 bool server_run = false;
 extern bool client_open;
@@ -31,7 +34,7 @@ extern uint8_t bands;
 extern char banda[13];
 extern char Flow[13];
 extern char Fhigh[13];
-extern char Tcity[13];
+extern char Tcity[TDT_CITY_NAME_MAX];
 extern char Tchan[13];
 extern char t_start[20];
 extern char t_stop[20];
@@ -44,6 +47,9 @@ extern bool program;
 
 char SERVER_BUFFER[SERVER_BUFFER_SIZE];
 
+// El bucle principal y la etapa de publicación escriben en el mismo socket
+static pthread_mutex_t send_lock = PTHREAD_MUTEX_INITIALIZER;
+
 void TimevalConv(char *timeData, struct tm *timeValue)
 {
     char *token = strtok(timeData, "-T:");
@@ -117,13 +123,36 @@ int8_t init_server(st_server *s_server)
     }
 }
 
+int Server_Write(st_server *s_server, const char *data, size_t len)
+{
+    int result = 0;
+
+    // Cada mensaje sale entero y sin intercalarse con otro
+    pthread_mutex_lock(&send_lock);
+    while (len > 0) {
+        ssize_t n = write(s_server->conf_fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            result = -1;
+            break;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    pthread_mutex_unlock(&send_lock);
+
+    return result;
+}
+
 void Server_SendString(st_server *s_server, const char *data)
 {
     char dataServer[SERVER_BUFFER_SIZE];
     
     memset(dataServer, 0, sizeof(dataServer));
     sprintf(dataServer, "<%s>", data);
-    write(s_server->conf_fd, dataServer, strlen(dataServer));    
+    Server_Write(s_server, dataServer, strlen(dataServer));    
 }
 
 void sendLocation(st_server *s_server, const char *Latitude, const char *Longitude)
@@ -143,7 +172,7 @@ void sendLocation(st_server *s_server, const char *Latitude, const char *Longitu
     
     memset(dataServer, 0, sizeof(dataServer));
     sprintf(dataServer, "{initResponse:{\"serial_id\": \"%s\", \"location\": \"bogota\", \"latitude\": %s, \"longitude\": %s}}", MACDevice, Latitude, Longitude);
-    write(s_server->conf_fd, dataServer, strlen(dataServer));
+    Server_Write(s_server, dataServer, strlen(dataServer));
 }
 
 int stringLen(char *str)
@@ -242,79 +271,15 @@ void* ServerIntHandler(void* arg)
                         if (!strcmp(measure->valuestring, "RMTDT")) {
                             cJSON *channel = cJSON_GetObjectItemCaseSensitive(json, "channel"); 
                             cJSON *location = cJSON_GetObjectItemCaseSensitive(json, "location");
-                            sprintf(Tchan, "%s", channel->valuestring);
-                            sprintf(Tcity, "%s", location->valuestring);
+                            snprintf(Tchan, sizeof(Tchan), "%s", channel->valuestring);
+                            snprintf(Tcity, sizeof(Tcity), "%s", location->valuestring);
                         } else {
-                            if(!strcmp(band->valuestring, "VHF") && !strcmp(fmin->valuestring, "88")) {
-                                bands = VHF1;
-                            } else if(!strcmp(band->valuestring, "VHF") && !strcmp(fmin->valuestring, "137")) {  
-                                bands = VHF2;                            
-                            } else if(!strcmp(band->valuestring, "VHF") && !strcmp(fmin->valuestring, "148")) {
-                                bands = VHF3;
-                            } else if(!strcmp(band->valuestring, "VHF") && !strcmp(fmin->valuestring, "154")) {
-                                bands = VHF4;
-                            } else if(!strcmp(band->valuestring, "UHF") && !strcmp(fmin->valuestring, "400")) {
-                                bands = UHF1;
-                            } else if(!strcmp(band->valuestring, "UHF") && !strcmp(fmin->valuestring, "420")) {
-                                bands = UHF1_2;
-                            } else if(!strcmp(band->valuestring, "UHF") && !strcmp(fmin->valuestring, "440")) {
-                                bands = UHF1_3;
-                            } else if(!strcmp(band->valuestring, "UHF") && !strcmp(fmin->valuestring, "450")) {
-                                bands = UHF1_4;
-                            } else if(!strcmp(band->valuestring, "TDT") && !strcmp(fmin->valuestring, "470")) {
-                                bands = UHF2_1;
-                            } else if(!strcmp(band->valuestring, "TDT") && !strcmp(fmin->valuestring, "488")) {
-                                bands = UHF2_2;
-                            } else if(!strcmp(band->valuestring, "TDT") && !strcmp(fmin->valuestring, "506")) {
-                                bands = UHF2_3;
-                            } else if(!strcmp(band->valuestring, "TDT") && !strcmp(fmin->valuestring, "524")) {
-                                bands = UHF2_4;
-                            } else if(!strcmp(band->valuestring, "TDT") && !strcmp(fmin->valuestring, "542")) {
-                                bands = UHF2_5;
-                            } else if(!strcmp(band->valuestring, "TDT") && !strcmp(fmin->valuestring, "560")) {
-                                bands = UHF2_6;
-                            } else if(!strcmp(band->valuestring, "TDT") && !strcmp(fmin->valuestring, "578")) {
-                                bands = UHF2_7;
-                            } else if(!strcmp(band->valuestring, "TDT") && !strcmp(fmin->valuestring, "596")) {
-                                bands = UHF2_8;
-                            } else if(!strcmp(band->valuestring, "TDT") && !strcmp(fmin->valuestring, "614")) {
-                                bands = UHF2_9;
-                            } else if(!strcmp(band->valuestring, "TDT") && !strcmp(fmin->valuestring, "632")) {
-                                bands = UHF2_10;
-                            } else if(!strcmp(band->valuestring, "TDT") && !strcmp(fmin->valuestring, "650")) {
-                                bands = UHF2_11;
-                            } else if(!strcmp(band->valuestring, "TDT") && !strcmp(fmin->valuestring, "668")) {
-                                bands = UHF2_12;
-                            } else if(!strcmp(band->valuestring, "TDT") && !strcmp(fmin->valuestring, "678")) {
-                                bands = UHF2_13;
-                            } else if(!strcmp(band->valuestring, "UHF") && !strcmp(fmin->valuestring, "1708")) {
-                                bands = UHF3;
-                            } else if(!strcmp(band->valuestring, "UHF") && !strcmp(fmin->valuestring, "1735")) {
-                                bands = UHF3_1;
-                            } else if(!strcmp(band->valuestring, "UHF") && !strcmp(fmin->valuestring, "1805")) {
-                                bands = UHF3_2;
-                            } else if(!strcmp(band->valuestring, "UHF") && !strcmp(fmin->valuestring, "1848")) {
-                                bands = UHF3_3;
-                            } else if(!strcmp(band->valuestring, "UHF") && !strcmp(fmin->valuestring, "1868")) {
-                                bands = UHF3_4;
-                            } else if(!strcmp(band->valuestring, "UHF") && !strcmp(fmin->valuestring, "1877")) {
-                                bands = UHF3_5;
-                            } else if(!strcmp(band->valuestring, "SHF") && !strcmp(fmin->valuestring, "2550")) {
-                                bands = SHF1;
-                            } else if(!strcmp(band->valuestring, "SHF") && !strcmp(fmin->valuestring, "3295")) {
-                                bands = SHF2;
-                            } else if(!strcmp(band->valuestring, "SHF") && !strcmp(fmin->valuestring, "3338")) {
-                                bands = SHF2_2;
-                            } else if(!strcmp(band->valuestring, "SHF") && !strcmp(fmin->valuestring, "3375")) {
-                                bands = SHF2_3;
-                            } else if(!strcmp(band->valuestring, "SHF") && !strcmp(fmin->valuestring, "3444")) {
-                                bands = SHF2_4;
-                            } else if(!strcmp(band->valuestring, "SHF") && !strcmp(fmin->valuestring, "3538")) {
-                                bands = SHF2_5;
-                            } else if(!strcmp(band->valuestring, "SHF") && !strcmp(fmin->valuestring, "3550")) {
-                                bands = SHF2_6;
-                            } else if(!strcmp(band->valuestring, "SHF") && !strcmp(fmin->valuestring, "3580")) {
-                                bands = SHF2_7;
+                            // Servicio y fmin/fmax se resuelven sobre la cobertura de cada banda
+                            const band_info_t* info = band_registry_resolve(band->valuestring, fmin->valuestring, fmax->valuestring);
+                            if (info != NULL) {
+                                bands = info->id;
+                            } else {
+                                printf("Banda no registrada: %s %s-%s\r\n", band->valuestring, fmin->valuestring, fmax->valuestring);
                             }
 
                             sprintf(banda, "%s", band->valuestring);
@@ -4,6 +4,7 @@
 #include <pthread.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #define SERVER_BUFFER_SIZE 1000
 #define PORT 2000
@@ -21,6 +22,7 @@ typedef struct
 
 void TimevalConv(char *timeData, struct tm *timeValue);
 int8_t init_server(st_server *s_server);
+int Server_Write(st_server *s_server, const char *data, size_t len);
 void Server_SendString(st_server *s_server, const char *data);
 void sendLocation(st_server *s_server, const char *Latitude, const char *Longitude);
 int stringLen(char *str);
@@ -229,35 +229,44 @@ uint8_t reset_LTE(void)
 	return EXIT_SUCCESS;
 }
 
+/* La línea del conmutador de antena se pide una sola vez y se mantiene */
+static struct gpiod_line_request *antenna_request = NULL;
+
 uint8_t switch_ANTENNA(bool RF) 
 {
 	static const char *const chip_path = "/dev/gpiochip0";
 	static const unsigned int line_offset = ANTENNA_SEL;
 
-	enum gpiod_line_value value = GPIOD_LINE_VALUE_ACTIVE;
-	struct gpiod_line_request *request;
+	enum gpiod_line_value value = RF ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE;
 
-	request = request_output_line(chip_path, line_offset, value,
-				      "switch-ANTENNA");
-	if (!request) {
-		fprintf(stderr, "failed to request line: %s\n",
-			strerror(errno));
-		return EXIT_FAILURE;
+	if (!antenna_request) {
+		antenna_request = request_output_line(chip_path, line_offset, value,
+						      "switch-ANTENNA");
+		if (!antenna_request) {
+			fprintf(stderr, "failed to request line: %s\n",
+				strerror(errno));
+			return EXIT_FAILURE;
+		}
 	}
 	
+	gpiod_line_request_set_value(antenna_request, line_offset, value);
 	if(RF) {
-		gpiod_line_request_set_value(request, line_offset, GPIOD_LINE_VALUE_ACTIVE);
 		printf("RF1 ON RF2 OFF\n");
 	} else { 
-		gpiod_line_request_set_value(request, line_offset, GPIOD_LINE_VALUE_INACTIVE);
 		printf("RF1 OFF RF2 ON\n");
 	}
-	
-	gpiod_line_request_release(request);
 
 	return EXIT_SUCCESS;
 }
 
+void release_ANTENNA(void)
+{
+	if (antenna_request) {
+		gpiod_line_request_release(antenna_request);
+		antenna_request = NULL;
+	}
+}
+
 uint8_t real_time(void)
 {
 	static const char *const chip_path = "/dev/gpiochip0";
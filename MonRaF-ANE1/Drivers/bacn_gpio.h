@@ -17,6 +17,7 @@ uint8_t power_OFF_LTE(void);
 uint8_t reset_LTE(void);
 
 uint8_t switch_ANTENNA(bool RF);
+void release_ANTENNA(void);
 
 uint8_t real_time(void);
 
@@ -12,6 +12,8 @@
 #include <complex.h>
 
 #include "IQ.h"
+#include "tdt_index.h"
+#include "cs8_convert.h"
 
 int8_t* read_CS8(uint8_t file_sample, size_t* file_size)
 {
@@ -81,121 +83,32 @@ void delete_JSON(uint8_t file_json)
     }
 }
 
-int load_bands(uint8_t bands, double* frequencies, double* bandwidths)
+uint16_t load_bands_tdt(char* channel, char* city, int *modulation)
 {
-    char temp_buffer[MAX_BAND_SIZE];
-    char *token;
-    int num_rows = 0;
-    int i = 0;
-    const char *file_band = NULL;
-
-    switch (bands) {
-        case VHF1: file_band = "bands/VHF1.csv"; break;
-        case VHF2: file_band = "bands/VHF2.csv"; break;
-        case VHF3: file_band = "bands/VHF3.csv"; break;
-        case VHF4: file_band = "bands/VHF4.csv"; break;
-        case UHF1: file_band = "bands/UHF1.csv"; break;
-        case UHF1_2: file_band = "bands/UHF1_2.csv"; break;
-        case UHF1_3: file_band = "bands/UHF1_3.csv"; break;
-        case UHF1_4: file_band = "bands/UHF1_4.csv"; break;
-        case UHF2_1: file_band = "bands/UHF2_1.csv"; break;
-        case UHF2_2: file_band = "bands/UHF2_2.csv"; break;
-        case UHF2_3: file_band = "bands/UHF2_3.csv"; break;
-        case UHF2_4: file_band = "bands/UHF2_4.csv"; break;
-        case UHF2_5: file_band = "bands/UHF2_5.csv"; break;
-        case UHF2_6: file_band = "bands/UHF2_6.csv"; break;
-        case UHF2_7: file_band = "bands/UHF2_7.csv"; break;
-        case UHF2_8: file_band = "bands/UHF2_8.csv"; break;
-        case UHF2_9: file_band = "bands/UHF2_9.csv"; break;
-        case UHF2_10: file_band = "bands/UHF2_10.csv"; break;
-        case UHF2_11: file_band = "bands/UHF2_11.csv"; break;
-        case UHF2_12: file_band = "bands/UHF2_12.csv"; break;
-        case UHF2_13: file_band = "bands/UHF2_13.csv"; break;
-        case UHF3: file_band = "bands/UHF3.csv"; break;
-        case UHF3_1: file_band = "bands/UHF3_1.csv"; break;
-        case UHF3_2: file_band = "bands/UHF3_2.csv"; break;
-        case UHF3_3: file_band = "bands/UHF3_3.csv"; break;
-        case UHF3_4: file_band = "bands/UHF3_4.csv"; break;
-        case UHF3_5: file_band = "bands/UHF3_5.csv"; break;
-        case SHF1: file_band = "bands/SHF1.csv"; break;
-        case SHF2: file_band = "bands/SHF2.csv"; break;
-        case SHF2_2: file_band = "bands/SHF2_2.csv"; break;
-        case SHF2_3: file_band = "bands/SHF2_3.csv"; break;
-        case SHF2_4: file_band = "bands/SHF2_4.csv"; break;
-        case SHF2_5: file_band = "bands/SHF2_5.csv"; break;
-        case SHF2_6: file_band = "bands/SHF2_6.csv"; break;
-        case SHF2_7: file_band = "bands/SHF2.csv"; break;
-        
-        default: return 0;
-    }
-    
-    FILE *file = fopen(file_band, "r");
-    if (!file) {
-        printf("Error: Unable to open file %s\n", file_band);
+    const tdt_channel_t* ch = tdt_index_lookup(city, channel);
+    if (ch == NULL) {
+        printf("Error: channel %s not found for %s\n", channel, city);
+        *modulation = 0;
         return 0;
     }
 
-    while (fgets(temp_buffer, MAX_BAND_SIZE, file) != NULL) {
-        num_rows++;
-    }
-
-    fseek(file, 0, SEEK_SET);
-    fgets(temp_buffer, MAX_BAND_SIZE, file);
-
-    while (fgets(temp_buffer, MAX_BAND_SIZE, file) != NULL) {
-        token = strtok(temp_buffer, ",");
-        frequencies[i] = atof(token);
-        token = strtok(NULL, "\n");
-        bandwidths[i] = atof(token);
-        i++;
-    }
-
-    fclose(file);
-    return num_rows;
+    *modulation = ch->modulation;
+    return ch->freq_mhz;
 }
 
-uint16_t load_bands_tdt(char* channel, char* city, int *modulation)
+int load_city_tdt(const char* city, tdt_channel_t* channels, int max_channels)
 {
-    char temp_buffer[MAX_BAND_SIZE];
-    char *token;
-    int num_rows = 0;
-    int i = 0;    
-    char file_band[20];
-    char canal[10];
-    char frequencia[10];
-    char modulacion[10];
-    sprintf(file_band, "Ciudades/%s.csv", city); //Aca se debe ajustar
-
-    FILE *file = fopen(file_band, "r");
-    if (!file) {
-        printf("Error: Unable to open file %s\n", file_band);
+    const tdt_channel_t* all = NULL;
+    int n = tdt_index_city(city, &all);
+    if (n == 0) {
+        printf("Error: no TDT channels for %s\n", city);
         return 0;
     }
-
-    while (fgets(temp_buffer, MAX_BAND_SIZE, file) != NULL) {
-        num_rows++;
-    }
-
-    fseek(file, 0, SEEK_SET);
-    fgets(temp_buffer, MAX_BAND_SIZE, file);
-
-    while (fgets(temp_buffer, MAX_BAND_SIZE, file) != NULL) {
-        token = strtok(temp_buffer, ",");
-        sprintf(canal, "%s", token);
-        token = strtok(NULL, ",");
-        sprintf(frequencia, "%s", token);
-        token = strtok(NULL, "\n");
-        sprintf(modulacion, "%s", token);
-
-        if(!strcmp(canal, channel)) {
-            break;
-        }
+    if (n > max_channels) {
+        n = max_channels;
     }
-
-    *modulation = atoi(modulacion);
-
-    fclose(file);
-    return atoi(frequencia);
+    memcpy(channels, all, (size_t)n * sizeof(tdt_channel_t));
+    return n;
 }
 
 complex double* Vector_BIN(int8_t *rawVector, size_t length, size_t* num_samples)
@@ -208,9 +121,7 @@ complex double* Vector_BIN(int8_t *rawVector, size_t length, size_t* num_samples
         exit(EXIT_FAILURE);
     }
 
-    for (size_t i = 0; i < *num_samples; i++) {
-        complex_samples[i] = CMPLX(rawVector[2 * i], rawVector[2 * i + 1]);
-    }
+    cs8_to_complex(rawVector, complex_samples, *num_samples);
 
     return complex_samples;
 }
\ No newline at end of file
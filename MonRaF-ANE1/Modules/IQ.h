@@ -12,6 +12,17 @@
 #include <complex.h>
 
 #define MAX_BAND_SIZE 50 ///< Tamaño máximo para el buffer de bandas
+#define MAX_TDT_CHANNELS 64 ///< Máximo de canales TDT de una ciudad
+
+/**
+ * @struct tdt_channel_t
+ * @brief Canal TDT de una ciudad (`Ciudades/<ciudad>.csv`).
+ */
+typedef struct {
+    char channel[13];   ///< Canal, como lo pide el servidor
+    uint16_t freq_mhz;  ///< Frecuencia central en MHz
+    int modulation;     ///< Orden de la modulación (16 o 64)
+} tdt_channel_t;
 
 /**
  * @enum BANDS
@@ -85,21 +96,18 @@ void delete_CS8(uint8_t file_sample);
 
 void delete_JSON(uint8_t file_json);
 
+uint16_t load_bands_tdt(char* channel, char* city, int *modulation);
+
 /**
- * @brief Carga las frecuencias y anchos de banda de un archivo CSV correspondiente a una banda seleccionada.
- * 
- * Esta función carga los valores de frecuencias y anchos de banda desde un archivo CSV, el cual depende de la banda seleccionada.
- * Los datos se almacenan en dos arreglos proporcionados como parámetros.
- * 
- * @param bands La banda de frecuencias a cargar (VHF1, VHF2, UHF1, etc.).
- * @param frequencies Puntero a un arreglo donde se almacenarán las frecuencias de la banda.
- * @param bandwidths Puntero a un arreglo donde se almacenarán los anchos de banda de la banda.
- * 
- * @return El número de filas leídas desde el archivo CSV, o 0 si ocurrió un error al abrir el archivo.
+ * @brief Carga todos los canales TDT de una ciudad, en el orden del archivo.
+ *
+ * @param city Ciudad (`Ciudades/<city>.csv`).
+ * @param channels Arreglo de salida.
+ * @param max_channels Capacidad de `channels`.
+ *
+ * @return Número de canales leídos, o 0 si no se pudo abrir el archivo.
  */
-int load_bands(uint8_t bands, double* frequencies, double* bandwidths);
-
-uint16_t load_bands_tdt(char* channel, char* city, int *modulation);
+int load_city_tdt(const char* city, tdt_channel_t* channels, int max_channels);
 
 /**
  * @brief Convierte un arreglo de datos en formato CS8 a un vector de números complejos IQ.
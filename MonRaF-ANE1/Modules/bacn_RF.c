@@ -9,43 +9,42 @@
 
 #include <libhackrf/hackrf.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <unistd.h>
 #include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include "bacn_RF.h"
 #include "IQ.h"
-#include "../Drivers/bacn_gpio.h"
+#include "welch_stream.h"
+#include "rf_session.h"
+#include "spsc_ring.h"
 
-/** @brief Variable para controlar la finalización del bucle principal. */
-static volatile bool do_exit = false;
+/** @brief Señales de interrupción recibidas; una captura se aborta si cambia mientras espera. */
+static volatile sig_atomic_t capture_interrupts = 0;
 
-/** @brief Archivo para almacenar los datos de salida. */
-FILE* file = NULL;
+/** @brief Los manejadores de señales se instalan una sola vez. */
+static pthread_once_t signals_once = PTHREAD_ONCE_INIT;
 
-/** @brief Contador de bytes transferidos. */
-volatile uint32_t byte_count = 0;
+/** @brief Capacidad pedida para la cola de este hilo (0: `rx_callback` escribe directamente). */
+static _Thread_local size_t stream_size = DEFAULT_STREAM_RING_SIZE;
 
-/** @brief Tamaño del buffer de streaming. */
-uint64_t stream_size = 0;
+/** @brief Cola de las capturas de este hilo; se reserva en la primera y se reutiliza. */
+static _Thread_local spsc_ring_t stream_ring;
 
-/** @brief Puntero al inicio del buffer circular de streaming. */
-uint32_t stream_head = 0;
+/** @brief Destino en memoria de este hilo (NULL: desactivado). */
+static _Thread_local uint8_t* memory_sink = NULL;
 
-/** @brief Puntero al final del buffer circular de streaming. */
-uint32_t stream_tail = 0;
+/** @brief Capacidad de `memory_sink`. */
+static _Thread_local size_t memory_sink_capacity = 0;
 
-/** @brief Número de streams descartados. */
-uint32_t stream_drop = 0;
+/** @brief Bytes escritos en `memory_sink` en el último tramo. */
+static _Thread_local size_t memory_sink_len = 0;
 
-/** @brief Buffer para almacenamiento temporal de datos de streaming. */
-uint8_t* stream_buf = NULL;
-
-/** @brief Flag para limitar la cantidad de muestras transferidas. */
-bool limit_num_samples = true;
-
-/** @brief Bytes restantes para transferir. */
-size_t bytes_to_xfer = 0;
+/** @brief Estadísticas de la última captura de este hilo. */
+static _Thread_local capture_stats_t capture_stats;
 
 /** @brief Frecuencia inicial para el barrido. */
 int64_t lo_freq = 0;
@@ -53,95 +52,387 @@ int64_t lo_freq = 0;
 /** @brief Frecuencia final para el barrido. */
 int64_t hi_freq = 0;
 
-/** @brief Dispositivo HackRF activo. */
-static hackrf_device* device = NULL;
+/** @brief Acumulador Welch en modo streaming de este hilo (NULL: las muestras se escriben en archivo). */
+static _Thread_local welch_stream_t* psd_stream = NULL;
+
+/** @brief Capturas TDT de este hilo a la tasa de banda ancha. */
+static _Thread_local bool tdt_wideband = false;
+
+/** @brief Acumulador que decide el fin de los tramos de este hilo (NULL: longitud fija). */
+static _Thread_local welch_stream_t* converge_stream = NULL;
+
+/** @brief Muestras mínimas por tramo en captura adaptativa. */
+static _Thread_local long converge_min_samples = 0;
 
-extern int64_t central_freq[60];
+/** @brief Semiancho relativo del intervalo de confianza en captura adaptativa. */
+static _Thread_local double converge_rel_ci = 0.0;
 
 extern uint8_t getData;
 
+
+void set_psd_stream(welch_stream_t* ws)
+{
+	psd_stream = ws;
+}
+
+
+void set_capture_convergence(welch_stream_t* ws, long min_samples, double rel_ci)
+{
+	converge_stream = ws;
+	converge_min_samples = min_samples;
+	converge_rel_ci = rel_ci;
+}
+
+
+void set_tdt_wideband(bool wide)
+{
+	tdt_wideband = wide;
+}
+
+
+int64_t capture_center_hz(uint8_t central_freq_Rx_MHz, bool is_second_sample)
+{
+	int64_t lo = ((int64_t)central_freq_Rx_MHz - 10) * 1000000;
+	if (is_second_sample) {
+		lo += SECOND_SAMPLE_OFFSET_HZ;
+	}
+	return lo + DEFAULT_CENTRAL_FREQ_HZ;
+}
+
+
+void set_stream_ring_size(size_t bytes)
+{
+	stream_size = bytes;
+	// Se vuelve a reservar con el nuevo tamaño en la próxima captura
+	spsc_ring_free(&stream_ring);
+}
+
+
+void set_memory_sink(uint8_t* buffer, size_t capacity)
+{
+	memory_sink = buffer;
+	memory_sink_capacity = (buffer != NULL) ? capacity : 0;
+	memory_sink_len = 0;
+}
+
+
+size_t memory_sink_length(void)
+{
+	return memory_sink_len;
+}
+
+
+const capture_stats_t* get_capture_stats(void)
+{
+	return &capture_stats;
+}
+
+
+void sigint_callback_handler(int signum)
+{
+	fprintf(stderr, "Caught signal %d\n", signum);
+	capture_interrupts++;
+}
+
+
+static void capture_signals_install(void)
+{
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = sigint_callback_handler;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+}
+
+
 /**
- * @brief Detiene el bucle principal de captura.
+ * @brief Prepara el contexto de una captura con la configuración de este hilo.
+ *
+ * @return 0 si se pudo crear, -1 en caso de error.
  */
-void stop_main_loop(void)
+static int capture_ctx_init(capture_ctx_t* ctx)
 {
-	do_exit = true;
-	kill(getpid(), SIGALRM);
+	memset(ctx, 0, sizeof(*ctx));
+	if (completion_init(&ctx->done) != 0) {
+		return -1;
+	}
+	ctx->psd_stream = psd_stream;
+	ctx->memory_sink = memory_sink;
+	ctx->memory_sink_capacity = memory_sink_capacity;
+	ctx->converge = converge_stream;
+	ctx->converge_min_bytes = (converge_min_samples > 0) ? (uint64_t)converge_min_samples * 2 : 0;
+	ctx->converge_ci = converge_rel_ci;
+	ctx->limit_num_samples = true;
+	atomic_init(&ctx->byte_count, 0);
+	atomic_init(&ctx->stream_stop, false);
+	atomic_init(&ctx->sink_failed, false);
+	pthread_once(&signals_once, capture_signals_install);
+	return 0;
 }
 
 
-int rx_callback(hackrf_transfer* transfer)
+/**
+ * @brief Deja los resultados de la captura para `memory_sink_length` y `get_capture_stats`.
+ */
+static void capture_ctx_destroy(capture_ctx_t* ctx)
 {
-	size_t bytes_to_write;
-	size_t bytes_written;
+	memory_sink_len = ctx->memory_sink_len;
+	capture_stats = ctx->stats;
+	completion_destroy(&ctx->done);
+}
 
-	if (file == NULL) {
-		stop_main_loop();
-		return -1;
+
+/**
+ * @brief Prepara el contexto para un tramo de `bytes` bytes.
+ */
+static void capture_ctx_begin(capture_ctx_t* ctx, size_t bytes)
+{
+	completion_reset(&ctx->done);
+	atomic_store(&ctx->byte_count, 0);
+	atomic_store(&ctx->sink_failed, false);
+	ctx->bytes_to_xfer = bytes;
+	ctx->memory_sink_len = 0;
+	if (ctx->converge != NULL) {
+		welch_stream_reset(ctx->converge);
 	}
+}
 
-	/* Determina cuántos bytes escribir */
-	bytes_to_write = transfer->valid_length;
 
-	/* Actualiza el conteo de bytes */
-	byte_count += transfer->valid_length;
-	
-	if (limit_num_samples) {
-		if (bytes_to_write >= bytes_to_xfer) {
-			bytes_to_write = bytes_to_xfer;
+/**
+ * @brief Espera el fin del tramo vigilando que sigan llegando bytes.
+ *
+ * @param ctx Captura.
+ * @param deadline_ms Plazo total del tramo (0: sin plazo, sólo se vigila el atasco).
+ *
+ * @return 0 si el tramo terminó bien; -1 si falló, se atascó, venció el plazo o llegó una señal.
+ */
+static int capture_wait(capture_ctx_t* ctx, uint32_t deadline_ms)
+{
+	sig_atomic_t interrupts = capture_interrupts;
+	uint64_t last = atomic_load(&ctx->byte_count);
+	uint32_t idle_ms = 0;
+	uint32_t elapsed_ms = 0;
+	int status = 0;
+
+	while (!completion_wait(&ctx->done, CAPTURE_POLL_MS, &status)) {
+		uint64_t now = atomic_load(&ctx->byte_count);
+		elapsed_ms += CAPTURE_POLL_MS;
+		idle_ms = (now == last) ? idle_ms + CAPTURE_POLL_MS : 0;
+		last = now;
+
+		if (capture_interrupts != interrupts) {
+			fprintf(stderr, "Capture interrupted\n");
+			completion_signal(&ctx->done, -1);
+		} else if (idle_ms >= CAPTURE_STALL_MS) {
+			fprintf(stderr, "Couldn't transfer any bytes for %u ms.\n", idle_ms);
+			completion_signal(&ctx->done, -1);
+		} else if (deadline_ms > 0 && elapsed_ms >= deadline_ms) {
+			fprintf(stderr, "Capture deadline of %u ms exceeded\n", deadline_ms);
+			completion_signal(&ctx->done, -1);
 		}
-		bytes_to_xfer -= bytes_to_write;
 	}
+	return status;
+}
 
-	/* Escribe los datos directamente en el archivo si no hay búfer de transmisión */
-	if (stream_size == 0) {
-		bytes_written = fwrite(transfer->buffer, 1, bytes_to_write, file);
-		if ((bytes_written != bytes_to_write) ||
-		    (limit_num_samples && (bytes_to_xfer == 0))) {
-			stop_main_loop();
-			fprintf(stderr, "Total Bytes: %u\n",byte_count);
-			return -1;
-		} else {
-			return 0;
+
+/**
+ * @brief Plazo de un tramo: su duración nominal a `sample_rate` más un margen.
+ */
+static uint32_t capture_deadline_ms(size_t bytes, double sample_rate)
+{
+	return (uint32_t)(1000.0 * (double)bytes / (2.0 * sample_rate)) + CAPTURE_DEADLINE_MARGIN_MS;
+}
+
+
+/**
+ * @brief Entrega bytes recibidos a los destinos activos (PSD, memoria, archivo).
+ *
+ * @return false si la escritura en el archivo falló.
+ */
+static bool sink_write(capture_ctx_t* ctx, const uint8_t* data, size_t length)
+{
+	if (ctx->psd_stream != NULL) {
+		welch_stream_push_cs8(ctx->psd_stream, (const int8_t*)data, length);
+	}
+	if (ctx->memory_sink != NULL) {
+		size_t room = ctx->memory_sink_capacity - ctx->memory_sink_len;
+		size_t n = (length < room) ? length : room;
+		memcpy(ctx->memory_sink + ctx->memory_sink_len, data, n);
+		ctx->memory_sink_len += n;
+	}
+	if (ctx->file != NULL && fwrite(data, 1, length, ctx->file) != length) {
+		return false;
+	}
+	ctx->stats.bytes_delivered += length;
+
+	if (ctx->converge != NULL) {
+		if (ctx->converge != ctx->psd_stream) {
+			welch_stream_push_cs8(ctx->converge, (const int8_t*)data, length);
+		}
+		uint64_t delivered = ctx->converge->num_samples * 2ull;
+		if (delivered >= ctx->converge_min_bytes && !completion_is_done(&ctx->done)) {
+			double ci = welch_stream_channel_ci(ctx->converge);
+			if (ci <= ctx->converge_ci) {
+				// Lo que siga en camino (cola, transferencias en vuelo) también llega al destino
+				ctx->stats.converged_tiles++;
+				fprintf(stderr, "Converged after %lu bytes (CI %.4f)\n", (unsigned long)delivered, ci);
+				completion_signal(&ctx->done, 0);
+			}
 		}
 	}
+	return true;
+}
 
-	if ((stream_size - 1 + stream_head - stream_tail) % stream_size <
-	    bytes_to_write) {
-		stream_drop++;
-	} else {
-		if (stream_tail + bytes_to_write <= stream_size) {
-			memcpy(stream_buf + stream_tail,
-			       transfer->buffer,
-			       bytes_to_write);
-		} else {
-			memcpy(stream_buf + stream_tail,
-			       transfer->buffer,
-			       (stream_size - stream_tail));
-			memcpy(stream_buf,
-			       transfer->buffer + (stream_size - stream_tail),
-			       bytes_to_write - (stream_size - stream_tail));
-		};
-		__atomic_store_n(
-			&stream_tail,
-			(stream_tail + bytes_to_write) % stream_size,
-			__ATOMIC_RELEASE);
+
+/**
+ * @brief Hilo consumidor: vacía la cola de la captura en los destinos hasta que el productor termine.
+ */
+static void* stream_consumer(void* arg)
+{
+	capture_ctx_t* ctx = (capture_ctx_t*)arg;
+
+	for (;;) {
+		// Leer la marca antes que la cola: si ya estaba puesta, lo que falte no llegará
+		bool stopping = atomic_load(&ctx->stream_stop);
+		const uint8_t* data;
+		size_t length = spsc_ring_peek(ctx->ring, &data);
+
+		if (length == 0) {
+			if (stopping) {
+				break;
+			}
+			usleep(STREAM_CONSUMER_IDLE_US);
+			continue;
+		}
+		if (!sink_write(ctx, data, length)) {
+			fprintf(stderr, "Sink write failed, stopping capture\n");
+			atomic_store(&ctx->sink_failed, true);
+			completion_signal(&ctx->done, -1);
+			break;
+		}
+		spsc_ring_consume(ctx->ring, length);
 	}
-	return 0;
+	return NULL;
 }
 
 
-void sigint_callback_handler(int signum)
+/**
+ * @brief Arranca la cola y su consumidor para el tramo que va a empezar.
+ *
+ * Sin cola configurada (`set_stream_ring_size(0)`) no hace nada y `rx_callback`
+ * escribe directamente.
+ *
+ * @return 0 si la captura puede empezar, -1 en caso de error.
+ */
+static int stream_start(capture_ctx_t* ctx)
 {
-	fprintf(stderr, "Caught signal %d\n", signum);
-	do_exit = true;
+	if (stream_size == 0) {
+		ctx->ring = NULL;
+		return 0;
+	}
+	if (stream_ring.buf == NULL && spsc_ring_init(&stream_ring, stream_size) != 0) {
+		return -1;
+	}
+	ctx->ring = &stream_ring;
+	spsc_ring_reset(ctx->ring);
+	atomic_store(&ctx->stream_stop, false);
+
+	// El consumidor no atiende señales: Ctrl+C lo recibe el hilo principal
+	sigset_t all, previous;
+	sigfillset(&all);
+	pthread_sigmask(SIG_BLOCK, &all, &previous);
+	int created = pthread_create(&ctx->stream_thread, NULL, stream_consumer, ctx);
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+	if (created != 0) {
+		fprintf(stderr, "Error: Unable to start stream consumer\n");
+		return -1;
+	}
+	ctx->stream_active = true;
+	return 0;
 }
 
+
 /**
- * @brief Manejador para la señal SIGALRM.
+ * @brief Espera a que el consumidor vacíe la cola y suma sus contadores a las estadísticas.
+ *
+ * Se llama con el productor ya detenido.
  */
-void sigalrm_callback_handler()
+static void stream_finish(capture_ctx_t* ctx)
 {
+	if (!ctx->stream_active) {
+		return;
+	}
+	atomic_store(&ctx->stream_stop, true);
+	pthread_join(ctx->stream_thread, NULL);
+	ctx->stream_active = false;
+
+	spsc_ring_t* ring = ctx->ring;
+	ctx->stats.drops += ring->drops;
+	ctx->stats.dropped_bytes += ring->dropped_bytes;
+	if (ring->high_water > ctx->stats.ring_high_water) {
+		ctx->stats.ring_high_water = ring->high_water;
+	}
+	fprintf(stderr, "Ring: %u drops (%lu bytes), high water %zu of %zu bytes\n",
+	        ring->drops, ring->dropped_bytes, ring->high_water, ring->size);
+}
+
+
+int rx_callback(hackrf_transfer* transfer)
+{
+	capture_ctx_t* ctx = (capture_ctx_t*)transfer->rx_ctx;
+	size_t bytes_to_write;
+
+	/* El tramo ya terminó (o el hilo que espera lo abortó) */
+	if (completion_is_done(&ctx->done)) {
+		return -1;
+	}
+
+	if (ctx->file == NULL && ctx->psd_stream == NULL && ctx->memory_sink == NULL) {
+		completion_signal(&ctx->done, -1);
+		return -1;
+	}
+
+	/* Determina cuántos bytes escribir */
+	bytes_to_write = transfer->valid_length;
+
+	/* Actualiza el conteo de bytes */
+	uint64_t byte_count = atomic_fetch_add(&ctx->byte_count, transfer->valid_length) + transfer->valid_length;
+	ctx->stats.bytes_received += transfer->valid_length;
+	
+	if (ctx->limit_num_samples) {
+		if (bytes_to_write >= ctx->bytes_to_xfer) {
+			bytes_to_write = ctx->bytes_to_xfer;
+		}
+		ctx->bytes_to_xfer -= bytes_to_write;
+	}
+
+	if (!ctx->stream_active) {
+		/* Sin cola, los datos se escriben directamente desde el callback */
+		if (!sink_write(ctx, transfer->buffer, bytes_to_write)) {
+			atomic_store(&ctx->sink_failed, true);
+			completion_signal(&ctx->done, -1);
+			return -1;
+		}
+		if (completion_is_done(&ctx->done)) {
+			/* La estimación convergió antes del máximo */
+			return -1;
+		}
+	} else {
+		/* Con cola, el callback sólo copia: el disco nunca lo detiene */
+		spsc_ring_push(ctx->ring, transfer->buffer, bytes_to_write);
+		if (atomic_load(&ctx->sink_failed)) {
+			return -1;
+		}
+	}
+
+	if (ctx->limit_num_samples && (ctx->bytes_to_xfer == 0)) {
+		completion_signal(&ctx->done, 0);
+		fprintf(stderr, "Total Bytes: %lu\n", byte_count);
+		return -1;
+	}
+	return 0;
 }
 
 
@@ -155,7 +446,6 @@ int getSamples(uint8_t central_freq_Rx_MHz, long samples_to_xfer_max, transceive
 
 	uint8_t tSample = 0;
 	int64_t FreqTDT;
-	uint64_t byte_count_now = 0;
 	char path[20];
 	
 	if (transceiver_mode == TRANSCEIVER_MODE_TDT) { 
@@ -164,8 +454,8 @@ int getSamples(uint8_t central_freq_Rx_MHz, long samples_to_xfer_max, transceive
 		tSample = 1;
 	} else {
 		// Definir rangos de frecuencia por banda
-		lo_freq = (central_freq_Rx_MHz - 10) * 1000000;
-		hi_freq = (central_freq_Rx_MHz + 10) * 1000000;
+		lo_freq = capture_center_hz(central_freq_Rx_MHz, is_second_sample) - DEFAULT_CENTRAL_FREQ_HZ;
+		hi_freq = lo_freq + 2 * DEFAULT_CENTRAL_FREQ_HZ;
 
 		// switch (bands) {
 		// 	case VHF1: lo_freq = 88000000; hi_freq = 108000000; break;
@@ -206,220 +496,310 @@ int getSamples(uint8_t central_freq_Rx_MHz, long samples_to_xfer_max, transceive
 		// 	default: return 0;
 		// }
 		
-		if (is_second_sample) {
-			lo_freq += 2000000;
-			hi_freq += 2000000;
-		}
-
 		tSample = (hi_freq - lo_freq)/DEFAULT_SAMPLE_RATE_HZ;
-				
-		central_freq[0] = lo_freq + DEFAULT_CENTRAL_FREQ_HZ;
-		fprintf(stderr, "central frequency: %lu\n", central_freq[0]);
-		
-		for(uint8_t i=1; i<tSample; i++) {
-			central_freq[i] = central_freq[0] + DEFAULT_SAMPLE_RATE_HZ;
-			fprintf(stderr, "central frequency: %lu\n", central_freq[i]); 
-		}
+		fprintf(stderr, "central frequency: %lu\n", lo_freq + DEFAULT_CENTRAL_FREQ_HZ);
 	}
 
-	if(lo_freq > 999999999) {
-		switch_ANTENNA(RF1);
-	} else {
-		switch_ANTENNA(RF2);
+	// El dispositivo queda abierto entre llamadas; sólo se reprograma lo que cambia
+	rf_session_t* rf = rf_session_acquire();
+	if (rf == NULL) {
+		return -1;
 	}
 
-	result = hackrf_init();
-	if (result != HACKRF_SUCCESS) {
-		fprintf(stderr,
-			"hackrf_init() failed: %s (%d)\n",
-			hackrf_error_name(result),
-			result);
+	capture_ctx_t ctx;
+	if (capture_ctx_init(&ctx) != 0) {
+		rf_session_release();
 		return -1;
 	}
 
-	// Configura manejadores de señales
-	signal(SIGINT, &sigint_callback_handler);
-	signal(SIGILL, &sigint_callback_handler);
-	signal(SIGFPE, &sigint_callback_handler);
-	signal(SIGSEGV, &sigint_callback_handler);
-	signal(SIGTERM, &sigint_callback_handler);
-	signal(SIGABRT, &sigint_callback_handler);
+	if (rf_session_set_antenna(rf, lo_freq > 999999999) != 0) {
+		fprintf(stderr, "Antenna switch failed\n");
+	}
 
-	signal(SIGALRM, &sigalrm_callback_handler);
+	double sample_rate = (transceiver_mode == TRANSCEIVER_MODE_TDT && !tdt_wideband) ? DEFAULT_SAMPLE_RATE_TDT : DEFAULT_SAMPLE_RATE_HZ;
+	result = rf_session_set_sample_rate(rf, sample_rate);
+	if (result != 0) {
+		rf_session_reset(rf);
+		capture_ctx_destroy(&ctx);
+		rf_session_release();
+		return -1;
+	}
 
 	fprintf(stderr, "Device initialized\r\n");
 
 	for(uint8_t i=0; i<tSample; i++)
 	{		
-		byte_count_now = 0;
 		if (transceiver_mode == TRANSCEIVER_MODE_TDT) { 
-			bytes_to_xfer = DEFAULT_SAMPLES_TDT_XFER_MAX * 2ull;
+			capture_ctx_begin(&ctx, (tdt_wideband ? DEFAULT_SAMPLES_TDT_WIDE_XFER_MAX : DEFAULT_SAMPLES_TDT_XFER_MAX) * 2ull);
 		} else {
 			// bytes_to_xfer = DEFAULT_SAMPLES_TO_XFER_MAX * 2ull;
-			bytes_to_xfer = samples_to_xfer_max * 2ull;
+			capture_ctx_begin(&ctx, samples_to_xfer_max * 2ull);
 		}	
+		uint32_t deadline_ms = capture_deadline_ms(ctx.bytes_to_xfer, sample_rate);
 
-		memset(path, 0, 20);
-		sprintf(path, "Samples/%d", i);
-		file = fopen(path, "wb");
-	
-		if (file == NULL) {
-			fprintf(stderr, "Failed to open file: %s\n", path);
-			return -1;
-		}
-		/* Change file buffer to have bigger one to store or read data on/to HDD */
-		result = setvbuf(file, NULL, _IOFBF, FD_BUFFER_SIZE);
-		if (result != 0) {
-			fprintf(stderr, "setvbuf() failed: %d\n", result);
-			return -1;
-		}
-
-		fprintf(stderr,"Start Acquisition\n");
-
-		result = hackrf_open(&device);
-		if (result != HACKRF_SUCCESS) {
-			fprintf(stderr,
-				"hackrf_open() failed: %s (%d)\n",
-				hackrf_error_name(result),
-				result);
-			return -1;
-		}
-
-		if (transceiver_mode == TRANSCEIVER_MODE_TDT) { 
-			result = hackrf_set_sample_rate(device, DEFAULT_SAMPLE_RATE_TDT);
-			if (result != HACKRF_SUCCESS) {
-				fprintf(stderr,
-					"hackrf_set_sample_rate() failed: %s (%d)\n",
-					hackrf_error_name(result),
-					result);
-				return -1;
+		/* En modo streaming la PSD (o la memoria) recibe las muestras y no se escribe archivo */
+		if (ctx.psd_stream == NULL && ctx.memory_sink == NULL) {
+			memset(path, 0, 20);
+			sprintf(path, "Samples/%d", i);
+			ctx.file = fopen(path, "wb");
+		
+			if (ctx.file == NULL) {
+				fprintf(stderr, "Failed to open file: %s\n", path);
+				result = -1;
+				break;
 			}
-		} else {
-			result = hackrf_set_sample_rate(device, DEFAULT_SAMPLE_RATE_HZ);
-			if (result != HACKRF_SUCCESS) {
-				fprintf(stderr,
-					"hackrf_set_sample_rate() failed: %s (%d)\n",
-					hackrf_error_name(result),
-					result);
-				return -1;
+			/* Change file buffer to have bigger one to store or read data on/to HDD */
+			result = setvbuf(ctx.file, NULL, _IOFBF, FD_BUFFER_SIZE);
+			if (result != 0) {
+				fprintf(stderr, "setvbuf() failed: %d\n", result);
+				fclose(ctx.file);
+				ctx.file = NULL;
+				result = -1;
+				break;
 			}
-		}	
-		
-
-		result = hackrf_set_hw_sync_mode(device, 0);
-		if (result != HACKRF_SUCCESS) {
-			fprintf(stderr,
-				"hackrf_set_hw_sync_mode() failed: %s (%d)\n",
-				hackrf_error_name(result),
-				result);
-			return -1;
 		}
 
+		fprintf(stderr,"Start Acquisition\n");
+
 		if (transceiver_mode == TRANSCEIVER_MODE_TDT) { 
-			result = hackrf_set_freq(device, FreqTDT);
-		if (result != HACKRF_SUCCESS) {
-			fprintf(stderr,
-				"hackrf_set_freq() failed: %s (%d)\n",
-				hackrf_error_name(result),
-				result);
-			return -1;
-		}	
+			result = rf_session_tune(rf, FreqTDT);
 		} else {
-			result = hackrf_set_freq(device, central_freq[i]);
-			if (result != HACKRF_SUCCESS) {
-				fprintf(stderr,
-					"hackrf_set_freq() failed: %s (%d)\n",
-					hackrf_error_name(result),
-					result);
-				return -1;
-			}	
+			// La sesión guarda la frecuencia sintonizada; cada tramo avanza una tasa de muestreo
+			result = rf_session_tune(rf, lo_freq + DEFAULT_CENTRAL_FREQ_HZ + (int64_t)i * DEFAULT_SAMPLE_RATE_HZ);
 		}	
-		
 
 		if (transceiver_mode == TRANSCEIVER_MODE_RX) {
-			result = hackrf_set_vga_gain(device, 0);
-			result |= hackrf_set_lna_gain(device, 0);
-			result |= hackrf_start_rx(device, rx_callback, NULL);
+			result |= rf_session_set_gains(rf, 0, 0);
 		} else {
-			result = hackrf_set_vga_gain(device, vga_gain);
-			result |= hackrf_set_lna_gain(device, lna_gain);
-			result |= hackrf_start_rx(device, rx_callback, NULL);
+			result |= rf_session_set_gains(rf, lna_gain, vga_gain);
 		}
 
-		if (result != HACKRF_SUCCESS) {
-			fprintf(stderr,
-				"hackrf_start_rx() failed: %s (%d)\n",
-				hackrf_error_name(result),
-				result);
-			return -1;
+		if (result == 0) {
+			result = stream_start(&ctx);
 		}
 
-		// Wait for SIGALRM from interval timer, or another signal.
-		pause();
+		if (result == 0) {
+			result = rf_session_start(rf, rx_callback, &ctx);
+		}
 
-		/* Read and reset both totals at approximately the same time. */
-		byte_count_now = byte_count;
-		byte_count = 0;
+		if (result == 0) {
+			// Vuelve al completarse el tramo, o antes si el dispositivo deja de entregar
+			result = capture_wait(&ctx, deadline_ms);
 
-		if (!((byte_count_now == 0))) {
-			fprintf(stderr, "Name file RDY: %d\n", i);				
+			if (rf_session_stop(rf) == 0) {
+				fprintf(stderr, "stop_rx() done\n");
+			}
 		}
 
-		if ((byte_count_now == 0)) {
-			fprintf(stderr,
-				"Couldn't transfer any bytes for one second.\n");
-			break;
-		}	
+		/* El consumidor termina de vaciar la cola antes de cerrar el archivo */
+		stream_finish(&ctx);
 
-		// Stop interval timer.
-		result = hackrf_is_streaming(device);
-		if (do_exit) {
-			fprintf(stderr, "Exiting...\n");
-		} else {
-			fprintf(stderr,
-				"Exiting... device_is_streaming() result: %s (%d)\n",
-				hackrf_error_name(result),
-				result);
+		if (ctx.file != NULL) {
+			fflush(ctx.file);
+			fclose(ctx.file);
+			ctx.file = NULL;
+			fprintf(stderr, "fclose() done\n");
 		}
 
-		result = hackrf_stop_rx(device);
-		if (result != HACKRF_SUCCESS) {
-			fprintf(stderr,
-				"stop_rx() failed: %s (%d)\n",
-				hackrf_error_name(result),
-				result);
-		} else {
-			fprintf(stderr, "stop_rx() done\n");
-		}		
+		if (atomic_load(&ctx.sink_failed)) {
+			fprintf(stderr, "Capture sink failed on tile %d\n", i);
+			result = -1;
+			break;
+		}
 
-		if (file != NULL) {
-			if (file != stdin) {
-				fflush(file);
-			}
-			if ((file != stdout) && (file != stdin)) {
-				fclose(file);
-				file = NULL;
-				fprintf(stderr, "fclose() done\n");
-			}
+		if (result != 0) {
+			// La próxima captura reprograma el dispositivo desde cero
+			rf_session_reset(rf);
+			break;
 		}
 
-		result = hackrf_close(device);
-		if (result != HACKRF_SUCCESS) {
-			fprintf(stderr,
-				"device_close() failed: %s (%d)\n",
-				hackrf_error_name(result),
-				result);
-		} else {
-			fprintf(stderr, "device_close() done\n");
-		}			
+		fprintf(stderr, "Name file RDY: %d\n", i);
 	}
 
-	if (device != NULL) 
-	{
-		hackrf_exit();
-		fprintf(stderr, "device_exit() done\n");
+	if (ctx.stats.drops > 0) {
+		fprintf(stderr, "Capture dropped %u transfers (%lu bytes)\n",
+		        ctx.stats.drops, ctx.stats.dropped_bytes);
 	}
 
+	capture_ctx_destroy(&ctx);
+	rf_session_release();
+
 	fprintf(stderr, "exit\n");
+	return result;
+}
+
+
+/**
+ * @brief Callback del modo sweep: reparte los bloques entre los tramos del barrido.
+ */
+static int sweep_callback(hackrf_transfer* transfer)
+{
+	capture_ctx_t* ctx = (capture_ctx_t*)transfer->rx_ctx;
+
+	if (completion_is_done(&ctx->done)) {
+		return -1;
+	}
+	atomic_fetch_add(&ctx->byte_count, transfer->valid_length);
+
+	if (sweep_push(ctx->sweep, transfer->buffer, transfer->valid_length)) {
+		completion_signal(&ctx->done, 0);
+		return -1;
+	}
+	return 0;
+}
+
+
+int getSweep(sweep_t* sw, uint16_t lna_gain, uint16_t vga_gain)
+{
+	uint64_t byte_count_now = 0;
+
+	rf_session_t* rf = rf_session_acquire();
+	if (rf == NULL) {
+		return -1;
+	}
+
+	capture_ctx_t ctx;
+	if (capture_ctx_init(&ctx) != 0) {
+		rf_session_release();
+		return -1;
+	}
+
+	if (rf_session_set_antenna(rf, sw->lo_hz > 999999999) != 0) {
+		fprintf(stderr, "Antenna switch failed\n");
+	}
+
+	if (rf_session_set_sample_rate(rf, sw->fs) != 0 ||
+	    rf_session_set_gains(rf, lna_gain, vga_gain) != 0) {
+		rf_session_reset(rf);
+		capture_ctx_destroy(&ctx);
+		rf_session_release();
+		return -1;
+	}
+
+	ctx.sweep = sw;
+	capture_ctx_begin(&ctx, 0);
+
+	fprintf(stderr, "Start Sweep: %d tiles\n", sw->n_tiles);
+
+	if (rf_session_start_sweep(rf, &sw->plan, sweep_callback, &ctx) != 0) {
+		rf_session_reset(rf);
+		capture_ctx_destroy(&ctx);
+		rf_session_release();
+		return -1;
+	}
+
+	// Sin plazo total (depende de las pasadas pedidas): sólo se vigila que sigan llegando bloques
+	int result = capture_wait(&ctx, 0);
+
+	if (rf_session_stop(rf) == 0) {
+		fprintf(stderr, "stop_rx() done\n");
+	}
+	if (result != 0) {
+		rf_session_reset(rf);
+	}
+
+	byte_count_now = atomic_load(&ctx.byte_count);
+	capture_ctx_destroy(&ctx);
+	rf_session_release();
+
+	if (byte_count_now == 0) {
+		fprintf(stderr, "Couldn't transfer any sweep bytes.\n");
+		return -1;
+	}
+	if (result != 0) {
+		return -1;
+	}
+
+	fprintf(stderr, "Sweep done: %lu bytes\n", byte_count_now);
 	return 0;
 }
+
+
+int replay_CS8(const char* filename, long samples_to_xfer_max)
+{
+	FILE* source;
+	uint8_t* buffer;
+	hackrf_transfer transfer;
+	size_t read_size;
+	uint64_t byte_count_now = 0;
+	int result = 0;
+	capture_ctx_t ctx;
+
+	source = fopen(filename, "rb");
+	if (source == NULL) {
+		fprintf(stderr, "Failed to open file: %s\n", filename);
+		return -1;
+	}
+
+	buffer = (uint8_t*)malloc(REPLAY_TRANSFER_SIZE);
+	if (buffer == NULL) {
+		fprintf(stderr, "Error: Unable to allocate replay buffer\n");
+		fclose(source);
+		return -1;
+	}
+
+	if (capture_ctx_init(&ctx) != 0) {
+		free(buffer);
+		fclose(source);
+		return -1;
+	}
+
+	if (ctx.psd_stream == NULL && ctx.memory_sink == NULL) {
+		ctx.file = fopen("Samples/0", "wb");
+		if (ctx.file == NULL) {
+			fprintf(stderr, "Failed to open file: Samples/0\n");
+			capture_ctx_destroy(&ctx);
+			free(buffer);
+			fclose(source);
+			return -1;
+		}
+		setvbuf(ctx.file, NULL, _IOFBF, FD_BUFFER_SIZE);
+	}
+
+	if (samples_to_xfer_max > 0) {
+		capture_ctx_begin(&ctx, samples_to_xfer_max * 2ull);
+	} else {
+		fseek(source, 0, SEEK_END);
+		capture_ctx_begin(&ctx, ftell(source));
+		rewind(source);
+	}
+	// La reproducción no es en tiempo real: se escribe desde el callback, sin cola ni descartes
+
+	memset(&transfer, 0, sizeof(transfer));
+	transfer.buffer = buffer;
+	transfer.buffer_length = REPLAY_TRANSFER_SIZE;
+	transfer.rx_ctx = &ctx;
+
+	fprintf(stderr, "Start Replay: %s\n", filename);
+
+	while (!completion_is_done(&ctx.done)) {
+		read_size = fread(buffer, 1, REPLAY_TRANSFER_SIZE, source);
+		if (read_size == 0) {
+			break;
+		}
+		transfer.valid_length = (int)read_size;
+		if (rx_callback(&transfer) != 0) {
+			break;
+		}
+	}
+
+	byte_count_now = atomic_load(&ctx.byte_count);
+	if (byte_count_now == 0) {
+		fprintf(stderr, "Couldn't replay any bytes from %s\n", filename);
+		result = -1;
+	}
+	if (atomic_load(&ctx.sink_failed)) {
+		result = -1;
+	}
+
+	if (ctx.file != NULL) {
+		fclose(ctx.file);
+		ctx.file = NULL;
+	}
+	capture_ctx_destroy(&ctx);
+	free(buffer);
+	fclose(source);
+
+	fprintf(stderr, "Replay done: %lu bytes\n", byte_count_now);
+	return result;
+}
@@ -9,7 +9,14 @@
 #ifndef BACN_RF_H
 #define BACN_RF_H
 
+#include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
 #include <libhackrf/hackrf.h>
+#include "welch_stream.h"
+#include "sweep.h"
+#include "spsc_ring.h"
+#include "completion.h"
 
 /**
  * @def DEFAULT_SAMPLE_RATE_HZ
@@ -28,6 +35,12 @@
  */
 #define DEFAULT_CENTRAL_FREQ_HZ (10000000)
 
+/**
+ * @def SECOND_SAMPLE_OFFSET_HZ
+ * @brief Desplazamiento de la segunda captura RMER, que aporta los bins del DC de la primera.
+ */
+#define SECOND_SAMPLE_OFFSET_HZ (2000000)
+
 /**
  * @def DEFAULT_SAMPLES_TO_XFER_MAX
  * @brief Número máximo de muestras a transferir por defecto.
@@ -39,6 +52,12 @@
 // extern long samples_to_xfer_max; // se define en test_capture.c----------------
 #define DEFAULT_SAMPLES_TDT_XFER_MAX (6500000)
 
+/**
+ * @def DEFAULT_SAMPLES_TDT_WIDE_XFER_MAX
+ * @brief Muestras de una captura TDT de banda ancha (`set_tdt_wideband`): el mismo segundo a 20 MS/s.
+ */
+#define DEFAULT_SAMPLES_TDT_WIDE_XFER_MAX (20000000)
+
 /**
  * @def FD_BUFFER_SIZE
  * @brief Tamaño del búfer de transmisión.
@@ -47,6 +66,59 @@
  */
 #define FD_BUFFER_SIZE (8 * 1024)
 
+/**
+ * @def REPLAY_TRANSFER_SIZE
+ * @brief Tamaño de cada bloque entregado a `rx_callback` durante una reproducción.
+ * 
+ * Igual al tamaño de transferencia USB de libhackrf: 256 KB.
+ */
+#define REPLAY_TRANSFER_SIZE (256 * 1024)
+
+/**
+ * @def DEFAULT_STREAM_RING_SIZE
+ * @brief Capacidad por defecto de la cola entre `rx_callback` y el hilo que escribe las muestras.
+ * 
+ * 16 MB equivalen a unos 400 ms a 20 MS/s: margen para las pausas de escritura de una tarjeta SD.
+ */
+#define DEFAULT_STREAM_RING_SIZE (16 * 1024 * 1024)
+
+/**
+ * @def STREAM_CONSUMER_IDLE_US
+ * @brief Espera del hilo consumidor cuando la cola está vacía, en microsegundos.
+ */
+#define STREAM_CONSUMER_IDLE_US 500
+
+/**
+ * @def CAPTURE_POLL_MS
+ * @brief Cada cuánto revisa el hilo que espera una captura si ésta avanza, en milisegundos.
+ */
+#define CAPTURE_POLL_MS 100
+
+/**
+ * @def CAPTURE_STALL_MS
+ * @brief Tiempo sin recibir bytes tras el cual la captura se da por atascada, en milisegundos.
+ */
+#define CAPTURE_STALL_MS 1000
+
+/**
+ * @def CAPTURE_DEADLINE_MARGIN_MS
+ * @brief Margen sobre la duración nominal de un tramo antes de abortarlo, en milisegundos.
+ */
+#define CAPTURE_DEADLINE_MARGIN_MS 2000
+
+/**
+ * @struct capture_stats_t
+ * @brief Contadores de la última captura (suma de todos sus tramos).
+ */
+typedef struct {
+	uint64_t bytes_received;   /**< Bytes entregados por el front-end. */
+	uint64_t bytes_delivered;  /**< Bytes que llegaron a los destinos. */
+	uint32_t drops;            /**< Transferencias descartadas con la cola llena. */
+	uint64_t dropped_bytes;    /**< Bytes descartados con la cola llena. */
+	size_t ring_high_water;    /**< Máxima ocupación de la cola en bytes. */
+	uint32_t converged_tiles;  /**< Tramos que terminaron antes por convergencia. */
+} capture_stats_t;
+
 /**
  * @enum transceiver_mode_t
  * @brief Enumeración de los modos de operación del transceptor.
@@ -58,16 +130,117 @@ typedef enum {
 } transceiver_mode_t;
 
 /**
- * @brief Detiene el bucle principal.
+ * @struct capture_ctx_t
+ * @brief Estado de una captura en curso.
+ *
+ * Cada llamada a `getSamples`, `getSweep` o `replay_CS8` usa el suyo; los
+ * callbacks lo reciben en `transfer->rx_ctx`. Así una captura no comparte
+ * estado con otra lanzada desde otro hilo.
+ */
+typedef struct {
+	completion_t done;            /**< Aviso de fin del tramo (0: completo, -1: error). */
+	FILE* file;                   /**< Archivo de destino (NULL: sin archivo). */
+	welch_stream_t* psd_stream;   /**< PSD en streaming (NULL: desactivada). */
+	sweep_t* sweep;               /**< Barrido en curso (sólo `getSweep`). */
+	uint8_t* memory_sink;         /**< Destino en memoria (NULL: desactivado). */
+	size_t memory_sink_capacity;  /**< Capacidad de `memory_sink`. */
+	size_t memory_sink_len;       /**< Bytes escritos en `memory_sink` en el tramo. */
+	bool limit_num_samples;       /**< El tramo termina al llegar a `bytes_to_xfer`. */
+	size_t bytes_to_xfer;         /**< Bytes que faltan por entregar en el tramo. */
+	atomic_uint_fast64_t byte_count; /**< Bytes recibidos en el tramo (lo vigila el hilo que espera). */
+	spsc_ring_t* ring;            /**< Cola hacia el consumidor (NULL: el callback escribe directamente). */
+	pthread_t stream_thread;      /**< Hilo consumidor de `ring`. */
+	bool stream_active;           /**< El tramo pasa por `ring`. */
+	atomic_bool stream_stop;      /**< El productor terminó: el consumidor sale al vaciar la cola. */
+	atomic_bool sink_failed;      /**< El destino falló (p. ej. disco lleno). */
+	welch_stream_t* converge;     /**< PSD que decide el fin anticipado (NULL: longitud fija). */
+	uint64_t converge_min_bytes;  /**< Bytes mínimos del tramo antes de poder terminar. */
+	double converge_ci;           /**< Semiancho relativo con el que se da por convergida. */
+	capture_stats_t stats;        /**< Contadores de la captura. */
+} capture_ctx_t;
+
+/**
+ * @brief Activa o desactiva el modo streaming de la PSD.
  * 
- * Esta función se utiliza para finalizar la ejecución del programa de forma segura.
+ * Éste y los demás `set_*` configuran las capturas del hilo que los llama.
+ * Con un acumulador activo, `rx_callback` suma cada buffer recibido a la PSD de
+ * Welch en lugar de escribirlo en `Samples/N`, de modo que la PSD queda lista al
+ * llegar la última transferencia.
+ * 
+ * @param ws Acumulador inicializado con `welch_stream_init`, o NULL para volver a escribir archivos.
  */
-void stop_main_loop(void);
+void set_psd_stream(welch_stream_t* ws);
+
+/**
+ * @brief Activa la captura adaptativa: cada tramo termina cuando la potencia de canal converge.
+ *
+ * Las muestras también se suman a `ws` (además del archivo o la memoria) y el
+ * tramo se da por terminado en cuanto `welch_stream_channel_ci(ws)` baja de
+ * `rel_ci`, siempre que ya se hayan recibido `min_samples` muestras. El
+ * `samples_to_xfer_max` de `getSamples` sigue siendo el máximo. Los canales se
+ * fijan antes con `welch_stream_track_channels`; `ws` se reinicia en cada tramo.
+ *
+ * @param ws Acumulador con canales vigilados, o NULL para volver a la longitud fija.
+ * @param min_samples Muestras IQ mínimas por tramo.
+ * @param rel_ci Semiancho relativo del intervalo de confianza (p. ej. 0.023 ≈ ±0.1 dB).
+ */
+void set_capture_convergence(welch_stream_t* ws, long min_samples, double rel_ci);
+
+/**
+ * @brief Hace que las capturas `TRANSCEIVER_MODE_TDT` de este hilo sean de banda ancha.
+ *
+ * Con `wide` la captura se sintoniza igual (`centralFrec_TDT`) pero se toma a
+ * `DEFAULT_SAMPLE_RATE_HZ` durante `DEFAULT_SAMPLES_TDT_WIDE_XFER_MAX`
+ * muestras, para extraer después varios canales con `ddc.h`.
+ *
+ * @param wide true: 20 MS/s; false: la tasa TDT de siempre.
+ */
+void set_tdt_wideband(bool wide);
+
+/**
+ * @brief Frecuencia central (Hz) a la que `getSamples` sintoniza la banda indicada.
+ *
+ * @param central_freq_Rx_MHz Banda, como en `getSamples`.
+ * @param is_second_sample Captura desplazada `SECOND_SAMPLE_OFFSET_HZ`.
+ */
+int64_t capture_center_hz(uint8_t central_freq_Rx_MHz, bool is_second_sample);
+
+/**
+ * @brief Fija la capacidad de la cola entre `rx_callback` y el hilo consumidor.
+ * 
+ * Con cola, el callback USB sólo copia las muestras y un hilo aparte las lleva
+ * al archivo, a la memoria o a la PSD, de modo que una escritura lenta no hace
+ * perder transferencias (se descartan y se cuentan si la cola se llena).
+ * 
+ * @param bytes Capacidad en bytes (se redondea a potencia de dos), o 0 para escribir desde el callback.
+ */
+void set_stream_ring_size(size_t bytes);
+
+/**
+ * @brief Activa un destino en memoria para las muestras CS8 en lugar de `Samples/N`.
+ * 
+ * Se reinicia en cada tramo; lo que no cabe en `capacity` se ignora.
+ * 
+ * @param buffer Memoria de destino, o NULL para desactivarlo.
+ * @param capacity Tamaño de `buffer` en bytes.
+ */
+void set_memory_sink(uint8_t* buffer, size_t capacity);
+
+/**
+ * @brief Bytes escritos en el destino en memoria durante el último tramo de este hilo.
+ */
+size_t memory_sink_length(void);
+
+/**
+ * @brief Contadores de la última llamada a `getSamples` o `replay_CS8` de este hilo.
+ */
+const capture_stats_t* get_capture_stats(void);
 
 /**
  * @brief Callback para manejar los datos recibidos del HackRF.
  * 
- * @param transfer Estructura de transferencia de HackRF que contiene los datos recibidos.
+ * @param transfer Estructura de transferencia de HackRF que contiene los datos recibidos;
+ *                 `rx_ctx` apunta al `capture_ctx_t` de la captura.
  * @return int Devuelve 0 si el procesamiento fue exitoso, -1 en caso de error.
  */
 int rx_callback(hackrf_transfer* transfer);
@@ -75,17 +248,12 @@ int rx_callback(hackrf_transfer* transfer);
 /**
  * @brief Manejador de la señal SIGINT (Ctrl+C).
  * 
+ * Se instala una sola vez, en la primera captura. Interrumpe las capturas en curso.
+ * 
  * @param signum Número de la señal capturada.
  */
 void sigint_callback_handler(int signum);
 
-/**
- * @brief Manejador de la señal SIGALRM.
- * 
- * Este manejador se ejecuta cuando se captura la señal SIGALRM.
- */
-void sigalrm_callback_handler();
-
 /**
  * @brief Configura y ejecuta la adquisición de muestras con HackRF.
  * 
@@ -98,4 +266,32 @@ void sigalrm_callback_handler();
  */
 int getSamples(uint8_t bands, long samples_to_xfer_max, transceiver_mode_t transceiver_mode, uint16_t lna_gain, uint16_t vga_gain, uint16_t centralFrec, bool is_second_sample);
 
+/**
+ * @brief Ejecuta un barrido completo con una sola captura en modo sweep.
+ * 
+ * Programa la sesión de radio una vez, arranca el barrido del plan de `sw` y
+ * espera a que se completen `sw->sweeps_target` pasadas por todos los tramos.
+ * Los bloques se acumulan en los tramos de `sw` a medida que llegan; el
+ * panorama se obtiene después con `sweep_panorama`.
+ * 
+ * @param sw Barrido inicializado con `sweep_init`.
+ * @param lna_gain Ganancia del amplificador de bajo ruido (LNA) en dB.
+ * @param vga_gain Ganancia del amplificador de ganancia variable (VGA) en dB.
+ * @return int Devuelve 0 si se recibieron datos, -1 en caso de error.
+ */
+int getSweep(sweep_t* sw, uint16_t lna_gain, uint16_t vga_gain);
+
+/**
+ * @brief Reproduce un archivo CS8 grabado a través de `rx_callback`.
+ * 
+ * Entrega el archivo en bloques de `REPLAY_TRANSFER_SIZE` bytes por el mismo camino
+ * que las transferencias del HackRF, lo que permite probar el modo streaming
+ * (o la escritura en `Samples/0`) sin radio.
+ * 
+ * @param filename Archivo CS8 a reproducir.
+ * @param samples_to_xfer_max Número máximo de muestras IQ a entregar (0: todo el archivo).
+ * @return int Devuelve 0 si se entregó al menos un bloque, -1 en caso de error.
+ */
+int replay_CS8(const char* filename, long samples_to_xfer_max);
+
 #endif // BACN_RF_H
@@ -0,0 +1,286 @@
+/**
+ * @file band_registry.c
+ * @brief Implementación del registro de bandas.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "band_registry.h"
+
+/**
+ * @struct band_def_t
+ * @brief Descripción fija de una banda: archivo, servicio y frecuencia mínima
+ * con la que la pide el servidor.
+ */
+typedef struct {
+    bands_t id;
+    const char* name;
+    const char* service;
+    uint16_t fmin_mhz;
+} band_def_t;
+
+static const band_def_t band_defs[BAND_REGISTRY_SIZE] = {
+    {VHF1, "VHF1", "VHF", 88},
+    {VHF2, "VHF2", "VHF", 137},
+    {VHF3, "VHF3", "VHF", 148},
+    {VHF4, "VHF4", "VHF", 154},
+    {UHF1, "UHF1", "UHF", 400},
+    {UHF1_2, "UHF1_2", "UHF", 420},
+    {UHF1_3, "UHF1_3", "UHF", 440},
+    {UHF1_4, "UHF1_4", "UHF", 450},
+    {UHF2_1, "UHF2_1", "TDT", 470},
+    {UHF2_2, "UHF2_2", "TDT", 488},
+    {UHF2_3, "UHF2_3", "TDT", 506},
+    {UHF2_4, "UHF2_4", "TDT", 524},
+    {UHF2_5, "UHF2_5", "TDT", 542},
+    {UHF2_6, "UHF2_6", "TDT", 560},
+    {UHF2_7, "UHF2_7", "TDT", 578},
+    {UHF2_8, "UHF2_8", "TDT", 596},
+    {UHF2_9, "UHF2_9", "TDT", 614},
+    {UHF2_10, "UHF2_10", "TDT", 632},
+    {UHF2_11, "UHF2_11", "TDT", 650},
+    {UHF2_12, "UHF2_12", "TDT", 668},
+    {UHF2_13, "UHF2_13", "TDT", 678},
+    {UHF3, "UHF3", "UHF", 1708},
+    {UHF3_1, "UHF3_1", "UHF", 1735},
+    {UHF3_2, "UHF3_2", "UHF", 1805},
+    {UHF3_3, "UHF3_3", "UHF", 1848},
+    {UHF3_4, "UHF3_4", "UHF", 1868},
+    {UHF3_5, "UHF3_5", "UHF", 1877},
+    {SHF1, "SHF1", "SHF", 2550},
+    {SHF2, "SHF2", "SHF", 3295},
+    {SHF2_2, "SHF2_2", "SHF", 3338},
+    {SHF2_3, "SHF2_3", "SHF", 3375},
+    {SHF2_4, "SHF2_4", "SHF", 3444},
+    {SHF2_5, "SHF2_5", "SHF", 3538},
+    {SHF2_6, "SHF2_6", "SHF", 3550},
+    {SHF2_7, "SHF2_7", "SHF", 3580},
+};
+
+/** @brief Bandas por identificador. */
+static band_info_t registry[BAND_REGISTRY_SIZE];
+
+/** @brief Bandas cargadas, ordenadas por inicio de cobertura. */
+static const band_info_t* by_freq[BAND_REGISTRY_SIZE];
+static int by_freq_count = 0;
+
+/** @brief Canales de la banda más grande. */
+static int max_channels = 0;
+
+/** @brief Canalizaciones de todas las bandas, una tras otra. */
+static double* pool_frequency = NULL;
+static double* pool_bandwidth = NULL;
+
+static pthread_once_t registry_once = PTHREAD_ONCE_INIT;
+static int registry_status = -1;
+
+/**
+ * @brief Agrega las filas de `bands/<name>.csv` a los bloques comunes, en una sola lectura.
+ *
+ * @return Filas agregadas, o -1 si no se pudo abrir el archivo o no hay memoria.
+ */
+static int load_band_file(const char* name, size_t* used, size_t* capacity)
+{
+    char path[64];
+    char line[128];
+    snprintf(path, sizeof(path), "%s/%s.csv", BAND_REGISTRY_DIR, name);
+
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Unable to open file %s\n", path);
+        return -1;
+    }
+
+    int rows = 0;
+    bool header = true;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (header) {
+            header = false;
+            continue;
+        }
+        char* end;
+        double freq = strtod(line, &end);
+        if (end == line || *end != ',') {
+            continue;
+        }
+        double bw = strtod(end + 1, NULL);
+
+        if (*used == *capacity) {
+            size_t grown = (*capacity == 0) ? 1024 : 2 * *capacity;
+            double* f = (double*)realloc(pool_frequency, grown * sizeof(double));
+            if (f != NULL) pool_frequency = f;
+            double* b = (double*)realloc(pool_bandwidth, grown * sizeof(double));
+            if (b != NULL) pool_bandwidth = b;
+            if (f == NULL || b == NULL) {
+                fprintf(stderr, "Error: No se pudo reservar memoria para las bandas\n");
+                fclose(file);
+                return -1;
+            }
+            *capacity = grown;
+        }
+        pool_frequency[*used] = freq;
+        pool_bandwidth[*used] = bw;
+        (*used)++;
+        rows++;
+    }
+
+    fclose(file);
+    return rows;
+}
+
+static int compare_tile(const void* a, const void* b)
+{
+    const band_info_t* x = *(const band_info_t* const*)a;
+    const band_info_t* y = *(const band_info_t* const*)b;
+    return (x->tile_lo_mhz > y->tile_lo_mhz) - (x->tile_lo_mhz < y->tile_lo_mhz);
+}
+
+static void registry_load(void)
+{
+    size_t offset[BAND_REGISTRY_SIZE];
+    size_t used = 0;
+    size_t capacity = 0;
+    int status = 0;
+
+    for (int i = 0; i < BAND_REGISTRY_SIZE; i++) {
+        const band_def_t* def = &band_defs[i];
+        band_info_t* info = &registry[def->id];
+        info->id = def->id;
+        info->name = def->name;
+        info->service = def->service;
+        info->fmin_mhz = def->fmin_mhz;
+        info->tile_lo_mhz = def->fmin_mhz;
+        info->tile_hi_mhz = def->fmin_mhz + BAND_TILE_SPAN_MHZ;
+
+        offset[def->id] = used;
+        int rows = load_band_file(def->name, &used, &capacity);
+        if (rows < 0) {
+            status = -1;
+            rows = 0;
+        }
+        info->n_channels = rows;
+    }
+
+    // Los bloques ya no cambian de tamaño: se pueden fijar los punteros
+    for (int i = 0; i < BAND_REGISTRY_SIZE; i++) {
+        band_info_t* info = &registry[i];
+        if (info->n_channels == 0) {
+            continue;
+        }
+        info->frequency = pool_frequency + offset[i];
+        info->bandwidth = pool_bandwidth + offset[i];
+        info->channel_lo_mhz = info->frequency[0] - info->bandwidth[0] / 2;
+        info->channel_hi_mhz = info->frequency[0] + info->bandwidth[0] / 2;
+        for (int c = 1; c < info->n_channels; c++) {
+            double lo = info->frequency[c] - info->bandwidth[c] / 2;
+            double hi = info->frequency[c] + info->bandwidth[c] / 2;
+            if (lo < info->channel_lo_mhz) info->channel_lo_mhz = lo;
+            if (hi > info->channel_hi_mhz) info->channel_hi_mhz = hi;
+        }
+        by_freq[by_freq_count++] = info;
+        if (info->n_channels > max_channels) {
+            max_channels = info->n_channels;
+        }
+    }
+    qsort(by_freq, (size_t)by_freq_count, sizeof(by_freq[0]), compare_tile);
+
+    registry_status = status;
+}
+
+int band_registry_init(void)
+{
+    pthread_once(&registry_once, registry_load);
+    return registry_status;
+}
+
+const band_info_t* band_registry_get(uint8_t band)
+{
+    band_registry_init();
+    if (band >= BAND_REGISTRY_SIZE || registry[band].n_channels == 0) {
+        return NULL;
+    }
+    return &registry[band];
+}
+
+int band_registry_max_channels(void)
+{
+    band_registry_init();
+    return max_channels;
+}
+
+/**
+ * @brief Primera banda (en `by_freq`) cuya cobertura termina después de `lo_mhz`.
+ */
+static int first_tile_after(double lo_mhz)
+{
+    // Todas las coberturas miden lo mismo: el fin también está ordenado
+    int first = 0;
+    int last = by_freq_count;
+    while (first < last) {
+        int mid = first + (last - first) / 2;
+        if (by_freq[mid]->tile_hi_mhz > lo_mhz) {
+            last = mid;
+        } else {
+            first = mid + 1;
+        }
+    }
+    return first;
+}
+
+const band_info_t* band_registry_resolve(const char* service, const char* fmin, const char* fmax)
+{
+    band_registry_init();
+    if (service == NULL || fmin == NULL) {
+        return NULL;
+    }
+
+    char* end;
+    double lo = strtod(fmin, &end);
+    if (end == fmin) {
+        return NULL;
+    }
+    double hi = (fmax != NULL) ? strtod(fmax, NULL) : 0.0;
+    if (!(hi > lo)) {
+        hi = lo + BAND_TILE_SPAN_MHZ;
+    }
+
+    int first = first_tile_after(lo);
+    const band_info_t* best = NULL;
+    double best_overlap = 0.0;
+    for (int i = first; i < by_freq_count && by_freq[i]->tile_lo_mhz < hi; i++) {
+        const band_info_t* info = by_freq[i];
+        if (strcmp(info->service, service) != 0) {
+            continue;
+        }
+        if (info->tile_lo_mhz == lo) {
+            return info;
+        }
+        double a = (info->tile_lo_mhz > lo) ? info->tile_lo_mhz : lo;
+        double b = (info->tile_hi_mhz < hi) ? info->tile_hi_mhz : hi;
+        if (b - a > best_overlap) {
+            best_overlap = b - a;
+            best = info;
+        }
+    }
+    return best;
+}
+
+int band_registry_tiles(const char* service, double lo_mhz, double hi_mhz, const band_info_t** out, int max)
+{
+    band_registry_init();
+    if (service == NULL) {
+        return 0;
+    }
+
+    int n = 0;
+    for (int i = first_tile_after(lo_mhz); i < by_freq_count && by_freq[i]->tile_lo_mhz < hi_mhz && n < max; i++) {
+        if (strcmp(by_freq[i]->service, service) == 0) {
+            out[n++] = by_freq[i];
+        }
+    }
+    return n;
+}
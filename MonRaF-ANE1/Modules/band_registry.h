@@ -0,0 +1,115 @@
+/**
+ * @file band_registry.h
+ * @brief Registro inmutable de las bandas de medición, cargado una sola vez desde `bands/`.
+ *
+ * Cada banda de `bands_t` tiene su canalización (`bands/<nombre>.csv`, filas
+ * "frequency,bandwidth" en MHz) y la porción de espectro que cubre una captura
+ * (`BAND_TILE_SPAN_MHZ` desde la frecuencia mínima que envía el servidor).
+ * Todas las canalizaciones se leen en la primera llamada y quedan en dos
+ * bloques contiguos; después las mediciones sólo consultan punteros, sin
+ * tocar el sistema de archivos, desde cualquier hilo.
+ *
+ * Las bandas también se guardan ordenadas por frecuencia, para resolver una
+ * petición (servicio, fmin, fmax) con una búsqueda binaria sobre la cobertura
+ * en lugar de comparar cadenas banda por banda.
+ */
+
+#ifndef BAND_REGISTRY_H
+#define BAND_REGISTRY_H
+
+#include <stdint.h>
+#include "IQ.h"
+
+/**
+ * @def BAND_REGISTRY_DIR
+ * @brief Directorio de las canalizaciones.
+ */
+#define BAND_REGISTRY_DIR "bands"
+
+/**
+ * @def BAND_REGISTRY_SIZE
+ * @brief Número de bandas de `bands_t`.
+ */
+#define BAND_REGISTRY_SIZE (SHF2_7 + 1)
+
+/**
+ * @def BAND_TILE_SPAN_MHZ
+ * @brief Espectro que cubre una banda a partir de su frecuencia mínima (una captura de 20 MS/s).
+ */
+#define BAND_TILE_SPAN_MHZ (20)
+
+/**
+ * @struct band_info_t
+ * @brief Banda del registro.
+ */
+typedef struct {
+    bands_t id;                /**< Banda. */
+    const char* name;          /**< Nombre del archivo sin extensión ("VHF1", ...). */
+    const char* service;       /**< Servicio con el que la pide el servidor ("VHF", "UHF", "TDT", "SHF"). */
+    uint16_t fmin_mhz;         /**< Frecuencia mínima que envía el servidor. */
+    double tile_lo_mhz;        /**< Inicio de la cobertura (`fmin_mhz`). */
+    double tile_hi_mhz;        /**< Fin de la cobertura (`fmin_mhz + BAND_TILE_SPAN_MHZ`). */
+    double channel_lo_mhz;     /**< Borde inferior del primer canal. */
+    double channel_hi_mhz;     /**< Borde superior del último canal. */
+    int n_channels;            /**< Canales de la banda. */
+    const double* frequency;   /**< Frecuencia central de cada canal (MHz). */
+    const double* bandwidth;   /**< Ancho de banda de cada canal (MHz). */
+} band_info_t;
+
+/**
+ * @brief Carga el registro si aún no está cargado.
+ *
+ * Es seguro llamarla desde varios hilos; sólo la primera lee los archivos.
+ * Las demás funciones la llaman por su cuenta.
+ *
+ * @return 0 si todas las bandas se cargaron, -1 si faltó alguna (las demás siguen disponibles).
+ */
+int band_registry_init(void);
+
+/**
+ * @brief Banda por identificador.
+ *
+ * @return La banda, o NULL si `band` no existe o su canalización no se pudo cargar.
+ */
+const band_info_t* band_registry_get(uint8_t band);
+
+/**
+ * @brief Canales de la banda cargada más grande (0 si no se cargó ninguna).
+ *
+ * Acota las filas de parámetros de cualquier registro RMER/RNI.
+ */
+int band_registry_max_channels(void);
+
+/**
+ * @brief Resuelve una petición del servidor a una banda.
+ *
+ * Si alguna banda del servicio empieza exactamente en `fmin` se devuelve ésa;
+ * si no, la del servicio cuya cobertura comparte más espectro con
+ * [`fmin`, `fmax`]. Sin `fmax` (NULL o no mayor que `fmin`) se toma una
+ * cobertura completa a partir de `fmin`.
+ *
+ * @param service Servicio ("VHF", "UHF", "TDT", "SHF").
+ * @param fmin Frecuencia mínima en MHz, como texto.
+ * @param fmax Frecuencia máxima en MHz, como texto (puede ser NULL).
+ *
+ * @return La banda, o NULL si ninguna del servicio cubre el intervalo.
+ */
+const band_info_t* band_registry_resolve(const char* service, const char* fmin, const char* fmax);
+
+/**
+ * @brief Bandas de un servicio cuya cobertura comparte espectro con [`lo_mhz`, `hi_mhz`], ordenadas por frecuencia.
+ *
+ * Sirve para las peticiones que abarcan varias coberturas (p. ej. todo TDT),
+ * que se miden con un barrido (`sweep.h`) en lugar de banda por banda.
+ *
+ * @param service Servicio ("VHF", "UHF", "TDT", "SHF").
+ * @param lo_mhz Inicio del intervalo en MHz.
+ * @param hi_mhz Fin del intervalo en MHz.
+ * @param out Recibe las bandas.
+ * @param max Capacidad de `out`.
+ *
+ * @return Número de bandas escritas en `out`.
+ */
+int band_registry_tiles(const char* service, double lo_mhz, double hi_mhz, const band_info_t** out, int max);
+
+#endif // BAND_REGISTRY_H
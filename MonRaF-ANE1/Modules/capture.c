@@ -5,15 +5,12 @@
 #include <complex.h>
 #include "bacn_RF.h"
 #include "cs8_to_iq.h"
+#include "welch_stream.h"
+#include "sweep.h"
+#include "cs8_map.h"
+#include "pfb.h"
 #include "capture.h"
 
-// Stub necesario por bacn_RF
-int central_freq[10] = {100};
-void switch_ANTENNA(bool RF) {
-    (void)RF;
-    printf("[stub] switch_ANTENNA llamado (ignorado)\n");
-}
-
 int capture_signal(long samples_to_xfer_max, uint64_t central_frequency_mhz) {
     transceiver_mode_t mode = TRANSCEIVER_MODE_RX;
     uint16_t lna_gain = 0;
@@ -49,3 +46,123 @@ complex double* convert_cs8(const char* filename, size_t* N) {
     return x;
 }
 
+int capture_psd(long samples_to_xfer_max, uint64_t central_frequency_mhz,
+                int segment_length, double overlap, double* f, double* Pxx) {
+    welch_stream_t ws;
+    if (welch_stream_init(&ws, DEFAULT_SAMPLE_RATE_HZ, segment_length, overlap,
+                          WINDOW_HAMMING) != 0) {
+        return 1;
+    }
+
+    printf("▶ Capturando PSD en streaming en %lu MHz (N=%ld, nperseg=%d)...\n",
+           central_frequency_mhz, samples_to_xfer_max, segment_length);
+
+    set_psd_stream(&ws);
+    int r = getSamples(central_frequency_mhz, samples_to_xfer_max,
+                       TRANSCEIVER_MODE_RX, 0, 0, 200, false);
+    set_psd_stream(NULL);
+
+    long k = (r == 0) ? welch_stream_finish(&ws, f, Pxx) : -1;
+    welch_stream_free(&ws);
+
+    if (k <= 0) {
+        fprintf(stderr, "❌ Captura en streaming fallida (%d)\n", r);
+        return 1;
+    }
+    return 0;
+}
+
+int replay_psd(const char* filename, long samples_to_xfer_max,
+               int segment_length, double overlap, double* f, double* Pxx) {
+    welch_stream_t ws;
+    if (welch_stream_init(&ws, DEFAULT_SAMPLE_RATE_HZ, segment_length, overlap,
+                          WINDOW_HAMMING) != 0) {
+        return 1;
+    }
+
+    set_psd_stream(&ws);
+    int r = replay_CS8(filename, samples_to_xfer_max);
+    set_psd_stream(NULL);
+
+    long k = (r == 0) ? welch_stream_finish(&ws, f, Pxx) : -1;
+    welch_stream_free(&ws);
+
+    if (k <= 0) {
+        fprintf(stderr, "❌ Error reproduciendo %s\n", filename);
+        return 1;
+    }
+    printf("📥 %s reproducido en streaming (%ld segmentos)\n", filename, k);
+    return 0;
+}
+
+int capture_sweep(uint64_t lo_mhz, uint64_t hi_mhz, int sweeps, int segment_length,
+                  double overlap, double** f, double** Pxx) {
+    sweep_t sw;
+    if (sweep_init(&sw, lo_mhz * 1000000, hi_mhz * 1000000, segment_length,
+                   overlap, sweeps, WINDOW_HAMMING) != 0) {
+        return -1;
+    }
+
+    printf("▶ Barriendo %lu-%lu MHz en %d tramos (%d pasadas)...\n",
+           lo_mhz, hi_mhz, sw.n_tiles, sw.sweeps_target);
+
+    int bins = sweep_bins(&sw);
+    *f = malloc(bins * sizeof(double));
+    *Pxx = malloc(bins * sizeof(double));
+
+    int r = (*f && *Pxx) ? getSweep(&sw, 0, 0) : -1;
+    if (r == 0) {
+        r = sweep_panorama(&sw, *f, *Pxx);
+    }
+    sweep_free(&sw);
+
+    if (r != 0) {
+        fprintf(stderr, "❌ Barrido fallido\n");
+        free(*f); free(*Pxx);
+        *f = NULL; *Pxx = NULL;
+        return -1;
+    }
+    printf("✅ Panorama de %d bins\n", bins);
+    return bins;
+}
+
+int capture_channels(const char* filename, long samples_to_xfer_max, uint64_t central_frequency_mhz,
+                     const double* freq_mhz, const double* bw_mhz, int n_channels,
+                     double* power, double* peak) {
+    double raster_hz = pfb_raster(freq_mhz, bw_mhz, n_channels) * 1e6;
+    pfb_t pfb;
+    if (pfb_init(&pfb, DEFAULT_SAMPLE_RATE_HZ, raster_hz, PFB_DEFAULT_TAPS, false) != 0) {
+        return -1;
+    }
+
+    if (filename == NULL) {
+        if (capture_signal(samples_to_xfer_max, central_frequency_mhz) != 0) {
+            pfb_free(&pfb);
+            return -1;
+        }
+        filename = "Samples/0";
+    }
+
+    cs8_map_t capture;
+    if (cs8_map_open(&capture, filename) != 0) {
+        pfb_free(&pfb);
+        return -1;
+    }
+
+    printf("▶ Canalizando %zu muestras en %d subcanales de %.1f kHz...\n",
+           capture.num_samples, pfb.M, raster_hz / 1000.0);
+    pfb_push_cs8(&pfb, capture.data, capture.length);
+    cs8_map_close(&capture);
+
+    int inside = 0;
+    for (int i = 0; i < n_channels; i++) {
+        double offset_hz = freq_mhz[i] * 1e6 - (double)central_frequency_mhz * 1e6;
+        if (pfb_band_power(&pfb, offset_hz, bw_mhz[i] * 1e6, &power[i], &peak[i]) > 0) {
+            inside++;
+        }
+    }
+    pfb_free(&pfb);
+
+    printf("✅ %d de %d canales dentro de la captura\n", inside, n_channels);
+    return inside;
+}
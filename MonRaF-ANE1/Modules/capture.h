@@ -12,4 +12,25 @@ int capture_signal(long samples_to_xfer_max, uint64_t central_frequency_mhz);
 // Convierte archivo CS8 → vector de IQ complejos
 complex double* convert_cs8(const char* filename, size_t* N);
 
+// Captura IQ desde HackRF acumulando la PSD de Welch en streaming (sin archivo CS8)
+int capture_psd(long samples_to_xfer_max, uint64_t central_frequency_mhz,
+                int segment_length, double overlap, double* f, double* Pxx);
+
+// Reproduce un archivo CS8 por el camino de rx_callback acumulando la PSD en streaming
+int replay_psd(const char* filename, long samples_to_xfer_max,
+               int segment_length, double overlap, double* f, double* Pxx);
+
+// Barre [lo_mhz, hi_mhz) con una sola captura en modo sweep y une los tramos en un panorama.
+// Reserva *f y *Pxx (liberar con free) y devuelve el número de bins, o -1 en caso de error.
+// Herramienta de prueba; la tubería barre las peticiones de varias bandas (ver sweep.h).
+int capture_sweep(uint64_t lo_mhz, uint64_t hi_mhz, int sweeps, int segment_length,
+                  double overlap, double** f, double** Pxx);
+
+// Mide un plan de canales (freq_mhz/bw_mhz, como en bands/*.csv) con el canalizador PFB sobre
+// `filename` (NULL: captura nueva en Samples/0). Escribe la potencia media y el pico de cada canal
+// (lineales, unidades CS8^2) y devuelve cuántos caen dentro de la captura, o -1 en caso de error.
+int capture_channels(const char* filename, long samples_to_xfer_max, uint64_t central_frequency_mhz,
+                     const double* freq_mhz, const double* bw_mhz, int n_channels,
+                     double* power, double* peak);
+
 #endif
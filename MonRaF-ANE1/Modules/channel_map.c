@@ -0,0 +1,147 @@
+/**
+ * @file channel_map.c
+ * @brief Implementación de la caché de tablas canal → bins.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "channel_map.h"
+#include "find_closest_index.h"
+
+/** @brief Tablas en caché. */
+static channel_map_t* map_cache[CHANNEL_MAP_CACHE_SIZE];
+
+/** @brief Número de entradas válidas en `map_cache`. */
+static int map_count = 0;
+
+/** @brief Reloj lógico de accesos: la entrada con `last_use` menor es la más antigua. */
+static uint64_t map_clock = 0;
+
+static pthread_mutex_t map_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief FNV-1a de 64 bits sobre los bytes de un bloque, encadenable con `hash`.
+ */
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t len)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Calcula los bins de cada canal sobre el eje uniforme de la PSD.
+ */
+static void channel_map_fill(channel_map_t* map, const double* canalization, const double* bandwidth)
+{
+    const double f0 = ((double)map->central_freq - map->fs / 2.0) / 1e6;
+    const double df = map->fs / map->nfft / 1e6;
+
+    for (int i = 0; i < map->n_channels; i++) {
+        channel_bins_t* b = &map->bins[i];
+        b->lower = uniform_closest_index(f0, df, map->nfft, canalization[i] - bandwidth[i] / 2);
+        b->upper = uniform_closest_index(f0, df, map->nfft, canalization[i] + bandwidth[i] / 2);
+        b->center = uniform_closest_index(f0, df, map->nfft, canalization[i]);
+        if (b->lower > b->upper) {
+            int tmp = b->lower;
+            b->lower = b->upper;
+            b->upper = tmp;
+        }
+    }
+}
+
+/**
+ * @brief Suelta una referencia y libera la tabla si era la última. Requiere `map_lock`.
+ */
+static void map_unref(channel_map_t* map)
+{
+    if (--map->refs == 0) {
+        free(map->bins);
+        free(map);
+    }
+}
+
+/**
+ * @brief Saca de la caché la tabla usada hace más tiempo. Requiere `map_lock`.
+ */
+static void map_evict_oldest(void)
+{
+    int oldest = 0;
+    for (int i = 1; i < map_count; i++) {
+        if (map_cache[i]->last_use < map_cache[oldest]->last_use) {
+            oldest = i;
+        }
+    }
+    // Si una medición aún la usa, se libera cuando la suelte
+    map_unref(map_cache[oldest]);
+    map_cache[oldest] = map_cache[--map_count];
+}
+
+const channel_map_t* channel_map_get(const double* canalization, const double* bandwidth, int n_channels,
+                                     uint64_t central_freq, int nfft, double fs)
+{
+    if (n_channels <= 0 || nfft < 2 || fs <= 0.0) {
+        fprintf(stderr, "Error: tabla de canales inválida (%d canales, nfft %d)\n", n_channels, nfft);
+        return NULL;
+    }
+
+    uint64_t hash = fnv1a(14695981039346656037ull, canalization, (size_t)n_channels * sizeof(double));
+    hash = fnv1a(hash, bandwidth, (size_t)n_channels * sizeof(double));
+
+    pthread_mutex_lock(&map_lock);
+
+    for (int i = 0; i < map_count; i++) {
+        channel_map_t* m = map_cache[i];
+        if (m->band_hash == hash && m->n_channels == n_channels && m->central_freq == central_freq &&
+            m->nfft == nfft && m->fs == fs) {
+            m->refs++;
+            m->last_use = ++map_clock;
+            pthread_mutex_unlock(&map_lock);
+            return m;
+        }
+    }
+
+    channel_map_t* entry = (channel_map_t*)malloc(sizeof(channel_map_t));
+    channel_bins_t* bins = (channel_bins_t*)malloc((size_t)n_channels * sizeof(channel_bins_t));
+    if (entry == NULL || bins == NULL) {
+        fprintf(stderr, "Error: No se pudo reservar memoria para la tabla de canales\n");
+        free(entry);
+        free(bins);
+        pthread_mutex_unlock(&map_lock);
+        return NULL;
+    }
+
+    if (map_count >= CHANNEL_MAP_CACHE_SIZE) {
+        map_evict_oldest();
+    }
+
+    entry->band_hash = hash;
+    entry->n_channels = n_channels;
+    entry->central_freq = central_freq;
+    entry->nfft = nfft;
+    entry->fs = fs;
+    entry->bins = bins;
+    entry->refs = 2;  // La caché y quien la pidió
+    entry->last_use = ++map_clock;
+    channel_map_fill(entry, canalization, bandwidth);
+    map_cache[map_count++] = entry;
+
+    pthread_mutex_unlock(&map_lock);
+    return entry;
+}
+
+void channel_map_release(const channel_map_t* map)
+{
+    if (map == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&map_lock);
+    map_unref((channel_map_t*)map);
+    pthread_mutex_unlock(&map_lock);
+}
@@ -0,0 +1,78 @@
+/**
+ * @file channel_map.h
+ * @brief Tablas precalculadas canal → bins de la PSD, compartidas entre mediciones.
+ *
+ * Los parámetros RMER/RNI miden cada canal de la banda sobre el intervalo de
+ * bins [`lower`, `upper`] de la PSD cuyos extremos están más cerca de
+ * `frecuencia ± ancho / 2`. Ese intervalo sólo depende de la canalización, de
+ * la sintonía y del eje de la PSD (`nfft`, `fs`), así que se calcula una vez
+ * por combinación y se reutiliza en todas las mediciones siguientes de la
+ * misma banda. El eje es el de `welch_psd_finalize` pasado a MHz absolutos:
+ * `(sintonía - fs/2 + i·fs/nfft) / 1e6`.
+ *
+ * La caché guarda hasta `CHANNEL_MAP_CACHE_SIZE` tablas; al llenarse descarta
+ * la usada hace más tiempo (LRU). Cada `channel_map_get` toma una referencia
+ * que se devuelve con `channel_map_release`, de modo que una tabla descartada
+ * mientras una medición la usa sigue válida hasta que ésta la suelta.
+ */
+
+#ifndef CHANNEL_MAP_H
+#define CHANNEL_MAP_H
+
+#include <stdint.h>
+
+/**
+ * @def CHANNEL_MAP_CACHE_SIZE
+ * @brief Número máximo de tablas (banda, sintonía, nfft, fs) en caché; las más antiguas se descartan.
+ */
+#define CHANNEL_MAP_CACHE_SIZE 64
+
+/**
+ * @struct channel_bins_t
+ * @brief Bins de la PSD de un canal.
+ */
+typedef struct {
+    int lower;    /**< Bin más cercano a `frecuencia - ancho / 2`. */
+    int upper;    /**< Bin más cercano a `frecuencia + ancho / 2` (>= `lower`). */
+    int center;   /**< Bin más cercano a la frecuencia del canal. */
+} channel_bins_t;
+
+/**
+ * @struct channel_map_t
+ * @brief Tabla de una canalización sobre un eje de PSD concreto.
+ */
+typedef struct {
+    uint64_t band_hash;      /**< Huella de la canalización y los anchos de banda. */
+    int n_channels;          /**< Canales de la banda. */
+    uint64_t central_freq;   /**< Sintonía de la captura en Hz. */
+    int nfft;                /**< Bins de la PSD. */
+    double fs;               /**< Frecuencia de muestreo. */
+    channel_bins_t* bins;    /**< Un elemento por canal. */
+    int refs;                /**< Referencias: la caché y cada usuario (uso interno). */
+    uint64_t last_use;       /**< Reloj de la caché en el último acceso (uso interno). */
+} channel_map_t;
+
+/**
+ * @brief Obtiene (o calcula) la tabla de una canalización en MHz.
+ *
+ * La tabla no debe modificarse; se devuelve con `channel_map_release` cuando
+ * ya no se usa. Es seguro llamar desde varios hilos.
+ *
+ * @param canalization Frecuencias centrales de los canales (MHz).
+ * @param bandwidth Ancho de banda de cada canal (MHz).
+ * @param n_channels Número de canales.
+ * @param central_freq Sintonía de la captura en Hz.
+ * @param nfft Bins de la PSD.
+ * @param fs Frecuencia de muestreo.
+ *
+ * @return La tabla, o NULL si los parámetros son inválidos o no hay memoria.
+ */
+const channel_map_t* channel_map_get(const double* canalization, const double* bandwidth, int n_channels,
+                                     uint64_t central_freq, int nfft, double fs);
+
+/**
+ * @brief Devuelve una tabla obtenida con `channel_map_get` (NULL no hace nada).
+ */
+void channel_map_release(const channel_map_t* map);
+
+#endif // CHANNEL_MAP_H
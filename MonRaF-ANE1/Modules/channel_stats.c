@@ -0,0 +1,242 @@
+/**
+ * @file channel_stats.c
+ * @brief Implementación de las estadísticas por canal.
+ *
+ * La selección es un quickselect con pivote mediana de tres y partición de
+ * Hoare; si la recursión se alarga más de 2·log2(n) vueltas (entradas
+ * adversas) el tramo restante se ordena, lo que acota el peor caso a
+ * O(n log n). Los tramos cortos se terminan por inserción.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "channel_stats.h"
+
+/** @brief Tramos más cortos que esto se ordenan por inserción. */
+#define SELECT_INSERTION 16
+
+/** @brief Área de trabajo del hilo: copia del tramo del canal en curso. */
+static _Thread_local double* scratch = NULL;
+
+/** @brief Capacidad de `scratch` en elementos. */
+static _Thread_local size_t scratch_capacity = 0;
+
+static int compare_double(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Garantiza espacio para `n` elementos en el área de trabajo.
+ */
+static double* scratch_reserve(size_t n)
+{
+    if (n > scratch_capacity) {
+        double* grown = (double*)realloc(scratch, n * sizeof(double));
+        if (grown == NULL) {
+            fprintf(stderr, "Error: Unable to allocate channel statistics scratch\n");
+            return NULL;
+        }
+        scratch = grown;
+        scratch_capacity = n;
+    }
+    return scratch;
+}
+
+static inline void swap_double(double* a, int i, int j)
+{
+    double t = a[i];
+    a[i] = a[j];
+    a[j] = t;
+}
+
+/**
+ * @brief Deja en `a[k]` el k-ésimo menor de `a[0, n)`, con los menores a su izquierda y los mayores a su derecha.
+ */
+static double select_kth(double* a, int n, int k)
+{
+    int lo = 0;
+    int hi = n;
+    int depth = 2 * (int)log2((double)n + 1.0);
+
+    while (hi - lo > SELECT_INSERTION) {
+        if (depth-- == 0) {
+            qsort(a + lo, (size_t)(hi - lo), sizeof(double), compare_double);
+            return a[k];
+        }
+
+        int mid = lo + (hi - lo) / 2;
+        if (a[mid] < a[lo]) swap_double(a, mid, lo);
+        if (a[hi - 1] < a[lo]) swap_double(a, hi - 1, lo);
+        if (a[hi - 1] < a[mid]) swap_double(a, hi - 1, mid);
+        double pivot = a[mid];
+
+        int i = lo;
+        int j = hi - 1;
+        while (i <= j) {
+            while (a[i] < pivot) i++;
+            while (a[j] > pivot) j--;
+            if (i <= j) {
+                swap_double(a, i, j);
+                i++;
+                j--;
+            }
+        }
+        // [lo, j] <= pivot, (j, i) == pivot, [i, hi) >= pivot
+        if (k <= j) {
+            hi = j + 1;
+        } else if (k >= i) {
+            lo = i;
+        } else {
+            return a[k];
+        }
+    }
+
+    for (int i = lo + 1; i < hi; i++) {
+        double v = a[i];
+        int j = i - 1;
+        while (j >= lo && a[j] > v) {
+            a[j + 1] = a[j];
+            j--;
+        }
+        a[j + 1] = v;
+    }
+    return a[k];
+}
+
+/**
+ * @brief Valor de orden `k` (con `k + 1` si `frac > 0`, interpolado) de `a[0, n)`.
+ */
+static double order_stat(double* a, int n, int k, double frac)
+{
+    double lo = select_kth(a, n, k);
+    if (frac <= 0.0 || k + 1 >= n) {
+        return lo;
+    }
+    // Tras la selección el siguiente es el menor de la parte derecha
+    double hi = a[k + 1];
+    for (int i = k + 2; i < n; i++) {
+        if (a[i] < hi) hi = a[i];
+    }
+    return lo + (hi - lo) * frac;
+}
+
+/**
+ * @brief Mediana de `a[0, n)`, igual que ordenar y promediar los dos centrales si `n` es par.
+ */
+static double median_of(double* a, int n)
+{
+    int k = n / 2;
+    double upper = select_kth(a, n, k);
+    if (n % 2 != 0) {
+        return upper;
+    }
+    // El central inferior es el mayor de la parte izquierda
+    double lower = a[0];
+    for (int i = 1; i < k; i++) {
+        if (a[i] > lower) lower = a[i];
+    }
+    return 0.5 * (lower + upper);
+}
+
+/**
+ * @brief Copia `src[0, n)` a `dst` acumulando suma y máximo en cuatro carriles independientes.
+ */
+static double copy_sum_max(double* dst, const double* src, int n, double* max_out)
+{
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    double m0 = src[0], m1 = src[0], m2 = src[0], m3 = src[0];
+    int i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        double v0 = src[i], v1 = src[i + 1], v2 = src[i + 2], v3 = src[i + 3];
+        dst[i] = v0;
+        dst[i + 1] = v1;
+        dst[i + 2] = v2;
+        dst[i + 3] = v3;
+        s0 += v0;
+        s1 += v1;
+        s2 += v2;
+        s3 += v3;
+        m0 = (v0 > m0) ? v0 : m0;
+        m1 = (v1 > m1) ? v1 : m1;
+        m2 = (v2 > m2) ? v2 : m2;
+        m3 = (v3 > m3) ? v3 : m3;
+    }
+    for (; i < n; i++) {
+        dst[i] = src[i];
+        s0 += src[i];
+        m0 = (src[i] > m0) ? src[i] : m0;
+    }
+
+    m0 = (m1 > m0) ? m1 : m0;
+    m2 = (m3 > m2) ? m3 : m2;
+    *max_out = (m2 > m0) ? m2 : m0;
+    return (s0 + s1) + (s2 + s3);
+}
+
+int channel_stats_compute(const double* psd, const channel_bins_t* bins, int n_channels,
+                          const double* percentiles, int n_percentiles, channel_stats_t* out)
+{
+    if (n_percentiles < 0 || n_percentiles > CHANNEL_STATS_MAX_PERCENTILES) {
+        fprintf(stderr, "Error: too many percentiles (%d)\n", n_percentiles);
+        return -1;
+    }
+
+    // Una sola reserva para el canal más ancho
+    int widest = 1;
+    for (int c = 0; c < n_channels; c++) {
+        int len = bins[c].upper - bins[c].lower;
+        if (len > widest) widest = len;
+    }
+    double* a = scratch_reserve((size_t)widest);
+    if (a == NULL) {
+        return -1;
+    }
+
+    for (int c = 0; c < n_channels; c++) {
+        channel_stats_t* s = &out[c];
+        int n = bins[c].upper - bins[c].lower;
+        if (n < 1) {
+            n = 1;
+        }
+
+        s->mean = copy_sum_max(a, psd + bins[c].lower, n, &s->max) / n;
+        s->median = median_of(a, n);
+        for (int p = 0; p < n_percentiles; p++) {
+            double pos = percentiles[p] / 100.0 * (n - 1);
+            if (pos < 0.0) pos = 0.0;
+            if (pos > n - 1) pos = n - 1;
+            int k = (int)floor(pos);
+            s->pct[p] = order_stat(a, n, k, pos - k);
+        }
+    }
+    return 0;
+}
+
+double channel_stats_median(const double* array, int start, int end)
+{
+    int n = end - start;
+    if (n < 1) {
+        return array[start];
+    }
+    double* a = scratch_reserve((size_t)n);
+    if (a == NULL) {
+        return NAN;
+    }
+    for (int i = 0; i < n; i++) {
+        a[i] = array[start + i];
+    }
+    return median_of(a, n);
+}
+
+void channel_stats_release(void)
+{
+    free(scratch);
+    scratch = NULL;
+    scratch_capacity = 0;
+}
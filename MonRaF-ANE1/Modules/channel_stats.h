@@ -0,0 +1,62 @@
+/**
+ * @file channel_stats.h
+ * @brief Estadísticas por canal (máximo, mediana, media y percentiles) de una PSD en una sola pasada.
+ *
+ * Para cada canal de una tabla `channel_map.h` se copia su tramo de la PSD a
+ * un área de trabajo del hilo, reutilizada entre canales y mediciones, mientras
+ * se acumulan el máximo y la suma; la mediana y los percentiles salen después
+ * por selección (introselect) sobre esa copia, sin ordenarla ni reservar
+ * memoria por canal.
+ *
+ * El tramo de un canal es [`lower`, `upper`), como el que recorrían
+ * `find_max` y `median`; si está vacío se usa el bin `lower`.
+ */
+
+#ifndef CHANNEL_STATS_H
+#define CHANNEL_STATS_H
+
+#include "channel_map.h"
+
+/**
+ * @def CHANNEL_STATS_MAX_PERCENTILES
+ * @brief Percentiles que se pueden pedir a la vez.
+ */
+#define CHANNEL_STATS_MAX_PERCENTILES 4
+
+/**
+ * @struct channel_stats_t
+ * @brief Estadísticas de un canal.
+ */
+typedef struct {
+    double max;                                 /**< Valor máximo. */
+    double median;                              /**< Mediana (media de los dos centrales si el tramo es par). */
+    double mean;                                /**< Media. */
+    double pct[CHANNEL_STATS_MAX_PERCENTILES];  /**< Percentiles pedidos, con interpolación lineal. */
+} channel_stats_t;
+
+/**
+ * @brief Calcula las estadísticas de todos los canales de una tabla.
+ *
+ * @param psd PSD (lineal) sobre la que se construyó la tabla.
+ * @param bins Bins de cada canal (`channel_map_t::bins`).
+ * @param n_channels Número de canales.
+ * @param percentiles Percentiles en [0, 100] (puede ser NULL si `n_percentiles` es 0).
+ * @param n_percentiles Número de percentiles (como máximo `CHANNEL_STATS_MAX_PERCENTILES`).
+ * @param out Un elemento por canal.
+ *
+ * @return 0 si se calcularon, -1 en caso de error.
+ */
+int channel_stats_compute(const double* psd, const channel_bins_t* bins, int n_channels,
+                          const double* percentiles, int n_percentiles, channel_stats_t* out);
+
+/**
+ * @brief Mediana de `array[start, end)` con el área de trabajo del hilo (sin ordenar ni reservar).
+ */
+double channel_stats_median(const double* array, int start, int end);
+
+/**
+ * @brief Libera el área de trabajo del hilo que llama.
+ */
+void channel_stats_release(void);
+
+#endif // CHANNEL_STATS_H
@@ -0,0 +1,88 @@
+/**
+ * @file completion.c
+ * @brief Implementación del aviso de fin con espera acotada.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "completion.h"
+
+int completion_init(completion_t* c)
+{
+    pthread_condattr_t attr;
+
+    memset(c, 0, sizeof(*c));
+    if (pthread_condattr_init(&attr) != 0) {
+        fprintf(stderr, "Error: Unable to create completion\n");
+        return -1;
+    }
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    int result = pthread_cond_init(&c->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    if (result != 0 || pthread_mutex_init(&c->lock, NULL) != 0) {
+        fprintf(stderr, "Error: Unable to create completion\n");
+        return -1;
+    }
+    return 0;
+}
+
+void completion_destroy(completion_t* c)
+{
+    pthread_mutex_destroy(&c->lock);
+    pthread_cond_destroy(&c->cond);
+}
+
+void completion_reset(completion_t* c)
+{
+    pthread_mutex_lock(&c->lock);
+    c->done = false;
+    c->status = 0;
+    pthread_mutex_unlock(&c->lock);
+}
+
+void completion_signal(completion_t* c, int status)
+{
+    pthread_mutex_lock(&c->lock);
+    if (!c->done) {
+        c->done = true;
+        c->status = status;
+        pthread_cond_broadcast(&c->cond);
+    }
+    pthread_mutex_unlock(&c->lock);
+}
+
+bool completion_is_done(completion_t* c)
+{
+    pthread_mutex_lock(&c->lock);
+    bool done = c->done;
+    pthread_mutex_unlock(&c->lock);
+    return done;
+}
+
+bool completion_wait(completion_t* c, uint32_t timeout_ms, int* status)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&c->lock);
+    while (!c->done) {
+        if (pthread_cond_timedwait(&c->cond, &c->lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    bool done = c->done;
+    if (done && status != NULL) {
+        *status = c->status;
+    }
+    pthread_mutex_unlock(&c->lock);
+    return done;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file completion.h
+ * @brief Aviso de fin de una operación entre hilos, con espera acotada.
+ *
+ * Lo usa cada captura: el callback de la radio (o el consumidor de la cola)
+ * avisa con `completion_signal` y el hilo que lanzó la captura espera con
+ * `completion_wait`, que vuelve al recibir el aviso o al agotarse el plazo. Los
+ * plazos se miden con `CLOCK_MONOTONIC`, así que un cambio de hora del sistema
+ * no los alarga ni los acorta.
+ */
+
+#ifndef COMPLETION_H
+#define COMPLETION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+/**
+ * @struct completion_t
+ * @brief Estado del aviso.
+ */
+typedef struct {
+    pthread_mutex_t lock;   /**< Protege `done` y `status`. */
+    pthread_cond_t cond;    /**< Se señala al llegar el aviso. */
+    bool done;              /**< Ya llegó el aviso. */
+    int status;             /**< Código del primer aviso. */
+} completion_t;
+
+/**
+ * @brief Prepara el aviso (sin recibir).
+ *
+ * @return 0 si se pudo crear, -1 en caso de error.
+ */
+int completion_init(completion_t* c);
+
+/**
+ * @brief Libera el aviso. Nadie debe estar esperando.
+ */
+void completion_destroy(completion_t* c);
+
+/**
+ * @brief Vuelve a dejar el aviso sin recibir.
+ */
+void completion_reset(completion_t* c);
+
+/**
+ * @brief Marca la operación como terminada y despierta a quien espera.
+ *
+ * Sólo cuenta el primer aviso: los siguientes no cambian `status`.
+ *
+ * @param c Aviso.
+ * @param status Resultado de la operación (0: éxito).
+ */
+void completion_signal(completion_t* c, int status);
+
+/**
+ * @brief Indica si ya llegó el aviso, sin esperar.
+ */
+bool completion_is_done(completion_t* c);
+
+/**
+ * @brief Espera el aviso como mucho `timeout_ms` milisegundos.
+ *
+ * @param c Aviso.
+ * @param timeout_ms Plazo máximo de espera.
+ * @param status Recibe el código del aviso si llegó (puede ser NULL).
+ *
+ * @return true si llegó el aviso, false si se agotó el plazo.
+ */
+bool completion_wait(completion_t* c, uint32_t timeout_ms, int* status);
+
+#endif // COMPLETION_H
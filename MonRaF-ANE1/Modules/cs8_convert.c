@@ -0,0 +1,466 @@
+/**
+ * @file cs8_convert.c
+ * @brief Implementación de los núcleos de conversión CS8 con selección en tiempo de ejecución.
+ *
+ * Cada núcleo procesa 16 bytes (8 muestras IQ) por iteración y termina con el
+ * bucle escalar. Los de conversión leen el bloque completo antes de escribirlo,
+ * lo que permite la conversión en sitio descrita en `cs8_convert.h`. Los de
+ * ventana hacen las mismas operaciones que el bucle escalar, en el mismo orden,
+ * así que el resultado no depende del núcleo elegido.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <complex.h>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "cs8_convert.h"
+
+typedef void (*cs8_double_fn)(const int8_t*, complex double*, size_t);
+typedef void (*cs8_float_fn)(const int8_t*, complex float*, size_t);
+typedef void (*cs8_sum_fn)(const int8_t*, size_t, int64_t*, int64_t*);
+typedef void (*cs8_window_fn)(const int8_t*, double, double, const double*, complex double*, int);
+
+static cs8_double_fn to_double = NULL;
+static cs8_float_fn to_float = NULL;
+static cs8_sum_fn sum_iq = NULL;
+static cs8_window_fn window_segment = NULL;
+static const char* kernel_name = "scalar";
+static pthread_once_t kernel_once = PTHREAD_ONCE_INIT;
+
+static void cs8_double_scalar(const int8_t* raw, complex double* out, size_t num_samples)
+{
+    for (size_t i = 0; i < num_samples; i++) {
+        out[i] = CMPLX(raw[2 * i], raw[2 * i + 1]);
+    }
+}
+
+static void cs8_float_scalar(const int8_t* raw, complex float* out, size_t num_samples)
+{
+    for (size_t i = 0; i < num_samples; i++) {
+        out[i] = CMPLXF(raw[2 * i], raw[2 * i + 1]);
+    }
+}
+
+static void cs8_sum_scalar(const int8_t* raw, size_t num_samples, int64_t* sum_i, int64_t* sum_q)
+{
+    int64_t si = 0, sq = 0;
+    for (size_t i = 0; i < num_samples; i++) {
+        si += raw[2 * i];
+        sq += raw[2 * i + 1];
+    }
+    *sum_i += si;
+    *sum_q += sq;
+}
+
+static void cs8_window_scalar(const int8_t* raw, double dc_i, double dc_q,
+                              const double* window, complex double* out, int nperseg)
+{
+    for (int i = 0; i < nperseg; i++) {
+        out[i] = CMPLX((raw[2 * i] - dc_i) * window[i],
+                       (raw[2 * i + 1] - dc_q) * window[i]);
+    }
+}
+
+/* Los acumuladores int32 de los núcleos se vacían a int64 cada CS8_SUM_BLOCK iteraciones. */
+#define CS8_SUM_BLOCK (1u << 20)
+
+#if defined(__aarch64__)
+
+static void cs8_double_neon(const int8_t* raw, complex double* out, size_t num_samples)
+{
+    double* dst = (double*)out;
+    size_t i = 0;
+
+    for (; i + 8 <= num_samples; i += 8) {
+        int8x16_t v = vld1q_s8(raw + 2 * i);
+        int16x8_t lo = vmovl_s8(vget_low_s8(v));
+        int16x8_t hi = vmovl_s8(vget_high_s8(v));
+        int32x4_t q0 = vmovl_s16(vget_low_s16(lo));
+        int32x4_t q1 = vmovl_s16(vget_high_s16(lo));
+        int32x4_t q2 = vmovl_s16(vget_low_s16(hi));
+        int32x4_t q3 = vmovl_s16(vget_high_s16(hi));
+
+        float64x2_t d0 = vcvtq_f64_s64(vmovl_s32(vget_low_s32(q0)));
+        float64x2_t d1 = vcvtq_f64_s64(vmovl_s32(vget_high_s32(q0)));
+        float64x2_t d2 = vcvtq_f64_s64(vmovl_s32(vget_low_s32(q1)));
+        float64x2_t d3 = vcvtq_f64_s64(vmovl_s32(vget_high_s32(q1)));
+        float64x2_t d4 = vcvtq_f64_s64(vmovl_s32(vget_low_s32(q2)));
+        float64x2_t d5 = vcvtq_f64_s64(vmovl_s32(vget_high_s32(q2)));
+        float64x2_t d6 = vcvtq_f64_s64(vmovl_s32(vget_low_s32(q3)));
+        float64x2_t d7 = vcvtq_f64_s64(vmovl_s32(vget_high_s32(q3)));
+
+        vst1q_f64(dst + 2 * i, d0);
+        vst1q_f64(dst + 2 * i + 2, d1);
+        vst1q_f64(dst + 2 * i + 4, d2);
+        vst1q_f64(dst + 2 * i + 6, d3);
+        vst1q_f64(dst + 2 * i + 8, d4);
+        vst1q_f64(dst + 2 * i + 10, d5);
+        vst1q_f64(dst + 2 * i + 12, d6);
+        vst1q_f64(dst + 2 * i + 14, d7);
+    }
+    cs8_double_scalar(raw + 2 * i, out + i, num_samples - i);
+}
+
+static void cs8_float_neon(const int8_t* raw, complex float* out, size_t num_samples)
+{
+    float* dst = (float*)out;
+    size_t i = 0;
+
+    for (; i + 8 <= num_samples; i += 8) {
+        int8x16_t v = vld1q_s8(raw + 2 * i);
+        int16x8_t lo = vmovl_s8(vget_low_s8(v));
+        int16x8_t hi = vmovl_s8(vget_high_s8(v));
+        float32x4_t f0 = vcvtq_f32_s32(vmovl_s16(vget_low_s16(lo)));
+        float32x4_t f1 = vcvtq_f32_s32(vmovl_s16(vget_high_s16(lo)));
+        float32x4_t f2 = vcvtq_f32_s32(vmovl_s16(vget_low_s16(hi)));
+        float32x4_t f3 = vcvtq_f32_s32(vmovl_s16(vget_high_s16(hi)));
+
+        vst1q_f32(dst + 2 * i, f0);
+        vst1q_f32(dst + 2 * i + 4, f1);
+        vst1q_f32(dst + 2 * i + 8, f2);
+        vst1q_f32(dst + 2 * i + 12, f3);
+    }
+    cs8_float_scalar(raw + 2 * i, out + i, num_samples - i);
+}
+
+static void cs8_sum_neon(const int8_t* raw, size_t num_samples, int64_t* sum_i, int64_t* sum_q)
+{
+    size_t i = 0;
+
+    while (i + 16 <= num_samples) {
+        int32x4_t acc_i = vdupq_n_s32(0);
+        int32x4_t acc_q = vdupq_n_s32(0);
+
+        for (unsigned n = 0; n < CS8_SUM_BLOCK && i + 16 <= num_samples; n++, i += 16) {
+            int8x16x2_t v = vld2q_s8(raw + 2 * i);   // val[0] = I, val[1] = Q
+            acc_i = vpadalq_s16(acc_i, vpaddlq_s8(v.val[0]));
+            acc_q = vpadalq_s16(acc_q, vpaddlq_s8(v.val[1]));
+        }
+        *sum_i += vaddlvq_s32(acc_i);
+        *sum_q += vaddlvq_s32(acc_q);
+    }
+    cs8_sum_scalar(raw + 2 * i, num_samples - i, sum_i, sum_q);
+}
+
+static void cs8_window_neon(const int8_t* raw, double dc_i, double dc_q,
+                            const double* window, complex double* out, int nperseg)
+{
+    double* dst = (double*)out;
+    const double dc_v[2] = { dc_i, dc_q };
+    float64x2_t dc = vld1q_f64(dc_v);
+    int i = 0;
+
+    for (; i + 4 <= nperseg; i += 4) {
+        int16x8_t v = vmovl_s8(vld1_s8(raw + 2 * i));
+        int32x4_t q0 = vmovl_s16(vget_low_s16(v));
+        int32x4_t q1 = vmovl_s16(vget_high_s16(v));
+
+        float64x2_t d0 = vcvtq_f64_s64(vmovl_s32(vget_low_s32(q0)));
+        float64x2_t d1 = vcvtq_f64_s64(vmovl_s32(vget_high_s32(q0)));
+        float64x2_t d2 = vcvtq_f64_s64(vmovl_s32(vget_low_s32(q1)));
+        float64x2_t d3 = vcvtq_f64_s64(vmovl_s32(vget_high_s32(q1)));
+
+        vst1q_f64(dst + 2 * i,     vmulq_n_f64(vsubq_f64(d0, dc), window[i]));
+        vst1q_f64(dst + 2 * i + 2, vmulq_n_f64(vsubq_f64(d1, dc), window[i + 1]));
+        vst1q_f64(dst + 2 * i + 4, vmulq_n_f64(vsubq_f64(d2, dc), window[i + 2]));
+        vst1q_f64(dst + 2 * i + 6, vmulq_n_f64(vsubq_f64(d3, dc), window[i + 3]));
+    }
+    cs8_window_scalar(raw + 2 * i, dc_i, dc_q, window + i, out + i, nperseg - i);
+}
+
+#elif defined(__x86_64__) || defined(__i386__)
+
+/* Extiende con signo los 16 bytes de v a cuatro vectores de 4 int32 (SSE2). */
+#define CS8_SSE2_WIDEN(v, q0, q1, q2, q3) do {                       \
+        __m128i lo16_ = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);  \
+        __m128i hi16_ = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);  \
+        q0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo16_, lo16_), 16);   \
+        q1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo16_, lo16_), 16);   \
+        q2 = _mm_srai_epi32(_mm_unpacklo_epi16(hi16_, hi16_), 16);   \
+        q3 = _mm_srai_epi32(_mm_unpackhi_epi16(hi16_, hi16_), 16);   \
+    } while (0)
+
+static void cs8_double_sse2(const int8_t* raw, complex double* out, size_t num_samples)
+{
+    double* dst = (double*)out;
+    size_t i = 0;
+
+    for (; i + 8 <= num_samples; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(raw + 2 * i));
+        __m128i q0, q1, q2, q3;
+        CS8_SSE2_WIDEN(v, q0, q1, q2, q3);
+
+        __m128d d0 = _mm_cvtepi32_pd(q0);
+        __m128d d1 = _mm_cvtepi32_pd(_mm_unpackhi_epi64(q0, q0));
+        __m128d d2 = _mm_cvtepi32_pd(q1);
+        __m128d d3 = _mm_cvtepi32_pd(_mm_unpackhi_epi64(q1, q1));
+        __m128d d4 = _mm_cvtepi32_pd(q2);
+        __m128d d5 = _mm_cvtepi32_pd(_mm_unpackhi_epi64(q2, q2));
+        __m128d d6 = _mm_cvtepi32_pd(q3);
+        __m128d d7 = _mm_cvtepi32_pd(_mm_unpackhi_epi64(q3, q3));
+
+        _mm_storeu_pd(dst + 2 * i, d0);
+        _mm_storeu_pd(dst + 2 * i + 2, d1);
+        _mm_storeu_pd(dst + 2 * i + 4, d2);
+        _mm_storeu_pd(dst + 2 * i + 6, d3);
+        _mm_storeu_pd(dst + 2 * i + 8, d4);
+        _mm_storeu_pd(dst + 2 * i + 10, d5);
+        _mm_storeu_pd(dst + 2 * i + 12, d6);
+        _mm_storeu_pd(dst + 2 * i + 14, d7);
+    }
+    cs8_double_scalar(raw + 2 * i, out + i, num_samples - i);
+}
+
+static void cs8_float_sse2(const int8_t* raw, complex float* out, size_t num_samples)
+{
+    float* dst = (float*)out;
+    size_t i = 0;
+
+    for (; i + 8 <= num_samples; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(raw + 2 * i));
+        __m128i q0, q1, q2, q3;
+        CS8_SSE2_WIDEN(v, q0, q1, q2, q3);
+
+        __m128 f0 = _mm_cvtepi32_ps(q0);
+        __m128 f1 = _mm_cvtepi32_ps(q1);
+        __m128 f2 = _mm_cvtepi32_ps(q2);
+        __m128 f3 = _mm_cvtepi32_ps(q3);
+
+        _mm_storeu_ps(dst + 2 * i, f0);
+        _mm_storeu_ps(dst + 2 * i + 4, f1);
+        _mm_storeu_ps(dst + 2 * i + 8, f2);
+        _mm_storeu_ps(dst + 2 * i + 12, f3);
+    }
+    cs8_float_scalar(raw + 2 * i, out + i, num_samples - i);
+}
+
+__attribute__((target("avx2")))
+static void cs8_double_avx2(const int8_t* raw, complex double* out, size_t num_samples)
+{
+    double* dst = (double*)out;
+    size_t i = 0;
+
+    for (; i + 8 <= num_samples; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(raw + 2 * i));
+        __m256i lo = _mm256_cvtepi8_epi32(v);
+        __m256i hi = _mm256_cvtepi8_epi32(_mm_srli_si128(v, 8));
+
+        __m256d d0 = _mm256_cvtepi32_pd(_mm256_castsi256_si128(lo));
+        __m256d d1 = _mm256_cvtepi32_pd(_mm256_extracti128_si256(lo, 1));
+        __m256d d2 = _mm256_cvtepi32_pd(_mm256_castsi256_si128(hi));
+        __m256d d3 = _mm256_cvtepi32_pd(_mm256_extracti128_si256(hi, 1));
+
+        _mm256_storeu_pd(dst + 2 * i, d0);
+        _mm256_storeu_pd(dst + 2 * i + 4, d1);
+        _mm256_storeu_pd(dst + 2 * i + 8, d2);
+        _mm256_storeu_pd(dst + 2 * i + 12, d3);
+    }
+    cs8_double_scalar(raw + 2 * i, out + i, num_samples - i);
+}
+
+__attribute__((target("avx2")))
+static void cs8_float_avx2(const int8_t* raw, complex float* out, size_t num_samples)
+{
+    float* dst = (float*)out;
+    size_t i = 0;
+
+    for (; i + 8 <= num_samples; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(raw + 2 * i));
+        __m256 f0 = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(v));
+        __m256 f1 = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(v, 8)));
+
+        _mm256_storeu_ps(dst + 2 * i, f0);
+        _mm256_storeu_ps(dst + 2 * i + 8, f1);
+    }
+    cs8_float_scalar(raw + 2 * i, out + i, num_samples - i);
+}
+
+/*
+ * Suma de I y Q: cada palabra de 16 bits es (Q << 8) | I, así que I se obtiene
+ * con un desplazamiento aritmético de ida y vuelta y Q con uno solo; madd con
+ * unos suma los pares vecinos en int32 sin mezclar I con Q.
+ */
+static void cs8_sum_sse2(const int8_t* raw, size_t num_samples, int64_t* sum_i, int64_t* sum_q)
+{
+    const __m128i ones = _mm_set1_epi16(1);
+    size_t i = 0;
+
+    while (i + 8 <= num_samples) {
+        __m128i acc_i = _mm_setzero_si128();
+        __m128i acc_q = _mm_setzero_si128();
+
+        for (unsigned n = 0; n < CS8_SUM_BLOCK && i + 8 <= num_samples; n++, i += 8) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(raw + 2 * i));
+            __m128i vi = _mm_srai_epi16(_mm_slli_epi16(v, 8), 8);
+            __m128i vq = _mm_srai_epi16(v, 8);
+            acc_i = _mm_add_epi32(acc_i, _mm_madd_epi16(vi, ones));
+            acc_q = _mm_add_epi32(acc_q, _mm_madd_epi16(vq, ones));
+        }
+
+        int32_t lanes_i[4], lanes_q[4];
+        _mm_storeu_si128((__m128i*)lanes_i, acc_i);
+        _mm_storeu_si128((__m128i*)lanes_q, acc_q);
+        for (int k = 0; k < 4; k++) {
+            *sum_i += lanes_i[k];
+            *sum_q += lanes_q[k];
+        }
+    }
+    cs8_sum_scalar(raw + 2 * i, num_samples - i, sum_i, sum_q);
+}
+
+static void cs8_window_sse2(const int8_t* raw, double dc_i, double dc_q,
+                            const double* window, complex double* out, int nperseg)
+{
+    double* dst = (double*)out;
+    const __m128d dc = _mm_set_pd(dc_q, dc_i);
+    int i = 0;
+
+    for (; i + 8 <= nperseg; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(raw + 2 * i));
+        __m128i q[4];
+        CS8_SSE2_WIDEN(v, q[0], q[1], q[2], q[3]);
+
+        for (int k = 0; k < 4; k++) {
+            __m128d lo = _mm_cvtepi32_pd(q[k]);
+            __m128d hi = _mm_cvtepi32_pd(_mm_unpackhi_epi64(q[k], q[k]));
+            lo = _mm_mul_pd(_mm_sub_pd(lo, dc), _mm_set1_pd(window[i + 2 * k]));
+            hi = _mm_mul_pd(_mm_sub_pd(hi, dc), _mm_set1_pd(window[i + 2 * k + 1]));
+            _mm_storeu_pd(dst + 2 * (i + 2 * k), lo);
+            _mm_storeu_pd(dst + 2 * (i + 2 * k + 1), hi);
+        }
+    }
+    cs8_window_scalar(raw + 2 * i, dc_i, dc_q, window + i, out + i, nperseg - i);
+}
+
+__attribute__((target("avx2")))
+static void cs8_sum_avx2(const int8_t* raw, size_t num_samples, int64_t* sum_i, int64_t* sum_q)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    size_t i = 0;
+
+    while (i + 16 <= num_samples) {
+        __m256i acc_i = _mm256_setzero_si256();
+        __m256i acc_q = _mm256_setzero_si256();
+
+        for (unsigned n = 0; n < CS8_SUM_BLOCK && i + 16 <= num_samples; n++, i += 16) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(raw + 2 * i));
+            __m256i vi = _mm256_srai_epi16(_mm256_slli_epi16(v, 8), 8);
+            __m256i vq = _mm256_srai_epi16(v, 8);
+            acc_i = _mm256_add_epi32(acc_i, _mm256_madd_epi16(vi, ones));
+            acc_q = _mm256_add_epi32(acc_q, _mm256_madd_epi16(vq, ones));
+        }
+
+        int32_t lanes_i[8], lanes_q[8];
+        _mm256_storeu_si256((__m256i*)lanes_i, acc_i);
+        _mm256_storeu_si256((__m256i*)lanes_q, acc_q);
+        for (int k = 0; k < 8; k++) {
+            *sum_i += lanes_i[k];
+            *sum_q += lanes_q[k];
+        }
+    }
+    cs8_sum_scalar(raw + 2 * i, num_samples - i, sum_i, sum_q);
+}
+
+__attribute__((target("avx2")))
+static void cs8_window_avx2(const int8_t* raw, double dc_i, double dc_q,
+                            const double* window, complex double* out, int nperseg)
+{
+    double* dst = (double*)out;
+    const __m256d dc = _mm256_set_pd(dc_q, dc_i, dc_q, dc_i);
+    int i = 0;
+
+    for (; i + 4 <= nperseg; i += 4) {
+        __m256i q = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)(raw + 2 * i)));
+        __m256d x0 = _mm256_cvtepi32_pd(_mm256_castsi256_si128(q));
+        __m256d x1 = _mm256_cvtepi32_pd(_mm256_extracti128_si256(q, 1));
+
+        // (w0, w0, w1, w1) para cada par de muestras
+        __m256d w0 = _mm256_permute4x64_pd(_mm256_castpd128_pd256(_mm_loadu_pd(window + i)), 0x50);
+        __m256d w1 = _mm256_permute4x64_pd(_mm256_castpd128_pd256(_mm_loadu_pd(window + i + 2)), 0x50);
+
+        _mm256_storeu_pd(dst + 2 * i, _mm256_mul_pd(_mm256_sub_pd(x0, dc), w0));
+        _mm256_storeu_pd(dst + 2 * i + 4, _mm256_mul_pd(_mm256_sub_pd(x1, dc), w1));
+    }
+    // El resto del proceso (FFTW, libm) es SSE: evitar la penalización de transición
+    _mm256_zeroupper();
+    cs8_window_scalar(raw + 2 * i, dc_i, dc_q, window + i, out + i, nperseg - i);
+}
+
+#endif
+
+static void cs8_select_kernel(void)
+{
+#if defined(__aarch64__)
+    to_double = cs8_double_neon;
+    to_float = cs8_float_neon;
+    sum_iq = cs8_sum_neon;
+    window_segment = cs8_window_neon;
+    kernel_name = "neon";
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        to_double = cs8_double_avx2;
+        to_float = cs8_float_avx2;
+        sum_iq = cs8_sum_avx2;
+        window_segment = cs8_window_avx2;
+        kernel_name = "avx2";
+    } else {
+        to_double = cs8_double_sse2;
+        to_float = cs8_float_sse2;
+        sum_iq = cs8_sum_sse2;
+        window_segment = cs8_window_sse2;
+        kernel_name = "sse2";
+    }
+#else
+    to_double = cs8_double_scalar;
+    to_float = cs8_float_scalar;
+    sum_iq = cs8_sum_scalar;
+    window_segment = cs8_window_scalar;
+    kernel_name = "scalar";
+#endif
+}
+
+void cs8_to_complex(const int8_t* raw, complex double* out, size_t num_samples)
+{
+    pthread_once(&kernel_once, cs8_select_kernel);
+    to_double(raw, out, num_samples);
+}
+
+void cs8_to_complex_float(const int8_t* raw, complex float* out, size_t num_samples)
+{
+    pthread_once(&kernel_once, cs8_select_kernel);
+    to_float(raw, out, num_samples);
+}
+
+complex double cs8_mean(const int8_t* raw, size_t num_samples)
+{
+    int64_t sum_i = 0, sum_q = 0;
+
+    if (num_samples == 0) {
+        return 0.0;
+    }
+    pthread_once(&kernel_once, cs8_select_kernel);
+    sum_iq(raw, num_samples, &sum_i, &sum_q);
+    return CMPLX((double)sum_i / (double)num_samples, (double)sum_q / (double)num_samples);
+}
+
+void cs8_window_segment(const int8_t* raw, complex double dc, const double* window,
+                        complex double* out, int nperseg)
+{
+    pthread_once(&kernel_once, cs8_select_kernel);
+    window_segment(raw, creal(dc), cimag(dc), window, out, nperseg);
+}
+
+const char* cs8_convert_kernel(void)
+{
+    pthread_once(&kernel_once, cs8_select_kernel);
+    return kernel_name;
+}
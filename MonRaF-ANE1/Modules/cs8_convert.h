@@ -0,0 +1,75 @@
+/**
+ * @file cs8_convert.h
+ * @brief Núcleos vectorizados para convertir muestras CS8 (I/Q int8 intercalados) a complejos.
+ *
+ * La implementación se elige en tiempo de ejecución: NEON en aarch64, AVX2 o
+ * SSE2 en x86-64 y un bucle escalar en el resto de arquitecturas. Además de la
+ * salida `complex double` se ofrece `complex float` (8 bytes por muestra) para
+ * las etapas que no necesitan doble precisión, y un núcleo que fusiona la
+ * lectura CS8, la resta de DC y la ventana de un segmento de Welch.
+ */
+
+#ifndef CS8_CONVERT_H
+#define CS8_CONVERT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <complex.h>
+
+/**
+ * @brief Convierte `num_samples` muestras CS8 a `complex double`.
+ *
+ * @param raw Pares I/Q int8 intercalados (longitud 2 * `num_samples` bytes).
+ * @param out Arreglo de salida (longitud `num_samples`).
+ * @param num_samples Número de muestras IQ.
+ *
+ * @note Admite conversión en sitio cuando `raw` ocupa los últimos 2 * `num_samples`
+ *       bytes del buffer `out`: cada bloque se lee antes de escribirse.
+ */
+void cs8_to_complex(const int8_t* raw, complex double* out, size_t num_samples);
+
+/**
+ * @brief Convierte `num_samples` muestras CS8 a `complex float`.
+ *
+ * @param raw Pares I/Q int8 intercalados (longitud 2 * `num_samples` bytes).
+ * @param out Arreglo de salida (longitud `num_samples`).
+ * @param num_samples Número de muestras IQ.
+ *
+ * @note Igual que `cs8_to_complex`, admite `raw` al final del propio buffer `out`.
+ */
+void cs8_to_complex_float(const int8_t* raw, complex float* out, size_t num_samples);
+
+/**
+ * @brief Media compleja (componente DC) de `num_samples` muestras CS8.
+ *
+ * Las sumas de I y Q se acumulan en enteros, por lo que el resultado es exacto
+ * e idéntico a promediar la señal ya convertida a `complex double`.
+ *
+ * @param raw Pares I/Q int8 intercalados.
+ * @param num_samples Número de muestras IQ.
+ *
+ * @return Media de la señal (0 si `num_samples` es 0).
+ */
+complex double cs8_mean(const int8_t* raw, size_t num_samples);
+
+/**
+ * @brief Arma la entrada de la FFT de un segmento en una sola pasada sobre los bytes CS8.
+ *
+ * Calcula `out[i] = (x[i] - dc) * window[i]` leyendo directamente los int8, sin
+ * convertir antes la captura ni restarle la DC en un recorrido aparte.
+ *
+ * @param raw Bytes CS8 del segmento (longitud 2 * `nperseg`).
+ * @param dc Componente DC a restar (p. ej. de `cs8_mean`; 0 para no restar nada).
+ * @param window Coeficientes de la ventana (longitud `nperseg`).
+ * @param out Buffer de entrada de la FFT (longitud `nperseg`).
+ * @param nperseg Longitud del segmento.
+ */
+void cs8_window_segment(const int8_t* raw, complex double dc, const double* window,
+                        complex double* out, int nperseg);
+
+/**
+ * @brief Nombre del núcleo seleccionado ("neon", "avx2", "sse2" o "scalar").
+ */
+const char* cs8_convert_kernel(void);
+
+#endif // CS8_CONVERT_H
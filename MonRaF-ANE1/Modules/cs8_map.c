@@ -0,0 +1,80 @@
+/**
+ * @file cs8_map.c
+ * @brief Implementación del lector CS8 basado en mmap.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "cs8_map.h"
+
+int cs8_map_open(cs8_map_t* map, const char* filename)
+{
+    memset(map, 0, sizeof(*map));
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        perror("Error: No se pudo abrir el archivo de datos CS8");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror("Error: fstat del archivo CS8");
+        close(fd);
+        return -1;
+    }
+
+    if (st.st_size < 2) {
+        fprintf(stderr, "Error: El archivo CS8 no contiene ninguna muestra completa.\n");
+        close(fd);
+        return -1;
+    }
+
+    // Un byte suelto al final es una muestra a medias: no se mapea
+    size_t length = (size_t)st.st_size & ~(size_t)1;
+    if (length != (size_t)st.st_size) {
+        fprintf(stderr, "Aviso: Tamaño impar del archivo CS8, se ignora el último byte.\n");
+    }
+
+    void* data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    // El mapeo mantiene el archivo abierto; el descriptor ya no hace falta
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        perror("Error: mmap del archivo CS8");
+        return -1;
+    }
+
+    // Lectura hacia adelante: read-ahead agresivo y descarte de páginas ya leídas
+    madvise(data, length, MADV_SEQUENTIAL);
+
+    map->data = (const int8_t*)data;
+    map->length = length;
+    map->num_samples = map->length / 2;
+    return 0;
+}
+
+const int8_t* cs8_map_window(const cs8_map_t* map, size_t first, size_t* count)
+{
+    if (map->data == NULL || first >= map->num_samples) {
+        *count = 0;
+        return NULL;
+    }
+    if (*count > map->num_samples - first) {
+        *count = map->num_samples - first;
+    }
+    return map->data + 2 * first;
+}
+
+void cs8_map_close(cs8_map_t* map)
+{
+    if (map->data != NULL) {
+        munmap((void*)map->data, map->length);
+    }
+    memset(map, 0, sizeof(*map));
+}
@@ -0,0 +1,58 @@
+/**
+ * @file cs8_map.h
+ * @brief Lectura de capturas CS8 mediante mmap, sin copiar el archivo a memoria.
+ *
+ * El archivo se expone como una vista `int8_t` de solo lectura. Las páginas se
+ * cargan bajo demanda desde la caché del sistema, de modo que nunca existe una
+ * copia completa de la captura en el heap.
+ */
+
+#ifndef CS8_MAP_H
+#define CS8_MAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @struct cs8_map_t
+ * @brief Vista de solo lectura de un archivo CS8 mapeado.
+ */
+typedef struct {
+    const int8_t* data;   /**< Pares I/Q int8 intercalados. */
+    size_t length;        /**< Longitud de la vista en bytes. */
+    size_t num_samples;   /**< Número de muestras IQ (`length` / 2). */
+} cs8_map_t;
+
+/**
+ * @brief Mapea un archivo CS8 completo con acceso secuencial (`MADV_SEQUENTIAL`).
+ *
+ * @param map Vista a inicializar.
+ * @param filename Ruta del archivo CS8.
+ *
+ * @return 0 si el archivo se mapeó correctamente, -1 si no se pudo o tiene menos de 2 bytes.
+ *
+ * @note Un byte impar al final (muestra incompleta) queda fuera de la vista.
+ * @note El archivo puede borrarse (p. ej. con `delete_CS8`) mientras esté mapeado;
+ *       los datos siguen accesibles hasta `cs8_map_close`.
+ */
+int cs8_map_open(cs8_map_t* map, const char* filename);
+
+/**
+ * @brief Devuelve una ventana de la captura a partir de la muestra `first`.
+ *
+ * @param map Vista mapeada.
+ * @param first Índice de la primera muestra IQ.
+ * @param count Número de muestras pedidas; se recorta al final del archivo.
+ *
+ * @return Puntero a los bytes CS8 de la ventana, o `NULL` si `first` está fuera del archivo.
+ */
+const int8_t* cs8_map_window(const cs8_map_t* map, size_t first, size_t* count);
+
+/**
+ * @brief Libera el mapeo.
+ *
+ * @param map Vista mapeada.
+ */
+void cs8_map_close(cs8_map_t* map);
+
+#endif // CS8_MAP_H
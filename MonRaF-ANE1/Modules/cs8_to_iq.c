@@ -4,15 +4,24 @@
  *
  * Este archivo contiene la implementación de la función `cargar_cs8`,
  * que permite cargar datos en formato CS8 desde un archivo binario
- * y convertirlos a un arreglo de números complejos.
+ * y convertirlos a un arreglo de números complejos. El archivo se lee una sola
+ * vez al final del buffer de salida y se convierte en sitio con los núcleos de
+ * `cs8_convert.h`.
  */
 
 #include "cs8_to_iq.h"
+#include "cs8_convert.h"
 #include <stdio.h>
 #include <stdlib.h>
 
 
-complex double* cargar_cs8(const char* filename, size_t* num_samples) {
+/**
+ * @brief Lee un archivo CS8 completo al final de un buffer de `sample_size` bytes por muestra.
+ *
+ * El archivo se deposita en los últimos `file_size` bytes del buffer para que la
+ * conversión pueda hacerse en sitio, sin un segundo arreglo `int8_t`.
+ */
+static void* leer_cs8(const char* filename, size_t sample_size, size_t* num_samples, int8_t** raw_data) {
     FILE* file = fopen(filename, "rb");
     if (!file) {
         perror("Error: No se pudo abrir el archivo de datos CS8");
@@ -23,38 +32,58 @@ complex double* cargar_cs8(const char* filename, size_t* num_samples) {
     long file_size = ftell(file);
     rewind(file);
 
-    if (file_size % 2 != 0) {
-        fprintf(stderr, "Error: Tamaño del archivo inválido. Debe ser múltiplo de 2.\n");
+    if (file_size < 2) {
+        fprintf(stderr, "Error: El archivo CS8 no contiene ninguna muestra completa.\n");
         fclose(file);
         return NULL;
     }
 
+    // Un byte suelto al final es una muestra a medias: se descarta
+    if (file_size % 2 != 0) {
+        fprintf(stderr, "Aviso: Tamaño impar del archivo CS8, se ignora el último byte.\n");
+        file_size--;
+    }
+
     *num_samples = file_size / 2;
-    int8_t* raw_data = (int8_t*)malloc(file_size);
-    complex double* IQ_data = (complex double*)malloc(*num_samples * sizeof(complex double));
+    size_t buffer_size = *num_samples * sample_size;
+    uint8_t* IQ_data = (uint8_t*)malloc(buffer_size > 0 ? buffer_size : 1);
 
-    if (!raw_data || !IQ_data) {
+    if (!IQ_data) {
         perror("Error: No se pudo reservar memoria");
-        free(raw_data);
-        free(IQ_data);
         fclose(file);
         return NULL;
     }
 
-    if (fread(raw_data, 1, (size_t)file_size, file) != (size_t)file_size) {
+    *raw_data = (int8_t*)(IQ_data + buffer_size - (size_t)file_size);
+    if (fread(*raw_data, 1, (size_t)file_size, file) != (size_t)file_size) {
         perror("Error: Lectura incompleta del archivo");
-        free(raw_data);
         free(IQ_data);
         fclose(file);
         return NULL;
     }
 
-    for (size_t i = 0; i < *num_samples; i++) {
-        IQ_data[i] = raw_data[2 * i] + raw_data[2 * i + 1] * I;
+    fclose(file);
+    return IQ_data;
+}
+
+complex double* cargar_cs8(const char* filename, size_t* num_samples) {
+    int8_t* raw_data;
+    complex double* IQ_data = leer_cs8(filename, sizeof(complex double), num_samples, &raw_data);
+    if (!IQ_data) {
+        return NULL;
     }
 
-    free(raw_data);
-    fclose(file);
+    cs8_to_complex(raw_data, IQ_data, *num_samples);
+    return IQ_data;
+}
+
+complex float* cargar_cs8_float(const char* filename, size_t* num_samples) {
+    int8_t* raw_data;
+    complex float* IQ_data = leer_cs8(filename, sizeof(complex float), num_samples, &raw_data);
+    if (!IQ_data) {
+        return NULL;
+    }
 
+    cs8_to_complex_float(raw_data, IQ_data, *num_samples);
     return IQ_data;
 }
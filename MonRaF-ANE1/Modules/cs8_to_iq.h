@@ -21,10 +21,25 @@
  * @param num_samples Puntero a una variable donde se almacenará el número de muestras leídas.
  * 
  * @return Un puntero a un arreglo de números complejos (`complex double`), 
- *         que contiene las muestras IQ. Retorna `NULL` en caso de error.
+ *         que contiene las muestras IQ. Retorna `NULL` en caso de error o si el
+ *         archivo tiene menos de 2 bytes; un byte impar al final se ignora.
  * 
  * @note Es responsabilidad del usuario liberar la memoria asignada para el arreglo devuelto.
  */
 complex double* cargar_cs8(const char* filename, size_t* num_samples);
 
+/**
+ * @brief Carga datos IQ desde un archivo CS8 en precisión simple.
+ *
+ * Igual que `cargar_cs8`, pero cada muestra ocupa 8 bytes en lugar de 16.
+ *
+ * @param filename Nombre del archivo binario que contiene los datos en formato CS8.
+ * @param num_samples Puntero a una variable donde se almacenará el número de muestras leídas.
+ *
+ * @return Un puntero a un arreglo `complex float` con las muestras IQ, o `NULL` en caso de error.
+ *
+ * @note Es responsabilidad del usuario liberar la memoria asignada para el arreglo devuelto.
+ */
+complex float* cargar_cs8_float(const char* filename, size_t* num_samples);
+
 #endif  // PROCESS_CS8
@@ -0,0 +1,224 @@
+/**
+ * @file ddc.c
+ * @brief Implementación de la conversión digital descendente.
+ *
+ * El media banda tiene corte en la cuarta parte de la tasa de entrada, así que
+ * sus coeficientes pares (salvo el central) son cero y sólo se recorren los
+ * impares, aprovechando además la simetría. El remuestreador evalúa una sola
+ * fase del prototipo por salida: la salida k cae en la muestra
+ * `floor(k · decim / interp)` con fase `(k · decim) mod interp`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <complex.h>
+
+#include "ddc.h"
+#include "window.h"
+
+/**
+ * @brief sinc normalizado.
+ */
+static double sinc(double x)
+{
+    return (x == 0.0) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+}
+
+/**
+ * @brief Media banda: sinc con corte en fs/4 y ventana Blackman-Harris, ganancia 1 en continua.
+ */
+static int ddc_halfband(ddc_t* d)
+{
+    const window_t* w = window_get(WINDOW_BLACKMAN_HARRIS, DDC_HALFBAND_TAPS);
+    if (w == NULL) {
+        return -1;
+    }
+    const int center = DDC_HALFBAND_TAPS / 2;
+    double sum = 0.0;
+    for (int j = 0; j < DDC_HALFBAND_TAPS; j++) {
+        d->hb[j] = sinc((j - center) / 2.0) * w->coeffs[j];
+        sum += d->hb[j];
+    }
+    for (int j = 0; j < DDC_HALFBAND_TAPS; j++) {
+        d->hb[j] /= sum;
+    }
+    return 0;
+}
+
+/**
+ * @brief Prototipo del remuestreador, con corte en la mitad de la tasa de salida, repartido en fases.
+ */
+static int ddc_resampler(ddc_t* d)
+{
+    const int P = DDC_RESAMPLER_TAPS;
+    const int N = d->interp * P;
+    const window_t* w = window_get(WINDOW_BLACKMAN_HARRIS, N);
+    double* h = (double*)malloc((size_t)N * sizeof(double));
+    d->branch = (double*)malloc((size_t)N * sizeof(double));
+    if (w == NULL || h == NULL || d->branch == NULL) {
+        free(h);
+        return -1;
+    }
+
+    // En la tasa intermedia (interp · entrada) el corte es 1 / (2 · decim)
+    double cutoff = 0.5 / d->decim;
+    double sum = 0.0;
+    for (int j = 0; j < N; j++) {
+        h[j] = sinc(2.0 * cutoff * (j - (N - 1) / 2.0)) * w->coeffs[j];
+        sum += h[j];
+    }
+
+    // Fase q: coeficientes h[q + p·interp] para x[n - p]; se guardan al revés para leer la historia en orden
+    for (int q = 0; q < d->interp; q++) {
+        for (int p = 0; p < P; p++) {
+            d->branch[(size_t)q * P + (P - 1 - p)] = h[q + p * d->interp] * d->interp / sum;
+        }
+    }
+    free(h);
+    return 0;
+}
+
+int ddc_init(ddc_t* d, double fs_in, double offset_hz, int interp, int decim)
+{
+    memset(d, 0, sizeof(*d));
+    if (fs_in <= 0.0 || interp < 1 || decim < interp) {
+        fprintf(stderr, "Error: invalid DDC ratio %d/%d\n", interp, decim);
+        return -1;
+    }
+    d->fs_in = fs_in;
+    d->interp = interp;
+    d->decim = decim;
+    d->fs_out = fs_in / 2.0 * interp / decim;
+    d->nco = 1.0;
+    d->nco_step = cexp(-I * 2.0 * M_PI * offset_hz / fs_in);
+
+    if (ddc_halfband(d) != 0 || ddc_resampler(d) != 0) {
+        fprintf(stderr, "Error: Unable to design DDC filters\n");
+        ddc_free(d);
+        return -1;
+    }
+    return 0;
+}
+
+size_t ddc_max_output(const ddc_t* d, size_t n_in)
+{
+    return (size_t)((double)(n_in / 2 + 1) * d->interp / d->decim) + 1;
+}
+
+/**
+ * @brief Salida del remuestreador con la fase `q` sobre las últimas `DDC_RESAMPLER_TAPS` muestras.
+ */
+static complex double ddc_resample(const ddc_t* d, int q)
+{
+    const double* b = d->branch + (size_t)q * DDC_RESAMPLER_TAPS;
+    const double* re = d->rs_re + d->rs_pos + 1;
+    const double* im = d->rs_im + d->rs_pos + 1;
+    double acc_re = 0.0;
+    double acc_im = 0.0;
+    for (int p = 0; p < DDC_RESAMPLER_TAPS; p++) {
+        acc_re += b[p] * re[p];
+        acc_im += b[p] * im[p];
+    }
+    return acc_re + I * acc_im;
+}
+
+/**
+ * @brief Agrega una muestra a 1/2 de la tasa de entrada; devuelve 1 si produjo una salida en `out`.
+ */
+static int ddc_push_resampler(ddc_t* d, double re, double im, complex double* out)
+{
+    const int P = DDC_RESAMPLER_TAPS;
+    d->rs_pos = (d->rs_pos + 1 == P) ? 0 : d->rs_pos + 1;
+    d->rs_re[d->rs_pos] = re;
+    d->rs_re[d->rs_pos + P] = re;
+    d->rs_im[d->rs_pos] = im;
+    d->rs_im[d->rs_pos + P] = im;
+
+    // decim >= interp: como mucho una salida por muestra
+    if (d->rs_count++ != d->rs_next) {
+        return 0;
+    }
+    int q = d->rs_phase;
+    int total = d->rs_phase + d->decim;
+    d->rs_next += (uint64_t)(total / d->interp);
+    d->rs_phase = total % d->interp;
+
+    if (d->rs_count < (uint64_t)P) {
+        return 0;
+    }
+    *out = ddc_resample(d, q);
+    return 1;
+}
+
+size_t ddc_process_cs8(ddc_t* d, const int8_t* raw, size_t n_samples, complex double* out)
+{
+    const int T = DDC_HALFBAND_TAPS;
+    const int center = T / 2;
+    size_t produced = 0;
+    complex double nco = d->nco;
+
+    for (size_t i = 0; i < n_samples; i++) {
+        complex double x = (raw[2 * i] + I * raw[2 * i + 1]) * nco;
+        nco *= d->nco_step;
+
+        d->hb_pos = (d->hb_pos + 1 == T) ? 0 : d->hb_pos + 1;
+        d->hb_re[d->hb_pos] = creal(x);
+        d->hb_re[d->hb_pos + T] = creal(x);
+        d->hb_im[d->hb_pos] = cimag(x);
+        d->hb_im[d->hb_pos + T] = cimag(x);
+
+        if ((++d->hb_count & 1) != 0 || d->hb_count < (uint64_t)T) {
+            continue;
+        }
+
+        // Sólo el coeficiente central y los de desplazamiento impar son distintos de cero
+        const double* re = d->hb_re + d->hb_pos + 1;
+        const double* im = d->hb_im + d->hb_pos + 1;
+        double acc_re = d->hb[center] * re[center];
+        double acc_im = d->hb[center] * im[center];
+        for (int k = 1; k <= center; k += 2) {
+            acc_re += d->hb[center + k] * (re[center + k] + re[center - k]);
+            acc_im += d->hb[center + k] * (im[center + k] + im[center - k]);
+        }
+
+        produced += (size_t)ddc_push_resampler(d, acc_re, acc_im, out + produced);
+    }
+
+    // Evitar que el redondeo acumulado cambie la amplitud del NCO
+    d->nco = nco / cabs(nco);
+    return produced;
+}
+
+complex double* ddc_extract_cs8(const int8_t* raw, size_t n_samples, double fs_in, double offset_hz,
+                                int interp, int decim, size_t* n_out)
+{
+    ddc_t d;
+    if (ddc_init(&d, fs_in, offset_hz, interp, decim) != 0) {
+        return NULL;
+    }
+
+    complex double* out = (complex double*)malloc(ddc_max_output(&d, n_samples) * sizeof(complex double));
+    if (out == NULL) {
+        fprintf(stderr, "Error: Unable to allocate DDC output\n");
+        ddc_free(&d);
+        return NULL;
+    }
+
+    // Por bloques, para que el NCO se renormalice a menudo
+    const size_t block = 1 << 16;
+    *n_out = 0;
+    for (size_t first = 0; first < n_samples; first += block) {
+        size_t n = (n_samples - first < block) ? n_samples - first : block;
+        *n_out += ddc_process_cs8(&d, raw + 2 * first, n, out + *n_out);
+    }
+    ddc_free(&d);
+    return out;
+}
+
+void ddc_free(ddc_t* d)
+{
+    free(d->branch);
+    d->branch = NULL;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file ddc.h
+ * @brief Conversión digital descendente (DDC): extrae un canal de una captura de banda ancha.
+ *
+ * La cadena es NCO → filtro de media banda (diezma por 2) → remuestreador
+ * polifásico `interp / decim`. Con 20 MS/s de entrada y 13/20 la salida queda
+ * a 6.5 MS/s, la tasa que esperan `analyze_signal` y `parameter_tdt`, así que
+ * un canal TDT de 6 MHz se puede medir desde una captura RMER de 20 MHz sin
+ * volver a sintonizar la radio.
+ *
+ * Los filtros trabajan sobre historias separadas en parte real e imaginaria
+ * (arreglos `double` contiguos), de modo que cada salida es un producto
+ * escalar simple que el compilador puede vectorizar.
+ */
+
+#ifndef DDC_H
+#define DDC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <complex.h>
+
+/**
+ * @def DDC_HALFBAND_TAPS
+ * @brief Coeficientes del filtro de media banda (banda pasante hasta ~0.33 de la tasa de salida).
+ */
+#define DDC_HALFBAND_TAPS 47
+
+/**
+ * @def DDC_RESAMPLER_TAPS
+ * @brief Coeficientes por fase del remuestreador polifásico.
+ */
+#define DDC_RESAMPLER_TAPS 64
+
+/**
+ * @def DDC_TDT_INTERP
+ * @brief Interpolación del remuestreador para TDT (10 MS/s · 13 / 20 = 6.5 MS/s).
+ */
+#define DDC_TDT_INTERP 13
+
+/**
+ * @def DDC_TDT_DECIM
+ * @brief Diezmado del remuestreador para TDT.
+ */
+#define DDC_TDT_DECIM 20
+
+/**
+ * @struct ddc_t
+ * @brief Estado de un DDC.
+ */
+typedef struct {
+    double fs_in;                /**< Tasa de entrada. */
+    double fs_out;               /**< Tasa de salida (`fs_in / 2 · interp / decim`). */
+    complex double nco;          /**< Fasor del NCO. */
+    complex double nco_step;     /**< Giro del NCO por muestra (lleva `offset_hz` a 0 Hz). */
+
+    double hb[DDC_HALFBAND_TAPS];        /**< Filtro de media banda. */
+    double hb_re[2 * DDC_HALFBAND_TAPS]; /**< Historia del media banda (parte real, duplicada). */
+    double hb_im[2 * DDC_HALFBAND_TAPS]; /**< Historia del media banda (parte imaginaria, duplicada). */
+    int hb_pos;                  /**< Última posición escrita de la historia. */
+    uint64_t hb_count;           /**< Muestras de entrada recibidas. */
+
+    int interp;                  /**< Interpolación del remuestreador. */
+    int decim;                   /**< Diezmado del remuestreador. */
+    double* branch;              /**< `interp` fases de `DDC_RESAMPLER_TAPS` coeficientes, en orden cronológico. */
+    double rs_re[2 * DDC_RESAMPLER_TAPS]; /**< Historia del remuestreador (parte real, duplicada). */
+    double rs_im[2 * DDC_RESAMPLER_TAPS]; /**< Historia del remuestreador (parte imaginaria, duplicada). */
+    int rs_pos;                  /**< Última posición escrita de la historia. */
+    uint64_t rs_count;           /**< Muestras recibidas por el remuestreador. */
+    uint64_t rs_next;            /**< Muestra del remuestreador que produce la siguiente salida. */
+    int rs_phase;                /**< Fase polifásica de la siguiente salida. */
+} ddc_t;
+
+/**
+ * @brief Prepara un DDC.
+ *
+ * @param d DDC.
+ * @param fs_in Tasa de entrada.
+ * @param offset_hz Frecuencia del canal respecto a la sintonía de la captura.
+ * @param interp Interpolación del remuestreador (1 para sólo diezmar por 2).
+ * @param decim Diezmado del remuestreador (>= `interp`).
+ *
+ * @return 0 si se pudo crear, -1 en caso de error.
+ */
+int ddc_init(ddc_t* d, double fs_in, double offset_hz, int interp, int decim);
+
+/**
+ * @brief Número máximo de salidas que pueden producir `n_in` muestras de entrada.
+ */
+size_t ddc_max_output(const ddc_t* d, size_t n_in);
+
+/**
+ * @brief Procesa `n_samples` muestras CS8 y escribe las salidas en `out`.
+ *
+ * Se puede llamar por bloques: el estado de los filtros se conserva entre
+ * llamadas. Las primeras salidas, mientras se llenan las historias, se omiten.
+ *
+ * @param out Destino, con espacio para `ddc_max_output(d, n_samples)` muestras.
+ *
+ * @return Número de muestras escritas.
+ */
+size_t ddc_process_cs8(ddc_t* d, const int8_t* raw, size_t n_samples, complex double* out);
+
+/**
+ * @brief Extrae un canal completo de una captura CS8.
+ *
+ * @param n_out Muestras de la señal devuelta.
+ *
+ * @return Señal a `fs_in / 2 · interp / decim` (liberar con free), o NULL en caso de error.
+ */
+complex double* ddc_extract_cs8(const int8_t* raw, size_t n_samples, double fs_in, double offset_hz,
+                                int interp, int decim, size_t* n_out);
+
+/**
+ * @brief Libera el DDC.
+ */
+void ddc_free(ddc_t* d);
+
+#endif // DDC_H
@@ -0,0 +1,271 @@
+/**
+ * @file fft_plan.c
+ * @brief Implementación de la caché de planes FFTW con persistencia de wisdom.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <complex.h>
+#include <fftw3.h>
+
+#include "fft_plan.h"
+
+/**
+ * @struct fft_plan_entry_t
+ * @brief Entrada de la caché: un plan por (nfft, alineación, dirección).
+ */
+typedef struct fft_plan_entry {
+    int nfft;        /**< Número de puntos. */
+    int sign;        /**< FFTW_FORWARD o FFTW_BACKWARD. */
+    bool aligned;    /**< Buffers con la alineación SIMD de fftw_malloc. */
+    bool inplace;    /**< Entrada y salida en el mismo buffer. */
+    fftw_plan plan;  /**< Plan creado sobre buffers propios. */
+    int refs;        /**< Referencias: la caché y cada `fft_plan_get` sin devolver. */
+    uint64_t last_use;            /**< Valor de `plan_clock` en el último acceso. */
+    struct fft_plan_entry* next;  /**< Siguiente plan desalojado aún en uso. */
+} fft_plan_entry_t;
+
+/** @brief Planes en caché. */
+static fft_plan_entry_t* plan_cache[FFT_PLAN_CACHE_SIZE];
+
+/** @brief Número de entradas válidas en `plan_cache`. */
+static int plan_count = 0;
+
+/** @brief Planes desalojados de la caché que alguien todavía ejecuta. */
+static fft_plan_entry_t* plan_retired = NULL;
+
+/** @brief Reloj lógico de accesos: la entrada con `last_use` menor es la más antigua. */
+static uint64_t plan_clock = 0;
+
+/** @brief Hay planes nuevos cuyo wisdom aún no se guardó. */
+static bool wisdom_dirty = false;
+
+/** @brief El planificador de FFTW no es reentrante: se serializa con este mutex. */
+static pthread_mutex_t plan_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** @brief Archivo de wisdom activo. */
+static const char* wisdom_file = FFT_WISDOM_FILE;
+
+/** @brief Modo de planificación activo. */
+static unsigned plan_flags = FFT_PLAN_FLAGS;
+
+/** @brief Indica si ya se intentó importar el wisdom. */
+static bool wisdom_loaded = false;
+
+static int import_wisdom_locked(void)
+{
+    wisdom_loaded = true;
+    if (fftw_import_wisdom_from_filename(wisdom_file)) {
+        printf("[fft] Wisdom cargado desde %s\n", wisdom_file);
+        return 1;
+    }
+    printf("[fft] Sin wisdom en %s, los planes se medirán al primer uso\n", wisdom_file);
+    return 0;
+}
+
+/**
+ * @brief Suelta una referencia y destruye el plan si era la última. Requiere `plan_lock`.
+ *
+ * @return 1 si el plan se destruyó.
+ */
+static int plan_unref(fft_plan_entry_t* entry)
+{
+    if (--entry->refs > 0) {
+        return 0;
+    }
+    fftw_destroy_plan(entry->plan);
+    free(entry);
+    return 1;
+}
+
+/**
+ * @brief Suelta la referencia de la caché a un plan. Requiere `plan_lock`.
+ */
+static void plan_retire(fft_plan_entry_t* entry)
+{
+    // Si un análisis aún lo ejecuta, se destruye cuando lo suelte
+    if (!plan_unref(entry)) {
+        entry->next = plan_retired;
+        plan_retired = entry;
+    }
+}
+
+/**
+ * @brief Saca de la caché el plan usado hace más tiempo. Requiere `plan_lock`.
+ */
+static void plan_evict_oldest(void)
+{
+    int oldest = 0;
+    for (int i = 1; i < plan_count; i++) {
+        if (plan_cache[i]->last_use < plan_cache[oldest]->last_use) {
+            oldest = i;
+        }
+    }
+    plan_retire(plan_cache[oldest]);
+    plan_cache[oldest] = plan_cache[--plan_count];
+}
+
+int fft_plan_init(const char* wisdom_path, unsigned flags)
+{
+    int result;
+
+    pthread_mutex_lock(&plan_lock);
+    wisdom_file = (wisdom_path != NULL) ? wisdom_path : FFT_WISDOM_FILE;
+    plan_flags = flags;
+    result = import_wisdom_locked();
+    pthread_mutex_unlock(&plan_lock);
+
+    return result;
+}
+
+fftw_plan fft_plan_get(int nfft, int sign, complex double* in, complex double* out)
+{
+    bool aligned = (fftw_alignment_of((double*)in) == 0) &&
+                   (fftw_alignment_of((double*)out) == 0);
+    bool inplace = (in == out);
+    fftw_plan plan = NULL;
+
+    pthread_mutex_lock(&plan_lock);
+
+    for (int i = 0; i < plan_count; i++) {
+        fft_plan_entry_t* e = plan_cache[i];
+        if (e->nfft == nfft && e->sign == sign && e->aligned == aligned && e->inplace == inplace) {
+            e->refs++;
+            e->last_use = ++plan_clock;
+            plan = e->plan;
+            pthread_mutex_unlock(&plan_lock);
+            return plan;
+        }
+    }
+
+    if (!wisdom_loaded) {
+        import_wisdom_locked();
+    }
+
+    fft_plan_entry_t* entry = (fft_plan_entry_t*)malloc(sizeof(fft_plan_entry_t));
+    if (entry == NULL) {
+        fprintf(stderr, "Error: No se pudo reservar memoria para la caché de planes FFT\n");
+        pthread_mutex_unlock(&plan_lock);
+        return NULL;
+    }
+
+    // FFTW_MEASURE sobrescribe los buffers: se planifica sobre buffers propios
+    complex double* plan_in = fftw_alloc_complex(nfft);
+    complex double* plan_out = inplace ? plan_in : fftw_alloc_complex(nfft);
+    if (plan_in == NULL || plan_out == NULL) {
+        fprintf(stderr, "Error: No se pudo reservar memoria para planificar la FFT\n");
+        fftw_free(plan_in);
+        if (!inplace) {
+            fftw_free(plan_out);
+        }
+        free(entry);
+        pthread_mutex_unlock(&plan_lock);
+        return NULL;
+    }
+
+    unsigned flags = plan_flags | (aligned ? 0 : FFTW_UNALIGNED);
+    plan = fftw_plan_dft_1d(nfft, plan_in, plan_out, sign, flags);
+
+    fftw_free(plan_in);
+    if (!inplace) {
+        fftw_free(plan_out);
+    }
+
+    if (plan == NULL) {
+        fprintf(stderr, "Error: fftw_plan_dft_1d(%d) falló\n", nfft);
+        free(entry);
+        pthread_mutex_unlock(&plan_lock);
+        return NULL;
+    }
+
+    if (plan_count >= FFT_PLAN_CACHE_SIZE) {
+        plan_evict_oldest();
+    }
+
+    entry->nfft = nfft;
+    entry->sign = sign;
+    entry->aligned = aligned;
+    entry->inplace = inplace;
+    entry->plan = plan;
+    entry->refs = 2;  // La caché y quien lo pidió
+    entry->last_use = ++plan_clock;
+    entry->next = NULL;
+    plan_cache[plan_count++] = entry;
+
+    // El wisdom se escribe en disco con fft_plan_save_wisdom, no en cada plan
+    wisdom_dirty = true;
+
+    pthread_mutex_unlock(&plan_lock);
+
+    printf("[fft] Plan nfft=%d %s creado\n", nfft, aligned ? "alineado" : "no alineado");
+    return plan;
+}
+
+void fft_plan_release(fftw_plan plan)
+{
+    if (plan == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&plan_lock);
+    for (int i = 0; i < plan_count; i++) {
+        if (plan_cache[i]->plan == plan) {
+            plan_unref(plan_cache[i]);
+            pthread_mutex_unlock(&plan_lock);
+            return;
+        }
+    }
+    for (fft_plan_entry_t** link = &plan_retired; *link != NULL; link = &(*link)->next) {
+        fft_plan_entry_t* entry = *link;
+        if (entry->plan == plan) {
+            if (entry->refs == 1) {
+                *link = entry->next;
+            }
+            plan_unref(entry);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&plan_lock);
+}
+
+/**
+ * @brief Exporta el wisdom si hay planes nuevos. Requiere `plan_lock`.
+ *
+ * @return 1 si el wisdom en disco está al día, 0 si no se pudo escribir.
+ */
+static int save_wisdom_locked(void)
+{
+    if (!wisdom_dirty) {
+        return 1;
+    }
+    if (!fftw_export_wisdom_to_filename(wisdom_file)) {
+        fprintf(stderr, "Error: No se pudo guardar el wisdom en %s\n", wisdom_file);
+        return 0;
+    }
+    wisdom_dirty = false;
+    return 1;
+}
+
+int fft_plan_save_wisdom(void)
+{
+    int result;
+
+    pthread_mutex_lock(&plan_lock);
+    result = save_wisdom_locked();
+    pthread_mutex_unlock(&plan_lock);
+
+    return result;
+}
+
+void fft_plan_cleanup(void)
+{
+    pthread_mutex_lock(&plan_lock);
+    save_wisdom_locked();
+    for (int i = 0; i < plan_count; i++) {
+        plan_retire(plan_cache[i]);
+    }
+    plan_count = 0;
+    pthread_mutex_unlock(&plan_lock);
+}
@@ -0,0 +1,90 @@
+/**
+ * @file fft_plan.h
+ * @brief Caché de planes FFTW compartida por todo el proceso, con persistencia de wisdom.
+ *
+ * Los planes se crean una sola vez por (nfft, alineación, dirección) con
+ * FFTW_MEASURE o FFTW_PATIENT y se reutilizan con `fftw_execute_dft` sobre los
+ * buffers de cada llamada. El wisdom de FFTW se carga al iniciar y se guarda en
+ * disco con `fft_plan_save_wisdom` (una vez por medición, sólo si hubo planes
+ * nuevos) y en `fft_plan_cleanup`, de modo que los arranques posteriores no
+ * vuelven a medir.
+ *
+ * La caché guarda hasta `FFT_PLAN_CACHE_SIZE` planes; al llenarse descarta el
+ * usado hace más tiempo (LRU). Cada `fft_plan_get` toma una referencia que se
+ * devuelve con `fft_plan_release`, de modo que un plan descartado mientras un
+ * análisis lo ejecuta sigue válido hasta que éste lo suelta.
+ */
+
+#ifndef FFT_PLAN_H
+#define FFT_PLAN_H
+
+#include <complex.h>
+#include <fftw3.h>
+
+/**
+ * @def FFT_WISDOM_FILE
+ * @brief Archivo de wisdom FFTW por defecto (relativo al directorio de trabajo).
+ */
+#define FFT_WISDOM_FILE "fftw.wisdom"
+
+/**
+ * @def FFT_PLAN_FLAGS
+ * @brief Modo de planificación por defecto.
+ */
+#define FFT_PLAN_FLAGS FFTW_MEASURE
+
+/**
+ * @def FFT_PLAN_CACHE_SIZE
+ * @brief Número máximo de planes en caché.
+ */
+#define FFT_PLAN_CACHE_SIZE 16
+
+/**
+ * @brief Carga el wisdom desde disco y fija el modo de planificación.
+ *
+ * Es opcional: si no se llama, la primera solicitud de plan carga
+ * `FFT_WISDOM_FILE` con `FFT_PLAN_FLAGS`.
+ *
+ * @param wisdom_path Archivo de wisdom (NULL: `FFT_WISDOM_FILE`).
+ * @param flags Modo de planificación (FFTW_MEASURE, FFTW_PATIENT, ...).
+ *
+ * @return 1 si se importó wisdom existente, 0 si se parte sin wisdom.
+ */
+int fft_plan_init(const char* wisdom_path, unsigned flags);
+
+/**
+ * @brief Obtiene (o crea) el plan 1D complejo para los buffers indicados.
+ *
+ * El plan se ejecuta con `fftw_execute_dft(plan, in, out)` y no debe destruirse:
+ * se devuelve con `fft_plan_release` cuando ya no se usa. Es seguro llamar
+ * desde varios hilos.
+ *
+ * @param nfft Número de puntos de la FFT.
+ * @param sign FFTW_FORWARD o FFTW_BACKWARD.
+ * @param in Buffer de entrada con el que se ejecutará el plan.
+ * @param out Buffer de salida con el que se ejecutará el plan.
+ *
+ * @return Plan FFTW, o NULL en caso de error.
+ */
+fftw_plan fft_plan_get(int nfft, int sign, complex double* in, complex double* out);
+
+/**
+ * @brief Devuelve un plan obtenido con `fft_plan_get` (NULL no hace nada).
+ */
+void fft_plan_release(fftw_plan plan);
+
+/**
+ * @brief Guarda en disco el wisdom de los planes creados desde el último guardado.
+ *
+ * @return 1 si el wisdom en disco está al día, 0 en caso de error.
+ */
+int fft_plan_save_wisdom(void);
+
+/**
+ * @brief Guarda el wisdom pendiente y vacía la caché.
+ *
+ * Los planes que aún no se han devuelto se destruyen con su `fft_plan_release`.
+ */
+void fft_plan_cleanup(void);
+
+#endif // FFT_PLAN_H
@@ -7,6 +7,7 @@
  */
 #include <stdio.h>
 #include <math.h>
+#include "find_closest_index.h"
 
 int find_closest_index(double* array, int length, double value) {
     int min_index = 0;
@@ -19,4 +20,15 @@ int find_closest_index(double* array, int length, double value) {
         }
     }
     return min_index;
-}
\ No newline at end of file
+}
+
+int uniform_closest_index(double f0, double df, int length, double value) {
+    double x = ceil((value - f0) / df - 0.5);
+    if (x < 0.0) {
+        return 0;
+    }
+    if (x > length - 1) {
+        return length - 1;
+    }
+    return (int)x;
+}
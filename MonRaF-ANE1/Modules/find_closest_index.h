@@ -38,4 +38,20 @@
  */
 int find_closest_index(double* array, int length, double value);
 
+/**
+ * @brief Igual que `find_closest_index` sobre un eje uniforme `f0 + i * df`, en tiempo constante.
+ *
+ * Los ejes de las PSD de Welch son uniformes, así que el índice sale de una
+ * división en lugar de recorrer el arreglo. Los empates se resuelven hacia el
+ * índice menor, como en `find_closest_index`.
+ *
+ * @param f0 Valor del primer elemento.
+ * @param df Separación entre elementos (> 0).
+ * @param length La cantidad de elementos del eje.
+ * @param value El valor buscado.
+ *
+ * @return El índice más cercano, recortado a [0, `length` - 1].
+ */
+int uniform_closest_index(double f0, double df, int length, double value);
+
 #endif // FIND_CLOSEST_INDEX_H
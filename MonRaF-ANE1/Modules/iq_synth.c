@@ -0,0 +1,343 @@
+/**
+ * @file iq_synth.c
+ * @brief Implementación del generador de señales IQ sintéticas.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <fftw3.h>
+
+#include "iq_synth.h"
+#include "fft_plan.h"
+
+/** @brief Amplitud de 0 dBFS en unidades CS8. */
+#define IQ_SYNTH_FULL_SCALE 127.0
+
+/** @brief Bits de fase de la tabla del oscilador (error de fase < 2^-12 vueltas, muy por debajo del ruido CS8). */
+#define SYNTH_LUT_BITS 12
+
+/** @brief Bits de índice de la tabla de ruido gaussiano. */
+#define SYNTH_NOISE_BITS 16
+
+/** @brief exp(j·2π·k/2^SYNTH_LUT_BITS). */
+static complex double osc_lut[1 << SYNTH_LUT_BITS];
+
+/** @brief Muestras N(0, 1) de las que se sortea el ruido. */
+static double noise_lut[1 << SYNTH_NOISE_BITS];
+
+static pthread_once_t lut_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief xorshift64*: rápido y suficiente para ruido y símbolos de prueba.
+ */
+static uint64_t synth_rand(iq_synth_t* s)
+{
+    s->rng ^= s->rng >> 12;
+    s->rng ^= s->rng << 25;
+    s->rng ^= s->rng >> 27;
+    return s->rng * 2685821657736338717ull;
+}
+
+/**
+ * @brief Uniforme en (0, 1].
+ */
+static double synth_uniform(iq_synth_t* s)
+{
+    return ((synth_rand(s) >> 11) + 1.0) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Llena las tablas compartidas del oscilador y del ruido.
+ */
+static void synth_lut_init(void)
+{
+    for (int k = 0; k < (1 << SYNTH_LUT_BITS); k++) {
+        osc_lut[k] = cexp(I * 2.0 * M_PI * k / (1 << SYNTH_LUT_BITS));
+    }
+
+    // Box-Muller una sola vez; al generar sólo se sortean índices
+    iq_synth_t seed = { .rng = 0x2545F4914F6CDD1Dull };
+    for (int k = 0; k < (1 << SYNTH_NOISE_BITS); k += 2) {
+        double r = sqrt(-2.0 * log(synth_uniform(&seed)));
+        double t = 2.0 * M_PI * synth_uniform(&seed);
+        noise_lut[k] = r * cos(t);
+        noise_lut[k + 1] = r * sin(t);
+    }
+}
+
+/**
+ * @brief Incremento de un acumulador de fase de 32 bits para `hz` a la tasa `fs`.
+ */
+static uint32_t phase_step(double hz, double fs)
+{
+    return (uint32_t)(int64_t)llround(hz / fs * 4294967296.0);
+}
+
+/**
+ * @brief exp(j·fase) de un acumulador de fase de 32 bits.
+ */
+static inline complex double osc(uint32_t phase)
+{
+    return osc_lut[phase >> (32 - SYNTH_LUT_BITS)];
+}
+
+/**
+ * @brief Nuevo símbolo OFDM: QPSK aleatorio en las subportadoras activas e IFFT.
+ */
+static void ofdm_next_symbol(iq_synth_t* s, iq_synth_component_t* c)
+{
+    memset(c->bins, 0, (size_t)c->nfft * sizeof(complex double));
+    for (int k = 0; k < c->n_bins; k++) {
+        uint64_t r = synth_rand(s);
+        double re = (r & 1) ? M_SQRT1_2 : -M_SQRT1_2;
+        double im = (r & 2) ? M_SQRT1_2 : -M_SQRT1_2;
+        c->bins[(c->first_bin + k + c->nfft) % c->nfft] = re + I * im;
+    }
+    fftw_plan plan = fft_plan_get(c->nfft, FFTW_BACKWARD, c->bins, c->symbol);
+    if (plan != NULL) {
+        fftw_execute_dft(plan, c->bins, c->symbol);
+        fft_plan_release(plan);
+    }
+    c->symbol_pos = 0;
+}
+
+/**
+ * @brief Recalcula lo que depende de la tasa de muestreo.
+ */
+static int component_prepare(iq_synth_t* s, iq_synth_component_t* c)
+{
+    switch (c->kind) {
+        case IQ_SYNTH_TONE:
+            c->phasor = 1.0;
+            c->step = cexp(I * 2.0 * M_PI * c->offset_hz / s->fs);
+            break;
+        case IQ_SYNTH_OFDM: {
+            // Separación pedida = ancho de banda / subportadoras; la IFFT es la potencia de dos que la cubre
+            double spacing = c->deviation_hz / c->rate_hz;
+            int nfft = 64;
+            while (nfft < s->fs / spacing && nfft < (1 << 16)) {
+                nfft <<= 1;
+            }
+            double df = s->fs / nfft;
+            fftw_free(c->bins);
+            fftw_free(c->symbol);
+            c->nfft = nfft;
+            c->n_bins = (int)(c->deviation_hz / df + 0.5);
+            if (c->n_bins < 1) {
+                c->n_bins = 1;
+            }
+            c->first_bin = (int)lround(c->offset_hz / df) - c->n_bins / 2;
+            c->symbol_len = nfft + nfft / 4;
+            c->bins = fftw_alloc_complex(nfft);
+            c->symbol = fftw_alloc_complex(nfft);
+            if (c->bins == NULL || c->symbol == NULL) {
+                fprintf(stderr, "Error: Unable to allocate OFDM symbol\n");
+                return -1;
+            }
+            ofdm_next_symbol(s, c);
+            break;
+        }
+        default:
+            break;
+    }
+    return 0;
+}
+
+/**
+ * @brief Lee los campos numéricos de un componente.
+ *
+ * @return Número de campos leídos, o -1 si alguno no es un número.
+ */
+static int parse_fields(char* fields, double* values, int max_values)
+{
+    int n = 0;
+    char* save = NULL;
+    for (char* tok = strtok_r(fields, ":", &save); tok != NULL; tok = strtok_r(NULL, ":", &save)) {
+        char* end;
+        if (n == max_values) {
+            return -1;
+        }
+        values[n] = strtod(tok, &end);
+        if (end == tok || *end != '\0') {
+            return -1;
+        }
+        n++;
+    }
+    return n;
+}
+
+int iq_synth_init(iq_synth_t* s, const char* spec, double fs)
+{
+    pthread_once(&lut_once, synth_lut_init);
+    memset(s, 0, sizeof(*s));
+    s->fs = fs;
+    s->rng = 0x9E3779B97F4A7C15ull;
+
+    char* copy = strdup(spec);
+    if (copy == NULL) {
+        return -1;
+    }
+
+    char* save = NULL;
+    for (char* item = strtok_r(copy, ",", &save); item != NULL; item = strtok_r(NULL, ",", &save)) {
+        if (s->n_components == IQ_SYNTH_MAX_COMPONENTS) {
+            fprintf(stderr, "Error: too many synthetic components\n");
+            break;
+        }
+
+        char* fields = strchr(item, ':');
+        double v[4] = {0};
+        int n = 0;
+        if (fields != NULL) {
+            *fields++ = '\0';
+            n = parse_fields(fields, v, 4);
+        }
+
+        iq_synth_component_t* c = &s->comp[s->n_components];
+        memset(c, 0, sizeof(*c));
+        if (strcmp(item, "tone") == 0 && n == 2) {
+            c->kind = IQ_SYNTH_TONE;
+        } else if (strcmp(item, "fm") == 0 && n == 4) {
+            c->kind = IQ_SYNTH_FM;
+        } else if (strcmp(item, "ofdm") == 0 && n == 4 && v[2] > 0 && v[3] >= 1) {
+            c->kind = IQ_SYNTH_OFDM;
+        } else if (strcmp(item, "noise") == 0 && n == 1) {
+            c->kind = IQ_SYNTH_NOISE;
+            v[1] = v[0];
+            v[0] = 0;
+        } else {
+            fprintf(stderr, "Error: invalid synthetic component '%s'\n", item);
+            free(copy);
+            iq_synth_free(s);
+            return -1;
+        }
+        c->offset_hz = v[0];
+        c->amplitude = IQ_SYNTH_FULL_SCALE * pow(10.0, v[1] / 20.0);
+        c->deviation_hz = v[2];
+        c->rate_hz = v[3];
+        s->n_components++;
+    }
+    free(copy);
+
+    if (s->n_components == 0) {
+        fprintf(stderr, "Error: empty synthetic signal\n");
+        return -1;
+    }
+    return iq_synth_set_rate(s, fs);
+}
+
+int iq_synth_set_rate(iq_synth_t* s, double fs)
+{
+    s->fs = fs;
+    for (int i = 0; i < s->n_components; i++) {
+        if (component_prepare(s, &s->comp[i]) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Suma `n` muestras de un componente a `acc`.
+ */
+static void component_add(iq_synth_t* s, iq_synth_component_t* c, complex double* acc, size_t n)
+{
+    switch (c->kind) {
+        case IQ_SYNTH_TONE:
+            for (size_t i = 0; i < n; i++) {
+                acc[i] += c->amplitude * c->phasor;
+                c->phasor *= c->step;
+            }
+            // Evitar que el redondeo acumulado cambie la amplitud
+            c->phasor /= cabs(c->phasor);
+            break;
+
+        case IQ_SYNTH_FM: {
+            // Acumuladores de fase de 32 bits: el desborde es la vuelta completa
+            uint32_t carrier = phase_step(c->offset_hz, s->fs);
+            uint32_t mod = phase_step(c->rate_hz, s->fs);
+            double dev = c->deviation_hz / s->fs * 4294967296.0;
+            for (size_t i = 0; i < n; i++) {
+                acc[i] += c->amplitude * osc(c->phase);
+                c->phase += carrier + (uint32_t)(int32_t)lrint(dev * cimag(osc(c->mod_phase)));
+                c->mod_phase += mod;
+            }
+            break;
+        }
+
+        case IQ_SYNTH_OFDM: {
+            // La IFFT sin normalizar suma n_bins subportadoras de potencia 1
+            double scale = c->amplitude / sqrt((double)c->n_bins);
+            int cp = c->symbol_len - c->nfft;
+            for (size_t i = 0; i < n; i++) {
+                if (c->symbol_pos == c->symbol_len) {
+                    ofdm_next_symbol(s, c);
+                }
+                // Primero el prefijo cíclico (cola del símbolo), luego el símbolo
+                acc[i] += scale * c->symbol[(c->symbol_pos + c->nfft - cp) % c->nfft];
+                c->symbol_pos++;
+            }
+            break;
+        }
+
+        case IQ_SYNTH_NOISE: {
+            double sigma = c->amplitude * M_SQRT1_2;
+            const uint64_t mask = (1u << SYNTH_NOISE_BITS) - 1;
+            for (size_t i = 0; i < n; i++) {
+                uint64_t r = synth_rand(s);
+                acc[i] += sigma * (noise_lut[r & mask] + I * noise_lut[(r >> 32) & mask]);
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Redondea y satura a int8.
+ */
+static int8_t to_cs8(double x)
+{
+    long v = lround(x);
+    if (v > 127) {
+        return 127;
+    }
+    if (v < -128) {
+        return -128;
+    }
+    return (int8_t)v;
+}
+
+void iq_synth_fill(iq_synth_t* s, int8_t* out, size_t n_samples)
+{
+    complex double acc[1024];
+
+    for (size_t done = 0; done < n_samples; ) {
+        size_t n = n_samples - done;
+        if (n > 1024) {
+            n = 1024;
+        }
+        memset(acc, 0, n * sizeof(complex double));
+        for (int i = 0; i < s->n_components; i++) {
+            component_add(s, &s->comp[i], acc, n);
+        }
+        for (size_t i = 0; i < n; i++) {
+            out[2 * (done + i)] = to_cs8(creal(acc[i]));
+            out[2 * (done + i) + 1] = to_cs8(cimag(acc[i]));
+        }
+        done += n;
+    }
+}
+
+void iq_synth_free(iq_synth_t* s)
+{
+    for (int i = 0; i < s->n_components; i++) {
+        fftw_free(s->comp[i].bins);
+        fftw_free(s->comp[i].symbol);
+        s->comp[i].bins = NULL;
+        s->comp[i].symbol = NULL;
+    }
+    s->n_components = 0;
+}
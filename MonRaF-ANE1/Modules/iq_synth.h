@@ -0,0 +1,108 @@
+/**
+ * @file iq_synth.h
+ * @brief Generador de señales IQ sintéticas en formato CS8.
+ *
+ * Suma tonos, portadoras FM, bloques tipo OFDM y ruido gaussiano, descritos
+ * con una cadena de texto, y entrega el resultado como muestras CS8 igual que
+ * el HackRF. Lo usa el backend sintético de `rf_session` para ejercitar y
+ * medir toda la cadena de medición sin radio ni archivos de captura.
+ *
+ * Formato de la descripción: componentes separados por comas y campos por
+ * dos puntos; las frecuencias son desplazamientos respecto a la frecuencia
+ * central en Hz y los niveles en dBFS (0 dBFS = amplitud 127).
+ *
+ * - `tone:<offset>:<dBFS>`
+ * - `fm:<offset>:<dBFS>:<desviación>:<frecuencia moduladora>`
+ * - `ofdm:<offset>:<dBFS>:<ancho de banda>:<subportadoras>`
+ * - `noise:<dBFS>`
+ *
+ * Por ejemplo `tone:1e6:-20,fm:-4e6:-25:75e3:1e3,ofdm:5e6:-30:6e6:1024,noise:-45`.
+ */
+
+#ifndef IQ_SYNTH_H
+#define IQ_SYNTH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <complex.h>
+
+/**
+ * @def IQ_SYNTH_MAX_COMPONENTS
+ * @brief Número máximo de componentes de una señal.
+ */
+#define IQ_SYNTH_MAX_COMPONENTS 16
+
+/**
+ * @enum iq_synth_kind_t
+ * @brief Tipo de componente.
+ */
+typedef enum {
+    IQ_SYNTH_TONE,    /**< Tono continuo. */
+    IQ_SYNTH_FM,      /**< Portadora modulada en frecuencia por un tono. */
+    IQ_SYNTH_OFDM,    /**< Símbolos QPSK sobre subportadoras, con prefijo cíclico. */
+    IQ_SYNTH_NOISE    /**< Ruido blanco gaussiano complejo. */
+} iq_synth_kind_t;
+
+/**
+ * @struct iq_synth_component_t
+ * @brief Un componente de la señal y su estado.
+ */
+typedef struct {
+    iq_synth_kind_t kind;        /**< Tipo. */
+    double offset_hz;            /**< Desplazamiento respecto a la frecuencia central. */
+    double amplitude;            /**< Amplitud RMS en unidades CS8. */
+    double deviation_hz;         /**< Desviación (FM) o ancho de banda (OFDM). */
+    double rate_hz;              /**< Frecuencia moduladora (FM) o subportadoras pedidas (OFDM). */
+    complex double phasor;       /**< Fase actual de la portadora (tono). */
+    complex double step;         /**< Giro por muestra (tono). */
+    uint32_t phase;              /**< Fase de la portadora, en 2^-32 vueltas (FM). */
+    uint32_t mod_phase;          /**< Fase de la moduladora, en 2^-32 vueltas (FM). */
+    int nfft;                    /**< Puntos de la IFFT (OFDM). */
+    int first_bin;               /**< Primera subportadora activa (OFDM). */
+    int n_bins;                  /**< Subportadoras activas (OFDM). */
+    complex double* bins;        /**< Símbolo en frecuencia (OFDM). */
+    complex double* symbol;      /**< Símbolo en el tiempo con prefijo cíclico (OFDM). */
+    int symbol_len;              /**< Muestras de `symbol`. */
+    int symbol_pos;              /**< Próxima muestra de `symbol` a emitir. */
+} iq_synth_component_t;
+
+/**
+ * @struct iq_synth_t
+ * @brief Generador.
+ */
+typedef struct {
+    double fs;                                             /**< Tasa de muestreo. */
+    int n_components;                                      /**< Componentes válidos. */
+    iq_synth_component_t comp[IQ_SYNTH_MAX_COMPONENTS];    /**< Componentes. */
+    uint64_t rng;                                          /**< Estado del generador pseudoaleatorio. */
+} iq_synth_t;
+
+/**
+ * @brief Crea un generador a partir de su descripción.
+ *
+ * @param s Generador.
+ * @param spec Descripción (ver el formato arriba).
+ * @param fs Tasa de muestreo inicial.
+ *
+ * @return 0 si la descripción es válida, -1 en caso contrario.
+ */
+int iq_synth_init(iq_synth_t* s, const char* spec, double fs);
+
+/**
+ * @brief Cambia la tasa de muestreo; las frecuencias de los componentes se conservan.
+ *
+ * @return 0 si se pudo, -1 si no se pudo reservar el OFDM.
+ */
+int iq_synth_set_rate(iq_synth_t* s, double fs);
+
+/**
+ * @brief Genera `n_samples` muestras IQ intercaladas (2 bytes por muestra).
+ */
+void iq_synth_fill(iq_synth_t* s, int8_t* out, size_t n_samples);
+
+/**
+ * @brief Libera el generador.
+ */
+void iq_synth_free(iq_synth_t* s);
+
+#endif // IQ_SYNTH_H
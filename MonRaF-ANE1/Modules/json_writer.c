@@ -0,0 +1,310 @@
+/**
+ * @file json_writer.c
+ * @brief Implementación del escritor JSON en streaming compatible con `cJSON_Print`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <limits.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "json_writer.h"
+
+static int flush_fd(json_writer_t* w)
+{
+    size_t done = 0;
+    while (done < w->len) {
+        ssize_t n = write(w->fd, w->buf + done, w->len - done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("Error al escribir el JSON");
+            w->failed = true;
+            return -1;
+        }
+        done += (size_t)n;
+    }
+    w->len = 0;
+    return 0;
+}
+
+/**
+ * @brief Garantiza `n` bytes libres en el buffer y devuelve dónde escribirlos.
+ */
+static char* reserve(json_writer_t* w, size_t n)
+{
+    if (w->failed) {
+        return NULL;
+    }
+    if (w->len + n > w->cap && w->fd >= 0) {
+        flush_fd(w);
+    }
+    if (w->len + n > w->cap) {
+        size_t cap = w->cap * 2;
+        while (cap < w->len + n) cap *= 2;
+        char* buf = realloc(w->buf, cap);
+        if (buf == NULL) {
+            fprintf(stderr, "Error: sin memoria para el JSON\n");
+            w->failed = true;
+            return NULL;
+        }
+        w->buf = buf;
+        w->cap = cap;
+    }
+    return w->buf + w->len;
+}
+
+static void put(json_writer_t* w, const char* s, size_t n)
+{
+    char* out = reserve(w, n);
+    if (out != NULL) {
+        memcpy(out, s, n);
+        w->len += n;
+    }
+}
+
+static void put_tabs(json_writer_t* w, int n)
+{
+    char* out = reserve(w, (size_t)n);
+    if (out != NULL) {
+        memset(out, '\t', (size_t)n);
+        w->len += (size_t)n;
+    }
+}
+
+/**
+ * @brief Escribe una cadena entre comillas con los mismos escapes que cJSON.
+ */
+static void put_quoted(json_writer_t* w, const char* s)
+{
+    size_t n = strlen(s);
+    // Peor caso: cada byte como \u00XX
+    char* out = reserve(w, n * 6 + 2);
+    if (out == NULL) {
+        return;
+    }
+    char* p = out;
+    *p++ = '"';
+    for (const unsigned char* c = (const unsigned char*)s; *c; c++) {
+        switch (*c) {
+            case '"':  *p++ = '\\'; *p++ = '"'; break;
+            case '\\': *p++ = '\\'; *p++ = '\\'; break;
+            case '\b': *p++ = '\\'; *p++ = 'b'; break;
+            case '\f': *p++ = '\\'; *p++ = 'f'; break;
+            case '\n': *p++ = '\\'; *p++ = 'n'; break;
+            case '\r': *p++ = '\\'; *p++ = 'r'; break;
+            case '\t': *p++ = '\\'; *p++ = 't'; break;
+            default:
+                if (*c < 32) {
+                    p += sprintf(p, "\\u%04x", *c);
+                } else {
+                    *p++ = (char)*c;
+                }
+        }
+    }
+    *p++ = '"';
+    w->len += (size_t)(p - out);
+}
+
+/**
+ * @brief Separador, sangría y clave antes de un valor.
+ */
+static void begin_value(json_writer_t* w, const char* key)
+{
+    if (w->depth == 0) {
+        return;
+    }
+    int level = w->depth - 1;
+
+    if (w->is_array[level]) {
+        if (w->has_items[level]) {
+            put(w, ", ", 2);
+        }
+    } else {
+        if (w->has_items[level]) {
+            put(w, ",\n", 2);
+        }
+        put_tabs(w, w->depth);
+        put_quoted(w, key != NULL ? key : "");
+        put(w, ":\t", 2);
+    }
+    w->has_items[level] = true;
+}
+
+static void open_container(json_writer_t* w, const char* key, bool is_array)
+{
+    begin_value(w, key);
+    if (w->depth >= JSON_WRITER_MAX_DEPTH) {
+        fprintf(stderr, "Error: JSON demasiado anidado\n");
+        w->failed = true;
+        return;
+    }
+    w->is_array[w->depth] = is_array;
+    w->has_items[w->depth] = false;
+    w->depth++;
+    put(w, is_array ? "[" : "{\n", is_array ? 1 : 2);
+}
+
+int json_writer_init(json_writer_t* w, int fd)
+{
+    memset(w, 0, sizeof(*w));
+    w->fd = fd;
+    w->cap = JSON_WRITER_CHUNK;
+    w->buf = malloc(w->cap);
+    if (w->buf == NULL) {
+        fprintf(stderr, "Error: sin memoria para el JSON\n");
+        w->failed = true;
+        return -1;
+    }
+    return 0;
+}
+
+void json_object_begin(json_writer_t* w, const char* key)
+{
+    open_container(w, key, false);
+}
+
+void json_object_end(json_writer_t* w)
+{
+    if (w->depth == 0) {
+        return;
+    }
+    if (w->has_items[w->depth - 1]) {
+        put(w, "\n", 1);
+    }
+    put_tabs(w, w->depth - 1);
+    put(w, "}", 1);
+    w->depth--;
+}
+
+void json_array_begin(json_writer_t* w, const char* key)
+{
+    open_container(w, key, true);
+}
+
+void json_array_end(json_writer_t* w)
+{
+    if (w->depth == 0) {
+        return;
+    }
+    put(w, "]", 1);
+    w->depth--;
+}
+
+void json_string(json_writer_t* w, const char* key, const char* value)
+{
+    begin_value(w, key);
+    put_quoted(w, value);
+}
+
+/**
+ * @brief Igual que `compare_double` de cJSON.
+ */
+static bool same_double(double a, double b)
+{
+    double max_val = fabs(a) > fabs(b) ? fabs(a) : fabs(b);
+    return fabs(a - b) <= max_val * DBL_EPSILON;
+}
+
+void json_number(json_writer_t* w, const char* key, double value)
+{
+    char number[32];
+    int length;
+
+    begin_value(w, key);
+
+    // Misma lógica que print_number de cJSON, incluido el valueint saturado
+    int valueint = (value >= INT_MAX) ? INT_MAX : (value <= (double)INT_MIN) ? INT_MIN : (int)value;
+    if (isnan(value) || isinf(value)) {
+        length = snprintf(number, sizeof(number), "null");
+    } else if (value == (double)valueint) {
+        length = snprintf(number, sizeof(number), "%d", valueint);
+    } else {
+        double test = 0.0;
+        length = snprintf(number, sizeof(number), "%1.15g", value);
+        if (sscanf(number, "%lg", &test) != 1 || !same_double(test, value)) {
+            length = snprintf(number, sizeof(number), "%1.17g", value);
+        }
+    }
+    put(w, number, (size_t)length);
+}
+
+void json_number_3f(json_writer_t* w, const char* key, double value)
+{
+    double scaled = value * 1000.0;
+
+    // Fuera del rango cómodo o demasiado cerca de un empate de redondeo: vía lenta exacta
+    if (!(fabs(value) < 1e9) ||
+        fabs(fabs(scaled - trunc(scaled)) - 0.5) < 1e-3) {
+        char tempu[50];
+        snprintf(tempu, sizeof(tempu), "%0.3f", value);
+        json_number(w, key, atof(tempu));
+        return;
+    }
+
+    int64_t milli = (int64_t)nearbyint(scaled);
+
+    begin_value(w, key);
+
+    // atof("%0.3f") reimpreso con %1.15g: parte entera, y decimales sin ceros finales
+    char digits[32];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    uint64_t mag = (uint64_t)(milli < 0 ? -milli : milli);
+    int frac = (int)(mag % 1000);
+    uint64_t whole = mag / 1000;
+
+    if (frac != 0) {
+        int n_frac = 3;
+        while (frac % 10 == 0) {
+            frac /= 10;
+            n_frac--;
+        }
+        for (int i = 0; i < n_frac; i++) {
+            *--p = (char)('0' + frac % 10);
+            frac /= 10;
+        }
+        *--p = '.';
+    }
+    do {
+        *--p = (char)('0' + whole % 10);
+        whole /= 10;
+    } while (whole != 0);
+    if (milli < 0) {
+        *--p = '-';
+    }
+    put(w, p, (size_t)(end - p));
+}
+
+int json_writer_finish(json_writer_t* w)
+{
+    if (!w->failed && w->fd >= 0) {
+        flush_fd(w);
+    }
+    free(w->buf);
+    w->buf = NULL;
+    w->len = 0;
+    w->cap = 0;
+    return w->failed ? -1 : 0;
+}
+
+char* json_writer_release(json_writer_t* w)
+{
+    char* out = reserve(w, 1);
+    if (out == NULL) {
+        free(w->buf);
+        w->buf = NULL;
+        return NULL;
+    }
+    *out = '\0';
+    out = w->buf;
+    w->buf = NULL;
+    w->len = 0;
+    w->cap = 0;
+    return out;
+}
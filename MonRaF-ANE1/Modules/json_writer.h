@@ -0,0 +1,108 @@
+/**
+ * @file json_writer.h
+ * @brief Escritor JSON en streaming con el mismo formato que `cJSON_Print`.
+ *
+ * Los valores se escriben directamente en un buffer que se vacía a un
+ * descriptor de archivo (o crece, si no hay descriptor), sin construir el
+ * árbol de nodos de cJSON. La salida reproduce byte a byte la de
+ * `cJSON_Print`: tabulaciones por nivel, `":\t"` tras cada clave, `", "`
+ * entre elementos de un arreglo y números con `%1.15g` (o `%d` si son enteros).
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @def JSON_WRITER_CHUNK
+ * @brief Tamaño del buffer en bytes; al llenarse se vacía al descriptor.
+ */
+#define JSON_WRITER_CHUNK (64 * 1024)
+
+/**
+ * @def JSON_WRITER_MAX_DEPTH
+ * @brief Niveles de anidamiento admitidos.
+ */
+#define JSON_WRITER_MAX_DEPTH 16
+
+/**
+ * @struct json_writer_t
+ * @brief Estado del escritor.
+ */
+typedef struct {
+    char* buf;                               /**< Buffer de salida. */
+    size_t len;                              /**< Bytes pendientes en `buf`. */
+    size_t cap;                              /**< Capacidad de `buf`. */
+    int fd;                                  /**< Descriptor de destino, o -1 para acumular en memoria. */
+    bool failed;                             /**< Hubo un error de memoria o de escritura. */
+    int depth;                               /**< Nivel de anidamiento actual. */
+    bool is_array[JSON_WRITER_MAX_DEPTH];    /**< El contenedor de cada nivel es un arreglo. */
+    bool has_items[JSON_WRITER_MAX_DEPTH];   /**< El contenedor de cada nivel ya tiene elementos. */
+} json_writer_t;
+
+/**
+ * @brief Prepara el escritor.
+ *
+ * @param w Escritor.
+ * @param fd Descriptor al que se vacía el buffer, o -1 para acumular todo el documento en memoria.
+ *
+ * @return 0 si se reservó el buffer, -1 en caso contrario.
+ */
+int json_writer_init(json_writer_t* w, int fd);
+
+/**
+ * @brief Abre un objeto. `key` es NULL en la raíz y dentro de arreglos.
+ */
+void json_object_begin(json_writer_t* w, const char* key);
+
+/**
+ * @brief Cierra el objeto abierto.
+ */
+void json_object_end(json_writer_t* w);
+
+/**
+ * @brief Abre un arreglo. `key` es NULL en la raíz y dentro de arreglos.
+ */
+void json_array_begin(json_writer_t* w, const char* key);
+
+/**
+ * @brief Cierra el arreglo abierto.
+ */
+void json_array_end(json_writer_t* w);
+
+/**
+ * @brief Escribe una cadena.
+ */
+void json_string(json_writer_t* w, const char* key, const char* value);
+
+/**
+ * @brief Escribe un número como lo haría `cJSON_AddNumberToObject`.
+ */
+void json_number(json_writer_t* w, const char* key, double value);
+
+/**
+ * @brief Escribe un número redondeado a 3 decimales.
+ *
+ * Equivale a `sprintf("%0.3f")` + `atof` + `json_number`, pero sin pasar por
+ * texto intermedio salvo en los casos límite de redondeo.
+ */
+void json_number_3f(json_writer_t* w, const char* key, double value);
+
+/**
+ * @brief Vacía lo pendiente al descriptor.
+ *
+ * @return 0 si todo el documento se escribió, -1 si hubo algún error.
+ */
+int json_writer_finish(json_writer_t* w);
+
+/**
+ * @brief Entrega el documento acumulado en memoria (modo sin descriptor).
+ *
+ * @return Cadena terminada en '\0' (liberar con `free`), o NULL si hubo errores.
+ */
+char* json_writer_release(json_writer_t* w);
+
+#endif // JSON_WRITER_H
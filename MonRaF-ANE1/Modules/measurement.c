@@ -0,0 +1,878 @@
+/**
+ * @file measurement.c
+ * @brief Etapas de las mediciones RMER, RNI y TDT sobre la tubería.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "measurement.h"
+#include "bacn_RF.h"
+#include "parameters.h"
+#include "parameters_rni.h"
+#include "tdt.h"
+#include "ddc.h"
+#include "cs8_map.h"
+#include "fft_plan.h"
+#include "band_registry.h"
+#include "tdt_index.h"
+#include "sweep.h"
+
+/**
+ * @brief Tipo de medición.
+ */
+typedef enum {
+    MEASURE_RMER,
+    MEASURE_RNI,
+    MEASURE_TDT,
+    MEASURE_TDT_WIDE,
+    MEASURE_TDT_CACHED,
+    MEASURE_SWEEP
+} measurement_kind_t;
+
+/**
+ * @struct measurement_job_t
+ * @brief Una medición en vuelo.
+ */
+typedef struct {
+    measurement_kind_t kind;     /**< Tipo de medición. */
+    uint32_t seq;                /**< Número de orden. */
+    uint8_t slot;                /**< Primer archivo de `Samples/` del trabajo (el segundo es `slot + 1`). */
+    uint8_t bands;               /**< Banda a capturar (RMER/RNI). */
+    int threshold;               /**< Umbral (RMER/RNI). */
+    window_type_t window;        /**< Ventana de Welch (RMER/RNI). */
+    double* canalization;        /**< Copia de la canalización (RMER/RNI). */
+    double* bandwidth;           /**< Copia de los anchos de banda (RMER/RNI). */
+    int canalization_length;     /**< Número de canales. */
+    char banda[16];              /**< Banda para el registro. */
+    char Flow[13];               /**< Frecuencia inferior para el registro. */
+    char Fhigh[13];              /**< Frecuencia superior para el registro. */
+    int modulation;              /**< Orden de la modulación (TDT). */
+    uint16_t tdt_freq_mhz;       /**< Frecuencia central del canal (TDT). */
+    char channel[13];            /**< Canal (TDT). */
+    tdt_channel_t tdt[MEASURE_TDT_WIDE_CHANNELS];         /**< Canales derivados de la captura (TDT de banda ancha). */
+    int n_tdt;                                            /**< Entradas válidas en `tdt`. */
+    psd_publication_t tdt_pub[MEASURE_TDT_WIDE_CHANNELS]; /**< Resultado de cada canal (TDT de banda ancha). */
+    psd_publication_t* cached;   /**< Canales ya derivados de capturas UHF2 (TDT sin captura). */
+    int n_cached;                /**< Entradas válidas en `cached`. */
+    uint64_t central_freq;       /**< Frecuencia central de la captura en Hz. */
+    rmer_job_t rmer;             /**< Estado de las etapas RMER. */
+    const band_info_t* tiles[BAND_REGISTRY_SIZE]; /**< Bandas del barrido, por frecuencia. */
+    int n_tiles;                 /**< Entradas válidas en `tiles`. */
+    sweep_t sweep;               /**< Barrido que cubre todas las bandas. */
+    double* panorama_f;          /**< Frecuencias del panorama (`sweep_bins`). */
+    double* panorama_p;          /**< PSD lineal del panorama. */
+    int panorama_bins;           /**< Bins del panorama. */
+    time_t rawtime;              /**< Momento del barrido. */
+    rmer_job_t* tile_rmer;       /**< Medición de cada banda del barrido. */
+    psd_publication_t pub;       /**< Resultado RNI/TDT. */
+} measurement_job_t;
+
+static pipeline_t pipeline;
+static st_server* server = NULL;
+static uint32_t next_seq = 0;
+static atomic_bool adaptive_capture = false;
+static atomic_bool integrated_power = false;
+static atomic_int psd_window = WINDOW_HAMMING;
+static atomic_uint jobs_finished = 0;
+
+/**
+ * @struct tdt_cache_entry_t
+ * @brief Canal TDT derivado de la captura de una banda RMER, a la espera de que se pida.
+ */
+typedef struct {
+    bool valid;                  /**< La entrada tiene una medición. */
+    tdt_channel_t channel;       /**< Canal medido. */
+    time_t captured;             /**< Hora de la captura de la que salió. */
+    psd_publication_t pub;       /**< Medición del canal. */
+} tdt_cache_entry_t;
+
+// Ciudad de la estación y canales derivados; los escriben la etapa PSD y los lee el hilo principal
+static pthread_mutex_t tdt_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static char tdt_city[TDT_CITY_NAME_MAX];
+static tdt_cache_entry_t tdt_cache[MAX_TDT_CHANNELS];
+
+/**
+ * @brief Publicación lista del trabajo, según su tipo.
+ */
+static psd_publication_t* job_publication(measurement_job_t* job)
+{
+    return (job->kind == MEASURE_RMER) ? &job->rmer.pub : &job->pub;
+}
+
+/**
+ * @brief Mueve la captura recién hecha (`Samples/0`) al archivo `Samples/<dst>`.
+ */
+static int take_sample(uint8_t dst)
+{
+    char path_zero_sample[20];
+    char path_dst_sample[20];
+    snprintf(path_zero_sample, sizeof(path_zero_sample), "Samples/%d", 0);
+    snprintf(path_dst_sample, sizeof(path_dst_sample), "Samples/%d", dst);
+
+    if (rename(path_zero_sample, path_dst_sample) != 0) {
+        fprintf(stderr, "Error: Unable to rename %s to %s\n", path_zero_sample, path_dst_sample);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Captura la banda del trabajo; en modo adaptativo para al converger sus canales.
+ */
+static int capture_band(measurement_job_t* job, bool is_second_sample)
+{
+    welch_stream_t ws;
+    bool adaptive = atomic_load(&adaptive_capture) && job->canalization_length > 0 &&
+                    welch_stream_init(&ws, DEFAULT_SAMPLE_RATE_HZ, MEASURE_ADAPTIVE_NPERSEG, 0, job->window) == 0;
+
+    if (adaptive) {
+        // La canalización está en MHz absolutos; el acumulador trabaja relativo a la sintonía
+        int n = job->canalization_length;
+        double* offset = (double*)malloc((size_t)n * sizeof(double));
+        double* bw = (double*)malloc((size_t)n * sizeof(double));
+        double center = (double)capture_center_hz(job->bands, is_second_sample);
+        if (offset != NULL && bw != NULL) {
+            for (int i = 0; i < n; i++) {
+                offset[i] = job->canalization[i] * 1e6 - center;
+                bw[i] = job->bandwidth[i] * 1e6;
+            }
+            adaptive = welch_stream_track_channels(&ws, offset, bw, n) > 0;
+        } else {
+            adaptive = false;
+        }
+        free(offset);
+        free(bw);
+        if (adaptive) {
+            set_capture_convergence(&ws, MEASURE_ADAPTIVE_MIN_SAMPLES, MEASURE_ADAPTIVE_CI);
+        } else {
+            welch_stream_free(&ws);
+        }
+    }
+
+    int totalSamples = getSamples(job->bands, MEASURE_SAMPLES_TO_XFER, TRANSCEIVER_MODE_RX, 0, 0, 0, is_second_sample);
+
+    if (adaptive) {
+        set_capture_convergence(NULL, 0, 0.0);
+        welch_stream_free(&ws);
+    }
+    return totalSamples;
+}
+
+static int stage_capture(void* arg)
+{
+    measurement_job_t* job = (measurement_job_t*)arg;
+    int totalSamples;
+
+    if (job->kind == MEASURE_TDT_CACHED) {
+        return 0;
+    }
+    if (job->kind == MEASURE_SWEEP) {
+        // Una sola captura salta por todas las bandas
+        if (getSweep(&job->sweep, 0, 0) != 0) {
+            return -1;
+        }
+        time(&job->rawtime);
+        return 0;
+    }
+    if (job->kind == MEASURE_TDT || job->kind == MEASURE_TDT_WIDE) {
+        set_tdt_wideband(job->kind == MEASURE_TDT_WIDE);
+        totalSamples = getSamples(0, DEFAULT_SAMPLES_TDT_XFER_MAX, TRANSCEIVER_MODE_TDT, 0, 0, job->tdt_freq_mhz, false);
+        set_tdt_wideband(false);
+        job->central_freq = (uint64_t)job->tdt_freq_mhz * 1000000;
+        return (totalSamples == 0) ? take_sample(job->slot) : -1;
+    }
+
+    if (job->kind == MEASURE_RMER) {
+        // Segunda captura (desplazada 2 MHz) primero, como hacía el lazo principal
+        totalSamples = capture_band(job, true);
+        if (totalSamples != 0 || take_sample(job->slot + 1) != 0) {
+            return -1;
+        }
+    }
+
+    totalSamples = capture_band(job, false);
+    if (totalSamples != 0 || take_sample(job->slot) != 0) {
+        return -1;
+    }
+    job->central_freq = (uint64_t)capture_center_hz(job->bands, false);
+    return 0;
+}
+
+static int stage_load(void* arg)
+{
+    measurement_job_t* job = (measurement_job_t*)arg;
+    if (job->kind != MEASURE_RMER) {
+        return 0;
+    }
+    if (parameter_job_init(&job->rmer, job->threshold, job->canalization, job->bandwidth, job->canalization_length,
+                           job->central_freq, job->slot, job->banda, job->Flow, job->Fhigh) != 0) {
+        return -1;
+    }
+    job->rmer.integrated = atomic_load(&integrated_power);
+    job->rmer.window = job->window;
+    return parameter_load(&job->rmer);
+}
+
+/**
+ * @brief Guarda la medición de un canal derivado (se queda con `pub`).
+ *
+ * Reemplaza la medición anterior del mismo canal; si no la hay ocupa una
+ * entrada libre o, con la tabla llena, la más antigua.
+ */
+static void tdt_cache_store(const tdt_channel_t* channel, time_t captured, psd_publication_t* pub)
+{
+    pthread_mutex_lock(&tdt_cache_lock);
+    int slot = -1;
+    for (int i = 0; i < MAX_TDT_CHANNELS && slot < 0; i++) {
+        if (tdt_cache[i].valid && tdt_cache[i].channel.freq_mhz == channel->freq_mhz &&
+            tdt_cache[i].channel.modulation == channel->modulation) {
+            slot = i;
+        }
+    }
+    for (int i = 0; i < MAX_TDT_CHANNELS && slot < 0; i++) {
+        if (!tdt_cache[i].valid) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        slot = 0;
+        for (int i = 1; i < MAX_TDT_CHANNELS; i++) {
+            if (tdt_cache[i].captured < tdt_cache[slot].captured) {
+                slot = i;
+            }
+        }
+    }
+    tdt_cache_entry_t* entry = &tdt_cache[slot];
+    if (entry->valid) {
+        psd_publication_free(&entry->pub);
+    }
+    entry->valid = true;
+    entry->channel = *channel;
+    entry->captured = captured;
+    entry->pub = *pub;
+    memset(pub, 0, sizeof(*pub));
+    pthread_mutex_unlock(&tdt_cache_lock);
+}
+
+/**
+ * @brief Saca del caché la medición reciente de un canal.
+ *
+ * Una medición de más de `MEASURE_TDT_REUSE_MAX_AGE_S` segundos se descarta.
+ *
+ * @return 0 si `pub` quedó lleno (liberar con `psd_publication_free`), -1 si no había medición reciente.
+ */
+static int tdt_cache_take(const tdt_channel_t* channel, psd_publication_t* pub)
+{
+    time_t now = time(NULL);
+    int result = -1;
+    pthread_mutex_lock(&tdt_cache_lock);
+    for (int i = 0; i < MAX_TDT_CHANNELS; i++) {
+        tdt_cache_entry_t* entry = &tdt_cache[i];
+        if (!entry->valid || entry->channel.freq_mhz != channel->freq_mhz || entry->channel.modulation != channel->modulation) {
+            continue;
+        }
+        if (now - entry->captured <= MEASURE_TDT_REUSE_MAX_AGE_S) {
+            *pub = entry->pub;
+            // El registro lleva el canal con el nombre que usa la ciudad pedida
+            snprintf(pub->record.channel, sizeof(pub->record.channel), "%s", channel->channel);
+            result = 0;
+        } else {
+            psd_publication_free(&entry->pub);
+        }
+        memset(entry, 0, sizeof(*entry));
+        break;
+    }
+    pthread_mutex_unlock(&tdt_cache_lock);
+    return result;
+}
+
+static void tdt_cache_clear(void)
+{
+    pthread_mutex_lock(&tdt_cache_lock);
+    for (int i = 0; i < MAX_TDT_CHANNELS; i++) {
+        if (tdt_cache[i].valid) {
+            psd_publication_free(&tdt_cache[i].pub);
+        }
+        memset(&tdt_cache[i], 0, sizeof(tdt_cache[i]));
+    }
+    pthread_mutex_unlock(&tdt_cache_lock);
+}
+
+/**
+ * @brief Mide con el DDC los canales TDT de la ciudad que caben en las capturas de una banda TDT.
+ *
+ * Cada canal sale de la captura (la sintonizada o la desplazada 2 MHz) cuyo
+ * centro queda más cerca, si está a ±`MEASURE_TDT_WIDE_MAX_OFFSET_MHZ`. Las
+ * mediciones quedan en el caché para `measurement_submit_tdt_city`; un fallo
+ * aquí no afecta a la medición RMER.
+ */
+static void tdt_tile_derive(measurement_job_t* job)
+{
+    const band_info_t* info = band_registry_get(job->bands);
+    if (info == NULL || strcmp(info->service, "TDT") != 0) {
+        return;
+    }
+    char city[TDT_CITY_NAME_MAX];
+    pthread_mutex_lock(&tdt_cache_lock);
+    snprintf(city, sizeof(city), "%s", tdt_city);
+    pthread_mutex_unlock(&tdt_cache_lock);
+    if (city[0] == '\0') {
+        return;
+    }
+
+    tdt_channel_t channels[MAX_TDT_CHANNELS];
+    int n = load_city_tdt(city, channels, MAX_TDT_CHANNELS);
+    const double max_offset_hz = MEASURE_TDT_WIDE_MAX_OFFSET_MHZ * 1e6;
+    for (int i = 0; i < n; i++) {
+        double freq_hz = (double)channels[i].freq_mhz * 1e6;
+        double offset_0 = freq_hz - (double)job->central_freq;
+        double offset_1 = offset_0 - SECOND_SAMPLE_OFFSET_HZ;
+        const cs8_map_t* capture = (fabs(offset_1) < fabs(offset_0)) ? &job->rmer.capture_1 : &job->rmer.capture_0;
+        double offset_hz = (capture == &job->rmer.capture_1) ? offset_1 : offset_0;
+        if (fabs(offset_hz) > max_offset_hz) {
+            continue;
+        }
+
+        size_t n_iq = 0;
+        complex double* iq = ddc_extract_cs8(capture->data, capture->num_samples, DEFAULT_SAMPLE_RATE_HZ, offset_hz,
+                                             DDC_TDT_INTERP, DDC_TDT_DECIM, &n_iq);
+        if (iq == NULL) {
+            continue;
+        }
+        psd_publication_t pub = {0};
+        if (parameter_tdt_compute_iq(channels[i].modulation, (uint64_t)channels[i].freq_mhz * 1000000, iq, n_iq,
+                                     channels[i].channel, &pub) == 0) {
+            tdt_cache_store(&channels[i], job->rmer.rawtime, &pub);
+            printf("TDT channel %s derived from band capture\r\n", channels[i].channel);
+        }
+        psd_publication_free(&pub);
+        free(iq);
+    }
+}
+
+/**
+ * @brief Une los tramos del barrido en el panorama y libera sus acumuladores.
+ */
+static int sweep_psd(measurement_job_t* job)
+{
+    job->panorama_bins = sweep_bins(&job->sweep);
+    job->panorama_f = (double*)malloc((size_t)job->panorama_bins * sizeof(double));
+    job->panorama_p = (double*)malloc((size_t)job->panorama_bins * sizeof(double));
+    if (job->panorama_f == NULL || job->panorama_p == NULL) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return -1;
+    }
+    int result = sweep_panorama(&job->sweep, job->panorama_f, job->panorama_p);
+    sweep_free(&job->sweep);
+    return result;
+}
+
+static int stage_psd(void* arg)
+{
+    measurement_job_t* job = (measurement_job_t*)arg;
+    if (job->kind == MEASURE_SWEEP) {
+        return sweep_psd(job);
+    }
+    if (job->kind != MEASURE_RMER) {
+        return 0;
+    }
+    // Las capturas siguen mapeadas sólo hasta que termina la PSD
+    tdt_tile_derive(job);
+    return parameter_psd(&job->rmer);
+}
+
+/**
+ * @brief Extrae cada canal de la captura de banda ancha con el DDC y lo mide como una captura TDT.
+ */
+static int tdt_wide_compute(measurement_job_t* job)
+{
+    char path[20];
+    snprintf(path, sizeof(path), "Samples/%d", job->slot);
+    cs8_map_t capture;
+    if (cs8_map_open(&capture, path) != 0) {
+        return -1;
+    }
+    remove(path);
+
+    int result = 0;
+    for (int i = 0; i < job->n_tdt && result == 0; i++) {
+        uint64_t freq_hz = (uint64_t)job->tdt[i].freq_mhz * 1000000;
+        double offset_hz = (double)freq_hz - (double)job->central_freq;
+        size_t n = 0;
+        complex double* iq = ddc_extract_cs8(capture.data, capture.num_samples, DEFAULT_SAMPLE_RATE_HZ, offset_hz,
+                                             DDC_TDT_INTERP, DDC_TDT_DECIM, &n);
+        if (iq == NULL) {
+            result = -1;
+            break;
+        }
+        result = parameter_tdt_compute_iq(job->tdt[i].modulation, freq_hz, iq, n, job->tdt[i].channel, &job->tdt_pub[i]);
+        free(iq);
+    }
+    cs8_map_close(&capture);
+    return result;
+}
+
+/**
+ * @brief Calcula cada banda del barrido como una medición RMER sobre su cobertura del panorama.
+ *
+ * El panorama tiene el paso de una PSD de `MEASURE_SWEEP_NPERSEG` puntos a
+ * 20 MS/s, así que cada cobertura de 20 MHz son justo esos bins. El pico de
+ * DC de cada salto ya se corrigió en `sweep_panorama`.
+ */
+static int sweep_compute(measurement_job_t* job)
+{
+    job->tile_rmer = (rmer_job_t*)calloc((size_t)job->n_tiles, sizeof(rmer_job_t));
+    if (job->tile_rmer == NULL) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return -1;
+    }
+
+    double df = DEFAULT_SAMPLE_RATE_HZ / MEASURE_SWEEP_NPERSEG;
+    char timer0[17];
+    strftime(timer0, sizeof(timer0), "%Y-%m-%dT%H:%M", localtime(&job->rawtime));
+
+    for (int t = 0; t < job->n_tiles; t++) {
+        const band_info_t* info = job->tiles[t];
+        rmer_job_t* rmer = &job->tile_rmer[t];
+        long first = lround((info->tile_lo_mhz * 1e6 - job->panorama_f[0]) / df);
+        if (first < 0 || first + MEASURE_SWEEP_NPERSEG > job->panorama_bins) {
+            fprintf(stderr, "Error: band %s outside the sweep\n", info->name);
+            return -1;
+        }
+
+        char Flow[13];
+        char Fhigh[13];
+        snprintf(Flow, sizeof(Flow), "%g", info->tile_lo_mhz);
+        snprintf(Fhigh, sizeof(Fhigh), "%g", info->tile_hi_mhz);
+        uint64_t center = (uint64_t)((info->tile_lo_mhz + BAND_TILE_SPAN_MHZ / 2.0) * 1e6);
+        if (parameter_job_init(rmer, job->threshold, info->frequency, info->bandwidth, info->n_channels,
+                               center, 0, job->banda, Flow, Fhigh) != 0) {
+            return -1;
+        }
+        rmer->rawtime = job->rawtime;
+        snprintf(rmer->timer0, sizeof(rmer->timer0), "%s", timer0);
+        rmer->integrated = atomic_load(&integrated_power);
+        rmer->window = job->window;
+        rmer->dc_free = true;
+        if (spectrum_alloc(&rmer->Pxx, MEASURE_SWEEP_NPERSEG, DEFAULT_SAMPLE_RATE_HZ, (double)center) != 0 ||
+            spectrum_alloc(&rmer->Pxx1, MEASURE_SWEEP_NPERSEG, DEFAULT_SAMPLE_RATE_HZ, (double)center) != 0) {
+            return -1;
+        }
+        memcpy(rmer->Pxx.p, job->panorama_p + first, MEASURE_SWEEP_NPERSEG * sizeof(double));
+        memcpy(rmer->Pxx1.p, job->panorama_p + first, MEASURE_SWEEP_NPERSEG * sizeof(double));
+        if (parameter_compute(rmer) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int stage_parameters(void* arg)
+{
+    measurement_job_t* job = (measurement_job_t*)arg;
+    switch (job->kind) {
+        case MEASURE_RMER:
+            return parameter_compute(&job->rmer);
+        case MEASURE_RNI:
+            return parameter_rni_compute(job->threshold, job->canalization, job->bandwidth, job->canalization_length,
+                                         job->central_freq, job->slot, job->banda, job->Flow, job->Fhigh, job->window, &job->pub);
+        case MEASURE_TDT:
+            return parameter_tdt_compute(job->modulation, job->central_freq, job->slot, job->channel, &job->pub);
+        case MEASURE_TDT_WIDE:
+            return tdt_wide_compute(job);
+        case MEASURE_TDT_CACHED:
+            return 0;
+        case MEASURE_SWEEP:
+            return sweep_compute(job);
+    }
+    return -1;
+}
+
+static int stage_publish(void* arg)
+{
+    measurement_job_t* job = (measurement_job_t*)arg;
+    if (job->kind == MEASURE_TDT_WIDE) {
+        for (int i = 0; i < job->n_tdt; i++) {
+            char path[20];
+            snprintf(path, sizeof(path), MEASURE_JSON_CHANNEL_FILE, i);
+            if (parameter_publish(&job->tdt_pub[i], server, path) != 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+    if (job->kind == MEASURE_SWEEP) {
+        for (int t = 0; t < job->n_tiles; t++) {
+            char path[32];
+            snprintf(path, sizeof(path), MEASURE_JSON_TILE_FILE, t);
+            if (parameter_publish(&job->tile_rmer[t].pub, server, path) != 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+    if (job->kind == MEASURE_TDT_CACHED) {
+        for (int i = 0; i < job->n_cached; i++) {
+            char path[20];
+            snprintf(path, sizeof(path), MEASURE_JSON_CHANNEL_FILE, i);
+            if (parameter_publish(&job->cached[i], server, path) != 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+    return parameter_publish(job_publication(job), server, MEASURE_JSON_FILE);
+}
+
+static void job_free(measurement_job_t* job)
+{
+    parameter_job_free(&job->rmer);
+    psd_publication_free(&job->pub);
+    for (int i = 0; i < job->n_tdt; i++) {
+        psd_publication_free(&job->tdt_pub[i]);
+    }
+    for (int i = 0; i < job->n_cached; i++) {
+        psd_publication_free(&job->cached[i]);
+    }
+    free(job->cached);
+    if (job->tile_rmer != NULL) {
+        for (int t = 0; t < job->n_tiles; t++) {
+            parameter_job_free(&job->tile_rmer[t]);
+        }
+        free(job->tile_rmer);
+    }
+    sweep_free(&job->sweep);
+    free(job->panorama_f);
+    free(job->panorama_p);
+    free(job->canalization);
+    free(job->bandwidth);
+    free(job);
+}
+
+static void job_done(void* arg, int status)
+{
+    measurement_job_t* job = (measurement_job_t*)arg;
+
+    if (status != 0) {
+        fprintf(stderr, "Measurement %u failed\n", job->seq);
+        // Si falló antes de cargarse, las capturas siguen en disco
+        char path[20];
+        snprintf(path, sizeof(path), "Samples/%d", job->slot);
+        remove(path);
+        snprintf(path, sizeof(path), "Samples/%d", job->slot + 1);
+        remove(path);
+    } else {
+        printf("Measurement %u published\r\n", job->seq);
+    }
+    job_free(job);
+    // Una escritura por medición y sólo si se planificaron tamaños nuevos
+    fft_plan_save_wisdom();
+    if ((atomic_fetch_add(&jobs_finished, 1) + 1) % MEASURE_REPORT_INTERVAL == 0) {
+        pipeline_report(&pipeline);
+    }
+}
+
+int measurement_init(st_server* s_server)
+{
+    server = s_server;
+    pipeline_init(&pipeline, job_done);
+    if (pipeline_add_stage(&pipeline, "capture", stage_capture) != 0 ||
+        pipeline_add_stage(&pipeline, "load", stage_load) != 0 ||
+        pipeline_add_stage(&pipeline, "psd", stage_psd) != 0 ||
+        pipeline_add_stage(&pipeline, "parameters", stage_parameters) != 0 ||
+        pipeline_add_stage(&pipeline, "publish", stage_publish) != 0) {
+        pipeline_stop(&pipeline);
+        return -1;
+    }
+    if (pipeline_start(&pipeline) != 0) {
+        pipeline_stop(&pipeline);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Interpreta el valor de una variable de entorno de encendido/apagado.
+ *
+ * @return 0 si el valor es válido (queda en `enabled`), -1 si no.
+ */
+static int parse_switch(const char* name, const char* value, bool* enabled)
+{
+    if (strcmp(value, "1") == 0 || strcmp(value, "on") == 0 || strcmp(value, "true") == 0) {
+        *enabled = true;
+        return 0;
+    }
+    if (strcmp(value, "0") == 0 || strcmp(value, "off") == 0 || strcmp(value, "false") == 0) {
+        *enabled = false;
+        return 0;
+    }
+    fprintf(stderr, "Error: invalid value %s=%s (expected 1/0, on/off or true/false)\n", name, value);
+    return -1;
+}
+
+int measurement_configure_from_env(void)
+{
+    int result = 0;
+
+    const char* window_env = getenv(MEASURE_WINDOW_ENV);
+    if (window_env != NULL) {
+        window_type_t window;
+        if (window_from_name(window_env, &window) == 0) {
+            measurement_set_window(window);
+        } else {
+            fprintf(stderr, "Error: unknown window %s=%s\n", MEASURE_WINDOW_ENV, window_env);
+            result = -1;
+        }
+    }
+
+    const char* adaptive_env = getenv(MEASURE_ADAPTIVE_ENV);
+    if (adaptive_env != NULL) {
+        bool enabled;
+        if (parse_switch(MEASURE_ADAPTIVE_ENV, adaptive_env, &enabled) == 0) {
+            measurement_set_adaptive(enabled);
+        } else {
+            result = -1;
+        }
+    }
+
+    const char* integrated_env = getenv(MEASURE_INTEGRATED_POWER_ENV);
+    if (integrated_env != NULL) {
+        bool enabled;
+        if (parse_switch(MEASURE_INTEGRATED_POWER_ENV, integrated_env, &enabled) == 0) {
+            measurement_set_integrated_power(enabled);
+        } else {
+            result = -1;
+        }
+    }
+
+    const char* city_env = getenv(MEASURE_TDT_CITY_ENV);
+    if (city_env != NULL) {
+        measurement_set_tdt_city(city_env);
+    }
+    return result;
+}
+
+void measurement_set_window(window_type_t window)
+{
+    atomic_store(&psd_window, (int)window);
+}
+
+void measurement_set_adaptive(bool enabled)
+{
+    atomic_store(&adaptive_capture, enabled);
+}
+
+void measurement_set_integrated_power(bool enabled)
+{
+    atomic_store(&integrated_power, enabled);
+}
+
+void measurement_set_tdt_city(const char* city)
+{
+    pthread_mutex_lock(&tdt_cache_lock);
+    snprintf(tdt_city, sizeof(tdt_city), "%s", (city != NULL) ? city : "");
+    pthread_mutex_unlock(&tdt_cache_lock);
+}
+
+/**
+ * @brief Reserva un trabajo con su número de orden y sus archivos de captura.
+ */
+static measurement_job_t* job_new(measurement_kind_t kind)
+{
+    measurement_job_t* job = (measurement_job_t*)calloc(1, sizeof(measurement_job_t));
+    if (job == NULL) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return NULL;
+    }
+    job->kind = kind;
+    job->seq = next_seq++;
+    job->window = (window_type_t)atomic_load(&psd_window);
+    // Samples/0 es la salida de getSamples; cada trabajo en vuelo tiene su par 2..127
+    job->slot = (uint8_t)(2 * (1 + job->seq % 63));
+    return job;
+}
+
+static int job_set_channels(measurement_job_t* job, uint8_t bands, int threshold, const double* canalization, const double* bandwidth,
+                            int canalization_length, const char* banda, const char* Flow, const char* Fhigh)
+{
+    job->bands = bands;
+    job->threshold = threshold;
+    job->canalization_length = canalization_length;
+    snprintf(job->banda, sizeof(job->banda), "%s", banda);
+    snprintf(job->Flow, sizeof(job->Flow), "%s", Flow);
+    snprintf(job->Fhigh, sizeof(job->Fhigh), "%s", Fhigh);
+
+    job->canalization = (double*)malloc((size_t)canalization_length * sizeof(double));
+    job->bandwidth = (double*)malloc((size_t)canalization_length * sizeof(double));
+    if (job->canalization == NULL || job->bandwidth == NULL) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return -1;
+    }
+    memcpy(job->canalization, canalization, (size_t)canalization_length * sizeof(double));
+    memcpy(job->bandwidth, bandwidth, (size_t)canalization_length * sizeof(double));
+    return 0;
+}
+
+static int job_submit(measurement_job_t* job)
+{
+    if (pipeline_submit(&pipeline, job) != 0) {
+        fprintf(stderr, "Error: measurement pipeline not running\n");
+        job_free(job);
+        return -1;
+    }
+    return 0;
+}
+
+int measurement_submit_rmer(uint8_t bands, int threshold, const double* canalization, const double* bandwidth, int canalization_length, const char* banda, const char* Flow, const char* Fhigh)
+{
+    measurement_job_t* job = job_new(MEASURE_RMER);
+    if (job == NULL) {
+        return -1;
+    }
+    if (job_set_channels(job, bands, threshold, canalization, bandwidth, canalization_length, banda, Flow, Fhigh) != 0) {
+        job_free(job);
+        return -1;
+    }
+    return job_submit(job);
+}
+
+int measurement_submit_sweep(int threshold, const char* banda, const char* Flow, const char* Fhigh)
+{
+    measurement_job_t* job = job_new(MEASURE_SWEEP);
+    if (job == NULL) {
+        return -1;
+    }
+    job->threshold = threshold;
+    snprintf(job->banda, sizeof(job->banda), "%s", banda);
+    snprintf(job->Flow, sizeof(job->Flow), "%s", Flow);
+    snprintf(job->Fhigh, sizeof(job->Fhigh), "%s", Fhigh);
+
+    job->n_tiles = band_registry_tiles(banda, atof(Flow), atof(Fhigh), job->tiles, BAND_REGISTRY_SIZE);
+    if (job->n_tiles == 0) {
+        fprintf(stderr, "Error: no %s band between %s and %s MHz\n", banda, Flow, Fhigh);
+        job_free(job);
+        return -1;
+    }
+
+    // Las coberturas empiezan en MHz enteros; el barrido las cubre completas
+    uint64_t lo_hz = (uint64_t)job->tiles[0]->tile_lo_mhz * 1000000;
+    uint64_t hi_hz = 0;
+    for (int t = 0; t < job->n_tiles; t++) {
+        uint64_t tile_hi_hz = (uint64_t)job->tiles[t]->tile_hi_mhz * 1000000;
+        if (tile_hi_hz > hi_hz) {
+            hi_hz = tile_hi_hz;
+        }
+    }
+    if (sweep_init(&job->sweep, lo_hz, hi_hz, MEASURE_SWEEP_NPERSEG, 0.5, MEASURE_SWEEP_PASSES, job->window) != 0) {
+        job_free(job);
+        return -1;
+    }
+    return job_submit(job);
+}
+
+int measurement_submit_rni(uint8_t bands, int threshold, const double* canalization, const double* bandwidth, int canalization_length, const char* banda, const char* Flow, const char* Fhigh)
+{
+    measurement_job_t* job = job_new(MEASURE_RNI);
+    if (job == NULL) {
+        return -1;
+    }
+    if (job_set_channels(job, bands, threshold, canalization, bandwidth, canalization_length, banda, Flow, Fhigh) != 0) {
+        job_free(job);
+        return -1;
+    }
+    return job_submit(job);
+}
+
+int measurement_submit_tdt(int modulation, uint16_t central_freq_mhz, const char* channel)
+{
+    measurement_job_t* job = job_new(MEASURE_TDT);
+    if (job == NULL) {
+        return -1;
+    }
+    job->modulation = modulation;
+    job->tdt_freq_mhz = central_freq_mhz;
+    snprintf(job->channel, sizeof(job->channel), "%s", channel);
+    return job_submit(job);
+}
+
+static int compare_tdt_freq(const void* a, const void* b)
+{
+    const tdt_channel_t* x = (const tdt_channel_t*)a;
+    const tdt_channel_t* y = (const tdt_channel_t*)b;
+    return (x->freq_mhz > y->freq_mhz) - (x->freq_mhz < y->freq_mhz);
+}
+
+int measurement_submit_tdt_city(const char* city)
+{
+    tdt_channel_t channels[MAX_TDT_CHANNELS];
+    int n = load_city_tdt(city, channels, MAX_TDT_CHANNELS);
+    if (n == 0) {
+        return -1;
+    }
+    measurement_set_tdt_city(city);
+
+    // Los canales que ya salieron de una captura UHF2 reciente se publican sin volver a capturar
+    measurement_job_t* cached = job_new(MEASURE_TDT_CACHED);
+    if (cached == NULL) {
+        return -1;
+    }
+    cached->cached = (psd_publication_t*)calloc((size_t)n, sizeof(psd_publication_t));
+    if (cached->cached == NULL) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        job_free(cached);
+        return -1;
+    }
+    int pending = 0;
+    for (int i = 0; i < n; i++) {
+        if (tdt_cache_take(&channels[i], &cached->cached[cached->n_cached]) == 0) {
+            cached->n_cached++;
+        } else {
+            channels[pending++] = channels[i];
+        }
+    }
+    n = pending;
+
+    int result = 0;
+    if (cached->n_cached > 0) {
+        result |= job_submit(cached);
+    } else {
+        job_free(cached);
+    }
+
+    qsort(channels, (size_t)n, sizeof(tdt_channel_t), compare_tdt_freq);
+    for (int i = 0; i < n; ) {
+        // Canales vecinos a ambos lados de una misma sintonía; el pico de continua queda entre ellos
+        uint16_t center = (i + 1 < n) ? (uint16_t)((channels[i].freq_mhz + channels[i + 1].freq_mhz) / 2) : 0;
+        if (i + 1 < n && center - channels[i].freq_mhz <= MEASURE_TDT_WIDE_MAX_OFFSET_MHZ &&
+            channels[i + 1].freq_mhz - center <= MEASURE_TDT_WIDE_MAX_OFFSET_MHZ) {
+            measurement_job_t* job = job_new(MEASURE_TDT_WIDE);
+            if (job == NULL) {
+                return -1;
+            }
+            job->tdt_freq_mhz = center;
+            job->n_tdt = MEASURE_TDT_WIDE_CHANNELS;
+            memcpy(job->tdt, &channels[i], MEASURE_TDT_WIDE_CHANNELS * sizeof(tdt_channel_t));
+            result |= job_submit(job);
+            i += MEASURE_TDT_WIDE_CHANNELS;
+        } else {
+            result |= measurement_submit_tdt(channels[i].modulation, channels[i].freq_mhz, channels[i].channel);
+            i++;
+        }
+    }
+    return result;
+}
+
+void measurement_shutdown(void)
+{
+    pipeline_wait_idle(&pipeline);
+    pipeline_report(&pipeline);
+    pipeline_stop(&pipeline);
+    tdt_cache_clear();
+    fft_plan_cleanup();
+}
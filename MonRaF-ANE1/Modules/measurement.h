@@ -0,0 +1,282 @@
+/**
+ * @file measurement.h
+ * @brief Mediciones RMER, RNI y TDT repartidas en una tubería de etapas.
+ *
+ * Cada medición pasa por captura → carga → PSD → parámetros → publicación,
+ * cada etapa en su propio hilo (`pipeline.h`). Mientras se analiza la
+ * medición N el HackRF ya puede estar capturando la N+1. Cada trabajo usa su
+ * propio par de archivos en `Samples/`, así que las capturas en vuelo no se
+ * pisan; la publicación escribe `JSON/0` (o `JSON/tdt_<canal>` en TDT de
+ * banda ancha) y el aviso al cliente nombra el archivo.
+ *
+ * Una petición RMER que abarca varias bandas (`measurement_submit_sweep`) se
+ * mide con un solo barrido (`sweep.h`): la radio salta por todo el intervalo
+ * sin detenerse y cada banda se publica desde el panorama unido.
+ *
+ * En modo adaptativo (`measurement_set_adaptive`, opcional) las capturas RMER/RNI
+ * terminan en cuanto la potencia de los canales de la banda converge, en lugar
+ * de tomar siempre `MEASURE_SAMPLES_TO_XFER` muestras.
+ *
+ * Las mediciones TDT de toda una ciudad (`measurement_submit_tdt_city`)
+ * capturan a 20 MS/s entre dos canales vecinos y derivan ambos con el DDC
+ * (`ddc.h`), con una sola sintonía por cada par. Antes, los canales que ya
+ * cubrió la captura de una banda TDT (UHF2) reciente se sacan de ella con el
+ * mismo DDC mientras se calcula su PSD, y se publican sin volver a capturar.
+ */
+
+#ifndef MEASUREMENT_H
+#define MEASUREMENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pipeline.h"
+#include "IQ.h"
+#include "window.h"
+#include "../Drivers/bacn_RTI.h"
+
+/**
+ * @def MEASURE_SAMPLES_TO_XFER
+ * @brief Muestras por captura RMER/RNI (1 s a 20 MS/s).
+ */
+#define MEASURE_SAMPLES_TO_XFER (20000000)
+
+/**
+ * @def MEASURE_ADAPTIVE_MIN_SAMPLES
+ * @brief Muestras mínimas de una captura adaptativa (0.1 s a 20 MS/s).
+ */
+#define MEASURE_ADAPTIVE_MIN_SAMPLES (2000000)
+
+/**
+ * @def MEASURE_ADAPTIVE_CI
+ * @brief Semiancho relativo con el que converge la potencia de canal (±0.1 dB al 95 %).
+ */
+#define MEASURE_ADAPTIVE_CI (0.023)
+
+/**
+ * @def MEASURE_ADAPTIVE_NPERSEG
+ * @brief Segmento de la PSD que vigila la convergencia durante la captura.
+ */
+#define MEASURE_ADAPTIVE_NPERSEG (4096)
+
+/**
+ * @def MEASURE_SWEEP_NPERSEG
+ * @brief Segmento de Welch de un barrido: cada banda sale del panorama con los
+ * 4096 bins de la PSD que publica una medición RMER.
+ */
+#define MEASURE_SWEEP_NPERSEG (4096)
+
+/**
+ * @def MEASURE_SWEEP_PASSES
+ * @brief Pasadas completas que promedia un barrido.
+ */
+#define MEASURE_SWEEP_PASSES (20)
+
+/**
+ * @def MEASURE_TDT_WIDE_CHANNELS
+ * @brief Canales TDT que se derivan de una captura de banda ancha.
+ */
+#define MEASURE_TDT_WIDE_CHANNELS (2)
+
+/**
+ * @def MEASURE_TDT_WIDE_MAX_OFFSET_MHZ
+ * @brief Separación máxima entre la sintonía y un canal derivado: con 3 MHz de
+ * semiancho el canal queda dentro de ±7 MHz, donde el filtro de banda base del
+ * HackRF a 20 MS/s aún es plano.
+ */
+#define MEASURE_TDT_WIDE_MAX_OFFSET_MHZ (4)
+
+/**
+ * @def MEASURE_TDT_REUSE_MAX_AGE_S
+ * @brief Antigüedad máxima (s) de un canal TDT derivado de una captura UHF2 para publicarlo sin capturar.
+ */
+#define MEASURE_TDT_REUSE_MAX_AGE_S (300)
+
+/**
+ * @def MEASURE_TDT_ALL_CHANNELS
+ * @brief Canal con el que el servidor pide medir todos los canales TDT de la ciudad.
+ */
+#define MEASURE_TDT_ALL_CHANNELS "all"
+
+/**
+ * @def MEASURE_JSON_FILE
+ * @brief JSON que lee `Socket/client.js`.
+ */
+#define MEASURE_JSON_FILE "JSON/0"
+
+/**
+ * @def MEASURE_JSON_CHANNEL_FILE
+ * @brief JSON de cada canal de una medición TDT de varios canales (`%d`: posición del canal en la medición).
+ *
+ * Los canales se publican uno tras otro; cada uno en su archivo para que el
+ * cliente, que lee el JSON después de recibir el aviso, no lea el segundo
+ * en lugar del primero. El prefijo `tdt_` los separa de `MEASURE_JSON_FILE`,
+ * que usan las demás mediciones.
+ */
+#define MEASURE_JSON_CHANNEL_FILE "JSON/tdt_%d"
+
+/**
+ * @def MEASURE_JSON_TILE_FILE
+ * @brief JSON de cada banda de un barrido (`%d`: posición de la banda en el barrido).
+ */
+#define MEASURE_JSON_TILE_FILE "JSON/tile_%d"
+
+/**
+ * @def MEASURE_WINDOW_ENV
+ * @brief Variable de entorno con la ventana de Welch de RMER/RNI (`window_name`: "hann", ...).
+ */
+#define MEASURE_WINDOW_ENV "MONRAF_WINDOW"
+
+/**
+ * @def MEASURE_ADAPTIVE_ENV
+ * @brief Variable de entorno que activa la captura adaptativa ("1"/"on"/"true" o "0"/"off"/"false").
+ */
+#define MEASURE_ADAPTIVE_ENV "MONRAF_ADAPTIVE"
+
+/**
+ * @def MEASURE_INTEGRATED_POWER_ENV
+ * @brief Variable de entorno que activa la potencia integrada por canal en RMER (mismos valores que `MEASURE_ADAPTIVE_ENV`).
+ */
+#define MEASURE_INTEGRATED_POWER_ENV "MONRAF_INTEGRATED_POWER"
+
+/**
+ * @def MEASURE_TDT_CITY_ENV
+ * @brief Variable de entorno con la ciudad de la estación (`measurement_set_tdt_city`).
+ */
+#define MEASURE_TDT_CITY_ENV "MONRAF_TDT_CITY"
+
+/**
+ * @def MEASURE_REPORT_INTERVAL
+ * @brief Mediciones terminadas entre dos informes de tiempos por etapa.
+ */
+#define MEASURE_REPORT_INTERVAL (32)
+
+/**
+ * @brief Arranca la tubería de mediciones.
+ *
+ * @param s_server Servidor al que se avisa cada publicación.
+ *
+ * @return 0 si arrancó, -1 en caso de error.
+ */
+int measurement_init(st_server* s_server);
+
+/**
+ * @brief Aplica la configuración de las variables de entorno `MEASURE_*_ENV`.
+ *
+ * Las variables ausentes dejan el valor por defecto; un valor inválido se
+ * informa y también lo deja.
+ *
+ * @return 0 si todas las variables presentes eran válidas, -1 en caso contrario.
+ */
+int measurement_configure_from_env(void);
+
+/**
+ * @brief Ventana de Welch de las PSD RMER/RNI (por defecto `WINDOW_HAMMING`).
+ *
+ * Afecta a las mediciones que se encolen después de la llamada.
+ */
+void measurement_set_window(window_type_t window);
+
+/**
+ * @brief Activa o desactiva la longitud adaptativa de las capturas RMER/RNI.
+ *
+ * Desactivada por defecto (`MEASURE_ADAPTIVE_ENV` la activa): una captura
+ * adaptativa es más corta, así que la mediana y el máximo por canal se
+ * estiman con menos segmentos y varían más entre mediciones.
+ *
+ * Afecta a las capturas que empiecen después de la llamada. El máximo sigue
+ * siendo `MEASURE_SAMPLES_TO_XFER`; TDT siempre usa su longitud fija.
+ */
+void measurement_set_adaptive(bool enabled);
+
+/**
+ * @brief Activa o desactiva la potencia integrada y el ancho de banda ocupado por canal en RMER.
+ *
+ * Desactivada por defecto (`MEASURE_INTEGRATED_POWER_ENV` la activa). Con el
+ * modo activo cada canal publica además `channel_power`, `obw` y `bw_xdb`
+ * (`PSD_RMER_INTEGRATED_COLS`). Afecta a las mediciones que se carguen
+ * después de la llamada.
+ */
+void measurement_set_integrated_power(bool enabled);
+
+/**
+ * @brief Ciudad cuyos canales TDT se derivan de las capturas RMER de las bandas TDT.
+ *
+ * Sin ciudad (por defecto, salvo `MEASURE_TDT_CITY_ENV`) no se deriva nada.
+ * `measurement_submit_tdt_city` también la fija. Afecta a las mediciones cuya
+ * PSD se calcule después de la llamada.
+ *
+ * @param city Ciudad (`Ciudades/<city>.csv`), o NULL o "" para no derivar.
+ */
+void measurement_set_tdt_city(const char* city);
+
+/**
+ * @brief Encola una medición RMER (dos capturas desplazadas 2 MHz).
+ *
+ * La canalización se copia: el llamador puede reutilizar sus arreglos al volver.
+ * Espera si la tubería está llena. Si la banda es del servicio TDT, los canales
+ * de la ciudad (`measurement_set_tdt_city`) que caben en sus capturas se miden
+ * también y quedan para `measurement_submit_tdt_city`.
+ *
+ * @return 0 si se encoló, -1 en caso de error.
+ */
+int measurement_submit_rmer(uint8_t bands, int threshold, const double* canalization, const double* bandwidth, int canalization_length, const char* banda, const char* Flow, const char* Fhigh);
+
+/**
+ * @brief Encola una medición RMER de todas las bandas de un servicio entre `Flow` y `Fhigh`, con un solo barrido.
+ *
+ * Las bandas se toman del registro (`band_registry_tiles`) y el barrido cubre
+ * sus coberturas completas. Cada banda se publica por separado con su
+ * canalización y la PSD de su cobertura (`MEASURE_JSON_TILE_FILE`). Como no
+ * quedan capturas IQ, no se derivan canales TDT ni se aplica el modo
+ * adaptativo. Espera si la tubería está llena.
+ *
+ * @param threshold Umbral de presencia en dB.
+ * @param banda Servicio ("VHF", "UHF", "TDT", "SHF"), también para el registro.
+ * @param Flow Frecuencia inferior en MHz, como texto.
+ * @param Fhigh Frecuencia superior en MHz, como texto.
+ *
+ * @return 0 si se encoló, -1 en caso de error (p. ej. ninguna banda en el intervalo).
+ */
+int measurement_submit_sweep(int threshold, const char* banda, const char* Flow, const char* Fhigh);
+
+/**
+ * @brief Encola una medición RNI.
+ *
+ * @return 0 si se encoló, -1 en caso de error.
+ */
+int measurement_submit_rni(uint8_t bands, int threshold, const double* canalization, const double* bandwidth, int canalization_length, const char* banda, const char* Flow, const char* Fhigh);
+
+/**
+ * @brief Encola una medición TDT.
+ *
+ * @param modulation Orden de la modulación (16 o 64).
+ * @param central_freq_mhz Frecuencia central del canal en MHz.
+ * @param channel Canal para el registro.
+ *
+ * @return 0 si se encoló, -1 en caso de error.
+ */
+int measurement_submit_tdt(int modulation, uint16_t central_freq_mhz, const char* channel);
+
+/**
+ * @brief Encola la medición de todos los canales TDT de una ciudad.
+ *
+ * Los canales medidos en los últimos `MEASURE_TDT_REUSE_MAX_AGE_S` segundos
+ * desde la captura de una banda TDT (`measurement_submit_rmer`) se publican
+ * de ella, juntos y sin capturar. Del resto, se ordenan por frecuencia y se agrupan de a dos cuando caben a
+ * ±`MEASURE_TDT_WIDE_MAX_OFFSET_MHZ` de una misma sintonía; cada par sale de
+ * una sola captura de banda ancha. Los que quedan sueltos se miden como
+ * `measurement_submit_tdt`. Cada canal se publica por separado.
+ *
+ * @param city Ciudad (`Ciudades/<city>.csv`).
+ *
+ * @return 0 si se encolaron todas, -1 en caso de error.
+ */
+int measurement_submit_tdt_city(const char* city);
+
+/**
+ * @brief Termina las mediciones pendientes, imprime los tiempos por etapa, detiene la tubería
+ * y guarda el wisdom FFT pendiente.
+ */
+void measurement_shutdown(void);
+
+#endif // MEASUREMENT_H
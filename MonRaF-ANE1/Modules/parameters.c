@@ -16,9 +16,15 @@
 #include <unistd.h>
 #include "IQ.h"
 #include "cs8_to_iq.h"
+#include "cs8_map.h"
 #include "welch.h"
-#include "cJSON.h"
-#include "find_closest_index.h"
+#include "psd_archive.h"
+#include "parameters.h"
+#include "channel_map.h"
+#include "channel_stats.h"
+#include "psd_integral.h"
+#include "spectrum.h"
+#include "bacn_RF.h"
 #include "save_to_file.h"
 #include "tdt_functions.h"
 #include "moda.h"
@@ -28,339 +34,184 @@
 extern bool program;
 
 double median(double* array, int start, int end) {
-    int length = end - start;
-    double* temp = (double*)malloc(length * sizeof(double));
-    if (temp == NULL) {
-        fprintf(stderr, "Memory allocation failed.\n");
-        exit(EXIT_FAILURE);
-    }
-    for (int i = 0; i < length; i++) {
-        temp[i] = array[start + i];
-    }
-    qsort(temp, length, sizeof(double), compare_doubles);
+    return channel_stats_median(array, start, end);
+}
 
-    double med;
-    if (length % 2 == 0) {
-        med = 0.5 * (temp[length / 2 - 1] + temp[length / 2]);
-    } else {
-        med = temp[length / 2];
+int parameter_job_init(rmer_job_t* job, int threshold, const double* canalization, const double* bandwidth, int canalization_length, uint64_t central_freq, uint8_t file_sample, const char* banda, const char* Flow, const char* Fhigh)
+{
+    memset(job, 0, sizeof(*job));
+    job->threshold = threshold;
+    job->canalization_length = canalization_length;
+    job->central_freq = central_freq;
+    job->file_sample = file_sample;
+    snprintf(job->banda, sizeof(job->banda), "%s", banda);
+    snprintf(job->Flow, sizeof(job->Flow), "%s", Flow);
+    snprintf(job->Fhigh, sizeof(job->Fhigh), "%s", Fhigh);
+
+    // Copia propia: mientras se analiza este trabajo ya se pueden cargar las bandas del siguiente
+    job->canalization = (double*)malloc((size_t)canalization_length * sizeof(double));
+    job->bandwidth = (double*)malloc((size_t)canalization_length * sizeof(double));
+    if (job->canalization == NULL || job->bandwidth == NULL) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        parameter_job_free(job);
+        return -1;
     }
-    free(temp);
-    return med;
+    memcpy(job->canalization, canalization, (size_t)canalization_length * sizeof(double));
+    memcpy(job->bandwidth, bandwidth, (size_t)canalization_length * sizeof(double));
+    return 0;
 }
 
-void parameter(st_server *s_server, int threshold, double* canalization, double* bandwidth, int canalization_length, uint64_t central_freq, uint8_t file_sample, char* banda, char* Flow, char* Fhigh) 
+int parameter_load(rmer_job_t* job)
 {
-    size_t num_samples;
-
     char file_sample_str_0[100];
-    sprintf(file_sample_str_0, "Samples/%d", file_sample);
+    sprintf(file_sample_str_0, "Samples/%d", job->file_sample);
 
-    uint8_t file_sample_two = file_sample +1 ;
+    uint8_t file_sample_two = job->file_sample +1 ;
 
     char file_sample_str_1[100];
     sprintf(file_sample_str_1, "Samples/%d", file_sample_two);
-    
-    
 
-    complex double* vector_IQ_0 = cargar_cs8(file_sample_str_0, &num_samples);
-    complex double* vector_IQ_1 = cargar_cs8(file_sample_str_1, &num_samples);
+    if (cs8_map_open(&job->capture_0, file_sample_str_0) != 0) {
+        return -1;
+    }
+    if (cs8_map_open(&job->capture_1, file_sample_str_1) != 0) {
+        cs8_map_close(&job->capture_0);
+        return -1;
+    }
+    job->mapped = true;
 
-    printf("Total samples: %lu\r\n", num_samples);
+    printf("Total samples: %lu\r\n", job->capture_1.num_samples);
     
-    delete_CS8(file_sample);
+    delete_CS8(job->file_sample);
     delete_CS8(file_sample_two);
-
-    delete_JSON(file_sample);
            
-    char timer0[17];
-    time_t rawtime;
-    struct tm * timeinfo;
-    time(&rawtime);
-    timeinfo = localtime(&rawtime);
-    strftime(timer0, sizeof(timer0), "%Y-%m-%dT%H:%M", timeinfo);
-
-    double* Pxx = NULL;
-    double* f = NULL;
-    double* Pxx1 = NULL;
-    double* f1 = NULL;
-
-    double* Pxx2 = NULL;
-    double* f2 = NULL;
-    double* Pxx12 = NULL;
-    double* f12 = NULL;
-
-    int nperseg = 32768;
-    int presence;
-    int N_f=nperseg;
-
-    size_t psd_size = nperseg;
-    size_t psd_size1 = 4096;
-
-    Pxx = (double*) malloc(psd_size * sizeof(double));
-    f = (double*) malloc(psd_size * sizeof(double));
-    Pxx1 = (double*) malloc(psd_size1 * sizeof(double));
-    f1 = (double*) malloc(psd_size1 * sizeof(double));
-
-    Pxx2 = (double*) malloc(psd_size * sizeof(double));
-    f2 = (double*) malloc(psd_size * sizeof(double));
-    Pxx12 = (double*) malloc(psd_size1 * sizeof(double));
-    f12 = (double*) malloc(psd_size1 * sizeof(double));
-    
-    welch_psd_complex(vector_IQ_0, num_samples, 20000000, nperseg, 0, f, Pxx);
-    welch_psd_complex(vector_IQ_0, num_samples, 20000000, 4096, 0, f1, Pxx1);
-    free(vector_IQ_0);
-
-    welch_psd_complex(vector_IQ_1, num_samples, 20000000, nperseg, 0, f2, Pxx2);
-    welch_psd_complex(vector_IQ_1, num_samples, 20000000, 4096, 0, f12, Pxx12);
-    free(vector_IQ_1);
-
-    //real_time();
-    if (nperseg % 2 != 0) {
-        printf("La longitud del vector debe ser par.\n");
-        return;
-    }
-    // -----------Acomodar potencias de welch-----------
-    int half = nperseg / 2;
-    int half1 = 2048;
-    double* temp = (double*)malloc(nperseg * sizeof(double));
-    double* temp1 = (double*)malloc(4096 * sizeof(double));
-
-    for (int i = 0; i < half; i++) {
-        temp[i] = Pxx[half + i];
-        
-    }
-
-    for (int i = 0; i < half1; i++) {
-        temp1[i] = Pxx1[half1 + i];
-        
-    }
-
-    for (int i = 0; i < half; i++) {
-        temp[half + i] = Pxx[i];
-    }
-    for (int i = 0; i < half1; i++) {
-        temp1[half1 + i] = Pxx1[i];
-    }
-
-    for (int i = 0; i < nperseg; i++) {
-        Pxx[i] = temp[i];
-    } 
-    for (int i = 0; i < 4096; i++) {
-        Pxx1[i] = temp1[i];
-    }
-
-    free(temp);
-    free(temp1);
-
-    // save_to_file(f, Pxx, nperseg, "data.csv");
-
-    for (int i = 0; i < N_f; i++) {
-        f[i] = (f[i] + central_freq) / 1e6;
-    }
-    for (int i = 0; i < 4096; i++) {
-        f1[i] = (f1[i] + central_freq) / 1e6;
-    }
-
-    int index = nperseg/2 ;
-    int count = nperseg*0.002;
-    int index1 = 2048 ;
-    int count1 = 4096*0.002;
-    int b=index-(count+13);
-    int a=index;
-
-    for (int i=0; i<count; i++)
-    {   
-        b=b-3;
-        Pxx[a]=Pxx[b];
-        a=a-1;
-        
-    }
-    a=index;
-    for (int i=0; i<count; i++)
-    {   
-        Pxx[i]=Pxx[b];
-        a=a+1;
-        b=b-2;
-        
-    }
-    a=index1;
-    b=index1-(count1+5);
-    for (int i=0; i<count1; i++)
-    {   
-        b=b-3;
-        Pxx1[a]=Pxx1[b];
-        a=a-1; 
-    }
-    a=index1;
-    b=index1-(count1+5);
-    for (int i=0; i<count; i++)
-    {   
-         
-        Pxx1[a]=Pxx1[b];
-        a=a+1;
-        b=b-2;
-        
-    }
+    time(&job->rawtime);
+    struct tm * timeinfo = localtime(&job->rawtime);
+    strftime(job->timer0, sizeof(job->timer0), "%Y-%m-%dT%H:%M", timeinfo);
+    return 0;
+}
 
-    //--------------------------Ordenar esto plox---------------------------
+int parameter_psd(rmer_job_t* job)
+{
+    int nperseg = RMER_NPERSEG;
+    double fs = 20000000;
+    double center = (double)job->central_freq;
+    double center_ref = center + SECOND_SAMPLE_OFFSET_HZ;
+
+    if (spectrum_alloc(&job->Pxx, nperseg, fs, center) != 0 ||
+        spectrum_alloc(&job->Pxx1, 4096, fs, center) != 0 ||
+        spectrum_alloc(&job->Pxx12, 4096, fs, center_ref) != 0) {
+        return -1;
+    }
+
+    // 32768 y 4096 puntos en una sola pasada por la primera captura; de la segunda sólo
+    // hace falta la PSD que se publica. Los ejes son los de los `spectrum_t`
+    welch_res_t res_0[2] = {
+        {.segment_length = nperseg, .P_welch_out = job->Pxx.p, .window = job->window},
+        {.segment_length = 4096, .P_welch_out = job->Pxx1.p, .window = job->window},
+    };
+    welch_psd_cs8_multi(job->capture_0.data, job->capture_0.num_samples, fs, 0, res_0, 2);
+
+    welch_res_t res_1[1] = {
+        {.segment_length = 4096, .P_welch_out = job->Pxx12.p, .window = job->window},
+    };
+    welch_psd_cs8_multi(job->capture_1.data, job->capture_1.num_samples, fs, 0, res_1, 1);
+
+    // Las capturas ya no hacen falta: se liberan antes de que llegue la siguiente
+    cs8_map_close(&job->capture_0);
+    cs8_map_close(&job->capture_1);
+    job->mapped = false;
+    return 0;
+}
 
-    int half2 = nperseg / 2;
-    int half12 = 2048;
-    double* temp2 = (double*)malloc(nperseg * sizeof(double));
-    double* temp12 = (double*)malloc(4096 * sizeof(double));
+int parameter_compute(rmer_job_t* job)
+{
+    double* Pxx = job->Pxx.p;
+    double* Pxx1 = job->Pxx1.p;
 
-    for (int i = 0; i < half2; i++) {
-        temp2[i] = Pxx2[half2 + i];
-        
-    }
+    uint64_t central_freq = job->central_freq;
+    double* canalization = job->canalization;
+    double* bandwidth = job->bandwidth;
+    int canalization_length = job->canalization_length;
+    int threshold = job->threshold;
 
-    for (int i = 0; i < half12; i++) {
-        temp12[i] = Pxx12[half12 + i];
-        
-    }
+    int nperseg = job->Pxx.n;
+    int presence;
+    int N_f=nperseg;
 
-    for (int i = 0; i < half2; i++) {
-        temp2[half2 + i] = Pxx2[i];
+    // -----------Pico de DC-----------
+    // Welch ya entrega el orden canónico: el DC está en el centro de cada PSD
+    if (!job->dc_free && spectrum_repair_dc(&job->Pxx, spectrum_dc_half_width(&job->Pxx), SPECTRUM_DC_GUARD) != 0) {
+        return -1;
     }
-    for (int i = 0; i < half12; i++) {
-        temp12[half12 + i] = Pxx12[i];
+    if (!job->dc_free && spectrum_replace_dc(&job->Pxx1, &job->Pxx12, RMER_DC_REPLACE_BINS, SPECTRUM_DC_GUARD) != 0) {
+        printf("\nError while DC spike replacement, interpolating instead");
+        spectrum_repair_dc(&job->Pxx1, spectrum_dc_half_width(&job->Pxx1), SPECTRUM_DC_GUARD);
     }
 
-    for (int i = 0; i < nperseg; i++) {
-        Pxx2[i] = temp2[i];
-    } 
-    for (int i = 0; i < 4096; i++) {
-        Pxx12[i] = temp12[i];
+    //real_time();
+    // ---------------Registro de la medición--------------------
+    psd_record_header_t record;
+    psd_record_init(&record, PSD_MEASURE_RMER, job->rawtime, job->timer0, central_freq, 20000000, 4096, canalization_length);
+    snprintf(record.band, sizeof(record.band), "%s", job->banda);
+    snprintf(record.fmin, sizeof(record.fmin), "%s", job->Flow);
+    snprintf(record.fmax, sizeof(record.fmax), "%s", job->Fhigh);
+    if (job->integrated) {
+        record.param_cols = PSD_RMER_INTEGRATED_COLS;
+    }
+
+    double* psd_db = (double*)malloc(4096 * sizeof(double));
+    double* params = (double*)malloc((size_t)canalization_length * record.param_cols * sizeof(double));
+    if (psd_db == NULL || (params == NULL && canalization_length > 0)) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        free(psd_db);
+        free(params);
+        return -1;
     }
+    job->pub.record = record;
+    job->pub.psd_db = psd_db;
+    job->pub.params = params;
 
-    free(temp2);
-    free(temp12);
-
-    // save_to_file(f, Pxx, nperseg, "data.csv");
-
-    for (int i = 0; i < N_f; i++) {
-        f2[i] = (f2[i] + central_freq) / 1e6;
-    }
     for (int i = 0; i < 4096; i++) {
-        f12[i] = (f12[i] + central_freq) / 1e6;
-    }
-
-    index = nperseg/2 ;
-    count = nperseg*0.002;
-    index1 = 2048 ;
-    count1 = 4096*0.002;
-    b=index-(count+13);
-    a=index;
-
-    for (int i=0; i<count; i++)
-    {   
-        b=b-3;
-        Pxx2[a]=Pxx2[b];
-        a=a-1;
-        
-    }
-    a=index;
-    for (int i=0; i<count; i++)
-    {   
-        Pxx2[i]=Pxx2[b];
-        a=a+1;
-        b=b-2;
-        
-    }
-    a=index1;
-    b=index1-(count1+5);
-    for (int i=0; i<count1; i++)
-    {   
-        b=b-3;
-        Pxx12[a]=Pxx12[b];
-        a=a-1; 
-    }
-    a=index1;
-    b=index1-(count1+5);
-    for (int i=0; i<count; i++)
-    {   
-         
-        Pxx12[a]=Pxx12[b];
-        a=a+1;
-        b=b-2;
-        
-    }
-
-    bool DC_spike_success = DC_spike_correction(Pxx1, f1, Pxx12, f12);
-
-    if (!DC_spike_success) {
-        printf("\nError while DC_spike_correction");
+        psd_db[i] = 10*log10(Pxx1[i]);
     }
 
-    //real_time();
- //datos visualizacion
-    char tempu[50];
-
      // ---------------Cálculo de parámetros para cada canal--------------------
-    cJSON *json_root = cJSON_CreateObject();
-
-    cJSON_AddStringToObject(json_root, "datetime", timer0);
-    cJSON_AddStringToObject(json_root, "band", banda);
-    cJSON_AddStringToObject(json_root, "fmin", Flow);
-    cJSON_AddStringToObject(json_root, "fmax", Fhigh);
-    cJSON_AddStringToObject(json_root, "units", "MHz");
-    cJSON_AddStringToObject(json_root, "measure", "RMER");
+    float noise = find_min(Pxx, nperseg);
 
-    cJSON *json_vectors = cJSON_CreateObject();
-   
+    //real_time();
 
-    cJSON *json_Pxx_array = cJSON_CreateArray();
-    
-    for (int i = 0; i < 4096; i++) {
-        memset(tempu, 0, sizeof(tempu));
-        sprintf(tempu, "%0.3f", 10*log10(Pxx1[i])); //Hacer algo aca
-        cJSON_AddItemToArray(json_Pxx_array, cJSON_CreateNumber(atof(tempu)));
-        //cJSON_AddItemToArray(json_Pxx_array, cJSON_CreateNumber(10*log10(constante*Pxx1[i])));
+    // Bins de cada canal: se calculan una vez por banda y sintonía y se reutilizan
+    const channel_map_t* map = (canalization_length > 0)
+        ? channel_map_get(canalization, bandwidth, canalization_length, central_freq, N_f, 20000000)
+        : NULL;
+    if (canalization_length > 0 && map == NULL) {
+        return -1;
     }
-    cJSON_AddItemToObject(json_vectors, "Pxx", json_Pxx_array);
 
-    cJSON *json_f_array = cJSON_CreateArray();
-    for (int i = 0; i < 4096; i++) {
-        memset(tempu, 0, sizeof(tempu));
-        sprintf(tempu, "%0.3f", f1[i]);
-        cJSON_AddItemToArray(json_f_array, cJSON_CreateNumber(atof(tempu)));
-        //cJSON_AddItemToArray(json_f_array, cJSON_CreateNumber(f1[i]));
+    // Máximo y mediana de todos los canales en una pasada, por selección
+    channel_stats_t* stats = (channel_stats_t*)malloc(((size_t)canalization_length + 1) * sizeof(channel_stats_t));
+    if (stats == NULL || (canalization_length > 0 &&
+                          channel_stats_compute(Pxx, map->bins, canalization_length, NULL, 0, stats) != 0)) {
+        free(stats);
+        channel_map_release(map);
+        return -1;
     }
-    cJSON_AddItemToObject(json_vectors, "f", json_f_array);
-
-    cJSON_AddItemToObject(json_root, "vectors", json_vectors);
-
-    cJSON *json_params_array = cJSON_CreateArray();
-
-    float noise = find_min(Pxx, nperseg);
 
-    //real_time();
+    // Suma acumulada de la PSD: potencia y anchos de banda de cada canal sin recorrer sus bins
+    psd_integral_t integral = {0};
+    if (job->integrated && psd_integral_init(&integral, Pxx, N_f, 20000000.0 / N_f) != 0) {
+        free(stats);
+        channel_map_release(map);
+        return -1;
+    }
 
     for (int idx = 0; idx < canalization_length; idx++) {
         double center_freq = canalization[idx];
-        double bw = bandwidth[idx];
-
-        double target_lower_freq = center_freq - bw / 2;
-        double target_upper_freq = center_freq + bw / 2;
-
-        int lower_index = find_closest_index(f, N_f, target_lower_freq);
-        int upper_index = find_closest_index(f, N_f, target_upper_freq);
-
-
-        if (lower_index > upper_index) {
-            int temp = lower_index;
-            lower_index = upper_index;
-            upper_index = temp;
-        }
-        if (lower_index < 0) lower_index = 0;
-        if (upper_index >= N_f) upper_index = N_f - 1;
 
-        int range_length = upper_index - lower_index + 1;
-        
-        double power_max = find_max(Pxx, lower_index, upper_index);
+        double power_max = stats[idx].max;
 
-        double power = median(Pxx, lower_index, upper_index);
+        double power = stats[idx].median;
 
         double snr = 10.0 * log10(power_max / noise );
 
@@ -370,73 +221,72 @@ void parameter(st_server *s_server, int threshold, double* canalization, double*
             presence = 0;
         }
 
-        cJSON *json_item = cJSON_CreateObject();
-        cJSON_AddNumberToObject(json_item, "freq", center_freq);
-
-        memset(tempu, 0, sizeof(tempu));
-        sprintf(tempu, "%0.3f", 10.0 * log10(power));
-        cJSON_AddNumberToObject(json_item, "power", atof(tempu));
+        double* row = params + (size_t)idx * record.param_cols;
+        row[0] = center_freq;
+        row[1] = 10.0 * log10(power);
+        row[2] = 10.0 * log10(power_max);
+        row[3] = snr;
+        row[4] = presence;
+
+        if (job->integrated) {
+            int lower_index = map->bins[idx].lower;
+            int upper_index = map->bins[idx].upper;
+            row[5] = 10.0 * log10(psd_integral_power(&integral, lower_index, upper_index));
+            row[6] = psd_integral_obw(&integral, lower_index, upper_index, PSD_OBW_FRACTION);
+            row[7] = psd_integral_xdb_bandwidth(&integral, lower_index, upper_index, power_max, PSD_XDB_BANDWIDTH_DB);
+        }
+    }
+    free(stats);
+    psd_integral_free(&integral);
+    channel_map_release(map);
 
-        memset(tempu, 0, sizeof(tempu));
-        sprintf(tempu, "%0.3f", 10.0 * log10(power_max));        
-        cJSON_AddNumberToObject(json_item, "power_max", atof(tempu));
-        
-        memset(tempu, 0, sizeof(tempu));
-        sprintf(tempu, "%0.3f", snr);        
-        cJSON_AddNumberToObject(json_item, "snr", atof(tempu));
+    //real_time();
 
-        cJSON_AddNumberToObject(json_item, "Presence", presence);
+    return 0;
+}
 
-        cJSON_AddItemToArray(json_params_array, json_item);
+int parameter_publish(psd_publication_t* pub, st_server *s_server, const char* filename)
+{
+    // Se guarda en el historial binario y se exporta el JSON que lee Socket/client.js
+    int published = psd_archive_publish(&pub->record, pub->psd_db, pub->params, filename);
+    if (published != 0) {
+        return -1;
     }
-
     //real_time();
 
-    cJSON_AddItemToObject(json_root, "params", json_params_array);
-    
-    cJSON *json_data = cJSON_CreateObject();
-    cJSON_AddItemToObject(json_data, "data", json_root);
-    
-    char *json_string = cJSON_Print(json_data);
-
-    char filename[20];
-    memset(filename, 0, 20);
-    sprintf(filename, "JSON/%d", file_sample);
-
-    FILE *file = fopen(filename, "w");
-    if (file == NULL) {
-        printf("Error al abrir el archivo para escribir.\n");
-        //cJSON_Delete(json_data);
-        cJSON_Delete(json_root);
-        free(json_string);
-        free(f);
-        free(Pxx);
-        free(f1);
-        free(Pxx1);
-        free(vector_IQ_0);
-        free(vector_IQ_1);
+    // El aviso lleva el archivo: dos publicaciones seguidas no se leen del mismo JSON
+    char dataServer[64];
+    snprintf(dataServer, sizeof(dataServer), "{%s:{\"file\":\"%s\"}}", program ? "data" : "dataStreaming", filename);
+    return Server_Write(s_server, dataServer, strlen(dataServer));
+}
+
+void parameter_job_free(rmer_job_t* job)
+{
+    if (job->mapped) {
+        cs8_map_close(&job->capture_0);
+        cs8_map_close(&job->capture_1);
+    }
+    free(job->canalization);
+    free(job->bandwidth);
+    spectrum_free(&job->Pxx);
+    spectrum_free(&job->Pxx1);
+    spectrum_free(&job->Pxx12);
+    psd_publication_free(&job->pub);
+    memset(job, 0, sizeof(*job));
+}
 
+void parameter(st_server *s_server, int threshold, double* canalization, double* bandwidth, int canalization_length, uint64_t central_freq, uint8_t file_sample, char* banda, char* Flow, char* Fhigh) 
+{
+    rmer_job_t job;
+    if (parameter_job_init(&job, threshold, canalization, bandwidth, canalization_length, central_freq, file_sample, banda, Flow, Fhigh) != 0) {
         return;
     }
-    fprintf(file, "%s", json_string);
-    fclose(file);
-    //real_time();
 
-    char dataServer[10];
-    memset(dataServer, 0, sizeof(dataServer));
-    if(program) {
-        sprintf(dataServer, "{data:{}}");
-    } else {
-        sprintf(dataServer, "{dataStreaming:{}}");
+    if (parameter_load(&job) == 0 && parameter_psd(&job) == 0 && parameter_compute(&job) == 0) {
+        char filename[20];
+        memset(filename, 0, 20);
+        sprintf(filename, "JSON/%d", file_sample);
+        parameter_publish(&job.pub, s_server, filename);
     }
-    write(s_server->conf_fd, dataServer, strlen(dataServer));
-    
-    //cJSON_Delete(json_data);
-    cJSON_Delete(json_root);
-    free(json_string);
-    free(f);
-    free(Pxx);
-    free(f1);
-    free(Pxx1);
-    //real_time();
-}
\ No newline at end of file
+    parameter_job_free(&job);
+}
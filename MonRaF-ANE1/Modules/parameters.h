@@ -10,8 +10,108 @@
 #define PARAMETER_ANALYSIS_H
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "cs8_map.h"
+#include "psd_archive.h"
+#include "spectrum.h"
+#include "window.h"
 #include "../Drivers/bacn_RTI.h"
 
+/**
+ * @def RMER_NPERSEG
+ * @brief Longitud de segmento de la PSD de alta resolución usada para los parámetros.
+ */
+#define RMER_NPERSEG 32768
+
+/**
+ * @def RMER_DC_REPLACE_BINS
+ * @brief Bins a cada lado del DC de la PSD publicada que se toman de la segunda captura.
+ */
+#define RMER_DC_REPLACE_BINS 50
+
+/**
+ * @struct rmer_job_t
+ * @brief Estado de una medición RMER entre las etapas de `parameter`.
+ *
+ * `parameter` ejecuta las etapas en orden; la tubería de mediciones
+ * (`measurement.h`) las reparte entre hilos para que la captura del siguiente
+ * trabajo se solape con el análisis de éste.
+ */
+typedef struct {
+    int threshold;               /**< Umbral de presencia en dB. */
+    double* canalization;        /**< Frecuencias centrales de los canales (copia propia). */
+    double* bandwidth;           /**< Ancho de banda de cada canal (copia propia). */
+    int canalization_length;     /**< Número de canales. */
+    uint64_t central_freq;       /**< Frecuencia central de la captura en Hz. */
+    uint8_t file_sample;         /**< Primer archivo de `Samples/` (el segundo es `file_sample + 1`). */
+    char banda[16];              /**< Banda para el registro. */
+    char Flow[13];               /**< Frecuencia inferior para el registro. */
+    char Fhigh[13];              /**< Frecuencia superior para el registro. */
+    cs8_map_t capture_0;         /**< Captura `Samples/file_sample`. */
+    cs8_map_t capture_1;         /**< Captura `Samples/file_sample + 1`. */
+    bool mapped;                 /**< Las capturas siguen mapeadas. */
+    time_t rawtime;              /**< Momento de la medición. */
+    char timer0[17];             /**< `rawtime` como "%Y-%m-%dT%H:%M". */
+    spectrum_t Pxx;              /**< PSD de `RMER_NPERSEG` puntos de la primera captura (de la que salen los parámetros). */
+    spectrum_t Pxx1;             /**< PSD de 4096 puntos de la primera captura. */
+    spectrum_t Pxx12;            /**< PSD de 4096 puntos de la segunda captura: bins del DC de `Pxx1`. */
+    window_type_t window;        /**< Ventana de Welch (`WINDOW_HAMMING` tras `parameter_job_init`). */
+    bool integrated;             /**< Añadir potencia integrada y anchos de banda por canal (`psd_integral.h`). */
+    bool dc_free;                /**< `Pxx` y `Pxx1` ya vienen sin pico de DC (tramo de un barrido): no se corrigen. */
+    psd_publication_t pub;       /**< Registro, PSD en dB y filas por canal (`PSD_RMER_COLS` o `PSD_RMER_INTEGRATED_COLS` columnas). */
+} rmer_job_t;
+
+/**
+ * @brief Prepara una medición copiando la canalización.
+ *
+ * @return 0 si se pudo reservar, -1 en caso contrario.
+ */
+int parameter_job_init(rmer_job_t* job, int threshold, const double* canalization, const double* bandwidth, int canalization_length, uint64_t central_freq, uint8_t file_sample, const char* banda, const char* Flow, const char* Fhigh);
+
+/**
+ * @brief Etapa de carga: mapea `Samples/file_sample` y `Samples/file_sample + 1` y borra los archivos.
+ */
+int parameter_load(rmer_job_t* job);
+
+/**
+ * @brief Etapa de PSD: Welch de 32768 y 4096 puntos de la primera captura y de 4096
+ * de la segunda; libera los mapeos.
+ */
+int parameter_psd(rmer_job_t* job);
+
+/**
+ * @brief Etapa de parámetros: corrige las PSD y calcula potencia, SNR y presencia por canal.
+ *
+ * El pico de DC de `Pxx` se interpola (`spectrum_repair_dc`) y el de `Pxx1`,
+ * que es la PSD que se publica, se sustituye con los bins de `Pxx12`
+ * (`spectrum_replace_dc`). Con `job->dc_free` (PSD sacadas de un barrido, ya
+ * corregidas) no se toca ninguna; los parámetros salen de `Pxx` con su propia
+ * longitud.
+ *
+ * Con `job->integrated` añade la potencia integrada del canal, el ancho de
+ * banda ocupado (`PSD_OBW_FRACTION`) y el ancho a `PSD_XDB_BANDWIDTH_DB`.
+ */
+int parameter_compute(rmer_job_t* job);
+
+/**
+ * @brief Publica una medición: registro binario, JSON `filename` y aviso al cliente.
+ *
+ * El aviso (`{data:{"file":...}}` o `{dataStreaming:{"file":...}}`) nombra
+ * `filename`, así que el cliente lee cada publicación de su propio archivo.
+ *
+ * Común a RMER, RNI y TDT; la tubería lo llama siempre desde la misma etapa
+ * para que las escrituras del JSON que lee el cliente no se crucen.
+ *
+ * @return 0 si se publicó, -1 en caso de error.
+ */
+int parameter_publish(psd_publication_t* pub, st_server *s_server, const char* filename);
+
+/**
+ * @brief Libera todo lo que reservaron las etapas.
+ */
+void parameter_job_free(rmer_job_t* job);
+
 /**
  * @brief Realiza análisis espectral y genera parámetros para canales específicos.
  * 
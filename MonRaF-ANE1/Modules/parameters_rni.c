@@ -16,9 +16,14 @@
 #include <unistd.h>
 #include "IQ.h"
 #include "cs8_to_iq.h"
+#include "cs8_map.h"
 #include "welch.h"
-#include "cJSON.h"
-#include "find_closest_index.h"
+#include "psd_archive.h"
+#include "parameters.h"
+#include "parameters_rni.h"
+#include "channel_map.h"
+#include "channel_stats.h"
+#include "spectrum.h"
 #include "save_to_file.h"
 #include "tdt_functions.h"
 #include "moda.h"
@@ -26,19 +31,22 @@
 
 extern bool program;
 
-void parameter_rni(st_server *s_server, int threshold, double* canalization, double* bandwidth, int canalization_length, uint64_t central_freq, uint8_t file_sample, char* banda, char* Flow, char* Fhigh) 
+int parameter_rni_compute(int threshold, double* canalization, double* bandwidth, int canalization_length, uint64_t central_freq, uint8_t file_sample, char* banda, char* Flow, char* Fhigh, window_type_t window, psd_publication_t* pub)
 {
     size_t num_samples;
 
     char file_sample_str[100];
     sprintf(file_sample_str, "Samples/%d", file_sample); 
 
-    complex double* vector_IQ = cargar_cs8(file_sample_str, &num_samples);
+    cs8_map_t capture;
+    if (cs8_map_open(&capture, file_sample_str) != 0) {
+        return -1;
+    }
+    num_samples = capture.num_samples;
 
     printf("Total samples: %lu\r\n", num_samples);
     
     delete_CS8(file_sample);
-    delete_JSON(file_sample);
            
     char timer0[17];
     time_t rawtime;
@@ -47,187 +55,91 @@ void parameter_rni(st_server *s_server, int threshold, double* canalization, dou
     timeinfo = localtime(&rawtime);
     strftime(timer0, sizeof(timer0), "%Y-%m-%dT%H:%M", timeinfo);
 
-    double* Pxx = NULL;
-    double* f = NULL;
-    double* Pxx1 = NULL;
-    double* f1 = NULL;
     int nperseg = 32768;
     int presence;
     int N_f=nperseg;
 
-    size_t psd_size = nperseg;
-    size_t psd_size1 = 4096;
-    Pxx = (double*) malloc(psd_size * sizeof(double));
-    f = (double*) malloc(psd_size * sizeof(double));
-    Pxx1 = (double*) malloc(psd_size1 * sizeof(double));
-    f1 = (double*) malloc(psd_size1 * sizeof(double));
-    
-    welch_psd_complex(vector_IQ, num_samples, 20000000, nperseg, 0, f, Pxx);
-    welch_psd_complex(vector_IQ, num_samples, 20000000, 4096, 0, f1, Pxx1);
-    free(vector_IQ);
-
-    if (nperseg % 2 != 0) {
-        printf("La longitud del vector debe ser par.\n");
-        return;
-    }
-    // -----------Acomodar potencias de welch-----------
-    int half = nperseg / 2;
-    int half1 =2048;
-    double* temp = (double*)malloc(nperseg * sizeof(double));
-    double* temp1 = (double*)malloc(4096 * sizeof(double));
-
-    for (int i = 0; i < half; i++) {
-        temp[i] = Pxx[half + i];
-        
-    }
-
-    for (int i = 0; i < half; i++) {
-        temp[half + i] = Pxx[i];
-    }
-
-    for (int i = 0; i < nperseg; i++) {
-        Pxx[i] = temp[i];
-    } 
-
-
-    for (int i = 0; i < half1; i++) {
-        temp1[i] = Pxx1[half1 + i];
-        
-    }
-
-
-    for (int i = 0; i < half1; i++) {
-        temp1[half1 + i] = Pxx1[i];
-    }
-
-
-    for (int i = 0; i < 4096; i++) {
-        Pxx1[i] = temp1[i];
-    }
-
-    free(temp);
-    free(temp1);
-
-    // save_to_file(f, Pxx, nperseg, "data.csv");
-
-    for (int i = 0; i < N_f; i++) {
-        f[i] = (f[i] + central_freq) / 1e6;
-    }
-    for (int i = 0; i < 4096; i++) {
-        f1[i] = (f1[i] + central_freq) / 1e6;
-    }
-
-    int index = nperseg/2 ;
-    int count = nperseg*0.002;
-    int index1 = 2048 ;
-    int count1 = 4096*0.002;
-    int b=index-(count+3);
-    int a=index;
-
-    for (int i=0; i<count; i++)
-    {   
-        b=b-3;
-        Pxx[a]=Pxx[b];
-        a=a-1;
-        
-    }
-    a=index;
-    for (int i=0; i<count; i++)
-    {   
-        Pxx[i]=Pxx[b];
-        a=a+1;
-        b=b-2;
-        
-    }
-    a=index1;
-    b=index1-(count1+5);
-    for (int i=0; i<count1; i++)
-    {   
-        b=b-3;
-        Pxx1[a]=Pxx1[b];
-        a=a-1; 
-    }
-    a=index1;
-    b=index1-(count1+5);
-    for (int i=0; i<count; i++)
-    {   
-         
-        Pxx1[a]=Pxx1[b];
-        a=a+1;
-        b=b-2;
-        
+    spectrum_t psd = {0};
+    spectrum_t psd1 = {0};
+    if (spectrum_alloc(&psd, nperseg, 20000000, (double)central_freq) != 0 ||
+        spectrum_alloc(&psd1, 4096, 20000000, (double)central_freq) != 0) {
+        spectrum_free(&psd);
+        cs8_map_close(&capture);
+        return -1;
+    }
+    double* Pxx = psd.p;
+    double* Pxx1 = psd1.p;
+
+    // 32768 y 4096 puntos en una sola pasada por la captura; los ejes son los de los `spectrum_t`
+    welch_res_t res[2] = {
+        {.segment_length = nperseg, .P_welch_out = Pxx, .window = window},
+        {.segment_length = 4096, .P_welch_out = Pxx1, .window = window},
+    };
+    welch_psd_cs8_multi(capture.data, num_samples, 20000000, 0, res, 2);
+    cs8_map_close(&capture);
+
+    // -----------Pico de DC-----------
+    // Welch ya entrega el orden canónico: el DC está en el centro de cada PSD
+    if (spectrum_repair_dc(&psd, spectrum_dc_half_width(&psd), SPECTRUM_DC_GUARD) != 0 ||
+        spectrum_repair_dc(&psd1, spectrum_dc_half_width(&psd1), SPECTRUM_DC_GUARD) != 0) {
+        spectrum_free(&psd);
+        spectrum_free(&psd1);
+        return -1;
     }
 
  
  //datos visualizacion
  
 
-    // ---------------Cálculo de parámetros para cada canal--------------------
-    cJSON *json_root = cJSON_CreateObject();
+    // ---------------Registro de la medición--------------------
+    int n_channels = (canalization_length > 0) ? canalization_length : 0;
 
-    cJSON_AddStringToObject(json_root, "datetime", timer0);
-    cJSON_AddStringToObject(json_root, "band", banda);
-    cJSON_AddStringToObject(json_root, "fmin", Flow);
-    cJSON_AddStringToObject(json_root, "fmax", Fhigh);
-    cJSON_AddStringToObject(json_root, "units", "MHz");
-    cJSON_AddStringToObject(json_root, "measure", "RNI");
-    char tempu[50];
+    psd_record_header_t record;
+    psd_record_init(&record, PSD_MEASURE_RNI, rawtime, timer0, central_freq, 20000000, 4096, n_channels);
+    snprintf(record.band, sizeof(record.band), "%s", banda);
+    snprintf(record.fmin, sizeof(record.fmin), "%s", Flow);
+    snprintf(record.fmax, sizeof(record.fmax), "%s", Fhigh);
 
-    cJSON *json_vectors = cJSON_CreateObject();
-    double constante=abs((abs(10*log10(Pxx[0])))-abs((10*log10(Pxx1[0]))));
-    cJSON *json_Pxx_array = cJSON_CreateArray();
-    for (int i = 0; i < 4096; i++) {
-        memset(tempu, 0, sizeof(tempu));
-        sprintf(tempu, "%0.3f", 10*log10(Pxx1[i])+constante); //Hacer algo aca
-        cJSON_AddItemToArray(json_Pxx_array, cJSON_CreateNumber(atof(tempu)));
-        //cJSON_AddItemToArray(json_Pxx_array, cJSON_CreateNumber(10*log10(constante*Pxx1[i])));
+    double* psd_db = (double*)malloc(4096 * sizeof(double));
+    double* params = (double*)malloc(((size_t)n_channels + 1) * PSD_RNI_COLS * sizeof(double));
+    if (psd_db == NULL || params == NULL) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        free(psd_db);
+        free(params);
+        spectrum_free(&psd);
+        spectrum_free(&psd1);
+        return -1;
     }
-    cJSON_AddItemToObject(json_vectors, "Pxx", json_Pxx_array);
 
-    cJSON *json_f_array = cJSON_CreateArray();
+    double constante=abs((abs(10*log10(Pxx[0])))-abs((10*log10(Pxx1[0]))));
     for (int i = 0; i < 4096; i++) {
-        memset(tempu, 0, sizeof(tempu));
-        sprintf(tempu, "%0.3f", f1[i]);
-        cJSON_AddItemToArray(json_f_array, cJSON_CreateNumber(atof(tempu)));
-        //cJSON_AddItemToArray(json_f_array, cJSON_CreateNumber(f1[i]));
+        psd_db[i] = 10*log10(Pxx1[i])+constante;
     }
-    cJSON_AddItemToObject(json_vectors, "f", json_f_array);
-
-    cJSON_AddItemToObject(json_root, "vectors", json_vectors);
-
-    cJSON *json_params_array = cJSON_CreateArray();
-
 
+    // ---------------Cálculo de parámetros para cada canal--------------------
     float noise = find_min(Pxx, nperseg);
 
-    for (int idx = 0; idx < (canalization_length-1); idx++) {
+    // Bins de cada canal: se calculan una vez por banda y sintonía y se reutilizan
+    const channel_map_t* map = (n_channels > 0)
+        ? channel_map_get(canalization, bandwidth, n_channels, central_freq, N_f, 20000000)
+        : NULL;
+    channel_stats_t* stats = (channel_stats_t*)malloc(((size_t)n_channels + 1) * sizeof(channel_stats_t));
+    if (stats == NULL || (n_channels > 0 && (map == NULL ||
+                          channel_stats_compute(Pxx, map->bins, n_channels, NULL, 0, stats) != 0))) {
+        free(stats);
+        channel_map_release(map);
+        free(psd_db);
+        free(params);
+        spectrum_free(&psd);
+        spectrum_free(&psd1);
+        return -1;
+    }
+
+    for (int idx = 0; idx < n_channels; idx++) {
         double center_freq = canalization[idx];
-        double bw = bandwidth[idx];
-    
-
-        int index = find_closest_index(f, N_f, center_freq);
-
-        double target_lower_freq = center_freq - bw / 2;
-        double target_upper_freq = center_freq + bw / 2;
-
-        int lower_index = find_closest_index(f, N_f, target_lower_freq);
-        int upper_index = find_closest_index(f, N_f, target_upper_freq);
-
-        if (lower_index > upper_index) {
-            int temp = lower_index;
-            lower_index = upper_index;
-            upper_index = temp;
-        }
-
-        if (lower_index < 0) lower_index = 0;
-        if (upper_index >= N_f) upper_index = N_f - 1;
 
-        int range_length = upper_index - lower_index + 1;
+        double power_max = stats[idx].max;
 
-
-        double power_max = find_max(Pxx, lower_index, upper_index);
-
-        double power = median(Pxx, lower_index, upper_index);
         double power_vm = 10*log10(power_max);
         power_vm=pow(10, (power_vm-30.0)/10.0);
 
@@ -236,59 +148,36 @@ void parameter_rni(st_server *s_server, int threshold, double* canalization, dou
 
         double v_max=28;
 
-        cJSON *json_item = cJSON_CreateObject();
-        cJSON_AddStringToObject(json_item, "time", timer0);
-        cJSON_AddNumberToObject(json_item, "freq", center_freq);
-        cJSON_AddNumberToObject(json_item, "dbm", 10*log10(power_max));
-        cJSON_AddNumberToObject(json_item, "V/m", v_m);
-        cJSON_AddNumberToObject(json_item, "limite ocupado",(v_m/v_max)*100);
-
-
-        cJSON_AddItemToArray(json_params_array, json_item);
+        double* row = params + (size_t)idx * PSD_RNI_COLS;
+        row[0] = center_freq;
+        row[1] = 10*log10(power_max);
+        row[2] = v_m;
+        row[3] = (v_m/v_max)*100;
         
     }
+    free(stats);
+    channel_map_release(map);
 
-    cJSON_AddItemToObject(json_root, "params", json_params_array);
-    
-    cJSON *json_data = cJSON_CreateObject();
-    cJSON_AddItemToObject(json_data, "data", json_root);
-    
-    char *json_string = cJSON_Print(json_data);
+    pub->record = record;
+    pub->psd_db = psd_db;
+    pub->params = params;
 
-    char filename[20];
-    memset(filename, 0, 20);
-    sprintf(filename, "JSON/%d", file_sample);
+    spectrum_free(&psd);
+    spectrum_free(&psd1);
+    return 0;
+}
 
-    FILE *file = fopen(filename, "w");
-    if (file == NULL) {
-        printf("Error al abrir el archivo para escribir.\n");
-        //cJSON_Delete(json_data);
-        cJSON_Delete(json_root);
-        free(json_string);
-        free(f);
-        free(Pxx);
-        free(f1);
-        free(Pxx1);
-        free(vector_IQ);
+void parameter_rni(st_server *s_server, int threshold, double* canalization, double* bandwidth, int canalization_length, uint64_t central_freq, uint8_t file_sample, char* banda, char* Flow, char* Fhigh) 
+{
+    psd_publication_t pub;
+    if (parameter_rni_compute(threshold, canalization, bandwidth, canalization_length, central_freq, file_sample, banda, Flow, Fhigh, WINDOW_HAMMING, &pub) != 0) {
         return;
     }
-    fprintf(file, "%s", json_string);
-    fclose(file);
 
-    char dataServer[10];
-    memset(dataServer, 0, sizeof(dataServer));
-    if(program) {
-        sprintf(dataServer, "{data:{}}");
-    } else {
-        sprintf(dataServer, "{dataStreaming:{}}");
-    }
-    write(s_server->conf_fd, dataServer, strlen(dataServer));
-    
-    //cJSON_Delete(json_data);
-    cJSON_Delete(json_root);
-    free(json_string);
-    free(f);
-    free(Pxx);
-    free(f1);
-    free(Pxx1);
-}
\ No newline at end of file
+    char filename[20];
+    memset(filename, 0, 20);
+    sprintf(filename, "JSON/%d", file_sample);
+
+    parameter_publish(&pub, s_server, filename);
+    psd_publication_free(&pub);
+}
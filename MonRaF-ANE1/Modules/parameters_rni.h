@@ -12,6 +12,8 @@
 
 #include <stdint.h>
 #include <complex.h>
+#include "psd_archive.h"
+#include "window.h"
 #include "../Drivers/bacn_RTI.h"
 
 /**
@@ -32,4 +34,13 @@
 
 void parameter_rni(st_server *s_server, int threshold, double* canalisation, double* bandwidth, int canalisation_length, uint64_t central_freq, uint8_t file_sample, char* banda, char* Flow, char* Fhigh);
 
+/**
+ * @brief Igual que `parameter_rni` pero sin publicar: deja la medición en `pub`.
+ *
+ * @param window Ventana de las PSD de Welch (`parameter_rni` usa `WINDOW_HAMMING`).
+ *
+ * @return 0 si `pub` quedó lleno (liberar con `psd_publication_free`), -1 en caso de error.
+ */
+int parameter_rni_compute(int threshold, double* canalization, double* bandwidth, int canalization_length, uint64_t central_freq, uint8_t file_sample, char* banda, char* Flow, char* Fhigh, window_type_t window, psd_publication_t* pub);
+
 #endif // PARAMETER_H
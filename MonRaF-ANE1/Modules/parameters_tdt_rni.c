@@ -17,6 +17,7 @@
 
 #include "cJSON.h"
 #include "tdt_functions.h"
+#include "cs8_map.h"
 
 
 void parameter_tdt_rni(int modulation, uint64_t central_freq, uint8_t file_sample) {
@@ -26,7 +27,11 @@ void parameter_tdt_rni(int modulation, uint64_t central_freq, uint8_t file_sampl
 
     snprintf(cs8_path, sizeof(cs8_path), "%d", file_sample);
 
-    complex double* IQ_data = cargar_cs8(cs8_path, &num_samples);
+    cs8_map_t capture;
+    if (cs8_map_open(&capture, cs8_path) != 0) {
+        return;
+    }
+    num_samples = capture.num_samples;
 
     printf("Total samples: %lu\r\n", num_samples);
 
@@ -39,7 +44,7 @@ void parameter_tdt_rni(int modulation, uint64_t central_freq, uint8_t file_sampl
     
     double mer_value = 0.0, ber_value = 0.0, c_n_value = 0.0, signal_power_value;
 
-    analyze_signal(central_freq, modulation, IQ_data, num_samples, &mer_value, &ber_value, &c_n_value, &signal_power_value);
+    analyze_signal_cs8(central_freq, modulation, capture.data, num_samples, &mer_value, &ber_value, &c_n_value, &signal_power_value);
 
     double v_m = sqrt((signal_power_value/1000)*377);
 
@@ -72,6 +77,5 @@ void parameter_tdt_rni(int modulation, uint64_t central_freq, uint8_t file_sampl
     
     cJSON_Delete(json_array);
     free(json_string);
-    free(IQ_data);
     return EXIT_SUCCESS;
 }
\ No newline at end of file
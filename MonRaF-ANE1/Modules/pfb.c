@@ -0,0 +1,277 @@
+/**
+ * @file pfb.c
+ * @brief Implementación del canalizador por banco de filtros polifásico.
+ *
+ * Para cada salida, en el instante n de la muestra más reciente:
+ *
+ *   X_k[n] = sum_j h[j] x[n - j] e^{-i 2π k (n - j) / M}
+ *
+ * es decir, cada subcanal se baja a banda base y se filtra con el prototipo.
+ * Agrupando j = p·M + m, las `taps` ramas se suman en un vector de M puntos y
+ * una IFFT da todos los subcanales; el factor e^{-i 2π k n / M} se aplica
+ * rotando ese vector antes de la IFFT.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <complex.h>
+#include <fftw3.h>
+
+#include "pfb.h"
+#include "fft_plan.h"
+#include "window.h"
+
+/**
+ * @brief Prototipo: sinc con corte en la mitad de la separación y ventana Blackman-Harris, con suma 1.
+ */
+static int pfb_prototype(pfb_t* p)
+{
+    const window_t* w = window_get(WINDOW_BLACKMAN_HARRIS, p->L);
+    if (w == NULL) {
+        return -1;
+    }
+
+    double sum = 0.0;
+    for (int j = 0; j < p->L; j++) {
+        double t = (j - (p->L - 1) / 2.0) / p->M;
+        double sinc = (t == 0.0) ? 1.0 : sin(M_PI * t) / (M_PI * t);
+        p->h[j] = sinc * w->coeffs[j];
+        sum += p->h[j];
+    }
+    for (int j = 0; j < p->L; j++) {
+        p->h[j] /= sum;
+    }
+    return 0;
+}
+
+int pfb_init(pfb_t* p, double fs, double spacing_hz, int taps, bool oversampled)
+{
+    memset(p, 0, sizeof(*p));
+
+    long M = (spacing_hz > 0.0) ? lround(fs / spacing_hz) : 0;
+    if (M < 2 || M > (1 << 16)) {
+        fprintf(stderr, "Error: invalid PFB spacing %.1f Hz\n", spacing_hz);
+        return -1;
+    }
+    p->fs = fs;
+    p->M = (int)M;
+    p->D = oversampled ? p->M / 2 : p->M;
+    p->taps = (taps > 0) ? taps : PFB_DEFAULT_TAPS;
+    p->L = p->M * p->taps;
+
+    p->h = (double*)malloc((size_t)p->L * sizeof(double));
+    p->hist = (complex double*)calloc(2 * (size_t)p->L, sizeof(complex double));
+    p->fft_in = fftw_alloc_complex(p->M);
+    p->fft_out = fftw_alloc_complex(p->M);
+    p->power_acc = (double*)calloc((size_t)p->M, sizeof(double));
+    p->peak = (double*)calloc((size_t)p->M, sizeof(double));
+    if (!p->h || !p->hist || !p->fft_in || !p->fft_out || !p->power_acc || !p->peak) {
+        fprintf(stderr, "Error: Unable to allocate PFB\n");
+        pfb_free(p);
+        return -1;
+    }
+
+    if (pfb_prototype(p) != 0) {
+        pfb_free(p);
+        return -1;
+    }
+    p->plan = fft_plan_get(p->M, FFTW_BACKWARD, p->fft_in, p->fft_out);
+    if (p->plan == NULL) {
+        pfb_free(p);
+        return -1;
+    }
+    return 0;
+}
+
+double pfb_raster(const double* freq, const double* bw, int n)
+{
+    double raster = 0.0;
+    for (int i = 0; i < n; i++) {
+        if (bw[i] > 0.0 && (raster == 0.0 || bw[i] < raster)) {
+            raster = bw[i];
+        }
+        if (i > 0) {
+            double step = fabs(freq[i] - freq[i - 1]);
+            if (step > 0.0 && (raster == 0.0 || step < raster)) {
+                raster = step;
+            }
+        }
+    }
+    return raster;
+}
+
+int pfb_attach_iq(pfb_t* p, int channel, complex double* out, size_t capacity)
+{
+    if (channel < 0 || channel >= p->M || p->n_iq == PFB_MAX_IQ) {
+        return -1;
+    }
+    pfb_iq_t* iq = &p->iq[p->n_iq++];
+    iq->channel = channel;
+    iq->out = out;
+    iq->capacity = capacity;
+    iq->len = 0;
+    return 0;
+}
+
+/**
+ * @brief Suma las ramas sobre las últimas `L` muestras, IFFT y acumulación de una salida.
+ */
+static void pfb_output(pfb_t* p)
+{
+    const int M = p->M;
+    // seg[L - 1] es la muestra más reciente, seg[L - 1 - j] = x[n - j]
+    const complex double* seg = p->hist + p->pos + 1;
+    complex double* u = p->fft_out;
+
+    memset(u, 0, (size_t)M * sizeof(complex double));
+    for (int b = 0; b < p->taps; b++) {
+        const double* h = p->h + (size_t)b * M;
+        const complex double* x = seg + (p->L - 1) - (size_t)b * M;
+        for (int m = 0; m < M; m++) {
+            u[m] += h[m] * x[-m];
+        }
+    }
+
+    // Rotación por n mod M: cada subcanal queda referido al mismo instante absoluto
+    int s = (int)((p->n - 1) % (uint64_t)M);
+    memcpy(p->fft_in, u + s, (size_t)(M - s) * sizeof(complex double));
+    memcpy(p->fft_in + (M - s), u, (size_t)s * sizeof(complex double));
+
+    fftw_execute_dft(p->plan, p->fft_in, p->fft_out);
+
+    for (int k = 0; k < M; k++) {
+        double re = creal(p->fft_out[k]);
+        double im = cimag(p->fft_out[k]);
+        double power = re * re + im * im;
+        p->power_acc[k] += power;
+        if (power > p->peak[k]) {
+            p->peak[k] = power;
+        }
+    }
+    for (int i = 0; i < p->n_iq; i++) {
+        pfb_iq_t* iq = &p->iq[i];
+        if (iq->len < iq->capacity) {
+            iq->out[iq->len++] = p->fft_out[iq->channel];
+        }
+    }
+    p->outputs++;
+}
+
+/**
+ * @brief Agrega una muestra y produce una salida cada `D` muestras, con la historia ya llena.
+ */
+static inline void pfb_push_sample(pfb_t* p, complex double x)
+{
+    p->pos = (p->pos + 1 == p->L) ? 0 : p->pos + 1;
+    p->hist[p->pos] = x;
+    p->hist[p->pos + p->L] = x;
+    p->n++;
+
+    if (++p->phase == p->D) {
+        p->phase = 0;
+        if (p->n >= (uint64_t)p->L) {
+            pfb_output(p);
+        }
+    }
+}
+
+void pfb_push_cs8(pfb_t* p, const int8_t* buffer, size_t length)
+{
+    size_t pos = 0;
+
+    // Completar la muestra que quedó partida en el buffer anterior
+    if (p->has_carry && length > 0) {
+        pfb_push_sample(p, p->carry + buffer[0] * I);
+        p->has_carry = false;
+        pos = 1;
+    }
+    for (; pos + 1 < length; pos += 2) {
+        pfb_push_sample(p, buffer[pos] + buffer[pos + 1] * I);
+    }
+    if (pos < length) {
+        p->carry = buffer[pos];
+        p->has_carry = true;
+    }
+}
+
+/**
+ * @brief Subcanal con signo (-M/2 < k < M/2) más cercano a `offset_hz`, o M si cae fuera.
+ */
+static int pfb_signed_channel(const pfb_t* p, double offset_hz)
+{
+    long k = lround(offset_hz * p->M / p->fs);
+    // El subcanal M/2 mezcla los dos bordes de la banda: no se usa
+    return (labs(k) <= (p->M - 1) / 2) ? (int)k : p->M;
+}
+
+int pfb_channel_index(const pfb_t* p, double offset_hz)
+{
+    int k = pfb_signed_channel(p, offset_hz);
+    return (k == p->M) ? -1 : (k + p->M) % p->M;
+}
+
+double pfb_channel_power(const pfb_t* p, int channel)
+{
+    return (p->outputs > 0) ? p->power_acc[channel] / p->outputs : 0.0;
+}
+
+double pfb_channel_peak(const pfb_t* p, int channel)
+{
+    return p->peak[channel];
+}
+
+int pfb_band_power(const pfb_t* p, double offset_hz, double bw_hz, double* power, double* peak)
+{
+    double spacing = p->fs / p->M;
+    int edge = (p->M - 1) / 2;
+    // Límites del canal en unidades de subcanal; el subcanal k ocupa [k - 0.5, k + 0.5]
+    double lo = (offset_hz - bw_hz / 2) / spacing;
+    double hi = (offset_hz + bw_hz / 2) / spacing;
+    int used = 0;
+
+    *power = 0.0;
+    *peak = 0.0;
+    for (int k = (int)floor(lo + 0.5); k <= (int)ceil(hi - 0.5); k++) {
+        double overlap = fmin(hi, k + 0.5) - fmax(lo, k - 0.5);
+        if (k < -edge || k > edge || overlap <= 0.0) {
+            continue;
+        }
+        int channel = (k + p->M) % p->M;
+        // Los subcanales del borde cuentan en proporción a la parte que cae dentro del canal
+        *power += fmin(overlap, 1.0) * pfb_channel_power(p, channel);
+        if (overlap >= 0.5 && p->peak[channel] > *peak) {
+            *peak = p->peak[channel];
+        }
+        used++;
+    }
+    return used;
+}
+
+void pfb_reset(pfb_t* p)
+{
+    memset(p->hist, 0, 2 * (size_t)p->L * sizeof(complex double));
+    memset(p->power_acc, 0, (size_t)p->M * sizeof(double));
+    memset(p->peak, 0, (size_t)p->M * sizeof(double));
+    p->pos = 0;
+    p->n = 0;
+    p->phase = 0;
+    p->has_carry = false;
+    p->outputs = 0;
+    for (int i = 0; i < p->n_iq; i++) {
+        p->iq[i].len = 0;
+    }
+}
+
+void pfb_free(pfb_t* p)
+{
+    fft_plan_release(p->plan);
+    free(p->h);
+    free(p->hist);
+    fftw_free(p->fft_in);
+    fftw_free(p->fft_out);
+    free(p->power_acc);
+    free(p->peak);
+    memset(p, 0, sizeof(*p));
+}
@@ -0,0 +1,152 @@
+/**
+ * @file pfb.h
+ * @brief Canalizador por banco de filtros polifásico (PFB) para medir planes de canales densos.
+ *
+ * Divide la captura (`fs`, centrada en la sintonía) en `M = fs / separación`
+ * subcanales uniformes alineados con el raster de la banda, con una sola FFT
+ * de `M` puntos cada `D` muestras de entrada (`D = M` crítico, `D = M / 2`
+ * sobremuestreado). Cada subcanal es la salida de un mismo filtro prototipo
+ * pasabajos (sinc con ventana Blackman-Harris) desplazado a su frecuencia, lo
+ * que aísla los canales vecinos mucho mejor que los bins sueltos de una FFT.
+ *
+ * Por subcanal acumula la potencia media y la potencia instantánea máxima, y
+ * puede entregar la señal IQ de banda estrecha de algunos subcanales. Con
+ * ganancia unitaria en continua, un tono de amplitud A en el centro de un
+ * subcanal da potencia A^2, y el ruido blanco entra con el ancho de banda de la
+ * separación: las potencias son comparables con la PSD integrada en el canal.
+ */
+
+#ifndef PFB_H
+#define PFB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <complex.h>
+#include <fftw3.h>
+
+/**
+ * @def PFB_DEFAULT_TAPS
+ * @brief Coeficientes del prototipo por rama (longitud total `M * taps`).
+ */
+#define PFB_DEFAULT_TAPS 12
+
+/**
+ * @def PFB_MAX_IQ
+ * @brief Número máximo de subcanales de los que se guarda la señal IQ.
+ */
+#define PFB_MAX_IQ 8
+
+/**
+ * @struct pfb_iq_t
+ * @brief Destino de la señal IQ de un subcanal.
+ */
+typedef struct {
+    int channel;              /**< Subcanal (índice de la FFT). */
+    complex double* out;      /**< Muestras a `fs / D`. */
+    size_t capacity;          /**< Capacidad de `out`. */
+    size_t len;               /**< Muestras escritas. */
+} pfb_iq_t;
+
+/**
+ * @struct pfb_t
+ * @brief Estado del canalizador.
+ */
+typedef struct {
+    double fs;                /**< Frecuencia de muestreo de entrada. */
+    int M;                    /**< Subcanales (puntos de la FFT). */
+    int D;                    /**< Muestras de entrada por salida. */
+    int taps;                 /**< Coeficientes por rama. */
+    int L;                    /**< Longitud del prototipo (`M * taps`). */
+    double* h;                /**< Prototipo, con suma 1. */
+    complex double* hist;     /**< Últimas `L` muestras, duplicadas para leerlas contiguas. */
+    int pos;                  /**< Posición de escritura en `hist` (módulo `L`). */
+    uint64_t n;               /**< Muestras de entrada recibidas. */
+    int phase;                /**< Muestras desde la última salida. */
+    int8_t carry;             /**< Byte I pendiente si un buffer terminó en medio de una muestra. */
+    bool has_carry;           /**< Indica si `carry` es válido. */
+    complex double* fft_in;   /**< Entrada de la FFT (ramas sumadas y rotadas). */
+    complex double* fft_out;  /**< Subcanales de la salida actual. */
+    fftw_plan plan;           /**< Plan de la caché `fft_plan.h`. */
+    double* power_acc;        /**< Suma de |X_k|^2 por subcanal. */
+    double* peak;             /**< Máximo de |X_k|^2 por subcanal. */
+    uint64_t outputs;         /**< Salidas acumuladas. */
+    pfb_iq_t iq[PFB_MAX_IQ];  /**< Subcanales con salida IQ. */
+    int n_iq;                 /**< Entradas válidas en `iq`. */
+} pfb_t;
+
+/**
+ * @brief Prepara un canalizador.
+ *
+ * @param p Canalizador.
+ * @param fs Frecuencia de muestreo de entrada.
+ * @param spacing_hz Separación entre subcanales; `M = round(fs / spacing_hz)`.
+ * @param taps Coeficientes por rama (`PFB_DEFAULT_TAPS` si es <= 0).
+ * @param oversampled true: una salida cada `M / 2` muestras (menos aliasing en la IQ); false: cada `M`.
+ *
+ * @return 0 si se pudo crear, -1 en caso de error.
+ */
+int pfb_init(pfb_t* p, double fs, double spacing_hz, int taps, bool oversampled);
+
+/**
+ * @brief Separación de raster de un plan de canales: la menor entre la distancia
+ * entre frecuencias consecutivas y el menor ancho de banda.
+ *
+ * @param freq Frecuencias de los canales (cualquier unidad, p. ej. MHz de los CSV de `bands/`).
+ * @param bw Anchos de banda, en la misma unidad.
+ * @param n Número de canales.
+ *
+ * @return La separación, o 0 si no hay ningún valor positivo.
+ */
+double pfb_raster(const double* freq, const double* bw, int n);
+
+/**
+ * @brief Guarda la señal IQ de banda estrecha de un subcanal en `out`.
+ *
+ * @return 0 si se registró, -1 si el subcanal no existe o ya hay `PFB_MAX_IQ`.
+ */
+int pfb_attach_iq(pfb_t* p, int channel, complex double* out, size_t capacity);
+
+/**
+ * @brief Agrega un buffer CS8 (pares I/Q int8 intercalados).
+ */
+void pfb_push_cs8(pfb_t* p, const int8_t* buffer, size_t length);
+
+/**
+ * @brief Subcanal que contiene `offset_hz` (respecto a la sintonía), o -1 si cae fuera de la banda.
+ */
+int pfb_channel_index(const pfb_t* p, double offset_hz);
+
+/**
+ * @brief Potencia media del subcanal (0 si aún no hay salidas).
+ */
+double pfb_channel_power(const pfb_t* p, int channel);
+
+/**
+ * @brief Potencia instantánea máxima del subcanal.
+ */
+double pfb_channel_peak(const pfb_t* p, int channel);
+
+/**
+ * @brief Potencia y pico de un canal del plan que puede abarcar varios subcanales.
+ *
+ * Suma la potencia media de los subcanales que solapan
+ * [`offset_hz - bw_hz / 2`, `offset_hz + bw_hz / 2`], ponderada por la
+ * fracción de cada uno que cae dentro, y toma el mayor pico de los que están
+ * al menos a medias dentro.
+ *
+ * @return Subcanales usados, o 0 si el canal está fuera de la banda.
+ */
+int pfb_band_power(const pfb_t* p, double offset_hz, double bw_hz, double* power, double* peak);
+
+/**
+ * @brief Vacía los acumuladores, la historia y la salida IQ conservando filtro y plan.
+ */
+void pfb_reset(pfb_t* p);
+
+/**
+ * @brief Libera el canalizador.
+ */
+void pfb_free(pfb_t* p);
+
+#endif // PFB_H
@@ -0,0 +1,229 @@
+/**
+ * @file pipeline.c
+ * @brief Implementación de la tubería de etapas con colas acotadas.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pipeline.h"
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void queue_init(pipeline_queue_t* q)
+{
+    memset(q, 0, sizeof(*q));
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+}
+
+static void queue_destroy(pipeline_queue_t* q)
+{
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+}
+
+static void queue_push(pipeline_queue_t* q, void* job)
+{
+    pthread_mutex_lock(&q->lock);
+    while (q->count == PIPELINE_QUEUE_DEPTH) {
+        pthread_cond_wait(&q->not_full, &q->lock);
+    }
+    int tail = (q->head + q->count) % PIPELINE_QUEUE_DEPTH;
+    q->jobs[tail] = job;
+    q->enqueued[tail] = now_s();
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/**
+ * @brief Saca el siguiente trabajo; espera si la cola está vacía.
+ *
+ * @return false si la cola está cerrada y vacía.
+ */
+static bool queue_pop(pipeline_queue_t* q, void** job, double* enqueued)
+{
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0 && !q->closed) {
+        pthread_cond_wait(&q->not_empty, &q->lock);
+    }
+    if (q->count == 0) {
+        pthread_mutex_unlock(&q->lock);
+        return false;
+    }
+    *job = q->jobs[q->head];
+    *enqueued = q->enqueued[q->head];
+    q->head = (q->head + 1) % PIPELINE_QUEUE_DEPTH;
+    q->count--;
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return true;
+}
+
+static void queue_close(pipeline_queue_t* q)
+{
+    pthread_mutex_lock(&q->lock);
+    q->closed = true;
+    pthread_cond_broadcast(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+static void* stage_thread(void* arg)
+{
+    pipeline_stage_t* st = (pipeline_stage_t*)arg;
+    pipeline_t* p = (pipeline_t*)st->owner;
+    void* job;
+    double enqueued;
+
+    while (queue_pop(&st->input, &job, &enqueued)) {
+        double t0 = now_s();
+        int status = st->run(job);
+        double t1 = now_s();
+
+        pthread_mutex_lock(&p->lock);
+        st->jobs++;
+        st->busy_s += t1 - t0;
+        st->queued_s += t0 - enqueued;
+        if (t1 - t0 > st->max_s) {
+            st->max_s = t1 - t0;
+        }
+        if (status != 0) {
+            st->failed++;
+        }
+        pthread_mutex_unlock(&p->lock);
+
+        if (status == 0 && st->index + 1 < p->n_stages) {
+            // Si la etapa siguiente va atrasada, ésta espera: la cola acota la memoria en vuelo
+            queue_push(&p->stages[st->index + 1].input, job);
+            double t2 = now_s();
+            pthread_mutex_lock(&p->lock);
+            st->blocked_s += t2 - t1;
+            pthread_mutex_unlock(&p->lock);
+            continue;
+        }
+
+        if (p->done != NULL) {
+            p->done(job, status);
+        }
+        pthread_mutex_lock(&p->lock);
+        if (--p->in_flight == 0) {
+            pthread_cond_broadcast(&p->idle);
+        }
+        pthread_mutex_unlock(&p->lock);
+    }
+    return NULL;
+}
+
+void pipeline_init(pipeline_t* p, pipeline_done_fn done)
+{
+    memset(p, 0, sizeof(*p));
+    p->done = done;
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->idle, NULL);
+}
+
+int pipeline_add_stage(pipeline_t* p, const char* name, pipeline_stage_fn run)
+{
+    if (p->running || p->n_stages == PIPELINE_MAX_STAGES) {
+        fprintf(stderr, "Error: Unable to add pipeline stage %s\n", name);
+        return -1;
+    }
+    pipeline_stage_t* st = &p->stages[p->n_stages];
+    memset(st, 0, sizeof(*st));
+    st->name = name;
+    st->run = run;
+    st->owner = p;
+    st->index = p->n_stages;
+    queue_init(&st->input);
+    p->n_stages++;
+    return 0;
+}
+
+int pipeline_start(pipeline_t* p)
+{
+    for (int i = 0; i < p->n_stages; i++) {
+        if (pthread_create(&p->stages[i].thread, NULL, stage_thread, &p->stages[i]) != 0) {
+            fprintf(stderr, "Error: Unable to start pipeline stage %s\n", p->stages[i].name);
+            // Detener las que sí arrancaron
+            for (int j = 0; j < i; j++) {
+                queue_close(&p->stages[j].input);
+                pthread_join(p->stages[j].thread, NULL);
+            }
+            return -1;
+        }
+    }
+    p->started = now_s();
+    p->running = true;
+    return 0;
+}
+
+int pipeline_submit(pipeline_t* p, void* job)
+{
+    if (!p->running || p->n_stages == 0) {
+        return -1;
+    }
+    pthread_mutex_lock(&p->lock);
+    p->in_flight++;
+    pthread_mutex_unlock(&p->lock);
+
+    queue_push(&p->stages[0].input, job);
+    return 0;
+}
+
+void pipeline_wait_idle(pipeline_t* p)
+{
+    pthread_mutex_lock(&p->lock);
+    while (p->in_flight > 0) {
+        pthread_cond_wait(&p->idle, &p->lock);
+    }
+    pthread_mutex_unlock(&p->lock);
+}
+
+void pipeline_report(pipeline_t* p)
+{
+    pthread_mutex_lock(&p->lock);
+    double elapsed = now_s() - p->started;
+    int critical = 0;
+    for (int i = 1; i < p->n_stages; i++) {
+        if (p->stages[i].busy_s > p->stages[critical].busy_s) {
+            critical = i;
+        }
+    }
+    for (int i = 0; i < p->n_stages; i++) {
+        const pipeline_stage_t* st = &p->stages[i];
+        double n = st->jobs > 0 ? (double)st->jobs : 1.0;
+        printf("[pipeline] %-10s jobs=%lu failed=%lu avg=%.1f ms max=%.1f ms queued=%.1f ms blocked=%.1f ms busy=%.0f%%%s\n",
+               st->name, st->jobs, st->failed,
+               1e3 * st->busy_s / n, 1e3 * st->max_s,
+               1e3 * st->queued_s / n, 1e3 * st->blocked_s / n,
+               elapsed > 0 ? 100.0 * st->busy_s / elapsed : 0.0,
+               (i == critical && st->jobs > 0) ? "  <- critical path" : "");
+    }
+    pthread_mutex_unlock(&p->lock);
+}
+
+void pipeline_stop(pipeline_t* p)
+{
+    if (p->running) {
+        pipeline_wait_idle(p);
+        for (int i = 0; i < p->n_stages; i++) {
+            queue_close(&p->stages[i].input);
+            pthread_join(p->stages[i].thread, NULL);
+        }
+        p->running = false;
+    }
+    for (int i = 0; i < p->n_stages; i++) {
+        queue_destroy(&p->stages[i].input);
+    }
+    p->n_stages = 0;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file pipeline.h
+ * @brief Tubería de etapas con colas acotadas y un hilo por etapa.
+ *
+ * Cada trabajo recorre las etapas en orden; entre una etapa y la siguiente hay
+ * una cola de `PIPELINE_QUEUE_DEPTH` trabajos. Así la primera etapa (la
+ * captura) puede avanzar con el trabajo siguiente mientras las demás procesan
+ * el actual, y si el análisis se atrasa la cola llena frena a la captura en
+ * lugar de acumular muestras sin límite. Cada etapa mide su tiempo de trabajo
+ * y de espera para identificar el camino crítico.
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+/**
+ * @def PIPELINE_MAX_STAGES
+ * @brief Número máximo de etapas.
+ */
+#define PIPELINE_MAX_STAGES 8
+
+/**
+ * @def PIPELINE_QUEUE_DEPTH
+ * @brief Trabajos que caben en la cola de entrada de cada etapa.
+ */
+#define PIPELINE_QUEUE_DEPTH 2
+
+/**
+ * @brief Función de una etapa. Devuelve 0 si el trabajo sigue, distinto de 0 para descartarlo.
+ */
+typedef int (*pipeline_stage_fn)(void* job);
+
+/**
+ * @brief Se llama al terminar un trabajo (o al descartarlo), desde el hilo de la última etapa que lo tocó.
+ *
+ * @param job Trabajo.
+ * @param status 0 si pasó por todas las etapas, o lo que devolvió la etapa que lo descartó.
+ */
+typedef void (*pipeline_done_fn)(void* job, int status);
+
+/**
+ * @struct pipeline_queue_t
+ * @brief Cola acotada de trabajos con el instante en que entró cada uno.
+ */
+typedef struct {
+    void* jobs[PIPELINE_QUEUE_DEPTH];          /**< Trabajos en cola. */
+    double enqueued[PIPELINE_QUEUE_DEPTH];     /**< Instante de entrada de cada trabajo (s). */
+    int head;                                  /**< Posición del siguiente trabajo a sacar. */
+    int count;                                 /**< Trabajos en cola. */
+    bool closed;                               /**< No entrarán más trabajos. */
+    pthread_mutex_t lock;                      /**< Protege la cola. */
+    pthread_cond_t not_empty;                  /**< Hay trabajos o la cola se cerró. */
+    pthread_cond_t not_full;                   /**< Hay sitio. */
+} pipeline_queue_t;
+
+/**
+ * @struct pipeline_stage_t
+ * @brief Etapa y sus estadísticas.
+ */
+typedef struct {
+    const char* name;           /**< Nombre para el informe. */
+    pipeline_stage_fn run;      /**< Trabajo de la etapa. */
+    pipeline_queue_t input;     /**< Cola de entrada. */
+    pthread_t thread;           /**< Hilo de la etapa. */
+    void* owner;                /**< Tubería a la que pertenece. */
+    int index;                  /**< Posición en la tubería. */
+    uint64_t jobs;              /**< Trabajos procesados. */
+    uint64_t failed;            /**< Trabajos descartados en esta etapa. */
+    double busy_s;              /**< Tiempo total dentro de `run`. */
+    double max_s;               /**< Mayor tiempo de un trabajo en `run`. */
+    double queued_s;            /**< Tiempo total de los trabajos esperando en `input`. */
+    double blocked_s;           /**< Tiempo total esperando sitio en la cola siguiente. */
+} pipeline_stage_t;
+
+/**
+ * @struct pipeline_t
+ * @brief Tubería completa.
+ */
+typedef struct {
+    pipeline_stage_t stages[PIPELINE_MAX_STAGES]; /**< Etapas en orden. */
+    int n_stages;                                 /**< Etapas registradas. */
+    pipeline_done_fn done;                        /**< Fin de cada trabajo. */
+    bool running;                                 /**< Los hilos están en marcha. */
+    double started;                               /**< Instante de `pipeline_start` (s). */
+    pthread_mutex_t lock;                         /**< Protege `in_flight` y las estadísticas. */
+    pthread_cond_t idle;                          /**< `in_flight` llegó a 0. */
+    int in_flight;                                /**< Trabajos dentro de la tubería. */
+} pipeline_t;
+
+/**
+ * @brief Prepara una tubería vacía.
+ *
+ * @param p Tubería.
+ * @param done Se llama al terminar o descartar cada trabajo (puede ser NULL).
+ */
+void pipeline_init(pipeline_t* p, pipeline_done_fn done);
+
+/**
+ * @brief Agrega una etapa al final. Sólo antes de `pipeline_start`.
+ *
+ * @return 0 si se agregó, -1 si no caben más etapas.
+ */
+int pipeline_add_stage(pipeline_t* p, const char* name, pipeline_stage_fn run);
+
+/**
+ * @brief Arranca un hilo por etapa.
+ *
+ * @return 0 si todas arrancaron, -1 en caso de error.
+ */
+int pipeline_start(pipeline_t* p);
+
+/**
+ * @brief Entrega un trabajo a la primera etapa; espera si su cola está llena.
+ *
+ * @return 0 si se aceptó, -1 si la tubería no está en marcha.
+ */
+int pipeline_submit(pipeline_t* p, void* job);
+
+/**
+ * @brief Espera a que no quede ningún trabajo en la tubería.
+ */
+void pipeline_wait_idle(pipeline_t* p);
+
+/**
+ * @brief Imprime, por etapa, trabajos, tiempo medio y máximo, espera en cola y ocupación.
+ *
+ * La etapa con más tiempo de trabajo acumulado se marca como camino crítico.
+ */
+void pipeline_report(pipeline_t* p);
+
+/**
+ * @brief Termina los trabajos pendientes y detiene los hilos.
+ */
+void pipeline_stop(pipeline_t* p);
+
+#endif // PIPELINE_H
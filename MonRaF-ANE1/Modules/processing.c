@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include "welch.h"
+#include "cs8_convert.h"
 #include "processing.h"
 
 void remove_dc(complex double* x, size_t N) {
@@ -23,10 +24,33 @@ void compute_welch_psd(complex double* x, size_t N, double fs,
 
     welch_psd_complex(x, N, fs, segment_length, overlap, f, Pxx);
 
-    const double eps = 1e-15;
-    for (int i = 0; i < segment_length; i++) {
-        Pxx_dB[i] = 10.0 * log10(Pxx[i] + eps);
+    psd_to_db(Pxx, Pxx_dB, segment_length);
+
+    free(Pxx);
+}
+
+void compute_welch_psd_cs8(const int8_t* raw, size_t N, double fs,
+                           int segment_length, double overlap, window_type_t window,
+                           double* f, double* Pxx_dB) {
+
+    double* Pxx = malloc(segment_length * sizeof(double));
+    if (!Pxx) {
+        fprintf(stderr, "❌ Error al reservar memoria para Pxx\n");
+        return;
     }
 
+    // Equivale a remove_dc + compute_welch_psd sin tocar la captura
+    welch_res_t res = { .segment_length = segment_length, .f_out = f, .P_welch_out = Pxx, .window = window };
+    welch_psd_cs8_dc(raw, N, fs, overlap, cs8_mean(raw, N), &res, 1);
+
+    psd_to_db(Pxx, Pxx_dB, segment_length);
+
     free(Pxx);
 }
+
+void psd_to_db(const double* Pxx, double* Pxx_dB, int length) {
+    const double eps = 1e-15;
+    for (int i = 0; i < length; i++) {
+        Pxx_dB[i] = 10.0 * log10(Pxx[i] + eps);
+    }
+}
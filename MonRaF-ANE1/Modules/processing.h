@@ -3,10 +3,16 @@
 
 #include <complex.h>
 #include <stddef.h>
+#include <stdint.h>
+#include "window.h"
 
 void remove_dc(complex double* x, size_t N);
 void compute_welch_psd(complex double* x, size_t N, double fs,
                        int segment_length, double overlap,
                        double* f, double* Pxx_dB);
+void compute_welch_psd_cs8(const int8_t* raw, size_t N, double fs,
+                           int segment_length, double overlap, window_type_t window,
+                           double* f, double* Pxx_dB);
+void psd_to_db(const double* Pxx, double* Pxx_dB, int length);
 
 #endif
@@ -0,0 +1,342 @@
+/**
+ * @file psd_archive.c
+ * @brief Implementación del archivo circular de registros PSD sobre un mapeo compartido.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "psd_archive.h"
+
+/** @brief "PSDA" en little-endian. */
+#define PSD_ARCHIVE_MAGIC 0x41445350u
+#define PSD_ARCHIVE_VERSION 2
+
+/** @brief La cabecera ocupa una página para que las ranuras queden alineadas. */
+#define PSD_ARCHIVE_HEADER_SIZE 4096
+
+/**
+ * @struct archive_header_t
+ * @brief Cabecera del archivo.
+ */
+typedef struct {
+    uint32_t magic;               /**< `PSD_ARCHIVE_MAGIC`. */
+    uint32_t version;             /**< `PSD_ARCHIVE_VERSION`. */
+    uint32_t n_slots;             /**< Número de ranuras. */
+    uint32_t slot_size;           /**< Tamaño de cada ranura en bytes. */
+    _Atomic uint64_t next_seq;    /**< Siguiente número de secuencia a entregar. */
+} archive_header_t;
+
+/**
+ * @struct archive_slot_t
+ * @brief Cabecera de una ranura; el registro va a continuación.
+ *
+ * `state` vale 0 si la ranura nunca se usó, 2 * seq + 1 mientras se escribe el
+ * registro `seq` y 2 * seq + 2 cuando está completo.
+ */
+typedef struct {
+    _Atomic uint64_t state;  /**< Contador seqlock. */
+    uint32_t length;         /**< Bytes del registro. */
+    uint32_t reserved;       /**< Relleno hasta 16 bytes. */
+} archive_slot_t;
+
+/** @brief Archivo del proceso usado por `psd_archive_publish`. */
+static psd_archive_t default_archive;
+
+/** @brief Indica si `default_archive` está abierto. */
+static bool default_ready = false;
+
+static archive_header_t* archive_header(const psd_archive_t* archive)
+{
+    return (archive_header_t*)archive->base;
+}
+
+static archive_slot_t* archive_slot(const psd_archive_t* archive, uint64_t seq)
+{
+    uint8_t* slots = (uint8_t*)archive->base + PSD_ARCHIVE_HEADER_SIZE;
+    return (archive_slot_t*)(slots + (size_t)(seq % archive->n_slots) * archive->slot_size);
+}
+
+static size_t archive_length(uint32_t n_slots, uint32_t slot_size)
+{
+    return PSD_ARCHIVE_HEADER_SIZE + (size_t)n_slots * slot_size;
+}
+
+int psd_archive_open(psd_archive_t* archive, const char* path, uint32_t n_slots, uint32_t slot_size)
+{
+    memset(archive, 0, sizeof(*archive));
+
+    if (n_slots > 0 && (slot_size <= sizeof(archive_slot_t) + sizeof(psd_record_header_t) ||
+                        slot_size % 64 != 0)) {
+        fprintf(stderr, "Error: tamaño de ranura inválido (%u)\n", slot_size);
+        return -1;
+    }
+
+    int fd = open(path, n_slots > 0 ? (O_RDWR | O_CREAT) : O_RDWR, 0644);
+    if (fd < 0) {
+        perror("Error al abrir el archivo de historial");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror("Error en fstat");
+        close(fd);
+        return -1;
+    }
+
+    // Reutilizar el archivo si su cabecera es válida y su geometría coincide
+    bool reuse = false;
+    if ((size_t)st.st_size >= PSD_ARCHIVE_HEADER_SIZE) {
+        archive_header_t hdr;
+        if (pread(fd, &hdr, sizeof(hdr), 0) == (ssize_t)sizeof(hdr) &&
+            hdr.magic == PSD_ARCHIVE_MAGIC && hdr.version == PSD_ARCHIVE_VERSION &&
+            hdr.n_slots > 0 &&
+            (size_t)st.st_size == archive_length(hdr.n_slots, hdr.slot_size) &&
+            (n_slots == 0 || (hdr.n_slots == n_slots && hdr.slot_size == slot_size))) {
+            n_slots = hdr.n_slots;
+            slot_size = hdr.slot_size;
+            reuse = true;
+        }
+    }
+
+    if (!reuse) {
+        if (n_slots == 0) {
+            fprintf(stderr, "Error: %s no es un archivo de historial válido\n", path);
+            close(fd);
+            return -1;
+        }
+        // ftruncate a 0 primero para que todas las ranuras vuelvan a estar vacías
+        if (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t)archive_length(n_slots, slot_size)) != 0) {
+            perror("Error al dimensionar el archivo de historial");
+            close(fd);
+            return -1;
+        }
+    }
+
+    size_t length = archive_length(n_slots, slot_size);
+    void* base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("Error en mmap");
+        return -1;
+    }
+
+    archive->base = base;
+    archive->length = length;
+    archive->n_slots = n_slots;
+    archive->slot_size = slot_size;
+
+    if (!reuse) {
+        archive_header_t* hdr = archive_header(archive);
+        hdr->n_slots = n_slots;
+        hdr->slot_size = slot_size;
+        hdr->version = PSD_ARCHIVE_VERSION;
+        atomic_store(&hdr->next_seq, 0);
+        // La firma va al final: un lector nunca ve una cabecera a medias
+        atomic_thread_fence(memory_order_release);
+        hdr->magic = PSD_ARCHIVE_MAGIC;
+    }
+    return 0;
+}
+
+int64_t psd_archive_append(psd_archive_t* archive, const psd_record_header_t* hdr,
+                           const double* psd_db, const double* params)
+{
+    size_t cap = archive->slot_size - sizeof(archive_slot_t);
+    if (psd_record_size(hdr) > cap) {
+        fprintf(stderr, "Error: el registro (%zu bytes) no cabe en una ranura de %u\n",
+                psd_record_size(hdr), archive->slot_size);
+        return -1;
+    }
+
+    uint64_t seq = atomic_fetch_add(&archive_header(archive)->next_seq, 1);
+    archive_slot_t* slot = archive_slot(archive, seq);
+
+    atomic_store_explicit(&slot->state, 2 * seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    slot->length = (uint32_t)psd_record_encode(slot + 1, cap, hdr, psd_db, params);
+
+    atomic_store_explicit(&slot->state, 2 * seq + 2, memory_order_release);
+    return (int64_t)seq;
+}
+
+int64_t psd_archive_read(const psd_archive_t* archive, int64_t seq, void* buf, size_t len)
+{
+    if (seq < 0) {
+        return 0;
+    }
+
+    const archive_slot_t* slot = archive_slot(archive, (uint64_t)seq);
+    uint64_t expected = 2 * (uint64_t)seq + 2;
+
+    if (atomic_load_explicit(&slot->state, memory_order_acquire) != expected) {
+        return 0;
+    }
+
+    size_t length = slot->length;
+    size_t copy = length;
+    if (copy > len) copy = len;
+    if (copy > archive->slot_size - sizeof(archive_slot_t)) copy = 0;
+    memcpy(buf, slot + 1, copy);
+
+    // Si la ranura cambió durante la copia, el contenido no sirve
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&slot->state, memory_order_relaxed) != expected) {
+        return 0;
+    }
+    if (length > len) {
+        return -1;
+    }
+    return (int64_t)length;
+}
+
+int64_t psd_archive_last(const psd_archive_t* archive)
+{
+    uint64_t next = atomic_load(&archive_header(archive)->next_seq);
+    return (int64_t)next - 1;
+}
+
+/**
+ * @brief Escribe el JSON en `<path>.tmp` y lo renombra sobre `path`.
+ *
+ * El cliente lee el archivo en cuanto recibe el aviso: con `rename` ve el JSON
+ * anterior o el nuevo completo, nunca uno a medio escribir ni ausente.
+ */
+static int write_json(const psd_record_view_t* view, const char* path)
+{
+    char tmp_path[PATH_MAX];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+        fprintf(stderr, "Error: ruta de JSON demasiado larga: %s\n", path);
+        return -1;
+    }
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        printf("Error al abrir el archivo para escribir.\n");
+        return -1;
+    }
+    int result = psd_record_write_json(view, fd);
+    if (close(fd) != 0) {
+        result = -1;
+    }
+    if (result == 0 && rename(tmp_path, path) != 0) {
+        perror("Error al publicar el JSON");
+        result = -1;
+    }
+    if (result != 0) {
+        unlink(tmp_path);
+    }
+    return result;
+}
+
+int psd_archive_export_json(const psd_archive_t* archive, int64_t seq, const char* path)
+{
+    void* buf = malloc(archive->slot_size);
+    if (buf == NULL) {
+        fprintf(stderr, "Error: sin memoria para exportar el registro\n");
+        return -1;
+    }
+
+    int result = -1;
+    int64_t length = psd_archive_read(archive, seq, buf, archive->slot_size);
+    psd_record_view_t view;
+    if (length <= 0) {
+        fprintf(stderr, "Error: el registro %lld no está disponible\n", (long long)seq);
+    } else if (psd_record_decode(buf, (size_t)length, &view) == 0) {
+        result = write_json(&view, path);
+    }
+
+    free(buf);
+    return result;
+}
+
+void psd_archive_close(psd_archive_t* archive)
+{
+    if (archive->base != NULL) {
+        munmap(archive->base, archive->length);
+    }
+    memset(archive, 0, sizeof(*archive));
+}
+
+uint32_t psd_archive_slot_size(uint16_t max_params)
+{
+    psd_record_header_t widest;
+    psd_record_init(&widest, PSD_MEASURE_RMER, 0, "", 0.0, 0.0, PSD_ARCHIVE_PSD_BINS, max_params);
+    widest.param_cols = PSD_RMER_INTEGRATED_COLS;
+
+    size_t size = sizeof(archive_slot_t) + psd_record_size(&widest);
+    return (uint32_t)((size + 63) & ~(size_t)63);
+}
+
+int psd_archive_init(const char* path, uint16_t max_params)
+{
+    if (default_ready) {
+        psd_archive_close(&default_archive);
+        default_ready = false;
+    }
+    if (psd_archive_open(&default_archive, path, PSD_ARCHIVE_SLOTS, psd_archive_slot_size(max_params)) != 0) {
+        return -1;
+    }
+    default_ready = true;
+    printf("[psd] Historial en %s (%lld registros previos)\n", path,
+           (long long)psd_archive_last(&default_archive) + 1);
+    return 0;
+}
+
+int psd_archive_publish(const psd_record_header_t* hdr, const double* psd_db,
+                        const double* params, const char* json_path)
+{
+    if (default_ready) {
+        int64_t seq = psd_archive_append(&default_archive, hdr, psd_db, params);
+        if (seq < 0) {
+            return -1;
+        }
+        if (psd_archive_export_json(&default_archive, seq, json_path) == 0) {
+            return 0;
+        }
+    }
+
+    // Sin historial (o si el registro ya fue pisado): convertir desde un buffer propio
+    size_t size = psd_record_size(hdr);
+    void* buf = malloc(size);
+    if (buf == NULL) {
+        fprintf(stderr, "Error: sin memoria para el registro\n");
+        return -1;
+    }
+
+    int result = -1;
+    psd_record_view_t view;
+    if (psd_record_encode(buf, size, hdr, psd_db, params) == size &&
+        psd_record_decode(buf, size, &view) == 0) {
+        result = write_json(&view, json_path);
+    }
+
+    free(buf);
+    return result;
+}
+
+void psd_archive_cleanup(void)
+{
+    if (default_ready) {
+        psd_archive_close(&default_archive);
+        default_ready = false;
+    }
+}
+
+void psd_publication_free(psd_publication_t* pub)
+{
+    free(pub->psd_db);
+    free(pub->params);
+    pub->psd_db = NULL;
+    pub->params = NULL;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file psd_archive.h
+ * @brief Archivo circular en disco, mapeado en memoria, con el historial de registros PSD.
+ *
+ * El archivo tiene una página de cabecera seguida de `n_slots` ranuras de
+ * `slot_size` bytes. Cada `psd_archive_append` toma un número de secuencia
+ * creciente y escribe el registro en la ranura `seq % n_slots`, pisando el más
+ * antiguo. Cada ranura lleva un contador tipo seqlock (impar mientras se
+ * escribe), así que ni los escritores ni los lectores se bloquean: el lector
+ * copia el registro y descarta la copia si la ranura cambió mientras leía.
+ * El mapeo es compartido, por lo que otro proceso puede abrir el mismo archivo
+ * y leer el historial sin pasar por el proceso de medición.
+ */
+
+#ifndef PSD_ARCHIVE_H
+#define PSD_ARCHIVE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "psd_record.h"
+
+/**
+ * @def PSD_ARCHIVE_FILE
+ * @brief Archivo del historial por defecto (relativo al directorio de trabajo).
+ */
+#define PSD_ARCHIVE_FILE "Outputs/psd_archive.bin"
+
+/**
+ * @def PSD_ARCHIVE_SLOTS
+ * @brief Número de registros que conserva el archivo por defecto.
+ */
+#define PSD_ARCHIVE_SLOTS 256
+
+/**
+ * @def PSD_ARCHIVE_PSD_BINS
+ * @brief Puntos de la PSD publicada por RMER, RNI y TDT.
+ */
+#define PSD_ARCHIVE_PSD_BINS 4096
+
+/**
+ * @struct psd_archive_t
+ * @brief Archivo abierto.
+ */
+typedef struct {
+    void* base;           /**< Inicio del mapeo. */
+    size_t length;        /**< Tamaño del mapeo en bytes. */
+    uint32_t n_slots;     /**< Número de ranuras. */
+    uint32_t slot_size;   /**< Tamaño de cada ranura en bytes. */
+} psd_archive_t;
+
+/**
+ * @brief Abre (o crea) un archivo circular.
+ *
+ * Si el archivo existe y su cabecera es válida se reutiliza con su geometría;
+ * si no existe, o su geometría no coincide con la pedida, se crea de nuevo.
+ *
+ * @param archive Archivo a inicializar.
+ * @param path Ruta en disco.
+ * @param n_slots Número de ranuras; 0 sólo abre un archivo existente (para lectores).
+ * @param slot_size Tamaño de cada ranura en bytes.
+ *
+ * @return 0 si el archivo quedó mapeado, -1 en caso de error.
+ */
+int psd_archive_open(psd_archive_t* archive, const char* path, uint32_t n_slots, uint32_t slot_size);
+
+/**
+ * @brief Añade un registro, sobrescribiendo el más antiguo si el archivo está lleno.
+ *
+ * El registro se codifica directamente en la ranura, sin copias intermedias.
+ * Es seguro llamarla desde varios hilos o procesos a la vez.
+ *
+ * @return Número de secuencia del registro, o -1 si no cabe en una ranura.
+ */
+int64_t psd_archive_append(psd_archive_t* archive, const psd_record_header_t* hdr,
+                           const double* psd_db, const double* params);
+
+/**
+ * @brief Copia el registro `seq` en `buf`.
+ *
+ * @return Bytes copiados, 0 si el registro ya fue sobrescrito o se está
+ *         escribiendo, o -1 si `buf` es demasiado pequeño.
+ */
+int64_t psd_archive_read(const psd_archive_t* archive, int64_t seq, void* buf, size_t len);
+
+/**
+ * @brief Número de secuencia del último registro añadido, o -1 si el archivo está vacío.
+ */
+int64_t psd_archive_last(const psd_archive_t* archive);
+
+/**
+ * @brief Convierte el registro `seq` al JSON que consume `Socket/client.js` y lo escribe en `path`.
+ *
+ * El JSON se escribe en `<path>.tmp` y se renombra sobre `path`, de modo que
+ * un lector nunca ve el archivo ausente o incompleto.
+ *
+ * @return 0 si se escribió el archivo, -1 en caso de error.
+ */
+int psd_archive_export_json(const psd_archive_t* archive, int64_t seq, const char* path);
+
+/**
+ * @brief Desmapea el archivo.
+ */
+void psd_archive_close(psd_archive_t* archive);
+
+/**
+ * @brief Tamaño de ranura para el registro más grande con `max_params` filas.
+ *
+ * Cuenta `PSD_ARCHIVE_PSD_BINS` puntos float32 y la tabla más ancha
+ * (`PSD_RMER_INTEGRATED_COLS` columnas), redondeado a 64 bytes.
+ */
+uint32_t psd_archive_slot_size(uint16_t max_params);
+
+/**
+ * @brief Abre el archivo del proceso en `path` con ranuras para `max_params` filas.
+ *
+ * @param path Ruta en disco.
+ * @param max_params Filas del registro más grande (canales de la banda más grande, `band_registry_max_channels`).
+ *
+ * @return 0 si el archivo quedó abierto, -1 en caso de error.
+ */
+int psd_archive_init(const char* path, uint16_t max_params);
+
+/**
+ * @struct psd_publication_t
+ * @brief Medición calculada que espera ser publicada (cabecera, PSD en dB y parámetros).
+ */
+typedef struct {
+    psd_record_header_t record;  /**< Cabecera del registro. */
+    double* psd_db;              /**< `record.n_bins` valores, reservados con malloc. */
+    double* params;              /**< `record.n_params` filas, reservadas con malloc. */
+} psd_publication_t;
+
+/**
+ * @brief Libera la PSD y los parámetros de una publicación.
+ */
+void psd_publication_free(psd_publication_t* pub);
+
+/**
+ * @brief Guarda una medición en el archivo del proceso y escribe su JSON en `json_path`.
+ *
+ * Si `psd_archive_init` no se llamó (o falló) el registro sólo se convierte a
+ * JSON, de modo que las mediciones siguen funcionando sin historial. Un
+ * registro que no cabe en una ranura del archivo abierto es un error: no se
+ * publica, para que no falte en el historial sin que nadie lo note.
+ *
+ * @return 0 si se escribió el JSON, -1 en caso de error.
+ */
+int psd_archive_publish(const psd_record_header_t* hdr, const double* psd_db,
+                        const double* params, const char* json_path);
+
+/**
+ * @brief Cierra el archivo del proceso.
+ */
+void psd_archive_cleanup(void);
+
+#endif // PSD_ARCHIVE_H
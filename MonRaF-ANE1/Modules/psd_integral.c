@@ -0,0 +1,113 @@
+/**
+ * @file psd_integral.c
+ * @brief Implementación de la potencia integrada y el ancho de banda ocupado.
+ *
+ * Como la PSD no es negativa, la suma acumulada es no decreciente también en
+ * coma flotante, y la bisección siempre encuentra el primer bin en el que se
+ * alcanza un nivel dado.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "psd_integral.h"
+
+int psd_integral_init(psd_integral_t* pi, const double* psd, int n, double df)
+{
+    pi->psd = psd;
+    pi->n = n;
+    pi->df = df;
+    pi->cum = (double*)malloc(((size_t)n + 1) * sizeof(double));
+    if (pi->cum == NULL) {
+        fprintf(stderr, "Error: Unable to allocate PSD cumulative sum\n");
+        return -1;
+    }
+
+    double acc = 0.0;
+    pi->cum[0] = 0.0;
+    for (int i = 0; i < n; i++) {
+        acc += psd[i];
+        pi->cum[i + 1] = acc;
+    }
+    return 0;
+}
+
+/**
+ * @brief Ajusta el tramo a la PSD; un tramo vacío pasa a ser el bin `lower`.
+ */
+static void clamp_range(const psd_integral_t* pi, int* lower, int* upper)
+{
+    if (*lower < 0) *lower = 0;
+    if (*lower > pi->n - 1) *lower = pi->n - 1;
+    if (*upper > pi->n) *upper = pi->n;
+    if (*upper <= *lower) *upper = *lower + 1;
+}
+
+double psd_integral_power(const psd_integral_t* pi, int lower, int upper)
+{
+    clamp_range(pi, &lower, &upper);
+    return (pi->cum[upper] - pi->cum[lower]) * pi->df;
+}
+
+/**
+ * @brief Posición fraccionaria (en bins) en la que la suma acumulada alcanza `level`, dentro de [`lower`, `upper`].
+ */
+static double crossing(const psd_integral_t* pi, int lower, int upper, double level)
+{
+    // Primer k en (lower, upper] con cum[k] >= level
+    int lo = lower + 1;
+    int hi = upper;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (pi->cum[mid] >= level) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    // El nivel se cruza dentro del bin lo - 1
+    double bin = pi->cum[lo] - pi->cum[lo - 1];
+    double frac = (bin > 0.0) ? (level - pi->cum[lo - 1]) / bin : 0.0;
+    if (frac < 0.0) frac = 0.0;
+    if (frac > 1.0) frac = 1.0;
+    return (lo - 1) + frac;
+}
+
+double psd_integral_obw(const psd_integral_t* pi, int lower, int upper, double fraction)
+{
+    clamp_range(pi, &lower, &upper);
+    double total = pi->cum[upper] - pi->cum[lower];
+    if (!(total > 0.0)) {
+        return 0.0;
+    }
+
+    double tail = 0.5 * (1.0 - fraction) * total;
+    double start = crossing(pi, lower, upper, pi->cum[lower] + tail);
+    double stop = crossing(pi, lower, upper, pi->cum[upper] - tail);
+    return (stop - start) * pi->df;
+}
+
+double psd_integral_xdb_bandwidth(const psd_integral_t* pi, int lower, int upper, double peak, double x_db)
+{
+    clamp_range(pi, &lower, &upper);
+    double level = peak * pow(10.0, -x_db / 10.0);
+
+    // Desde los bordes hacia dentro: se detiene en cuanto la señal aparece
+    int first = lower;
+    while (first < upper - 1 && pi->psd[first] < level) {
+        first++;
+    }
+    int last = upper - 1;
+    while (last > first && pi->psd[last] < level) {
+        last--;
+    }
+    return (last - first + 1) * pi->df;
+}
+
+void psd_integral_free(psd_integral_t* pi)
+{
+    free(pi->cum);
+    pi->cum = NULL;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file psd_integral.h
+ * @brief Potencia integrada y ancho de banda ocupado por canal a partir de la suma acumulada de una PSD.
+ *
+ * Se construye una vez por medición la suma acumulada de la PSD lineal,
+ * `cum[i] = Σ psd[0, i)`. Con ella la potencia de cualquier tramo de bins
+ * [`lower`, `upper`) es una resta, y los puntos que dejan fuera una fracción
+ * de esa potencia por cada lado (ancho de banda ocupado, ITU-R SM.328) se
+ * buscan por bisección sobre el mismo arreglo, dentro del bin con
+ * interpolación lineal. Ningún cálculo por canal recorre sus bins, salvo el
+ * ancho a x dB, que depende del perfil y no de la potencia acumulada.
+ */
+
+#ifndef PSD_INTEGRAL_H
+#define PSD_INTEGRAL_H
+
+/**
+ * @def PSD_OBW_FRACTION
+ * @brief Fracción de la potencia del canal que encierra el ancho de banda ocupado.
+ */
+#define PSD_OBW_FRACTION (0.99)
+
+/**
+ * @def PSD_XDB_BANDWIDTH_DB
+ * @brief Caída respecto al pico con la que se mide el ancho de banda a x dB.
+ */
+#define PSD_XDB_BANDWIDTH_DB (26.0)
+
+/**
+ * @struct psd_integral_t
+ * @brief Suma acumulada de una PSD.
+ */
+typedef struct {
+    const double* psd;   /**< PSD lineal (densidad por Hz); no se copia. */
+    double* cum;         /**< `n + 1` elementos: `cum[i]` es la suma de `psd[0, i)`. */
+    int n;               /**< Bins de la PSD. */
+    double df;           /**< Separación entre bins en Hz. */
+} psd_integral_t;
+
+/**
+ * @brief Construye la suma acumulada de `psd`.
+ *
+ * La PSD debe seguir viva y sin cambios mientras se use `pi`.
+ *
+ * @param pi Estructura a completar.
+ * @param psd PSD lineal, no negativa.
+ * @param n Bins de la PSD.
+ * @param df Separación entre bins en Hz (`fs / nfft`).
+ *
+ * @return 0 si se construyó, -1 en caso de error.
+ */
+int psd_integral_init(psd_integral_t* pi, const double* psd, int n, double df);
+
+/**
+ * @brief Potencia integrada del tramo [`lower`, `upper`) (el bin `lower` si está vacío).
+ */
+double psd_integral_power(const psd_integral_t* pi, int lower, int upper);
+
+/**
+ * @brief Ancho de banda en Hz que encierra `fraction` de la potencia del tramo, dejando la mitad del resto a cada lado.
+ *
+ * @return El ancho de banda, o 0 si el tramo no tiene potencia.
+ */
+double psd_integral_obw(const psd_integral_t* pi, int lower, int upper, double fraction);
+
+/**
+ * @brief Ancho de banda en Hz entre los bins más externos del tramo que no caen más de `x_db` por debajo de `peak`.
+ *
+ * @param peak Máximo del tramo (lineal), p. ej. `channel_stats_t::max`.
+ */
+double psd_integral_xdb_bandwidth(const psd_integral_t* pi, int lower, int upper, double peak, double x_db);
+
+/**
+ * @brief Libera la suma acumulada.
+ */
+void psd_integral_free(psd_integral_t* pi);
+
+#endif // PSD_INTEGRAL_H
@@ -0,0 +1,254 @@
+/**
+ * @file psd_record.c
+ * @brief Codificación, validación y conversión a JSON de los registros de medición.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "psd_record.h"
+#include "json_writer.h"
+
+static size_t psd_bytes(const psd_record_header_t* hdr)
+{
+    size_t width = (hdr->format == PSD_FORMAT_I16_CDB) ? sizeof(int16_t) : sizeof(float);
+    // La tabla de parámetros queda alineada a 8 bytes
+    return ((size_t)hdr->n_bins * width + 7) & ~(size_t)7;
+}
+
+void psd_record_init(psd_record_header_t* hdr, psd_measure_t measure, int64_t timestamp,
+                     const char* datetime, double center_freq, double fs,
+                     uint32_t n_bins, uint16_t n_params)
+{
+    static const uint16_t cols[PSD_MEASURE_COUNT] = {PSD_RMER_COLS, PSD_RNI_COLS, PSD_RMTDT_COLS};
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->magic = PSD_RECORD_MAGIC;
+    hdr->version = PSD_RECORD_VERSION;
+    hdr->measure = (uint8_t)measure;
+    hdr->format = PSD_FORMAT_F32;
+    hdr->timestamp = timestamp;
+    hdr->center_freq = center_freq;
+    hdr->fs = fs;
+    hdr->n_bins = n_bins;
+    hdr->n_params = n_params;
+    hdr->param_cols = cols[measure];
+    snprintf(hdr->datetime, sizeof(hdr->datetime), "%s", datetime);
+}
+
+size_t psd_record_size(const psd_record_header_t* hdr)
+{
+    return sizeof(psd_record_header_t) + psd_bytes(hdr) +
+           (size_t)hdr->n_params * hdr->param_cols * sizeof(double);
+}
+
+size_t psd_record_encode(void* buf, size_t cap, const psd_record_header_t* hdr,
+                         const double* psd_db, const double* params)
+{
+    size_t size = psd_record_size(hdr);
+    if (size > cap) {
+        return 0;
+    }
+
+    psd_record_header_t* out = (psd_record_header_t*)buf;
+    memcpy(out, hdr, sizeof(*out));
+    out->magic = PSD_RECORD_MAGIC;
+    out->version = PSD_RECORD_VERSION;
+
+    uint8_t* psd = (uint8_t*)buf + sizeof(*out);
+    if (hdr->format == PSD_FORMAT_I16_CDB) {
+        int16_t* v = (int16_t*)psd;
+        for (uint32_t i = 0; i < hdr->n_bins; i++) {
+            double cdb = round(psd_db[i] * 100.0);
+            if (cdb > INT16_MAX) cdb = INT16_MAX;
+            if (cdb < INT16_MIN) cdb = INT16_MIN;
+            v[i] = (int16_t)cdb;
+        }
+    } else {
+        float* v = (float*)psd;
+        for (uint32_t i = 0; i < hdr->n_bins; i++) {
+            v[i] = (float)psd_db[i];
+        }
+    }
+
+    size_t n_values = (size_t)hdr->n_params * hdr->param_cols;
+    if (n_values > 0) {
+        memcpy(psd + psd_bytes(hdr), params, n_values * sizeof(double));
+    }
+    return size;
+}
+
+int psd_record_decode(const void* buf, size_t len, psd_record_view_t* view)
+{
+    const psd_record_header_t* hdr = (const psd_record_header_t*)buf;
+
+    if (len < sizeof(*hdr) || hdr->magic != PSD_RECORD_MAGIC ||
+        hdr->version != PSD_RECORD_VERSION || hdr->measure >= PSD_MEASURE_COUNT ||
+        hdr->format > PSD_FORMAT_I16_CDB || psd_record_size(hdr) > len) {
+        fprintf(stderr, "Error: registro PSD inválido\n");
+        return -1;
+    }
+
+    view->hdr = hdr;
+    view->psd = (const uint8_t*)buf + sizeof(*hdr);
+    view->params = (const double*)((const uint8_t*)view->psd + psd_bytes(hdr));
+    return 0;
+}
+
+double psd_record_bin_db(const psd_record_view_t* view, uint32_t i)
+{
+    if (view->hdr->format == PSD_FORMAT_I16_CDB) {
+        return ((const int16_t*)view->psd)[i] / 100.0;
+    }
+    return ((const float*)view->psd)[i];
+}
+
+double psd_record_bin_mhz(const psd_record_view_t* view, uint32_t i)
+{
+    // Mismas operaciones que welch_psd_finalize + (f + central_freq) / 1e6
+    double fs = view->hdr->fs;
+    double df = fs / view->hdr->n_bins;
+    return ((-fs / 2.0 + i * df) + view->hdr->center_freq) / 1e6;
+}
+
+static void write_vectors(json_writer_t* w, const psd_record_view_t* view)
+{
+    json_object_begin(w, "vectors");
+
+    json_array_begin(w, "Pxx");
+    for (uint32_t i = 0; i < view->hdr->n_bins; i++) {
+        json_number_3f(w, NULL, psd_record_bin_db(view, i));
+    }
+    json_array_end(w);
+
+    json_array_begin(w, "f");
+    for (uint32_t i = 0; i < view->hdr->n_bins; i++) {
+        json_number_3f(w, NULL, psd_record_bin_mhz(view, i));
+    }
+    json_array_end(w);
+
+    json_object_end(w);
+}
+
+static void write_params_rmer(json_writer_t* w, const psd_record_view_t* view)
+{
+    for (int idx = 0; idx < view->hdr->n_params; idx++) {
+        const double* row = view->params + (size_t)idx * view->hdr->param_cols;
+        json_object_begin(w, NULL);
+        json_number(w, "freq", row[0]);
+        json_number_3f(w, "power", row[1]);
+        json_number_3f(w, "power_max", row[2]);
+        json_number_3f(w, "snr", row[3]);
+        json_number(w, "Presence", row[4]);
+        if (view->hdr->param_cols >= PSD_RMER_INTEGRATED_COLS) {
+            json_number_3f(w, "channel_power", row[5]);
+            json_number(w, "obw", row[6]);
+            json_number(w, "bw_xdb", row[7]);
+        }
+        json_object_end(w);
+    }
+}
+
+static void write_params_rni(json_writer_t* w, const psd_record_view_t* view)
+{
+    for (int idx = 0; idx < view->hdr->n_params; idx++) {
+        const double* row = view->params + (size_t)idx * view->hdr->param_cols;
+        json_object_begin(w, NULL);
+        json_string(w, "time", view->hdr->datetime);
+        json_number(w, "freq", row[0]);
+        json_number(w, "dbm", row[1]);
+        json_number(w, "V/m", row[2]);
+        json_number(w, "limite ocupado", row[3]);
+        json_object_end(w);
+    }
+}
+
+static void write_params_tdt(json_writer_t* w, const psd_record_view_t* view)
+{
+    for (int idx = 0; idx < view->hdr->n_params; idx++) {
+        const double* row = view->params + (size_t)idx * view->hdr->param_cols;
+        json_object_begin(w, NULL);
+        json_number(w, "freq", row[0]);
+        json_number(w, "power", row[1]);
+        json_number(w, "C/N", row[2]);
+        json_number(w, "MER", row[3]);
+        json_number(w, "BER", row[4]);
+        json_string(w, "modulation", view->hdr->modulation);
+        json_string(w, "rate hp", "2/3");
+        json_string(w, "guard", "1/8");
+        json_number(w, "segment length", 1024);
+        json_number(w, "fs", 20000000);
+        json_string(w, "window", "Hamming");
+        json_number(w, "bandwidth", 6500000);
+        json_number(w, "overlap", 0);
+        json_object_end(w);
+    }
+}
+
+/**
+ * @brief Escribe el documento `{"data": {...}}` completo.
+ */
+static void write_document(json_writer_t* w, const psd_record_view_t* view)
+{
+    const psd_record_header_t* hdr = view->hdr;
+
+    json_object_begin(w, NULL);
+    json_object_begin(w, "data");
+
+    // Mismo orden de claves que parameter(), parameter_rni() y parameter_tdt()
+    json_string(w, "datetime", hdr->datetime);
+    if (hdr->measure == PSD_MEASURE_RMTDT) {
+        json_string(w, "fmin", hdr->fmin);
+        json_string(w, "fmax", hdr->fmax);
+        json_string(w, "measure", "RMTDT");
+        json_string(w, "units", "MHz");
+        json_string(w, "channel", hdr->channel);
+        json_string(w, "band", hdr->band);
+    } else {
+        json_string(w, "band", hdr->band);
+        json_string(w, "fmin", hdr->fmin);
+        json_string(w, "fmax", hdr->fmax);
+        json_string(w, "units", "MHz");
+        json_string(w, "measure", hdr->measure == PSD_MEASURE_RNI ? "RNI" : "RMER");
+    }
+
+    write_vectors(w, view);
+
+    json_array_begin(w, "params");
+    switch (hdr->measure) {
+        case PSD_MEASURE_RMER:
+            write_params_rmer(w, view);
+            break;
+        case PSD_MEASURE_RNI:
+            write_params_rni(w, view);
+            break;
+        case PSD_MEASURE_RMTDT:
+            write_params_tdt(w, view);
+            break;
+    }
+    json_array_end(w);
+
+    json_object_end(w);
+    json_object_end(w);
+}
+
+char* psd_record_to_json(const psd_record_view_t* view)
+{
+    json_writer_t w;
+    if (json_writer_init(&w, -1) != 0) {
+        return NULL;
+    }
+    write_document(&w, view);
+    return json_writer_release(&w);
+}
+
+int psd_record_write_json(const psd_record_view_t* view, int fd)
+{
+    json_writer_t w;
+    if (json_writer_init(&w, fd) != 0) {
+        return -1;
+    }
+    write_document(&w, view);
+    return json_writer_finish(&w);
+}
@@ -0,0 +1,157 @@
+/**
+ * @file psd_record.h
+ * @brief Formato binario compacto para los resultados de una medición (PSD + parámetros por canal).
+ *
+ * Un registro ocupa una cabecera fija, la PSD en dB (float32 o int16 en
+ * centésimas de dB) y una tabla de parámetros `n_params` x `param_cols` en
+ * double. El eje de frecuencias no se guarda: se reconstruye a partir de `fs`,
+ * `n_bins` y `center_freq` con las mismas operaciones que `welch_psd_finalize`.
+ * El JSON que consume `Socket/client.js` se genera sólo cuando se pide, con
+ * `psd_record_write_json` o `psd_record_to_json`. Los campos están en el orden de bytes de la máquina.
+ */
+
+#ifndef PSD_RECORD_H
+#define PSD_RECORD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** @brief "PSDR" en little-endian. */
+#define PSD_RECORD_MAGIC 0x52445350u
+#define PSD_RECORD_VERSION 2
+
+/**
+ * @enum psd_measure_t
+ * @brief Tipo de medición; define el significado de las columnas de parámetros.
+ */
+typedef enum {
+    PSD_MEASURE_RMER = 0,  /**< `parameter`: freq, power, power_max, snr, Presence. */
+    PSD_MEASURE_RNI,       /**< `parameter_rni`: freq, dbm, V/m, limite ocupado. */
+    PSD_MEASURE_RMTDT,     /**< `parameter_tdt`: freq, power, C/N, MER, BER. */
+    PSD_MEASURE_COUNT
+} psd_measure_t;
+
+/**
+ * @enum psd_format_t
+ * @brief Codificación de los valores de la PSD.
+ */
+typedef enum {
+    PSD_FORMAT_F32 = 0,    /**< float32 en dB. */
+    PSD_FORMAT_I16_CDB     /**< int16 en centésimas de dB (rango ±327.67 dB). */
+} psd_format_t;
+
+/** @brief Columnas de la tabla de parámetros de cada tipo de medición. */
+#define PSD_RMER_COLS 5
+#define PSD_RNI_COLS 4
+#define PSD_RMTDT_COLS 5
+
+/**
+ * @brief Columnas RMER en modo de potencia integrada: las de `PSD_RMER_COLS`
+ * más potencia de canal (dB), ancho de banda ocupado y ancho a x dB (Hz).
+ * El llamador las fija en `param_cols` después de `psd_record_init`.
+ */
+#define PSD_RMER_INTEGRATED_COLS 8
+
+/**
+ * @struct psd_record_header_t
+ * @brief Cabecera de un registro. Va seguida de la PSD y de la tabla de parámetros.
+ */
+typedef struct {
+    uint32_t magic;          /**< `PSD_RECORD_MAGIC`. */
+    uint16_t version;        /**< `PSD_RECORD_VERSION`. */
+    uint8_t measure;         /**< `psd_measure_t`. */
+    uint8_t format;          /**< `psd_format_t`. */
+    int64_t timestamp;       /**< Hora de la medición (segundos Unix). */
+    double center_freq;      /**< Frecuencia central en Hz. */
+    double fs;               /**< Frecuencia de muestreo de la PSD en Hz. */
+    uint32_t n_bins;         /**< Número de puntos de la PSD. */
+    uint16_t n_params;       /**< Filas de la tabla de parámetros (canales). */
+    uint16_t param_cols;     /**< Columnas (double) por fila. */
+    char datetime[20];       /**< Fecha "YYYY-mm-ddTHH:MM" (o "HH:MM:SS"). */
+    char band[16];           /**< Banda medida. */
+    char fmin[16];           /**< Límite inferior en MHz, como texto (cabe `Flow[13]` completo). */
+    char fmax[16];           /**< Límite superior en MHz, como texto (cabe `Fhigh[13]` completo). */
+    char channel[16];        /**< Canal TDT (cabe `channel[13]` completo). */
+    char modulation[16];     /**< Modulación TDT ("64-QAM", ...). */
+} psd_record_header_t;
+
+/**
+ * @struct psd_record_view_t
+ * @brief Vista de un registro ya validado; los punteros apuntan dentro del buffer original.
+ */
+typedef struct {
+    const psd_record_header_t* hdr;  /**< Cabecera. */
+    const void* psd;                 /**< Valores de la PSD (`float` o `int16_t`). */
+    const double* params;            /**< Tabla de parámetros (fila mayor). */
+} psd_record_view_t;
+
+/**
+ * @brief Inicializa una cabecera: pone a cero los campos de texto y fija los numéricos.
+ *
+ * @param hdr Cabecera a completar.
+ * @param measure Tipo de medición (determina `param_cols`).
+ * @param timestamp Hora de la medición.
+ * @param datetime Fecha ya formateada.
+ * @param center_freq Frecuencia central en Hz.
+ * @param fs Frecuencia de muestreo de la PSD en Hz.
+ * @param n_bins Número de puntos de la PSD.
+ * @param n_params Filas de la tabla de parámetros.
+ */
+void psd_record_init(psd_record_header_t* hdr, psd_measure_t measure, int64_t timestamp,
+                     const char* datetime, double center_freq, double fs,
+                     uint32_t n_bins, uint16_t n_params);
+
+/**
+ * @brief Tamaño en bytes del registro descrito por `hdr`.
+ */
+size_t psd_record_size(const psd_record_header_t* hdr);
+
+/**
+ * @brief Serializa un registro.
+ *
+ * @param buf Destino.
+ * @param cap Capacidad de `buf` en bytes.
+ * @param hdr Cabecera (se completan `magic` y `version`).
+ * @param psd_db PSD en dB (longitud `hdr->n_bins`).
+ * @param params Tabla de parámetros (`hdr->n_params` * `hdr->param_cols` valores), puede ser NULL si no hay filas.
+ *
+ * @return Bytes escritos, o 0 si no cabe en `buf`.
+ */
+size_t psd_record_encode(void* buf, size_t cap, const psd_record_header_t* hdr,
+                         const double* psd_db, const double* params);
+
+/**
+ * @brief Valida un registro y arma su vista.
+ *
+ * @return 0 si el registro es válido, -1 en caso contrario.
+ */
+int psd_record_decode(const void* buf, size_t len, psd_record_view_t* view);
+
+/**
+ * @brief Valor del punto `i` de la PSD en dB.
+ */
+double psd_record_bin_db(const psd_record_view_t* view, uint32_t i);
+
+/**
+ * @brief Frecuencia del punto `i` en MHz, igual a la que calcula `parameter`.
+ */
+double psd_record_bin_mhz(const psd_record_view_t* view, uint32_t i);
+
+/**
+ * @brief Genera el JSON `{"data": {...}}` que antes escribía cada función de medición.
+ *
+ * @return Cadena JSON (liberar con `free`), o NULL en caso de error.
+ */
+char* psd_record_to_json(const psd_record_view_t* view);
+
+/**
+ * @brief Escribe el mismo JSON que `psd_record_to_json` directamente en `fd`.
+ *
+ * El documento se emite por bloques de `JSON_WRITER_CHUNK` bytes, sin armarlo
+ * completo en memoria.
+ *
+ * @return 0 si se escribió completo, -1 en caso de error.
+ */
+int psd_record_write_json(const psd_record_view_t* view, int fd);
+
+#endif // PSD_RECORD_H
@@ -0,0 +1,695 @@
+/**
+ * @file rf_session.c
+ * @brief Implementación de la sesión de radio persistente y de sus backends HackRF, de reproducción y sintético.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <libhackrf/hackrf.h>
+
+#include "rf_session.h"
+#include "bacn_RF.h"
+#include "iq_synth.h"
+#include "../Drivers/bacn_gpio.h"
+
+/** @brief Sesión del proceso usada por `getSamples`. */
+static rf_session_t default_session;
+
+/** @brief Turno de las capturas sobre `default_session`. */
+static pthread_mutex_t default_session_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** @brief Conmutador de antena de la placa (NULL: sólo se recuerda la antena). */
+static const rf_antenna_switch_t* antenna_switch = NULL;
+
+/* ------------------------------------------------------------------------- */
+/* Backend HackRF                                                            */
+/* ------------------------------------------------------------------------- */
+
+static int hackrf_check(int result, const char* what)
+{
+    if (result != HACKRF_SUCCESS) {
+        fprintf(stderr, "%s failed: %s (%d)\n", what, hackrf_error_name(result), result);
+        return -1;
+    }
+    return 0;
+}
+
+static int hackrf_rx_trampoline(hackrf_transfer* transfer)
+{
+    return rf_session_deliver((rf_session_t*)transfer->rx_ctx, transfer);
+}
+
+static int hackrf_backend_open(rf_session_t* rf, const char* arg)
+{
+    hackrf_device* device = NULL;
+    (void)arg;
+
+    if (hackrf_check(hackrf_init(), "hackrf_init()") != 0) {
+        return -1;
+    }
+    if (hackrf_check(hackrf_open(&device), "hackrf_open()") != 0) {
+        hackrf_exit();
+        return -1;
+    }
+    if (hackrf_check(hackrf_set_hw_sync_mode(device, 0), "hackrf_set_hw_sync_mode()") != 0) {
+        hackrf_close(device);
+        hackrf_exit();
+        return -1;
+    }
+    rf->handle = device;
+    return 0;
+}
+
+static void hackrf_backend_close(rf_session_t* rf)
+{
+    hackrf_check(hackrf_close((hackrf_device*)rf->handle), "hackrf_close()");
+    hackrf_exit();
+    rf->handle = NULL;
+}
+
+static int hackrf_backend_set_sample_rate(rf_session_t* rf, double rate)
+{
+    return hackrf_check(hackrf_set_sample_rate((hackrf_device*)rf->handle, rate),
+                        "hackrf_set_sample_rate()");
+}
+
+static int hackrf_backend_set_freq(rf_session_t* rf, uint64_t freq_hz)
+{
+    return hackrf_check(hackrf_set_freq((hackrf_device*)rf->handle, freq_hz), "hackrf_set_freq()");
+}
+
+static int hackrf_backend_set_gains(rf_session_t* rf, uint16_t lna, uint16_t vga)
+{
+    hackrf_device* device = (hackrf_device*)rf->handle;
+    int result = hackrf_set_vga_gain(device, vga);
+    result |= hackrf_set_lna_gain(device, lna);
+    return hackrf_check(result, "hackrf_set_gain()");
+}
+
+static int hackrf_backend_start(rf_session_t* rf)
+{
+    return hackrf_check(hackrf_start_rx((hackrf_device*)rf->handle, hackrf_rx_trampoline, rf),
+                        "hackrf_start_rx()");
+}
+
+static int hackrf_backend_stop(rf_session_t* rf)
+{
+    return hackrf_check(hackrf_stop_rx((hackrf_device*)rf->handle), "hackrf_stop_rx()");
+}
+
+static int hackrf_backend_start_sweep(rf_session_t* rf, const rf_sweep_plan_t* plan)
+{
+    hackrf_device* device = (hackrf_device*)rf->handle;
+
+    if (hackrf_check(hackrf_init_sweep(device, plan->freq_list_mhz, plan->num_ranges,
+                                       plan->num_bytes, plan->step_hz, plan->offset_hz, LINEAR),
+                     "hackrf_init_sweep()") != 0) {
+        return -1;
+    }
+    return hackrf_check(hackrf_start_rx_sweep(device, hackrf_rx_trampoline, rf),
+                        "hackrf_start_rx_sweep()");
+}
+
+const rf_backend_t rf_backend_hackrf = {
+    "hackrf",
+    hackrf_backend_open,
+    hackrf_backend_close,
+    hackrf_backend_set_sample_rate,
+    hackrf_backend_set_freq,
+    hackrf_backend_set_gains,
+    hackrf_backend_start,
+    hackrf_backend_stop,
+    hackrf_backend_start_sweep,
+};
+
+/* ------------------------------------------------------------------------- */
+/* Backends de reproducción y sintético                                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @struct replay_state_t
+ * @brief Estado de los backends de reproducción y sintético.
+ */
+typedef struct {
+    FILE* source;          /**< Archivo CS8 reproducido en bucle (NULL en el sintético). */
+    iq_synth_t* synth;     /**< Generador del backend sintético (NULL en la reproducción). */
+    uint8_t* buffer;       /**< Bloque de `REPLAY_TRANSFER_SIZE` bytes. */
+    pthread_t thread;      /**< Hilo que imita al hilo de transferencias de libusb. */
+    atomic_bool running;   /**< El hilo debe seguir entregando bloques. */
+    bool started;          /**< `thread` es válido. */
+    bool sweeping;         /**< Se está imitando un barrido. */
+    rf_sweep_plan_t plan;  /**< Plan del barrido en curso. */
+    int range;             /**< Rango actual del barrido. */
+    uint64_t hop_hz;       /**< Frecuencia de salto actual. */
+    uint32_t hop_blocks;   /**< Bloques entregados en el salto actual. */
+} replay_state_t;
+
+/**
+ * @brief Lee `n` bytes del archivo, volviendo al principio al llegar al final,
+ * o los genera si la fuente es sintética.
+ */
+static size_t replay_read(replay_state_t* st, uint8_t* dst, size_t n)
+{
+    if (st->synth != NULL) {
+        iq_synth_fill(st->synth, (int8_t*)dst, n / 2);
+        return n - n % 2;
+    }
+
+    size_t done = 0;
+    while (done < n) {
+        size_t read_size = fread(dst + done, 1, n - done, st->source);
+        if (read_size == 0) {
+            // Al final del archivo se vuelve a empezar, como una señal continua
+            rewind(st->source);
+            read_size = fread(dst + done, 1, n - done, st->source);
+            if (read_size == 0) {
+                break;
+            }
+        }
+        done += read_size;
+    }
+    return done;
+}
+
+/**
+ * @brief Llena una transferencia con bloques de barrido: cabecera de frecuencia + muestras.
+ */
+static size_t replay_fill_sweep(replay_state_t* st)
+{
+    const rf_sweep_plan_t* plan = &st->plan;
+    uint32_t blocks_per_hop = plan->num_bytes / BYTES_PER_BLOCK;
+    size_t len = 0;
+
+    while (len + BYTES_PER_BLOCK <= REPLAY_TRANSFER_SIZE) {
+        uint8_t* block = st->buffer + len;
+        block[0] = 0x7F;
+        block[1] = 0x7F;
+        for (int b = 0; b < 8; b++) {
+            block[2 + b] = (uint8_t)(st->hop_hz >> (8 * b));
+        }
+        size_t payload = BYTES_PER_BLOCK - RF_SWEEP_HEADER_BYTES;
+        if (replay_read(st, block + RF_SWEEP_HEADER_BYTES, payload) != payload) {
+            break;
+        }
+        len += BYTES_PER_BLOCK;
+
+        // Siguiente salto, como el firmware: al pasar el fin del rango se va al siguiente
+        if (++st->hop_blocks == blocks_per_hop) {
+            st->hop_blocks = 0;
+            st->hop_hz += plan->step_hz;
+            if (st->hop_hz >= plan->freq_list_mhz[2 * st->range + 1] * 1000000ull) {
+                st->range = (st->range + 1) % plan->num_ranges;
+                st->hop_hz = plan->freq_list_mhz[2 * st->range] * 1000000ull;
+            }
+        }
+    }
+    return len;
+}
+
+/**
+ * @brief Espera hasta que `bytes` bytes CS8 habrían llegado del front-end desde `start`.
+ */
+static void replay_pace(const rf_session_t* rf, const struct timespec* start, uint64_t bytes)
+{
+    double rate = (rf->sample_rate > 0) ? rf->sample_rate : DEFAULT_SAMPLE_RATE_HZ;
+    uint64_t ns = (uint64_t)(bytes / (2.0 * rate) * 1e9);
+    struct timespec until = *start;
+
+    until.tv_sec += (time_t)(ns / 1000000000ull);
+    until.tv_nsec += (long)(ns % 1000000000ull);
+    if (until.tv_nsec >= 1000000000L) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000L;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) != 0) {
+        // Interrumpido por una señal: se sigue esperando hasta el mismo instante
+    }
+}
+
+static void* replay_thread(void* arg)
+{
+    rf_session_t* rf = (rf_session_t*)arg;
+    replay_state_t* st = (replay_state_t*)rf->handle;
+    hackrf_transfer transfer;
+    struct timespec start;
+    uint64_t delivered = 0;
+
+    memset(&transfer, 0, sizeof(transfer));
+    transfer.buffer = st->buffer;
+    transfer.buffer_length = REPLAY_TRANSFER_SIZE;
+    transfer.rx_ctx = rf;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (atomic_load(&st->running)) {
+        size_t read_size = st->sweeping ? replay_fill_sweep(st)
+                                        : replay_read(st, st->buffer, REPLAY_TRANSFER_SIZE);
+        if (read_size == 0) {
+            break;
+        }
+        delivered += read_size;
+        if (rf->realtime) {
+            // Cada transferencia sale cuando la habría terminado de muestrear la radio
+            replay_pace(rf, &start, delivered);
+        }
+        transfer.valid_length = (int)read_size;
+        if (rf_session_deliver(rf, &transfer) != 0) {
+            break;
+        }
+    }
+    atomic_store(&st->running, false);
+    return NULL;
+}
+
+static int replay_backend_open(rf_session_t* rf, const char* arg)
+{
+    replay_state_t* st = calloc(1, sizeof(*st));
+    if (st == NULL) {
+        fprintf(stderr, "Error: Unable to allocate replay state\n");
+        return -1;
+    }
+    st->source = fopen(arg, "rb");
+    if (st->source == NULL) {
+        fprintf(stderr, "Failed to open file: %s\n", arg);
+        free(st);
+        return -1;
+    }
+    st->buffer = (uint8_t*)malloc(REPLAY_TRANSFER_SIZE);
+    if (st->buffer == NULL) {
+        fprintf(stderr, "Error: Unable to allocate replay buffer\n");
+        fclose(st->source);
+        free(st);
+        return -1;
+    }
+    rf->handle = st;
+    return 0;
+}
+
+static int replay_backend_stop(rf_session_t* rf)
+{
+    replay_state_t* st = (replay_state_t*)rf->handle;
+    atomic_store(&st->running, false);
+    if (st->started) {
+        pthread_join(st->thread, NULL);
+        st->started = false;
+    }
+    st->sweeping = false;
+    return 0;
+}
+
+static void replay_backend_close(rf_session_t* rf)
+{
+    replay_state_t* st = (replay_state_t*)rf->handle;
+    replay_backend_stop(rf);
+    if (st->source != NULL) {
+        fclose(st->source);
+    }
+    if (st->synth != NULL) {
+        iq_synth_free(st->synth);
+        free(st->synth);
+    }
+    free(st->buffer);
+    free(st);
+    rf->handle = NULL;
+}
+
+static int replay_backend_set_sample_rate(rf_session_t* rf, double rate)
+{
+    (void)rf;
+    (void)rate;
+    return 0;
+}
+
+static int replay_backend_set_freq(rf_session_t* rf, uint64_t freq_hz)
+{
+    (void)rf;
+    (void)freq_hz;
+    return 0;
+}
+
+static int replay_backend_set_gains(rf_session_t* rf, uint16_t lna, uint16_t vga)
+{
+    (void)rf;
+    (void)lna;
+    (void)vga;
+    return 0;
+}
+
+static int replay_backend_start(rf_session_t* rf)
+{
+    replay_state_t* st = (replay_state_t*)rf->handle;
+    atomic_store(&st->running, true);
+    if (pthread_create(&st->thread, NULL, replay_thread, rf) != 0) {
+        fprintf(stderr, "Error: Unable to start replay thread\n");
+        atomic_store(&st->running, false);
+        return -1;
+    }
+    st->started = true;
+    return 0;
+}
+
+static int replay_backend_start_sweep(rf_session_t* rf, const rf_sweep_plan_t* plan)
+{
+    replay_state_t* st = (replay_state_t*)rf->handle;
+    st->plan = *plan;
+    st->range = 0;
+    st->hop_hz = plan->freq_list_mhz[0] * 1000000ull;
+    st->hop_blocks = 0;
+    st->sweeping = true;
+    if (replay_backend_start(rf) != 0) {
+        st->sweeping = false;
+        return -1;
+    }
+    return 0;
+}
+
+const rf_backend_t rf_backend_replay = {
+    "replay",
+    replay_backend_open,
+    replay_backend_close,
+    replay_backend_set_sample_rate,
+    replay_backend_set_freq,
+    replay_backend_set_gains,
+    replay_backend_start,
+    replay_backend_stop,
+    replay_backend_start_sweep,
+};
+
+static int synth_backend_open(rf_session_t* rf, const char* arg)
+{
+    replay_state_t* st = calloc(1, sizeof(*st));
+    if (st == NULL) {
+        fprintf(stderr, "Error: Unable to allocate synthetic source\n");
+        return -1;
+    }
+    st->synth = (iq_synth_t*)malloc(sizeof(iq_synth_t));
+    st->buffer = (uint8_t*)malloc(REPLAY_TRANSFER_SIZE);
+    if (st->synth == NULL || st->buffer == NULL) {
+        fprintf(stderr, "Error: Unable to allocate synthetic source\n");
+        free(st->synth);
+        free(st->buffer);
+        free(st);
+        return -1;
+    }
+    if (iq_synth_init(st->synth, (arg != NULL) ? arg : "", DEFAULT_SAMPLE_RATE_HZ) != 0) {
+        free(st->synth);
+        free(st->buffer);
+        free(st);
+        return -1;
+    }
+    rf->handle = st;
+    return 0;
+}
+
+static int synth_backend_set_sample_rate(rf_session_t* rf, double rate)
+{
+    replay_state_t* st = (replay_state_t*)rf->handle;
+    return iq_synth_set_rate(st->synth, rate);
+}
+
+const rf_backend_t rf_backend_synth = {
+    "synth",
+    synth_backend_open,
+    replay_backend_close,
+    synth_backend_set_sample_rate,
+    replay_backend_set_freq,
+    replay_backend_set_gains,
+    replay_backend_start,
+    replay_backend_stop,
+    replay_backend_start_sweep,
+};
+
+/* ------------------------------------------------------------------------- */
+/* Sesión                                                                    */
+/* ------------------------------------------------------------------------- */
+
+int rf_session_open(rf_session_t* rf, const rf_backend_t* backend, const char* arg)
+{
+    memset(rf, 0, sizeof(*rf));
+    rf->lna_gain = -1;
+    rf->vga_gain = -1;
+    rf->antenna = -1;
+    rf->settle_us = RF_SETTLE_TIME_US;
+
+    if (backend->open(rf, arg) != 0) {
+        return -1;
+    }
+    rf->backend = backend;
+    fprintf(stderr, "RF session opened (%s)\n", backend->name);
+    return 0;
+}
+
+void rf_session_close(rf_session_t* rf)
+{
+    if (rf->backend == NULL) {
+        return;
+    }
+    if (rf->streaming) {
+        rf_session_stop(rf);
+    }
+    rf->backend->close(rf);
+    fprintf(stderr, "RF session closed (%s): %u retunes, %llu settle bytes discarded\n",
+            rf->backend->name, rf->retunes, (unsigned long long)rf->discarded_bytes);
+    rf->backend = NULL;
+}
+
+void rf_session_reset(rf_session_t* rf)
+{
+    if (rf->backend == NULL) {
+        return;
+    }
+    if (rf->streaming) {
+        rf_session_stop(rf);
+    }
+    rf->sample_rate = 0;
+    rf->freq_hz = 0;
+    rf->lna_gain = -1;
+    rf->vga_gain = -1;
+    rf->settle_bytes = 0;
+}
+
+int rf_session_set_sample_rate(rf_session_t* rf, double rate)
+{
+    if (rf->sample_rate == rate) {
+        return 0;
+    }
+    if (rf->backend->set_sample_rate(rf, rate) != 0) {
+        rf->sample_rate = 0;
+        return -1;
+    }
+    rf->sample_rate = rate;
+    return 0;
+}
+
+int rf_session_tune(rf_session_t* rf, uint64_t freq_hz)
+{
+    if (rf->freq_hz == freq_hz) {
+        return 0;
+    }
+    if (rf->backend->set_freq(rf, freq_hz) != 0) {
+        rf->freq_hz = 0;
+        return -1;
+    }
+    rf->freq_hz = freq_hz;
+    rf->retunes++;
+
+    // Bytes CS8 (2 por muestra) que dura el asentamiento a la tasa actual
+    size_t settle_samples = (size_t)(rf->sample_rate * rf->settle_us / 1e6);
+    rf->settle_bytes = settle_samples * 2;
+    return 0;
+}
+
+int rf_session_set_gains(rf_session_t* rf, uint16_t lna_gain, uint16_t vga_gain)
+{
+    if (rf->lna_gain == lna_gain && rf->vga_gain == vga_gain) {
+        return 0;
+    }
+    if (rf->backend->set_gains(rf, lna_gain, vga_gain) != 0) {
+        rf->lna_gain = -1;
+        rf->vga_gain = -1;
+        return -1;
+    }
+    rf->lna_gain = lna_gain;
+    rf->vga_gain = vga_gain;
+    return 0;
+}
+
+int rf_session_set_antenna(rf_session_t* rf, bool rf1)
+{
+    int antenna = rf1 ? RF1 : RF2;
+    if (rf->antenna == antenna) {
+        return 0;
+    }
+    if (antenna_switch != NULL && antenna_switch->select(rf1) != 0) {
+        rf->antenna = -1;
+        return -1;
+    }
+    rf->antenna = antenna;
+    return 0;
+}
+
+void rf_session_set_antenna_switch(const rf_antenna_switch_t* sw)
+{
+    antenna_switch = sw;
+}
+
+void rf_session_set_settle(rf_session_t* rf, uint32_t settle_us)
+{
+    rf->settle_us = settle_us;
+}
+
+void rf_session_set_realtime(rf_session_t* rf, bool realtime)
+{
+    rf->realtime = realtime;
+}
+
+int rf_session_open_spec(rf_session_t* rf, const char* spec)
+{
+    static const struct {
+        const char* prefix;
+        const rf_backend_t* backend;
+        bool realtime;
+    } sources[] = {
+        {"replay:", &rf_backend_replay, false},
+        {"replay-rt:", &rf_backend_replay, true},
+        {"synth:", &rf_backend_synth, false},
+        {"synth-rt:", &rf_backend_synth, true},
+    };
+
+    if (spec == NULL || spec[0] == '\0' || strcmp(spec, "hackrf") == 0) {
+        return rf_session_open(rf, &rf_backend_hackrf, NULL);
+    }
+    for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); i++) {
+        size_t len = strlen(sources[i].prefix);
+        if (strncmp(spec, sources[i].prefix, len) == 0) {
+            if (rf_session_open(rf, sources[i].backend, spec + len) != 0) {
+                return -1;
+            }
+            rf_session_set_realtime(rf, sources[i].realtime);
+            return 0;
+        }
+    }
+    fprintf(stderr, "Error: unknown IQ source '%s'\n", spec);
+    return -1;
+}
+
+int rf_session_start(rf_session_t* rf, hackrf_sample_block_cb_fn callback, void* ctx)
+{
+    rf->callback = callback;
+    rf->callback_ctx = ctx;
+    if (rf->backend->start(rf) != 0) {
+        rf->callback = NULL;
+        return -1;
+    }
+    rf->streaming = true;
+    return 0;
+}
+
+int rf_session_start_sweep(rf_session_t* rf, const rf_sweep_plan_t* plan,
+                           hackrf_sample_block_cb_fn callback, void* ctx)
+{
+    if (plan->num_ranges < 1 || plan->num_ranges > RF_SWEEP_MAX_RANGES ||
+        plan->num_bytes == 0 || plan->num_bytes % BYTES_PER_BLOCK != 0 || plan->step_hz == 0) {
+        fprintf(stderr, "Error: invalid sweep plan\n");
+        return -1;
+    }
+
+    // El front-end descarta el asentamiento de cada salto; aquí no se recorta nada
+    rf->settle_bytes = 0;
+    rf->callback = callback;
+    rf->callback_ctx = ctx;
+    if (rf->backend->start_sweep(rf, plan) != 0) {
+        rf->callback = NULL;
+        return -1;
+    }
+    // Tras el barrido la sintonía queda indefinida: la próxima rf_session_tune reprograma
+    rf->freq_hz = 0;
+    rf->streaming = true;
+    return 0;
+}
+
+int rf_session_stop(rf_session_t* rf)
+{
+    if (!rf->streaming) {
+        return 0;
+    }
+    int result = rf->backend->stop(rf);
+    rf->streaming = false;
+    rf->callback = NULL;
+    rf->callback_ctx = NULL;
+    return result;
+}
+
+int rf_session_deliver(rf_session_t* rf, hackrf_transfer* transfer)
+{
+    size_t skip = rf->settle_bytes;
+
+    // El backend usa rx_ctx para encontrar la sesión; el callback recibe el de su captura
+    hackrf_transfer rest = *transfer;
+    rest.rx_ctx = rf->callback_ctx;
+
+    if (skip == 0) {
+        return rf->callback(&rest);
+    }
+
+    // Descartar las muestras tomadas mientras el sintetizador se asienta
+    if (skip >= (size_t)transfer->valid_length) {
+        rf->settle_bytes = skip - (size_t)transfer->valid_length;
+        rf->discarded_bytes += (size_t)transfer->valid_length;
+        return 0;
+    }
+
+    rest.buffer += skip;
+    rest.buffer_length -= (int)skip;
+    rest.valid_length -= (int)skip;
+    rf->settle_bytes = 0;
+    rf->discarded_bytes += skip;
+    return rf->callback(&rest);
+}
+
+rf_session_t* rf_session_get(void)
+{
+    if (default_session.backend == NULL &&
+        rf_session_open_spec(&default_session, getenv(RF_SOURCE_ENV)) != 0) {
+        return NULL;
+    }
+    return &default_session;
+}
+
+rf_session_t* rf_session_acquire(void)
+{
+    pthread_mutex_lock(&default_session_lock);
+    rf_session_t* rf = rf_session_get();
+    if (rf == NULL) {
+        pthread_mutex_unlock(&default_session_lock);
+    }
+    return rf;
+}
+
+void rf_session_release(void)
+{
+    pthread_mutex_unlock(&default_session_lock);
+}
+
+int rf_session_use(const rf_backend_t* backend, const char* arg)
+{
+    rf_session_close(&default_session);
+    return rf_session_open(&default_session, backend, arg);
+}
+
+int rf_session_use_spec(const char* spec)
+{
+    rf_session_close(&default_session);
+    return rf_session_open_spec(&default_session, spec);
+}
+
+void rf_session_cleanup(void)
+{
+    rf_session_close(&default_session);
+    if (antenna_switch != NULL && antenna_switch->release != NULL) {
+        antenna_switch->release();
+    }
+}
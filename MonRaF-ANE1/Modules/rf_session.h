@@ -0,0 +1,294 @@
+/**
+ * @file rf_session.h
+ * @brief Sesión de radio persistente: el dispositivo se abre una vez y se resintoniza entre tramos.
+ *
+ * La sesión guarda el estado del front-end (tasa de muestreo, frecuencia,
+ * ganancias y antena) y sólo reprograma lo que cambia entre capturas. Tras
+ * cada resintonización descarta las primeras muestras, mientras el PLL se
+ * asienta, antes de entregar las transferencias al callback del usuario.
+ * El acceso al hardware pasa por una tabla de funciones (`rf_backend_t`):
+ * HackRF para el equipo real, reproducción de un archivo CS8 (por ejemplo
+ * `Samples/200K` o `Samples/2M`) y un generador sintético (`iq_synth.h`) para
+ * probar y medir toda la cadena sin radio. Los dos últimos entregan a ritmo
+ * libre o, con `rf_session_set_realtime`, al ritmo de la tasa de muestreo.
+ *
+ * La fuente de la sesión del proceso se elige con la variable de entorno
+ * `MONRAF_IQ_SOURCE` (ver `rf_session_open_spec`); sin ella se usa el HackRF.
+ *
+ * El conmutador de antena no forma parte del HackRF sino de la placa: quien
+ * lo maneja (la GPIO en `main.c`) se registra con `rf_session_set_antenna_switch`.
+ * Sin conmutador registrado la sesión sólo recuerda la antena pedida, lo que
+ * basta para las herramientas que no corren en la placa.
+ */
+
+#ifndef RF_SESSION_H
+#define RF_SESSION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <libhackrf/hackrf.h>
+
+/**
+ * @def RF_SETTLE_TIME_US
+ * @brief Tiempo de asentamiento tras una resintonización, en microsegundos.
+ */
+#define RF_SETTLE_TIME_US 5000
+
+/**
+ * @def RF_SWEEP_MAX_RANGES
+ * @brief Número máximo de rangos de un barrido (límite del firmware de HackRF).
+ */
+#define RF_SWEEP_MAX_RANGES 10
+
+/**
+ * @def RF_SWEEP_HEADER_BYTES
+ * @brief Cabecera al inicio de cada bloque de un barrido: 0x7F 0x7F + frecuencia (8 bytes).
+ */
+#define RF_SWEEP_HEADER_BYTES 10
+
+/**
+ * @def RF_SOURCE_ENV
+ * @brief Variable de entorno con la fuente de la sesión del proceso.
+ */
+#define RF_SOURCE_ENV "MONRAF_IQ_SOURCE"
+
+typedef struct rf_session_t rf_session_t;
+
+/**
+ * @struct rf_sweep_plan_t
+ * @brief Lista de saltos de un barrido, con la semántica de `hackrf_init_sweep` (estilo lineal).
+ *
+ * Dentro de cada rango [`freq_list_mhz[2r]`, `freq_list_mhz[2r+1]`) MHz el
+ * front-end salta en pasos de `step_hz`, se queda `num_bytes` en cada salto y
+ * sintoniza `frecuencia de salto + offset_hz`. Cada bloque de `BYTES_PER_BLOCK`
+ * bytes empieza con 0x7F 0x7F y la frecuencia de salto (uint64 little-endian).
+ */
+typedef struct {
+    uint16_t freq_list_mhz[2 * RF_SWEEP_MAX_RANGES]; /**< Pares inicio/fin de cada rango, en MHz. */
+    int num_ranges;                                  /**< Rangos válidos en `freq_list_mhz`. */
+    uint32_t num_bytes;                              /**< Bytes por salto (múltiplo de `BYTES_PER_BLOCK`). */
+    uint32_t step_hz;                                /**< Separación entre saltos. */
+    uint32_t offset_hz;                              /**< Desplazamiento de la sintonía respecto a la frecuencia de salto. */
+} rf_sweep_plan_t;
+
+/**
+ * @struct rf_backend_t
+ * @brief Operaciones de un front-end de radio. Devuelven 0 si tienen éxito.
+ */
+typedef struct {
+    const char* name;                                            /**< Nombre para los mensajes. */
+    int (*open)(rf_session_t* rf, const char* arg);              /**< Abre el dispositivo (`arg` depende del backend). */
+    void (*close)(rf_session_t* rf);                             /**< Cierra el dispositivo. */
+    int (*set_sample_rate)(rf_session_t* rf, double rate);       /**< Fija la tasa de muestreo. */
+    int (*set_freq)(rf_session_t* rf, uint64_t freq_hz);         /**< Sintoniza. */
+    int (*set_gains)(rf_session_t* rf, uint16_t lna, uint16_t vga); /**< Fija las ganancias LNA/VGA. */
+    int (*start)(rf_session_t* rf);                              /**< Empieza a entregar transferencias a `rf_session_deliver`. */
+    int (*stop)(rf_session_t* rf);                               /**< Detiene la entrega. */
+    int (*start_sweep)(rf_session_t* rf, const rf_sweep_plan_t* plan); /**< Empieza un barrido con saltos. */
+} rf_backend_t;
+
+/**
+ * @struct rf_antenna_switch_t
+ * @brief Conmutador de antena de la placa.
+ */
+typedef struct {
+    uint8_t (*select)(bool rf1);  /**< Selecciona RF1 (true) o RF2 (false); 0 si tiene éxito. */
+    void (*release)(void);        /**< Libera el conmutador (puede ser NULL). */
+} rf_antenna_switch_t;
+
+/**
+ * @struct rf_session_t
+ * @brief Estado de la sesión.
+ */
+struct rf_session_t {
+    const rf_backend_t* backend;          /**< Front-end en uso (NULL: sesión cerrada). */
+    void* handle;                         /**< Estado propio del backend. */
+    double sample_rate;                   /**< Tasa de muestreo programada (0: ninguna). */
+    uint64_t freq_hz;                     /**< Frecuencia programada (0: ninguna). */
+    int lna_gain;                         /**< Ganancia LNA programada (-1: ninguna). */
+    int vga_gain;                         /**< Ganancia VGA programada (-1: ninguna). */
+    int antenna;                          /**< Antena seleccionada (RF1/RF2, -1: ninguna). */
+    uint32_t settle_us;                   /**< Tiempo de asentamiento tras resintonizar. */
+    volatile size_t settle_bytes;         /**< Bytes que faltan por descartar. */
+    uint64_t discarded_bytes;             /**< Total de bytes descartados (estadística). */
+    uint32_t retunes;                     /**< Número de resintonizaciones (estadística). */
+    hackrf_sample_block_cb_fn callback;   /**< Callback del usuario durante la captura. */
+    void* callback_ctx;                   /**< Contexto que recibe `callback` en `transfer->rx_ctx`. */
+    bool streaming;                       /**< Hay una captura en curso. */
+    bool realtime;                        /**< Los backends sin radio entregan al ritmo de `sample_rate`. */
+};
+
+/** @brief Backend HackRF (`arg` se ignora). */
+extern const rf_backend_t rf_backend_hackrf;
+
+/**
+ * @brief Backend de reproducción: entrega en bucle el archivo CS8 `arg`.
+ *
+ * En un barrido imita al firmware: parte el archivo en bloques con la cabecera
+ * de frecuencia y recorre los saltos del plan.
+ */
+extern const rf_backend_t rf_backend_replay;
+
+/**
+ * @brief Backend sintético: genera la señal descrita por `arg` (formato de `iq_synth_init`).
+ *
+ * Las frecuencias de la descripción son relativas a la sintonía, así que la
+ * señal acompaña a cada resintonización y a cada salto de un barrido.
+ */
+extern const rf_backend_t rf_backend_synth;
+
+/**
+ * @brief Abre una sesión con el backend indicado.
+ *
+ * @return 0 si el dispositivo quedó abierto, -1 en caso de error.
+ */
+int rf_session_open(rf_session_t* rf, const rf_backend_t* backend, const char* arg);
+
+/**
+ * @brief Detiene la captura en curso (si la hay) y cierra el dispositivo.
+ */
+void rf_session_close(rf_session_t* rf);
+
+/**
+ * @brief Programa la tasa de muestreo si cambió.
+ */
+int rf_session_set_sample_rate(rf_session_t* rf, double rate);
+
+/**
+ * @brief Sintoniza `freq_hz` y arma el descarte de muestras de asentamiento.
+ *
+ * Si la frecuencia no cambia no se toca el hardware ni se descarta nada.
+ */
+int rf_session_tune(rf_session_t* rf, uint64_t freq_hz);
+
+/**
+ * @brief Programa las ganancias si cambiaron.
+ */
+int rf_session_set_gains(rf_session_t* rf, uint16_t lna_gain, uint16_t vga_gain);
+
+/**
+ * @brief Selecciona la antena (RF1/RF2) si cambió.
+ *
+ * Si el conmutador falla la antena queda indefinida y la próxima llamada lo reintenta.
+ *
+ * @return 0 si la antena quedó seleccionada, -1 si el conmutador falló.
+ */
+int rf_session_set_antenna(rf_session_t* rf, bool rf1);
+
+/**
+ * @brief Registra el conmutador de antena de la placa (NULL: ninguno).
+ *
+ * Vale para todas las sesiones; debe llamarse antes de la primera captura.
+ */
+void rf_session_set_antenna_switch(const rf_antenna_switch_t* sw);
+
+/**
+ * @brief Detiene la captura en curso y olvida lo programado, sin cerrar el dispositivo.
+ *
+ * Tras un error de captura la siguiente vuelve a programar tasa, frecuencia y
+ * ganancias; la sesión (y el backend elegido con `rf_session_use`) se conserva.
+ */
+void rf_session_reset(rf_session_t* rf);
+
+/**
+ * @brief Cambia el tiempo de asentamiento (0 desactiva el descarte).
+ */
+void rf_session_set_settle(rf_session_t* rf, uint32_t settle_us);
+
+/**
+ * @brief Entrega en tiempo real (true) o a ritmo libre (false) en los backends sin radio.
+ *
+ * En tiempo real cada transferencia sale cuando la radio la habría terminado
+ * de muestrear, lo que reproduce los plazos y la presión sobre las colas de
+ * una captura real. El HackRF no se ve afectado.
+ */
+void rf_session_set_realtime(rf_session_t* rf, bool realtime);
+
+/**
+ * @brief Abre una sesión a partir de una descripción de la fuente.
+ *
+ * - `hackrf` (o NULL / cadena vacía): el HackRF.
+ * - `replay:<archivo>` / `replay-rt:<archivo>`: reproducción a ritmo libre / en tiempo real.
+ * - `synth:<señal>` / `synth-rt:<señal>`: generador sintético a ritmo libre / en tiempo real.
+ *
+ * @return 0 si quedó abierta, -1 si la descripción no es válida o no se pudo abrir.
+ */
+int rf_session_open_spec(rf_session_t* rf, const char* spec);
+
+/**
+ * @brief Empieza a entregar muestras a `callback`, ya sin las de asentamiento.
+ *
+ * @param rf Sesión.
+ * @param callback Callback de la captura.
+ * @param ctx Llega al callback en `transfer->rx_ctx`.
+ */
+int rf_session_start(rf_session_t* rf, hackrf_sample_block_cb_fn callback, void* ctx);
+
+/**
+ * @brief Empieza un barrido: una sola captura que salta por todas las frecuencias de `plan`.
+ *
+ * El front-end resintoniza por su cuenta y descarta el asentamiento de cada
+ * salto, así que la sesión entrega los bloques intactos (sin recortar bytes)
+ * para no desalinear las cabeceras. Se detiene con `rf_session_stop`.
+ */
+int rf_session_start_sweep(rf_session_t* rf, const rf_sweep_plan_t* plan,
+                           hackrf_sample_block_cb_fn callback, void* ctx);
+
+/**
+ * @brief Detiene la entrega de muestras; el dispositivo sigue abierto.
+ */
+int rf_session_stop(rf_session_t* rf);
+
+/**
+ * @brief Punto de entrada de las transferencias de los backends.
+ *
+ * Descarta los bytes de asentamiento pendientes y pasa el resto al callback,
+ * con `rx_ctx` apuntando al contexto de la captura.
+ *
+ * @return Lo que devuelva el callback (distinto de 0 detiene la captura).
+ */
+int rf_session_deliver(rf_session_t* rf, hackrf_transfer* transfer);
+
+/**
+ * @brief Sesión del proceso; si está cerrada la abre con la fuente de `MONRAF_IQ_SOURCE` (HackRF por defecto).
+ *
+ * @return La sesión, o NULL si no se pudo abrir el dispositivo.
+ */
+rf_session_t* rf_session_get(void);
+
+/**
+ * @brief Toma la sesión del proceso para una captura; la abre si está cerrada.
+ *
+ * Las capturas lanzadas desde hilos distintos esperan aquí su turno en lugar
+ * de reprogramar el dispositivo a la vez. Se devuelve con `rf_session_release`.
+ *
+ * @return La sesión, o NULL (sin tomarla) si no se pudo abrir el dispositivo.
+ */
+rf_session_t* rf_session_acquire(void);
+
+/**
+ * @brief Devuelve la sesión tomada con `rf_session_acquire`.
+ */
+void rf_session_release(void);
+
+/**
+ * @brief Abre la sesión del proceso con un backend concreto (p. ej. reproducción en pruebas).
+ *
+ * @return 0 si quedó abierta, -1 en caso de error.
+ */
+int rf_session_use(const rf_backend_t* backend, const char* arg);
+
+/**
+ * @brief Abre la sesión del proceso con la fuente descrita por `spec` (ver `rf_session_open_spec`).
+ *
+ * @return 0 si quedó abierta, -1 en caso de error.
+ */
+int rf_session_use_spec(const char* spec);
+
+/**
+ * @brief Cierra la sesión del proceso y libera el conmutador de antena.
+ */
+void rf_session_cleanup(void);
+
+#endif // RF_SESSION_H
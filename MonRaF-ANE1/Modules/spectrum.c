@@ -0,0 +1,174 @@
+/**
+ * @file spectrum.c
+ * @brief Implementación del espectro con eje implícito y de la reparación del DC.
+ *
+ * Todas las posiciones se validan antes de escribir: una región del DC que no
+ * cabe en el espectro (o en la referencia) deja los datos intactos y devuelve -1.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "spectrum.h"
+#include "find_closest_index.h"
+
+int spectrum_alloc(spectrum_t* s, int n, double fs, double center_hz)
+{
+    s->df = fs / n;
+    s->f0 = center_hz - fs / 2.0;
+    s->n = n;
+    s->ordering = SPECTRUM_CENTERED;
+    s->units = SPECTRUM_LINEAR;
+    s->p = (double*)malloc((size_t)n * sizeof(double));
+    if (s->p == NULL) {
+        fprintf(stderr, "Error: Unable to allocate spectrum of %d bins\n", n);
+        return -1;
+    }
+    return 0;
+}
+
+void spectrum_free(spectrum_t* s)
+{
+    free(s->p);
+    s->p = NULL;
+    s->n = 0;
+}
+
+/**
+ * @brief Posición en `p` del bin canónico `i`.
+ */
+static inline int storage_index(const spectrum_t* s, int i)
+{
+    if (s->ordering == SPECTRUM_FFT_ORDER) {
+        int half = s->n / 2;
+        return (i < half) ? i + half : i - half;
+    }
+    return i;
+}
+
+int spectrum_bin(const spectrum_t* s, double freq_hz)
+{
+    double pos = (freq_hz - s->f0) / s->df;
+    if (pos < -0.5 || pos >= s->n - 0.5) {
+        return -1;
+    }
+    return uniform_closest_index(s->f0, s->df, s->n, freq_hz);
+}
+
+double spectrum_at(const spectrum_t* s, int i)
+{
+    return s->p[storage_index(s, i)];
+}
+
+void spectrum_canonicalize(spectrum_t* s)
+{
+    if (s->ordering == SPECTRUM_CENTERED) {
+        return;
+    }
+    // Con n par el fftshift es un intercambio de mitades
+    int half = s->n / 2;
+    for (int i = 0; i < half; i++) {
+        double tmp = s->p[i];
+        s->p[i] = s->p[i + half];
+        s->p[i + half] = tmp;
+    }
+    s->ordering = SPECTRUM_CENTERED;
+}
+
+int spectrum_dc_half_width(const spectrum_t* s)
+{
+    int w = (int)(s->n * SPECTRUM_DC_FRACTION);
+    return (w > 0) ? w : 1;
+}
+
+static inline double level_db(const spectrum_t* s, int i)
+{
+    double v = spectrum_at(s, i);
+    return (s->units == SPECTRUM_DB) ? v : 10.0 * log10(v);
+}
+
+static inline void set_level_db(spectrum_t* s, int i, double db)
+{
+    s->p[storage_index(s, i)] = (s->units == SPECTRUM_DB) ? db : pow(10.0, db / 10.0);
+}
+
+/**
+ * @brief Región del DC [`*lo`, `*hi`] y comprobación de que ella y sus vecinos caben.
+ */
+static int dc_region(const spectrum_t* s, int half_width, int guard, int* lo, int* hi)
+{
+    int dc = s->n / 2;
+    *lo = dc - half_width;
+    *hi = dc + half_width;
+    if (half_width < 0 || guard < 1 || *lo - guard < 0 || *hi + guard >= s->n) {
+        fprintf(stderr, "Error: DC region of %d bins (+%d) does not fit in %d bins\n",
+                2 * half_width + 1, guard, s->n);
+        return -1;
+    }
+    return 0;
+}
+
+int spectrum_repair_dc(spectrum_t* s, int half_width, int guard)
+{
+    int lo, hi;
+    if (dc_region(s, half_width, guard, &lo, &hi) != 0) {
+        return -1;
+    }
+
+    double left = 0.0;
+    double right = 0.0;
+    for (int k = 1; k <= guard; k++) {
+        left += level_db(s, lo - k);
+        right += level_db(s, hi + k);
+    }
+    left /= guard;
+    right /= guard;
+
+    // Recta entre los centros de ambos grupos de vecinos
+    double x_left = lo - (guard + 1) / 2.0;
+    double x_right = hi + (guard + 1) / 2.0;
+    double slope = (right - left) / (x_right - x_left);
+    for (int i = lo; i <= hi; i++) {
+        set_level_db(s, i, left + (i - x_left) * slope);
+    }
+    return 0;
+}
+
+int spectrum_replace_dc(spectrum_t* s, const spectrum_t* ref, int half_width, int guard)
+{
+    int lo, hi;
+    if (dc_region(s, half_width, guard, &lo, &hi) != 0) {
+        return -1;
+    }
+    if (ref->units != s->units) {
+        fprintf(stderr, "Error: DC reference spectrum has different units\n");
+        return -1;
+    }
+
+    // El DC de la referencia no puede caer sobre los bins que se copian o se comparan
+    double span = (half_width + guard) * s->df + spectrum_dc_half_width(ref) * ref->df;
+    if (fabs(spectrum_center(ref) - spectrum_center(s)) <= span) {
+        fprintf(stderr, "Error: DC reference spectrum shares the DC region\n");
+        return -1;
+    }
+    // El eje es creciente: si la referencia cubre los extremos cubre todo lo intermedio
+    if (spectrum_bin(ref, spectrum_freq(s, lo - guard)) < 0 ||
+        spectrum_bin(ref, spectrum_freq(s, hi + guard)) < 0) {
+        fprintf(stderr, "Error: DC reference spectrum does not cover the DC region\n");
+        return -1;
+    }
+
+    double gain = 0.0;
+    for (int k = 1; k <= guard; k++) {
+        gain += level_db(s, lo - k) - level_db(ref, spectrum_bin(ref, spectrum_freq(s, lo - k)));
+        gain += level_db(s, hi + k) - level_db(ref, spectrum_bin(ref, spectrum_freq(s, hi + k)));
+    }
+    gain /= 2 * guard;
+
+    for (int i = lo; i <= hi; i++) {
+        int j = spectrum_bin(ref, spectrum_freq(s, i));
+        set_level_db(s, i, level_db(ref, j) + gain);
+    }
+    return 0;
+}
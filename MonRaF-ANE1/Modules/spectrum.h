@@ -0,0 +1,147 @@
+/**
+ * @file spectrum.h
+ * @brief Espectro de potencia con su eje implícito y reparación del pico de DC.
+ *
+ * Las PSD de Welch tienen un eje uniforme: basta con la frecuencia absoluta
+ * del primer bin y la separación entre bins para saber a qué frecuencia
+ * corresponde cada uno, sin guardar un arreglo `f[]` por PSD. `spectrum_t`
+ * lleva ese eje, el orden de los bins y las unidades junto a los datos.
+ *
+ * El orden canónico es el que entrega `welch_psd_finalize`: frecuencias
+ * crecientes en [centro - fs/2, centro + fs/2), con el DC en el bin `n / 2`.
+ * Los analizadores trabajan siempre en ese orden; el orden natural de la FFT
+ * (DC en el bin 0) sólo existe para poder envolver otros arreglos y pasarlos
+ * a canónico con `spectrum_canonicalize`.
+ *
+ * El pico de DC del HackRF se corrige con `spectrum_repair_dc`
+ * (interpolación entre los bins vecinos) o con `spectrum_replace_dc` (bins
+ * de otra captura sintonizada a otra frecuencia, que tiene su propio DC en
+ * otro lugar).
+ */
+
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <stdint.h>
+
+/**
+ * @def SPECTRUM_DC_FRACTION
+ * @brief Fracción de los bins que cubre el pico de DC a cada lado del centro.
+ */
+#define SPECTRUM_DC_FRACTION (0.002)
+
+/**
+ * @def SPECTRUM_DC_GUARD
+ * @brief Bins a cada lado de la región del DC con los que se estima el nivel vecino.
+ */
+#define SPECTRUM_DC_GUARD (10)
+
+/**
+ * @enum spectrum_order_t
+ * @brief Orden de los bins en `p`.
+ */
+typedef enum {
+    SPECTRUM_CENTERED = 0,   /**< Canónico: frecuencias crecientes, DC en `n / 2`. */
+    SPECTRUM_FFT_ORDER       /**< Orden natural de la FFT: DC en 0, frecuencias negativas al final. */
+} spectrum_order_t;
+
+/**
+ * @enum spectrum_units_t
+ * @brief Unidades de `p`.
+ */
+typedef enum {
+    SPECTRUM_LINEAR = 0,     /**< Densidad de potencia lineal (salida de Welch). */
+    SPECTRUM_DB              /**< 10·log10 de la densidad. */
+} spectrum_units_t;
+
+/**
+ * @struct spectrum_t
+ * @brief Espectro de `n` bins sobre el eje `f0 + i·df` (i en orden canónico).
+ */
+typedef struct {
+    double f0;                  /**< Frecuencia absoluta del primer bin canónico (Hz). */
+    double df;                  /**< Separación entre bins (Hz). */
+    int n;                      /**< Número de bins (par). */
+    spectrum_order_t ordering;  /**< Orden de `p`. */
+    spectrum_units_t units;     /**< Unidades de `p`. */
+    double* p;                  /**< Potencia por bin. */
+} spectrum_t;
+
+/**
+ * @brief Reserva un espectro de `n` bins para la salida de Welch.
+ *
+ * El eje es el de una PSD de `n` puntos a `fs` sintonizada en `center_hz`;
+ * queda en orden canónico y unidades lineales, como lo deja `welch_psd_finalize`.
+ *
+ * @return 0 si se pudo reservar, -1 en caso contrario.
+ */
+int spectrum_alloc(spectrum_t* s, int n, double fs, double center_hz);
+
+/**
+ * @brief Libera los datos de un espectro reservado con `spectrum_alloc`.
+ */
+void spectrum_free(spectrum_t* s);
+
+/**
+ * @brief Frecuencia absoluta (Hz) del bin canónico `i`.
+ */
+static inline double spectrum_freq(const spectrum_t* s, int i)
+{
+    return s->f0 + i * s->df;
+}
+
+/**
+ * @brief Frecuencia central de la sintonía (Hz): la del bin de DC.
+ */
+static inline double spectrum_center(const spectrum_t* s)
+{
+    return spectrum_freq(s, s->n / 2);
+}
+
+/**
+ * @brief Bin canónico más cercano a `freq_hz`.
+ *
+ * @return El bin, o -1 si la frecuencia cae fuera del espectro.
+ */
+int spectrum_bin(const spectrum_t* s, double freq_hz);
+
+/**
+ * @brief Potencia del bin canónico `i`, en cualquier orden de almacenamiento.
+ */
+double spectrum_at(const spectrum_t* s, int i);
+
+/**
+ * @brief Pasa `p` al orden canónico, en sitio (sin arreglos temporales).
+ */
+void spectrum_canonicalize(spectrum_t* s);
+
+/**
+ * @brief Bins que cubre el pico de DC a cada lado del centro (`SPECTRUM_DC_FRACTION`, al menos 1).
+ */
+int spectrum_dc_half_width(const spectrum_t* s);
+
+/**
+ * @brief Reemplaza el pico de DC interpolando entre los niveles vecinos.
+ *
+ * Los bins [`n/2 - half_width`, `n/2 + half_width`] pasan a una recta (en dB)
+ * entre el nivel medio de los `guard` bins inmediatamente por debajo y el de
+ * los `guard` bins inmediatamente por encima.
+ *
+ * @return 0 si se corrigió, -1 si la región y sus vecinos no caben en el espectro.
+ */
+int spectrum_repair_dc(spectrum_t* s, int half_width, int guard);
+
+/**
+ * @brief Reemplaza el pico de DC con los bins de otra captura a la misma frecuencia absoluta.
+ *
+ * `ref` debe estar sintonizado de modo que su propio DC quede fuera de la
+ * región y de sus vecinos (la segunda captura RMER, desplazada 2 MHz). Antes
+ * de copiar, `ref` se lleva al nivel de `s` con la diferencia media (en dB)
+ * entre ambos sobre los `guard` bins a cada lado de la región.
+ *
+ * @return 0 si se corrigió, -1 si `ref` no cubre la región, comparte el DC o
+ * tiene otras unidades.
+ */
+int spectrum_replace_dc(spectrum_t* s, const spectrum_t* ref, int half_width, int guard);
+
+#endif // SPECTRUM_H
@@ -0,0 +1,94 @@
+/**
+ * @file spsc_ring.c
+ * @brief Implementación de la cola circular de un productor y un consumidor.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spsc_ring.h"
+
+int spsc_ring_init(spsc_ring_t* r, size_t size)
+{
+    size_t capacity = SPSC_CACHE_LINE;
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+
+    memset(r, 0, sizeof(*r));
+    if (posix_memalign((void**)&r->buf, SPSC_CACHE_LINE, capacity) != 0) {
+        r->buf = NULL;
+        fprintf(stderr, "Error: Unable to allocate %zu byte ring\n", capacity);
+        return -1;
+    }
+    r->size = capacity;
+    r->mask = capacity - 1;
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    return 0;
+}
+
+void spsc_ring_free(spsc_ring_t* r)
+{
+    free(r->buf);
+    r->buf = NULL;
+    r->size = 0;
+    r->mask = 0;
+}
+
+void spsc_ring_reset(spsc_ring_t* r)
+{
+    atomic_store(&r->head, 0);
+    atomic_store(&r->tail, 0);
+    r->drops = 0;
+    r->dropped_bytes = 0;
+    r->high_water = 0;
+}
+
+bool spsc_ring_push(spsc_ring_t* r, const uint8_t* data, size_t length)
+{
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    size_t used = tail - head;
+
+    if (length > r->size - used) {
+        r->drops++;
+        r->dropped_bytes += length;
+        return false;
+    }
+
+    size_t pos = tail & r->mask;
+    size_t first = r->size - pos;
+    if (first >= length) {
+        memcpy(r->buf + pos, data, length);
+    } else {
+        memcpy(r->buf + pos, data, first);
+        memcpy(r->buf, data + first, length - first);
+    }
+
+    used += length;
+    if (used > r->high_water) {
+        r->high_water = used;
+    }
+    atomic_store_explicit(&r->tail, tail + length, memory_order_release);
+    return true;
+}
+
+size_t spsc_ring_peek(spsc_ring_t* r, const uint8_t** data)
+{
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    size_t available = tail - head;
+    size_t pos = head & r->mask;
+    size_t first = r->size - pos;
+
+    *data = r->buf + pos;
+    return (available < first) ? available : first;
+}
+
+void spsc_ring_consume(spsc_ring_t* r, size_t length)
+{
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    atomic_store_explicit(&r->head, head + length, memory_order_release);
+}
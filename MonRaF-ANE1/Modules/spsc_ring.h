@@ -0,0 +1,83 @@
+/**
+ * @file spsc_ring.h
+ * @brief Cola circular sin bloqueos de un productor y un consumidor para bytes de captura.
+ *
+ * El productor es el callback USB de HackRF y el consumidor un hilo que vacía
+ * la cola hacia el destino de la captura. Cada índice vive en su propia línea
+ * de caché para que los dos hilos no se invaliden mutuamente, y el tamaño es
+ * potencia de dos para envolver con una máscara. Si no hay espacio, el bloque
+ * completo se descarta y se cuenta: el productor nunca espera.
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/**
+ * @def SPSC_CACHE_LINE
+ * @brief Tamaño de línea de caché usado para separar los índices.
+ */
+#define SPSC_CACHE_LINE 64
+
+/**
+ * @struct spsc_ring_t
+ * @brief Estado de la cola.
+ */
+typedef struct {
+    uint8_t* buf;                                      /**< Almacenamiento de `size` bytes. */
+    size_t size;                                       /**< Capacidad (potencia de dos). */
+    size_t mask;                                       /**< `size - 1`. */
+    _Alignas(SPSC_CACHE_LINE) atomic_size_t head;      /**< Bytes consumidos (sólo escribe el consumidor). */
+    _Alignas(SPSC_CACHE_LINE) atomic_size_t tail;      /**< Bytes producidos (sólo escribe el productor). */
+    _Alignas(SPSC_CACHE_LINE) uint32_t drops;          /**< Bloques descartados por falta de espacio. */
+    uint64_t dropped_bytes;                            /**< Bytes descartados por falta de espacio. */
+    size_t high_water;                                 /**< Máxima ocupación observada por el productor. */
+} spsc_ring_t;
+
+/**
+ * @brief Reserva la cola.
+ *
+ * @param r Cola.
+ * @param size Capacidad deseada en bytes; se redondea a la siguiente potencia de dos.
+ *
+ * @return 0 si se reservó, -1 en caso de error.
+ */
+int spsc_ring_init(spsc_ring_t* r, size_t size);
+
+/**
+ * @brief Libera la cola.
+ */
+void spsc_ring_free(spsc_ring_t* r);
+
+/**
+ * @brief Vacía la cola y sus contadores. Sólo con productor y consumidor detenidos.
+ */
+void spsc_ring_reset(spsc_ring_t* r);
+
+/**
+ * @brief Copia `length` bytes a la cola (lado productor).
+ *
+ * @return true si se copiaron; false si no cabían y el bloque se contó como descartado.
+ */
+bool spsc_ring_push(spsc_ring_t* r, const uint8_t* data, size_t length);
+
+/**
+ * @brief Bytes contiguos listos para leer (lado consumidor).
+ *
+ * @param r Cola.
+ * @param data Recibe el puntero al primer byte disponible.
+ *
+ * @return Número de bytes contiguos en `*data` (0 si la cola está vacía).
+ */
+size_t spsc_ring_peek(spsc_ring_t* r, const uint8_t** data);
+
+/**
+ * @brief Libera `length` bytes ya procesados (lado consumidor).
+ */
+void spsc_ring_consume(spsc_ring_t* r, size_t length);
+
+#endif // SPSC_RING_H
@@ -0,0 +1,189 @@
+/**
+ * @file sweep.c
+ * @brief Implementación del barrido continuo con acumuladores Welch por tramo.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libhackrf/hackrf.h>
+
+#include "sweep.h"
+#include "spectrum.h"
+#include "bacn_RF.h"
+
+/** @brief Muestras IQ de un bloque después de la cabecera. */
+#define SWEEP_BLOCK_SAMPLES ((BYTES_PER_BLOCK - RF_SWEEP_HEADER_BYTES) / 2)
+
+int sweep_init(sweep_t* sw, uint64_t lo_hz, uint64_t hi_hz, int segment_length,
+               double overlap, int sweeps, window_type_t window)
+{
+    memset(sw, 0, sizeof(*sw));
+
+    if (lo_hz % 1000000 != 0 || hi_hz % 1000000 != 0 || hi_hz <= lo_hz ||
+        hi_hz / 1000000 > UINT16_MAX) {
+        fprintf(stderr, "Error: sweep range must be whole MHz (%lu - %lu)\n", lo_hz, hi_hz);
+        return -1;
+    }
+    if (segment_length <= 0 || segment_length > SWEEP_BLOCK_SAMPLES) {
+        fprintf(stderr, "Error: sweep segment length must fit in one block (%d)\n",
+                SWEEP_BLOCK_SAMPLES);
+        return -1;
+    }
+
+    sw->lo_hz = lo_hz;
+    sw->fs = DEFAULT_SAMPLE_RATE_HZ;
+    sw->n_tiles = (int)((hi_hz - lo_hz + SWEEP_STEP_HZ - 1) / SWEEP_STEP_HZ);
+    sw->segment_length = segment_length;
+    sw->keep_bins = (int)((double)SWEEP_STEP_HZ / sw->fs * segment_length + 0.5);
+    sw->sweeps_target = (sweeps > 0) ? sweeps : 1;
+    sw->hop_tile = -1;
+
+    // Un solo rango: el firmware salta de lo_hz en pasos de SWEEP_STEP_HZ hasta pasar hi_hz
+    sw->plan.freq_list_mhz[0] = (uint16_t)(lo_hz / 1000000);
+    sw->plan.freq_list_mhz[1] = (uint16_t)(hi_hz / 1000000);
+    sw->plan.num_ranges = 1;
+    sw->plan.num_bytes = SWEEP_BLOCKS_PER_HOP * BYTES_PER_BLOCK;
+    sw->plan.step_hz = SWEEP_STEP_HZ;
+    sw->plan.offset_hz = SWEEP_STEP_HZ / 2;
+
+    sw->tiles = calloc((size_t)sw->n_tiles, sizeof(welch_stream_t));
+    if (sw->tiles == NULL) {
+        fprintf(stderr, "Error: Unable to allocate sweep tiles\n");
+        return -1;
+    }
+    for (int t = 0; t < sw->n_tiles; t++) {
+        if (welch_stream_init(&sw->tiles[t], sw->fs, segment_length, overlap,
+                              window) != 0) {
+            sw->n_tiles = t;
+            sweep_free(sw);
+            return -1;
+        }
+    }
+
+    fprintf(stderr, "Sweep plan: %lu - %lu Hz, %d tiles of %d Hz\n",
+            lo_hz, hi_hz, sw->n_tiles, SWEEP_STEP_HZ);
+    return 0;
+}
+
+/**
+ * @brief Tramo al que pertenece un bloque según su cabecera, o -1 si no es válido.
+ */
+static int sweep_block_tile(const sweep_t* sw, const uint8_t* block)
+{
+    if (block[0] != 0x7F || block[1] != 0x7F) {
+        return -1;
+    }
+
+    uint64_t freq = 0;
+    for (int b = 7; b >= 0; b--) {
+        freq = (freq << 8) | block[2 + b];
+    }
+
+    if (freq < sw->lo_hz || (freq - sw->lo_hz) % SWEEP_STEP_HZ != 0) {
+        return -1;
+    }
+    uint64_t tile = (freq - sw->lo_hz) / SWEEP_STEP_HZ;
+    return (tile < (uint64_t)sw->n_tiles) ? (int)tile : -1;
+}
+
+bool sweep_push(sweep_t* sw, const uint8_t* buffer, size_t length)
+{
+    uint32_t blocks_per_hop = sw->plan.num_bytes / BYTES_PER_BLOCK;
+
+    for (size_t pos = 0; pos + BYTES_PER_BLOCK <= length; pos += BYTES_PER_BLOCK) {
+        const uint8_t* block = buffer + pos;
+        int tile = sweep_block_tile(sw, block);
+        if (tile < 0) {
+            sw->blocks_dropped++;
+            continue;
+        }
+
+        if (tile != sw->hop_tile) {
+            sw->hop_tile = tile;
+            sw->hop_blocks = 0;
+        }
+
+        // La cabecera pisa las primeras muestras: cada bloque es un tramo de señal aparte
+        welch_stream_t* ws = &sw->tiles[tile];
+        welch_stream_break(ws);
+        welch_stream_push_cs8(ws, (const int8_t*)(block + RF_SWEEP_HEADER_BYTES),
+                              BYTES_PER_BLOCK - RF_SWEEP_HEADER_BYTES);
+        sw->blocks++;
+
+        if (++sw->hop_blocks == blocks_per_hop) {
+            sw->hop_blocks = 0;
+            if (tile == sw->n_tiles - 1) {
+                sw->sweeps_done++;
+            }
+        }
+    }
+    return sw->sweeps_done >= sw->sweeps_target;
+}
+
+int sweep_bins(const sweep_t* sw)
+{
+    return sw->n_tiles * sw->keep_bins;
+}
+
+int sweep_panorama(const sweep_t* sw, double* f_out, double* P_out)
+{
+    int nperseg = sw->segment_length;
+    int first = nperseg / 2 - sw->keep_bins / 2;
+    int result = 0;
+
+    // Un tramo a la vez; el eje es relativo a la sintonía del tramo
+    spectrum_t tile;
+    if (spectrum_alloc(&tile, nperseg, sw->fs, 0.0) != 0) {
+        return -1;
+    }
+
+    for (int t = 0; t < sw->n_tiles; t++) {
+        if (welch_stream_finish(&sw->tiles[t], NULL, tile.p) <= 0) {
+            fprintf(stderr, "Error: sweep tile %d has no data\n", t);
+            result = -1;
+            break;
+        }
+
+        // Pico de DC en el centro del tramo
+        if (spectrum_repair_dc(&tile, SWEEP_DC_HALF_BINS, SPECTRUM_DC_GUARD) != 0) {
+            result = -1;
+            break;
+        }
+
+        double center = (double)(sw->lo_hz + (uint64_t)t * SWEEP_STEP_HZ + sw->plan.offset_hz);
+        double* f_dst = f_out + (size_t)t * sw->keep_bins;
+        double* P_dst = P_out + (size_t)t * sw->keep_bins;
+        for (int j = 0; j < sw->keep_bins; j++) {
+            f_dst[j] = center + spectrum_freq(&tile, first + j);
+            P_dst[j] = tile.p[first + j];
+        }
+    }
+
+    fprintf(stderr, "Sweep: %d sweeps, %lu blocks, %lu dropped\n",
+            sw->sweeps_done, sw->blocks, sw->blocks_dropped);
+
+    spectrum_free(&tile);
+    return result;
+}
+
+void sweep_reset(sweep_t* sw)
+{
+    for (int t = 0; t < sw->n_tiles; t++) {
+        welch_stream_reset(&sw->tiles[t]);
+    }
+    sw->hop_tile = -1;
+    sw->hop_blocks = 0;
+    sw->sweeps_done = 0;
+    sw->blocks = 0;
+    sw->blocks_dropped = 0;
+}
+
+void sweep_free(sweep_t* sw)
+{
+    for (int t = 0; t < sw->n_tiles; t++) {
+        welch_stream_free(&sw->tiles[t]);
+    }
+    free(sw->tiles);
+    memset(sw, 0, sizeof(*sw));
+}
@@ -0,0 +1,118 @@
+/**
+ * @file sweep.h
+ * @brief Barrido continuo de un plan de bandas en una sola captura, al estilo de `hackrf_sweep`.
+ *
+ * En lugar de abrir una captura por tramo (UHF2_1 … UHF2_13), el front-end
+ * salta por todas las frecuencias del plan con un único `start_rx`. Cada bloque
+ * llega con la frecuencia de su salto en la cabecera; el bloque se asigna a su
+ * tramo y se suma a un acumulador Welch propio de ese tramo. Al terminar, la
+ * parte central de cada tramo se une en un panorama continuo.
+ *
+ * Las mediciones RMER que abarcan varias bandas (`measurement_submit_sweep`)
+ * barren así todo el intervalo y publican cada banda desde el panorama; las
+ * de una sola banda siguen capturando con `getSamples`. `test_capture`
+ * (`capture_sweep`) guarda el panorama completo.
+ */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "welch_stream.h"
+#include "rf_session.h"
+
+/**
+ * @def SWEEP_STEP_HZ
+ * @brief Ancho útil de cada tramo: se descartan los bordes de la banda de 20 MHz, donde cae el filtro.
+ */
+#define SWEEP_STEP_HZ (15000000)
+
+/**
+ * @def SWEEP_BLOCKS_PER_HOP
+ * @brief Bloques de `BYTES_PER_BLOCK` bytes capturados en cada salto.
+ */
+#define SWEEP_BLOCKS_PER_HOP 16
+
+/**
+ * @def SWEEP_DC_HALF_BINS
+ * @brief Bins a cada lado del centro de un tramo que se interpolan para quitar el pico de DC (`spectrum_repair_dc`).
+ */
+#define SWEEP_DC_HALF_BINS 2
+
+/**
+ * @struct sweep_t
+ * @brief Estado de un barrido.
+ */
+typedef struct {
+    rf_sweep_plan_t plan;        /**< Saltos programados en el front-end. */
+    uint64_t lo_hz;              /**< Frecuencia de salto del primer tramo. */
+    int n_tiles;                 /**< Número de tramos. */
+    double fs;                   /**< Frecuencia de muestreo. */
+    int segment_length;          /**< Longitud de segmento de Welch en cada tramo. */
+    int keep_bins;               /**< Bins de cada tramo que entran en el panorama. */
+    int sweeps_target;           /**< Barridos completos a promediar. */
+    welch_stream_t* tiles;       /**< Un acumulador por tramo. */
+    int hop_tile;                /**< Tramo del último bloque recibido (-1: ninguno). */
+    uint32_t hop_blocks;         /**< Bloques recibidos en el salto actual. */
+    volatile int sweeps_done;    /**< Barridos completos recibidos. */
+    uint64_t blocks;             /**< Bloques aceptados (estadística). */
+    uint64_t blocks_dropped;     /**< Bloques sin cabecera o fuera del plan (estadística). */
+} sweep_t;
+
+/**
+ * @brief Prepara un barrido de [`lo_hz`, `hi_hz`).
+ *
+ * @param sw Barrido a inicializar.
+ * @param lo_hz Inicio del panorama (múltiplo de 1 MHz).
+ * @param hi_hz Fin del panorama (múltiplo de 1 MHz); el último tramo puede pasarse.
+ * @param segment_length Longitud de segmento de Welch (cabe en un bloque).
+ * @param overlap Solapamiento entre segmentos (0 a 1).
+ * @param sweeps Barridos completos a promediar antes de terminar.
+ * @param window Ventana de Welch de cada tramo.
+ *
+ * @return 0 si el barrido quedó listo, -1 en caso de error.
+ */
+int sweep_init(sweep_t* sw, uint64_t lo_hz, uint64_t hi_hz, int segment_length,
+               double overlap, int sweeps, window_type_t window);
+
+/**
+ * @brief Asigna los bloques de una transferencia a sus tramos y los acumula.
+ *
+ * @param sw Barrido.
+ * @param buffer Transferencia recibida (bloques de `BYTES_PER_BLOCK` con cabecera).
+ * @param length Bytes válidos en `buffer`.
+ *
+ * @return true cuando ya se completaron `sweeps_target` barridos.
+ */
+bool sweep_push(sweep_t* sw, const uint8_t* buffer, size_t length);
+
+/**
+ * @brief Número de bins del panorama (`n_tiles * keep_bins`).
+ */
+int sweep_bins(const sweep_t* sw);
+
+/**
+ * @brief Une la PSD de todos los tramos en un panorama ordenado por frecuencia.
+ *
+ * @param sw Barrido.
+ * @param f_out Frecuencias absolutas en Hz (longitud `sweep_bins`).
+ * @param P_out PSD lineal (longitud `sweep_bins`).
+ *
+ * @return 0 si todos los tramos tienen datos, -1 en caso contrario.
+ */
+int sweep_panorama(const sweep_t* sw, double* f_out, double* P_out);
+
+/**
+ * @brief Vacía los acumuladores para un nuevo barrido con el mismo plan.
+ */
+void sweep_reset(sweep_t* sw);
+
+/**
+ * @brief Libera los acumuladores.
+ */
+void sweep_free(sweep_t* sw);
+
+#endif // SWEEP_H
@@ -15,16 +15,19 @@
 #include <ctype.h>
 #include <time.h>
 #include "moda.h"
-#include "cJSON.h"
+#include "psd_archive.h"
 #include "IQ.h"
 #include "tdt_functions.h"
 #include "welch.h"
+#include "spectrum.h"
 #include "cs8_to_iq.h"
+#include "cs8_map.h"
 #include <math.h>
 #include <time.h>
 #include <unistd.h>
 #include "../Drivers/bacn_RTI.h"
 #include "tdt.h"
+#include "parameters.h"
 
 /**
  * @brief Procesa señales IQ para calcular parámetros clave de transmisión digital terrestre.
@@ -38,14 +41,17 @@
  * 
  * @return Código de salida `EXIT_SUCCESS` si la operación se realiza con éxito.
  * 
- * @note Genera un archivo JSON llamado `parameters_tdt.json` con los resultados.
+ * @note Guarda el resultado en el historial binario y lo exporta como JSON en `JSON/<file_sample>`.
  */
 
 extern bool program;
 
-void parameter_tdt(st_server *s_server, int modulation, uint64_t central_freq, uint8_t file_sample,  char* channel) {
-    size_t num_samples;
-    int c_f = central_freq;
+/**
+ * @brief Núcleo común de `parameter_tdt_compute` y `parameter_tdt_compute_iq`: recibe la señal
+ * a 6.5 MS/s como complejos (`data`) o como bytes CS8 (`raw`), según cuál no sea NULL.
+ */
+static int parameter_tdt_src(int modulation, uint64_t central_freq, complex double* data, const int8_t* raw,
+                             size_t num_samples, char* channel, psd_publication_t* pub) {
 
     const char* modulation_type;
 
@@ -59,7 +65,6 @@ void parameter_tdt(st_server *s_server, int modulation, uint64_t central_freq, u
     }
 
     int nperseg = 4096;
-    size_t psd_size = nperseg;
     char Longitude[13];
 
     struct tm time1;
@@ -67,20 +72,13 @@ void parameter_tdt(st_server *s_server, int modulation, uint64_t central_freq, u
 
     time_t startTime, stopTime;
 
-    char file_sample_str[100];
-    sprintf(file_sample_str, "Samples/%d", file_sample); 
-
-     
-    double* Pxx = NULL;
-    double* f = NULL;
-    Pxx = (double*) malloc(psd_size * sizeof(double));
-    f = (double*) malloc(psd_size * sizeof(double));
-
-    complex double* IQ_data = cargar_cs8(file_sample_str, &num_samples);
+    spectrum_t psd;
+    if (spectrum_alloc(&psd, nperseg, 6500000, (double)central_freq) != 0) {
+        return -1;
+    }
+    double* Pxx = psd.p;
 
     printf("Total samples: %lu\r\n", num_samples);
-    delete_CS8(file_sample);
-    delete_JSON(file_sample);
 
     char timer0[17];
     time_t rawtime;
@@ -88,73 +86,25 @@ void parameter_tdt(st_server *s_server, int modulation, uint64_t central_freq, u
     time(&rawtime);
     timeinfo = localtime(&rawtime);
     int presence;
-    int N_f=nperseg;
     strftime(timer0, sizeof(timer0), "%Y-%m-%dT%H:%M", timeinfo);
 
     
     
     double mer_value = 0.0, ber_value = 0.0, c_n_value = 0.0, signal_power_value;
 
-    analyze_signal(central_freq, modulation, IQ_data, num_samples, &mer_value, &ber_value, &c_n_value, &signal_power_value);
-    welch_psd_complex(IQ_data, num_samples, 6500000, nperseg, 0, f, Pxx);
-    free(IQ_data);
-       //real_time();
-    if (nperseg % 2 != 0) {
-        printf("La longitud del vector debe ser par.\n");
-        return;
-    }
-
-
-    // -----------Acomodar potencias de welch-----------
-    int half = nperseg / 2;
-    double* temp = (double*)malloc(nperseg * sizeof(double));
-    double* temp1 = (double*)malloc(4096 * sizeof(double));
-
-    for (int i = 0; i < half; i++) {
-        temp[i] = Pxx[half + i];
-        
-    }
-
-
-    for (int i = 0; i < half; i++) {
-        temp[half + i] = Pxx[i];
-    }
-
-
-    for (int i = 0; i < nperseg; i++) {
-        Pxx[i] = temp[i];
-    } 
-
-
-    free(temp);
-    free(temp1);
-
-    // save_to_file(f, Pxx, nperseg, "data.csv");
-
-    for (int i = 0; i < N_f; i++) {
-        f[i] = (f[i] + central_freq) / 1e6;
+    if (raw != NULL) {
+        analyze_signal_cs8(central_freq, modulation, raw, num_samples, &mer_value, &ber_value, &c_n_value, &signal_power_value);
+        welch_psd_cs8(raw, num_samples, 6500000, nperseg, 0, NULL, Pxx);
+    } else {
+        analyze_signal(central_freq, modulation, data, num_samples, &mer_value, &ber_value, &c_n_value, &signal_power_value);
+        welch_psd_complex(data, num_samples, 6500000, nperseg, 0, NULL, Pxx);
     }
+       //real_time();
 
-    int index = nperseg/2 ;
-    int count = nperseg*0.002;
-    int b=index-(count+5);
-    int a=index;
-
-    for (int i=0; i<count; i++)
-    {   
-        b=b-3;
-        Pxx[a]=Pxx[b];
-        a=a-1;
-        
-        
-    }
-    a=index;
-    for (int i=0; i<count; i++)
-    {   
-        Pxx[a]=Pxx[b];
-        a=a+1;
-        b=b+2;
-        
+    // Welch ya entrega el orden canónico: el DC está en el centro de la PSD
+    if (spectrum_repair_dc(&psd, spectrum_dc_half_width(&psd), SPECTRUM_DC_GUARD) != 0) {
+        spectrum_free(&psd);
+        return -1;
     }
 
     char FlowTdt[5];
@@ -164,99 +114,71 @@ void parameter_tdt(st_server *s_server, int modulation, uint64_t central_freq, u
     sprintf(FlowTdt, "%d", Flow);
     sprintf(FhighTdt, "%d", Fhigh);
         
-// Crear el objeto JSON raíz
-    cJSON *json_root = cJSON_CreateObject();
-
-    // Agregar la fecha y hora al objeto JSON
-    cJSON_AddStringToObject(json_root, "datetime", timer0);
-    cJSON_AddStringToObject(json_root, "fmin", FlowTdt);
-    cJSON_AddStringToObject(json_root, "fmax", FhighTdt);
-    cJSON_AddStringToObject(json_root, "measure", "RMTDT");
-    cJSON_AddStringToObject(json_root, "units", "MHz");
-    cJSON_AddStringToObject(json_root, "channel", channel);
-    cJSON_AddStringToObject(json_root, "band", "UHF");
-
-    cJSON *json_vectors = cJSON_CreateObject();
-    char tempu[50];
-    // Agregar los vectores Pxx y f al objeto JSON
-    cJSON *json_Pxx_array = cJSON_CreateArray();
-    for (int i = 0; i < 4096; i++) {
-        memset(tempu, 0, sizeof(tempu));
-        sprintf(tempu, "%0.3f", 10*log10(Pxx[i]));
-        cJSON_AddItemToArray(json_Pxx_array, cJSON_CreateNumber(atof(tempu)));
-        //cJSON_AddItemToArray(json_Pxx_array, cJSON_CreateNumber(10*log10(constante*Pxx1[i])));
+    // Registro de la medición
+    psd_record_header_t record;
+    psd_record_init(&record, PSD_MEASURE_RMTDT, rawtime, timer0, central_freq, 6500000, 4096, 1);
+    snprintf(record.band, sizeof(record.band), "%s", "UHF");
+    snprintf(record.fmin, sizeof(record.fmin), "%s", FlowTdt);
+    snprintf(record.fmax, sizeof(record.fmax), "%s", FhighTdt);
+    snprintf(record.channel, sizeof(record.channel), "%s", channel);
+    snprintf(record.modulation, sizeof(record.modulation), "%s", modulation_type);
+
+    double* psd_db = (double*)malloc(4096 * sizeof(double));
+    double* params = (double*)malloc(PSD_RMTDT_COLS * sizeof(double));
+    if (psd_db == NULL || params == NULL) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        free(psd_db);
+        free(params);
+        spectrum_free(&psd);
+        return -1;
     }
-    cJSON_AddItemToObject(json_vectors, "Pxx", json_Pxx_array);
-
-    cJSON *json_f_array = cJSON_CreateArray();
     for (int i = 0; i < 4096; i++) {
-        memset(tempu, 0, sizeof(tempu));
-        sprintf(tempu, "%0.3f", f[i]);
-        cJSON_AddItemToArray(json_f_array, cJSON_CreateNumber(atof(tempu)));
-        //cJSON_AddItemToArray(json_f_array, cJSON_CreateNumber(f1[i]));
+        psd_db[i] = 10*log10(Pxx[i]);
     }
-    cJSON_AddItemToObject(json_vectors, "f", json_f_array);
 
-    cJSON_AddItemToObject(json_root, "vectors", json_vectors);
+    params[0] = central_freq / 1e6;
+    params[1] = 10 * log10(signal_power_value);
+    params[2] = c_n_value;
+    params[3] = mer_value;
+    params[4] = ber_value;
 
-    // Crear el arreglo de parámetros
-    cJSON *json_params = cJSON_CreateObject();
-    cJSON *json_params_array = cJSON_CreateArray();
+    pub->record = record;
+    pub->psd_db = psd_db;
+    pub->params = params;
 
-    cJSON_AddNumberToObject(json_params, "freq", central_freq / 1e6);
-    cJSON_AddNumberToObject(json_params, "power", 10 * log10(signal_power_value));
-    cJSON_AddNumberToObject(json_params, "C/N", c_n_value);
-    cJSON_AddNumberToObject(json_params, "MER", mer_value);
-    cJSON_AddNumberToObject(json_params, "BER", ber_value);
-    cJSON_AddStringToObject(json_params, "modulation", modulation_type);
-    cJSON_AddStringToObject(json_params, "rate hp", "2/3");
-    cJSON_AddStringToObject(json_params, "guard", "1/8");
-    cJSON_AddNumberToObject(json_params, "segment length", 1024);
-    cJSON_AddNumberToObject(json_params, "fs", 20000000);
-    cJSON_AddStringToObject(json_params, "window", "Hamming");
-    cJSON_AddNumberToObject(json_params, "bandwidth", 6500000);
-    cJSON_AddNumberToObject(json_params, "overlap", 0);
+    spectrum_free(&psd);
+    return 0;
+}
 
-    cJSON_AddItemToArray(json_params_array, json_params);
+int parameter_tdt_compute(int modulation, uint64_t central_freq, uint8_t file_sample, char* channel, psd_publication_t* pub) {
+    char file_sample_str[100];
+    sprintf(file_sample_str, "Samples/%d", file_sample);
 
-    //write(s_server->conf_fd, dataServer, strlen(dataServer));
-    cJSON_AddItemToObject(json_root, "params", json_params_array);
+    cs8_map_t capture;
+    if (cs8_map_open(&capture, file_sample_str) != 0) {
+        return -1;
+    }
+    delete_CS8(file_sample);
 
-    cJSON *json_data = cJSON_CreateObject();
+    int result = parameter_tdt_src(modulation, central_freq, NULL, capture.data, capture.num_samples, channel, pub);
+    cs8_map_close(&capture);
+    return result;
+}
 
-    cJSON_AddItemToObject(json_data, "data", json_root);
+int parameter_tdt_compute_iq(int modulation, uint64_t central_freq, complex double* data, size_t num_samples, char* channel, psd_publication_t* pub) {
+    return parameter_tdt_src(modulation, central_freq, data, NULL, num_samples, channel, pub);
+}
 
-    char *json_string = cJSON_Print(json_data);
+void parameter_tdt(st_server *s_server, int modulation, uint64_t central_freq, uint8_t file_sample,  char* channel) {
+    psd_publication_t pub;
+    if (parameter_tdt_compute(modulation, central_freq, file_sample, channel, &pub) != 0) {
+        return;
+    }
 
     char filename[20];
     memset(filename, 0, 20);
     sprintf(filename, "JSON/%d", file_sample);
 
-    FILE *file = fopen(filename, "w");
-    if (file == NULL) {
-        printf("Error al abrir el archivo para escribir.\n");
-        cJSON_Delete(json_root);
-        free(json_string);
-        free(f);
-        free(Pxx);
-        free(IQ_data);
-        return;
-    }
-    fprintf(file, "%s", json_string);
-    fclose(file);
-#include "welch.h"
-    char dataServer[10];
-    memset(dataServer, 0, sizeof(dataServer));
-    if(program) {
-        sprintf(dataServer, "{data:{}}");
-    } else {
-        sprintf(dataServer, "{dataStreaming:{}}");
-    }
-    write(s_server->conf_fd, dataServer, strlen(dataServer));
-
-    
-    cJSON_Delete(json_root);
-    free(json_string);
-    free(f);
-    free(Pxx);
-}
\ No newline at end of file
+    parameter_publish(&pub, s_server, filename);
+    psd_publication_free(&pub);
+}
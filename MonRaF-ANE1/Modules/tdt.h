@@ -15,6 +15,7 @@
 #include "cJSON.h"
 #include "cs8_to_iq.h"
 #include "tdt_functions.h"
+#include "psd_archive.h"
 #include "../Drivers/bacn_RTI.h"
 /**
  * @brief Procesa señales IQ para calcular parámetros clave de transmisión digital terrestre.
@@ -32,4 +33,17 @@
  */
 void parameter_tdt(st_server *s_server, int modulation, uint64_t central_freq, uint8_t file_sample, char* channel);
 
+/**
+ * @brief Igual que `parameter_tdt` pero sin publicar: deja la medición en `pub`.
+ *
+ * @return 0 si `pub` quedó lleno (liberar con `psd_publication_free`), -1 en caso de error.
+ */
+int parameter_tdt_compute(int modulation, uint64_t central_freq, uint8_t file_sample, char* channel, psd_publication_t* pub);
+
+/**
+ * @brief Igual que `parameter_tdt_compute`, sobre una señal ya en memoria a 6.5 MS/s
+ * (p. ej. un canal extraído con `ddc_extract_cs8` de una captura de banda ancha).
+ */
+int parameter_tdt_compute_iq(int modulation, uint64_t central_freq, complex double* data, size_t num_samples, char* channel, psd_publication_t* pub);
+
 #endif // TDT_H
\ No newline at end of file
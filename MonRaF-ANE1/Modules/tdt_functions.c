@@ -16,7 +16,7 @@
 #include "save_to_file.h"
 #include "welch.h"
 #include "tdt_functions.h"
-#include "find_closest_index.h"
+#include "spectrum.h"
 #include "parameters.h"
 
 #define M_PI 3.14159265358979323846
@@ -32,10 +32,8 @@ double c_n(double* Pxx, double* f, int f_low, int f_high) {
 
 
 double mer(int f_low, int f_high, double* Pxx, int N) {
+    // El pico de DC ya viene reparado con spectrum_repair_dc: no se parchan bins fijos
     // Inicializar los valores máximo y mínimo en el array completo
-    Pxx[513]= Pxx[510];
-    Pxx[512]= Pxx[510];
-    Pxx[511]= Pxx[510];
     double max_power = Pxx[0];
     double min_power = Pxx[0];
     int a;
@@ -57,98 +55,57 @@ double mer(int f_low, int f_high, double* Pxx, int N) {
 
 
 
-void analyze_signal(double frecuencia, int modulation, complex double* data, size_t data_len, double* mer_value, double* ber_value, double* c_n_value, double* signal_power) {
+/**
+ * @brief Núcleo común de `analyze_signal` y `analyze_signal_cs8`: recibe la señal
+ * como complejos (`data`) o como bytes CS8 (`raw`), según cuál no sea NULL.
+ */
+static void analyze_signal_src(double frecuencia, int modulation, complex double* data, const int8_t* raw, size_t data_len, double* mer_value, double* ber_value, double* c_n_value, double* signal_power) {
     int segment_length = 4096;
     double fs = 6500000;
     //char window[10] = 'Hamming';
     double bandwidth = 6500000;
     double overlap = 0.0;
 
-    double* f1 = (double*)malloc(segment_length * sizeof(double));
-    double* Pxx1 = (double*)malloc(segment_length * sizeof(double));
-
-    // Verificación de asignaciones de memoria en un solo bloque
-    if (!f1 || !Pxx1) {
-        fprintf(stderr, "Memory allocation failed.\n");
-        free(f1);
-        free(Pxx1);
+    spectrum_t psd;
+    if (spectrum_alloc(&psd, segment_length, fs, frecuencia) != 0) {
         return; // Usa return para manejar errores sin exit
     }
-    // Calcular PSD usando Welch
-    welch_psd_complex(data, data_len, fs, segment_length, overlap, f1, Pxx1);
-
-    //-----------Acomodar potencias de welch-----------
-    int half = segment_length / 2;
-    double* temp = (double*)malloc(segment_length * sizeof(double));
-
-    for (int i = 0; i < half; i++) {
-        temp[i] = Pxx1[half + i];
-    }
-
-
-    for (int i = 0; i < half; i++) {
-        temp[half + i] = Pxx1[i];
-    }
+    double* Pxx1 = psd.p;
 
-    for (int i = 0; i < segment_length; i++) {
-        Pxx1[i] = temp[i];
-    }
-
-    free(temp);
-
-    for (int i = 0; i < segment_length; i++) {
-        f1[i] = (f1[i] + frecuencia) / 1000000;
-    }
-    int index = segment_length/2 ;
-    int count = segment_length*0.002;
-    int b=index-(count+5);
-    int a=index;
-
-    for (int i=0; i<count; i++)
-    {   
-        b=b-3;
-        Pxx1[a]=Pxx1[b];
-        a=a-1;
-        
-        
-    }
-    a=index;
-    for (int i=0; i<count; i++)
-    {   
-        Pxx1[a]=Pxx1[b];
-        a=a+1;
-        b=b+2;
-        
+    // Calcular PSD usando Welch; el eje es el de `psd`
+    if (raw != NULL) {
+        welch_psd_cs8(raw, data_len, fs, segment_length, overlap, NULL, Pxx1);
+    } else {
+        welch_psd_complex(data, data_len, fs, segment_length, overlap, NULL, Pxx1);
     }
 
-    
-
-    double fc = frecuencia;
-    int f_low = find_closest_index(f1, segment_length/2, fc - 3);
-    int f_high = find_closest_index(f1, segment_length/2, fc + 3);
-
-    f_low = 40;
-    f_high = 950;
-
-    // Verificación de índices válidos para evitar accesos fuera de los límites
-    if (f_low < 0 || f_high >= segment_length || f_low >= f_high) {
-        fprintf(stderr, "Invalid frequency indices.\n");
-        free(f1);
-        free(Pxx1);
+    // Welch ya entrega el orden canónico: el DC está en el centro de la PSD
+    if (spectrum_repair_dc(&psd, spectrum_dc_half_width(&psd), SPECTRUM_DC_GUARD) != 0) {
+        spectrum_free(&psd);
         return;
     }
 
+    // Región de la señal dentro del canal, en bins del eje ascendente
+    int f_low = 40;
+    int f_high = 950;
+
     // Calcular MER, BER y C/N
     *mer_value = mer(f_low, f_high , Pxx1, 1024);
 
     float MOD= modulation;
     *ber_value = calculate_BER_from_snr(*mer_value, MOD);
    
-    *c_n_value, *signal_power = c_n(Pxx1, f1, f_low, f_high);
+    *c_n_value, *signal_power = c_n(Pxx1, NULL, f_low, f_high);
+
+    spectrum_free(&psd);
+}
+
+void analyze_signal(double frecuencia, int modulation, complex double* data, size_t data_len, double* mer_value, double* ber_value, double* c_n_value, double* signal_power) {
+    analyze_signal_src(frecuencia, modulation, data, NULL, data_len, mer_value, ber_value, c_n_value, signal_power);
+}
 
-    // Liberar memoria
-    free(f1);
-    free(Pxx1);
+void analyze_signal_cs8(double frecuencia, int modulation, const int8_t* raw, size_t data_len, double* mer_value, double* ber_value, double* c_n_value, double* signal_power) {
+    analyze_signal_src(frecuencia, modulation, NULL, raw, data_len, mer_value, ber_value, c_n_value, signal_power);
 }
 
 
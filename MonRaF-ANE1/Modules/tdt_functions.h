@@ -14,6 +14,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <stdint.h>
 #include <complex.h>
 
 #define M_PI 3.14159265358979323846
@@ -33,6 +34,9 @@ double c_n(double* Pxx, double* f, int f_low, int f_high);
 /**
  * @brief Calcula la Modulation Error Ratio (MER).
  *
+ * `Pxx` debe llegar con el pico de DC ya reparado (`spectrum_repair_dc`), como
+ * lo deja `analyze_signal`.
+ *
  * @param f_low Índice inferior del rango de frecuencia de interés.
  * @param f_high Índice superior del rango de frecuencia de interés.
  * @param Pxx Densidad espectral de potencia (PSD) calculada.
@@ -57,6 +61,21 @@ double mer(int f_low, int f_high, double* Pxx, int N);
 
 void analyze_signal(double frecuencia, int modulation, complex double* data, size_t data_len, double* mer_value, double* ber_value, double* c_n_value, double* signal_power);
 
+/**
+ * @brief Igual que `analyze_signal`, pero leyendo directamente muestras CS8 (p. ej. de `cs8_map_t`).
+ *
+ * @param frecuencia Frecuencia central de la señal (en Hz).
+ * @param modulation Tipo de modulación (ej., 64-QAM, 16-QAM).
+ * @param raw Pares I/Q int8 intercalados (longitud 2 * `data_len` bytes).
+ * @param data_len Número de muestras IQ.
+ * @param mer_value Referencia para almacenar el valor calculado de MER.
+ * @param ber_value Referencia para almacenar el valor calculado de BER.
+ * @param c_n_value Referencia para almacenar el valor calculado de C/N.
+ * @param signal_power Referencia para almacenar la potencia de la señal.
+ */
+
+void analyze_signal_cs8(double frecuencia, int modulation, const int8_t* raw, size_t data_len, double* mer_value, double* ber_value, double* c_n_value, double* signal_power);
+
 /**
  * @brief Realiza un desplazamiento FFT para reordenar el espectro.
  *
@@ -0,0 +1,393 @@
+/**
+ * @file tdt_index.c
+ * @brief Implementación del índice de canales TDT por ciudad.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <pthread.h>
+
+#include "tdt_index.h"
+
+/**
+ * @struct city_entry_t
+ * @brief Ciudad del índice: sus canales son `channel_pool[first, first + count)`.
+ */
+typedef struct {
+    char key[TDT_CITY_NAME_MAX];   /**< Nombre normalizado. */
+    int first;                     /**< Primer canal. */
+    int count;                     /**< Número de canales. */
+} city_entry_t;
+
+/**
+ * @struct city_alias_t
+ * @brief Nombre (ya normalizado) con el que el servidor pide una ciudad y el de su archivo.
+ */
+typedef struct {
+    const char* from;
+    const char* to;
+} city_alias_t;
+
+static const city_alias_t city_aliases[] = {
+    {"san andres islas", "san andres"},
+};
+
+/**
+ * @brief Letra base de U+00C0..U+00FF (segundo byte de 0xC3 menos 0x80); 0 para × y ÷.
+ */
+static const char latin1_base[64] = {
+    'a', 'a', 'a', 'a', 'a', 'a', 'a', 'c', 'e', 'e', 'e', 'e', 'i', 'i', 'i', 'i',
+    'd', 'n', 'o', 'o', 'o', 'o', 'o', 0,   'o', 'u', 'u', 'u', 'u', 'y', 't', 's',
+    'a', 'a', 'a', 'a', 'a', 'a', 'a', 'c', 'e', 'e', 'e', 'e', 'i', 'i', 'i', 'i',
+    'd', 'n', 'o', 'o', 'o', 'o', 'o', 0,   'o', 'u', 'u', 'u', 'u', 'y', 't', 'y',
+};
+
+static tdt_channel_t* channel_pool = NULL;
+static int channel_count = 0;
+static int* channel_city = NULL;      /**< Ciudad de cada canal de `channel_pool`. */
+
+static city_entry_t* cities = NULL;
+static int city_count = 0;
+
+/** @brief Tablas hash: índice en `cities` / `channel_pool`, o -1 si la ranura está libre. */
+static int* city_slots = NULL;
+static size_t city_mask = 0;
+static int* channel_slots = NULL;
+static size_t channel_mask = 0;
+
+static pthread_once_t index_once = PTHREAD_ONCE_INIT;
+static int index_status = -1;
+
+static uint64_t fnv1a_str(uint64_t hash, const char* s)
+{
+    for (; *s != '\0'; s++) {
+        hash ^= (unsigned char)*s;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static uint64_t city_hash(const char* key)
+{
+    return fnv1a_str(14695981039346656037ull, key);
+}
+
+static uint64_t channel_hash(const char* key, const char* channel)
+{
+    // El separador evita que ("a", "b1") y ("ab", "1") coincidan
+    uint64_t hash = fnv1a_str(14695981039346656037ull, key);
+    hash = (hash ^ 0xff) * 1099511628211ull;
+    return fnv1a_str(hash, channel);
+}
+
+void tdt_index_normalize(const char* in, char* out, size_t cap)
+{
+    const unsigned char* p = (const unsigned char*)in;
+    size_t n = 0;
+    int pending_space = 0;
+
+    if (cap == 0) {
+        return;
+    }
+
+    while (*p != '\0' && n + 1 < cap) {
+        char c = 0;
+        if (*p == 0xC3 && p[1] >= 0x80 && p[1] <= 0xBF) {
+            // Latin-1 compuesto: vocal con tilde, ñ, ü, ...
+            c = latin1_base[p[1] - 0x80];
+            p += 2;
+        } else if ((*p == 0xCC && p[1] >= 0x80 && p[1] <= 0xBF) || (*p == 0xCD && p[1] >= 0x80 && p[1] <= 0xAF)) {
+            // Marca combinante U+0300..U+036F (forma descompuesta): se descarta
+            p += 2;
+            continue;
+        } else if (isalnum(*p)) {
+            c = (char)tolower(*p);
+            p++;
+        } else if (*p < 0x80) {
+            // Espacios, puntos, guiones y demás separadores ASCII
+            pending_space = (n > 0);
+            p++;
+            continue;
+        } else {
+            // Otro carácter multibyte: se copia tal cual
+            c = (char)*p;
+            p++;
+        }
+        if (c == 0) {
+            continue;
+        }
+        if (pending_space) {
+            out[n++] = ' ';
+            pending_space = 0;
+            if (n + 1 >= cap) {
+                break;
+            }
+        }
+        out[n++] = c;
+    }
+    out[n] = '\0';
+
+    // "Pto." abrevia "Puerto"
+    if (strncmp(out, "pto ", 4) == 0 && n + 3 < cap) {
+        memmove(out + 7, out + 4, n - 4 + 1);
+        memcpy(out, "puerto ", 7);
+    }
+    for (size_t i = 0; i < sizeof(city_aliases) / sizeof(city_aliases[0]); i++) {
+        if (strcmp(out, city_aliases[i].from) == 0) {
+            snprintf(out, cap, "%s", city_aliases[i].to);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Copia `channel` sin espacios al principio ni al final.
+ */
+static void trim_channel(const char* channel, char* out, size_t cap)
+{
+    while (isspace((unsigned char)*channel)) {
+        channel++;
+    }
+    snprintf(out, cap, "%s", channel);
+    size_t n = strlen(out);
+    while (n > 0 && isspace((unsigned char)out[n - 1])) {
+        out[--n] = '\0';
+    }
+}
+
+/**
+ * @brief Agrega los canales de un archivo al final de `channel_pool`.
+ *
+ * @return Canales agregados, o -1 si no se pudo leer o no hay memoria.
+ */
+static int load_city_file(const char* path, int city, int* capacity)
+{
+    char line[MAX_BAND_SIZE];
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Unable to open file %s\n", path);
+        return -1;
+    }
+
+    int rows = 0;
+    fgets(line, sizeof(line), file);
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char canal[13];
+        unsigned frequencia;
+        int modulacion;
+        if (sscanf(line, " %12[^,],%u,%d", canal, &frequencia, &modulacion) != 3) {
+            continue;
+        }
+
+        if (channel_count == *capacity) {
+            int grown = (*capacity == 0) ? 256 : 2 * *capacity;
+            tdt_channel_t* pool = (tdt_channel_t*)realloc(channel_pool, (size_t)grown * sizeof(tdt_channel_t));
+            if (pool != NULL) channel_pool = pool;
+            int* owner = (int*)realloc(channel_city, (size_t)grown * sizeof(int));
+            if (owner != NULL) channel_city = owner;
+            if (pool == NULL || owner == NULL) {
+                fprintf(stderr, "Error: No se pudo reservar memoria para los canales TDT\n");
+                fclose(file);
+                return -1;
+            }
+            *capacity = grown;
+        }
+
+        tdt_channel_t* ch = &channel_pool[channel_count];
+        trim_channel(canal, ch->channel, sizeof(ch->channel));
+        ch->freq_mhz = (uint16_t)frequencia;
+        ch->modulation = modulacion;
+        channel_city[channel_count] = city;
+        channel_count++;
+        rows++;
+    }
+
+    fclose(file);
+    return rows;
+}
+
+/**
+ * @brief Potencia de dos (como máscara) con al menos el doble de ranuras que `n`.
+ */
+static size_t table_mask(int n)
+{
+    size_t size = 16;
+    while (size < 2 * (size_t)n) {
+        size *= 2;
+    }
+    return size - 1;
+}
+
+static int city_find(const char* key)
+{
+    if (city_slots == NULL) {
+        return -1;
+    }
+    for (size_t s = city_hash(key) & city_mask;; s = (s + 1) & city_mask) {
+        int idx = city_slots[s];
+        if (idx < 0 || strcmp(cities[idx].key, key) == 0) {
+            return idx;
+        }
+    }
+}
+
+/**
+ * @brief Arma las dos tablas hash sobre las ciudades y canales ya cargados.
+ */
+static int build_tables(void)
+{
+    city_mask = table_mask(city_count);
+    channel_mask = table_mask(channel_count);
+    city_slots = (int*)malloc((city_mask + 1) * sizeof(int));
+    channel_slots = (int*)malloc((channel_mask + 1) * sizeof(int));
+    if (city_slots == NULL || channel_slots == NULL) {
+        fprintf(stderr, "Error: No se pudo reservar memoria para el índice TDT\n");
+        return -1;
+    }
+    memset(city_slots, -1, (city_mask + 1) * sizeof(int));
+    memset(channel_slots, -1, (channel_mask + 1) * sizeof(int));
+
+    for (int c = 0; c < city_count; c++) {
+        size_t s = city_hash(cities[c].key) & city_mask;
+        while (city_slots[s] >= 0) {
+            s = (s + 1) & city_mask;
+        }
+        city_slots[s] = c;
+    }
+
+    for (int i = 0; i < channel_count; i++) {
+        const char* key = cities[channel_city[i]].key;
+        size_t s = channel_hash(key, channel_pool[i].channel) & channel_mask;
+        bool duplicate = false;
+        while (channel_slots[s] >= 0) {
+            int other = channel_slots[s];
+            if (channel_city[other] == channel_city[i] && strcmp(channel_pool[other].channel, channel_pool[i].channel) == 0) {
+                duplicate = true;
+                break;
+            }
+            s = (s + 1) & channel_mask;
+        }
+        // Un canal repetido conserva su primera fila, como la búsqueda lineal de antes
+        if (!duplicate) {
+            channel_slots[s] = i;
+        }
+    }
+    return 0;
+}
+
+static void index_load(void)
+{
+    DIR* dir = opendir(TDT_INDEX_DIR);
+    if (dir == NULL) {
+        fprintf(stderr, "Error: Unable to open directory %s\n", TDT_INDEX_DIR);
+        return;
+    }
+
+    int city_capacity = 0;
+    int channel_capacity = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (len <= 4 || strcmp(entry->d_name + len - 4, ".csv") != 0) {
+            continue;
+        }
+
+        char name[TDT_CITY_NAME_MAX];
+        char key[TDT_CITY_NAME_MAX];
+        char path[sizeof(TDT_INDEX_DIR) + 1 + 256];
+        snprintf(name, sizeof(name), "%.*s", (int)(len - 4), entry->d_name);
+        tdt_index_normalize(name, key, sizeof(key));
+        snprintf(path, sizeof(path), "%s/%s", TDT_INDEX_DIR, entry->d_name);
+
+        bool seen = false;
+        for (int c = 0; c < city_count; c++) {
+            if (strcmp(cities[c].key, key) == 0) {
+                seen = true;
+                break;
+            }
+        }
+        if (seen) {
+            fprintf(stderr, "Error: %s repite la ciudad \"%s\"\n", path, key);
+            continue;
+        }
+
+        if (city_count == city_capacity) {
+            int grown = (city_capacity == 0) ? 32 : 2 * city_capacity;
+            city_entry_t* more = (city_entry_t*)realloc(cities, (size_t)grown * sizeof(city_entry_t));
+            if (more == NULL) {
+                fprintf(stderr, "Error: No se pudo reservar memoria para el índice TDT\n");
+                break;
+            }
+            cities = more;
+            city_capacity = grown;
+        }
+
+        city_entry_t* city = &cities[city_count];
+        snprintf(city->key, sizeof(city->key), "%s", key);
+        city->first = channel_count;
+        city->count = load_city_file(path, city_count, &channel_capacity);
+        if (city->count < 0) {
+            channel_count = city->first;
+            continue;
+        }
+        city_count++;
+    }
+    closedir(dir);
+
+    if (build_tables() != 0) {
+        return;
+    }
+    index_status = city_count;
+}
+
+int tdt_index_init(void)
+{
+    pthread_once(&index_once, index_load);
+    return index_status;
+}
+
+int tdt_index_city(const char* city, const tdt_channel_t** channels)
+{
+    char key[TDT_CITY_NAME_MAX];
+    if (tdt_index_init() < 0 || city == NULL) {
+        return 0;
+    }
+    tdt_index_normalize(city, key, sizeof(key));
+
+    int idx = city_find(key);
+    if (idx < 0) {
+        return 0;
+    }
+    *channels = channel_pool + cities[idx].first;
+    return cities[idx].count;
+}
+
+const tdt_channel_t* tdt_index_lookup(const char* city, const char* channel)
+{
+    char key[TDT_CITY_NAME_MAX];
+    char canal[sizeof(((tdt_channel_t*)0)->channel)];
+    if (tdt_index_init() < 0 || city == NULL || channel == NULL) {
+        return NULL;
+    }
+    tdt_index_normalize(city, key, sizeof(key));
+    trim_channel(channel, canal, sizeof(canal));
+
+    int c = city_find(key);
+    if (c < 0) {
+        return NULL;
+    }
+    for (size_t s = channel_hash(key, canal) & channel_mask;; s = (s + 1) & channel_mask) {
+        int idx = channel_slots[s];
+        if (idx < 0) {
+            return NULL;
+        }
+        if (channel_city[idx] == c && strcmp(channel_pool[idx].channel, canal) == 0) {
+            return &channel_pool[idx];
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * @file tdt_index.h
+ * @brief Índice en memoria de los canales TDT de todas las ciudades (CSV de `Ciudades/`).
+ *
+ * Todos los archivos de `TDT_INDEX_DIR` se leen una sola vez, en la primera
+ * consulta, y quedan en dos tablas hash de direccionamiento abierto: ciudad →
+ * canales de la ciudad (en el orden del archivo) y (ciudad, canal) →
+ * frecuencia y modulación. Después ninguna petición TDT toca el sistema de
+ * archivos.
+ *
+ * Los nombres de ciudad se comparan normalizados (`tdt_index_normalize`):
+ * sin tildes (UTF-8 compuesto o con marcas combinantes), en minúsculas, con
+ * los separadores reducidos a un espacio y las abreviaturas del servidor
+ * expandidas, de modo que "Bogotá", "BOGOTA" y "Bogota" son la misma ciudad,
+ * y "Pto. Carreño" es "Puerto Carreño".
+ */
+
+#ifndef TDT_INDEX_H
+#define TDT_INDEX_H
+
+#include <stddef.h>
+#include "IQ.h"
+
+/**
+ * @def TDT_INDEX_DIR
+ * @brief Directorio con un CSV "Canal,Frequency,modulacion" por ciudad.
+ */
+#define TDT_INDEX_DIR "Ciudades"
+
+/**
+ * @def TDT_CITY_NAME_MAX
+ * @brief Longitud máxima (con el terminador) de un nombre de ciudad, original o normalizado.
+ */
+#define TDT_CITY_NAME_MAX 48
+
+/**
+ * @brief Carga el índice si aún no está cargado.
+ *
+ * Es seguro llamarla desde varios hilos; sólo la primera lee los archivos.
+ * Las consultas la llaman por su cuenta.
+ *
+ * @return Número de ciudades cargadas, o -1 si no se pudo leer el directorio.
+ */
+int tdt_index_init(void);
+
+/**
+ * @brief Canal de una ciudad.
+ *
+ * @return El canal, o NULL si la ciudad o el canal no existen.
+ */
+const tdt_channel_t* tdt_index_lookup(const char* city, const char* channel);
+
+/**
+ * @brief Todos los canales de una ciudad, en el orden de su archivo.
+ *
+ * @param city Ciudad (cualquier forma que normalice igual que el nombre del archivo).
+ * @param channels Recibe el primer canal; los demás son contiguos.
+ *
+ * @return Número de canales, o 0 si la ciudad no existe.
+ */
+int tdt_index_city(const char* city, const tdt_channel_t** channels);
+
+/**
+ * @brief Normaliza un nombre de ciudad para compararlo.
+ *
+ * @param in Nombre en UTF-8.
+ * @param out Destino (como mucho `cap - 1` bytes más el terminador).
+ * @param cap Capacidad de `out`.
+ */
+void tdt_index_normalize(const char* in, char* out, size_t cap);
+
+#endif // TDT_INDEX_H
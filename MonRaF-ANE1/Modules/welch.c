@@ -3,7 +3,7 @@
  * @brief Compute the Power Spectral Density (PSD) of a complex signal and generate its frequency bins.
  *
  * Implements Welch’s method: splits the signal into overlapping segments,
- * applies a Hamming window, performs FFT on each segment, averages the periodograms,
+ * applies a window (Hamming by default, see window.h), performs FFT on each segment, averages the periodograms,
  * and outputs PSD values with associated frequencies.
  */
 
@@ -14,11 +14,19 @@
 #include <math.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
 
 #include "welch.h"
+#include "fft_plan.h"
+#include "cs8_convert.h"
+#include "window.h"
 
 #define PI 3.14159265358979323846
 
+/** @brief Worker threads used by `welch_psd_multi` (1 = serial path). */
+static int welch_threads = 1;
+
 /**
  * @brief Generate a Hamming window.
  *
@@ -32,246 +40,466 @@ void generate_hamming_window(double* window, int segment_length) {
 }
 
 /**
- * @brief Compute the PSD of a complex signal using Welch’s method.
- *
- * Splits the input into overlapping segments, windows each segment,
- * executes the FFT, accumulates and averages the spectral power,
- * and fills output arrays with PSD values and corresponding frequencies.
+ * @brief Per-resolution state used by the single-pass Welch engine.
+ */
+typedef struct {
+    int nperseg;               // segment length (= nfft)
+    int step;                  // nperseg - noverlap
+    long k_segments;           // total segments for this resolution
+    long k_next;               // next segment to process
+    long k_end;                // one past the last segment owned by this state
+    const double* window;      // window coefficients (owned by window.h)
+    double u_norm;             // window power normalisation
+    complex double* segment;   // FFT input
+    complex double* x_k_fft;   // FFT output
+    fftw_plan plan;            // cached plan (fft_plan.h)
+    double* P_acc;             // |X[k]|^2 accumulator (caller's P_welch_out)
+} welch_state_t;
+
+/**
+ * @brief Input of the engine: either complex samples or raw interleaved CS8 bytes.
+ */
+typedef struct {
+    const complex double* iq;  // complex input (NULL when reading CS8)
+    const int8_t* cs8;         // interleaved I/Q int8 input (e.g. a cs8_map_t view)
+    complex double dc;         // DC estimate subtracted from CS8 input (0 = none)
+} welch_src_t;
+
+/**
+ * @brief Validate one resolution and allocate its window, buffers and plan.
  *
- * @param signal         Pointer to input complex signal array (length = N_signal).
- * @param N_signal       Total number of samples in the input signal.
- * @param fs             Sampling rate in Hz.
- * @param segment_length Number of samples per segment.
- * @param overlap        Fractional overlap between segments (0 ≤ overlap < 1).
- * @param f_out          Output array for frequency bins (length = segment_length).
- * @param P_welch_out    Output array for PSD values (length = segment_length).
+ * @return 0 on success, -1 if the resolution must be skipped.
  */
-void welch_psd_complex(complex double* signal, size_t N_signal, double fs, 
-                       int segment_length, double overlap, 
-                       double* f_out, double* P_welch_out) 
+static int welch_state_init(welch_state_t* st, size_t N_signal, int segment_length,
+                            window_type_t window_type, double overlap, double* P_acc)
 {
+    memset(st, 0, sizeof(*st));
+
     // Convertimos overlap fraccional a muestras
     int noverlap = (int)(segment_length * overlap);
     if (noverlap >= segment_length) {
         fprintf(stderr, "Error: overlap demasiado grande.\n");
-        return;
+        return -1;
     }
 
     int nperseg = segment_length;
-    int nfft = segment_length;  // mantenemos FFT igual al segmento (se puede extender)
     int step = nperseg - noverlap;
     if (step <= 0) {
         fprintf(stderr, "Error: Overlap results in a non-positive step size.\n");
-        return;
+        return -1;
     }
 
-    int k_segments = (N_signal - noverlap) / step;
+    long k_segments = (N_signal - noverlap) / step;
     if (k_segments <= 0) {
         fprintf(stderr, "Error: Signal is too short for the given segment and overlap settings.\n");
-        return;
+        return -1;
     }
 
-    // Ventana Hamming (manteniendo comportamiento del código 1)
-    double window[nperseg];
-    for (int n = 0; n < nperseg; n++) {
-        window[n] = 0.54 - 0.46 * cos((2.0 * PI * n) / (nperseg - 1));
+    st->nperseg = nperseg;
+    st->step = step;
+    st->k_segments = k_segments;
+    st->k_end = k_segments;
+    st->P_acc = P_acc;
+
+    // Ventana y factor de normalización U, precalculados en el registro
+    const window_t* window = window_get(window_type, nperseg);
+    if (window == NULL) {
+        return -1;
     }
+    st->window = window->coeffs;
+    st->u_norm = window->u_norm;
 
-    // Factor de normalización U
-    double u_norm = 0.0;
-    for (int i = 0; i < nperseg; i++) {
-        u_norm += window[i] * window[i];
+    st->segment = fftw_alloc_complex(nperseg);
+    st->x_k_fft = fftw_alloc_complex(nperseg);
+    if (!st->segment || !st->x_k_fft) {
+        fprintf(stderr, "Error: No se pudo reservar memoria para Welch\n");
+        return -1;
     }
-    u_norm /= nperseg;
 
-    // Buffers FFTW
-    complex double* segment = fftw_alloc_complex(nfft);
-    complex double* x_k_fft = fftw_alloc_complex(nfft);
-    fftw_plan plan = fftw_plan_dft_1d(nfft, segment, x_k_fft, FFTW_FORWARD, FFTW_ESTIMATE);
+    st->plan = fft_plan_get(nperseg, FFTW_FORWARD, st->segment, st->x_k_fft);
+    if (st->plan == NULL) {
+        return -1;
+    }
 
     // Inicializar acumulador PSD
-    memset(P_welch_out, 0, nfft * sizeof(double));
+    memset(P_acc, 0, nperseg * sizeof(double));
+    return 0;
+}
+
+static void welch_state_free(welch_state_t* st)
+{
+    fft_plan_release(st->plan);
+    fftw_free(st->segment);
+    fftw_free(st->x_k_fft);
+}
+
+/**
+ * @brief Window, FFT and accumulate every pending segment that ends before `limit`.
+ */
+static void welch_state_run(welch_state_t* st, const welch_src_t* src, size_t limit)
+{
+    int nperseg = st->nperseg;
 
-    // Loop principal por segmentos
-    for (int k = 0; k < k_segments; k++) {
-        int start_index = k * step;
+    while (st->k_next < st->k_end &&
+           (size_t)st->k_next * st->step + nperseg <= limit) {
+        size_t first = (size_t)st->k_next * st->step;
 
         // Aplicar ventana
-        for (int i = 0; i < nperseg; i++) {
-            segment[i] = signal[start_index + i] * window[i];
-        }
-        // Zero padding si nfft > nperseg
-        for (int i = nperseg; i < nfft; i++) {
-            segment[i] = 0.0;
+        if (src->cs8 != NULL) {
+            // Lectura int8, resta de DC y ventana en una sola pasada
+            cs8_window_segment(src->cs8 + 2 * first, src->dc, st->window,
+                               st->segment, nperseg);
+        } else {
+            const complex double* x = src->iq + first;
+            for (int i = 0; i < nperseg; i++) {
+                st->segment[i] = x[i] * st->window[i];
+            }
         }
 
         // FFT
-        fftw_execute(plan);
+        fftw_execute_dft(st->plan, st->segment, st->x_k_fft);
 
         // Acumular |X[k]|^2
-        for (int i = 0; i < nfft; i++) {
-            double mag = cabs(x_k_fft[i]);
-            P_welch_out[i] += (mag * mag);
+        for (int i = 0; i < nperseg; i++) {
+            double mag = cabs(st->x_k_fft[i]);
+            st->P_acc[i] += (mag * mag);
         }
+        st->k_next++;
     }
+}
 
-    // Promediar y escalar
-    double scale = 1.0 / (fs * u_norm * k_segments * nperseg);
-    for (int i = 0; i < nfft; i++) {
-        P_welch_out[i] *= scale;
-    }
+/**
+ * @brief Walk the signal once in blocks, letting every resolution consume its segments.
+ *
+ * Starts at the first pending segment of any resolution and stops as soon as
+ * all of them reached `k_end`, so a worker only touches its own slice.
+ */
+static void welch_walk(welch_state_t* st, const bool* valid, int n_res,
+                       const welch_src_t* src, size_t N_signal, size_t block)
+{
+    size_t start = SIZE_MAX;
 
-    // --- fftshift para centrar en [-fs/2, fs/2] ---
-    int half = nfft / 2;
-    for (int i = 0; i < half; i++) {
-        double tmp = P_welch_out[i];
-        P_welch_out[i] = P_welch_out[i + half];
-        P_welch_out[i + half] = tmp;
+    for (int r = 0; r < n_res; r++) {
+        if (valid[r] && st[r].k_next < st[r].k_end) {
+            size_t first = (size_t)st[r].k_next * st[r].step;
+            if (first < start) {
+                start = first;
+            }
+        }
     }
-
-    // Frecuencias asociadas
-    double df = fs / nfft;
-    for (int i = 0; i < nfft; i++) {
-        f_out[i] = -fs / 2.0 + i * df;
+    if (start == SIZE_MAX) {
+        return;
     }
 
-    printf("[welch] PSD computation complete.\n");
+    for (size_t end = start + block; ; end += block) {
+        size_t limit = (end < N_signal) ? end : N_signal;
+        bool pending = false;
 
-    // Liberar recursos
-    fftw_destroy_plan(plan);
-    fftw_free(segment);
-    fftw_free(x_k_fft);
+        for (int r = 0; r < n_res; r++) {
+            if (valid[r]) {
+                welch_state_run(&st[r], src, limit);
+                pending |= (st[r].k_next < st[r].k_end);
+            }
+        }
+        if (!pending || end >= N_signal) {
+            break;
+        }
+    }
 }
 
+/**
+ * @brief One worker of the parallel path: a slice of segments per resolution,
+ * private FFT buffers and a private PSD accumulator.
+ */
+typedef struct {
+    welch_state_t st[WELCH_MAX_RES];
+    bool valid[WELCH_MAX_RES];
+    int n_res;
+    const welch_src_t* src;
+    size_t N_signal;
+    size_t block;
+    pthread_t thread;
+} welch_worker_t;
 
-// Helper function for advanced DC spike correction using second acquisition
-bool DC_spike_correction(double* psd1, double* f1, double* psd2, double* f2) {
+static void* welch_worker_main(void* arg)
+{
+    welch_worker_t* w = (welch_worker_t*)arg;
+    welch_walk(w->st, w->valid, w->n_res, w->src, w->N_signal, w->block);
+    return NULL;
+}
 
-    int length1 = sizeof(psd1);
-    int length2 = sizeof(psd2);
+/**
+ * @brief Split every resolution's segments across `n_threads` workers and reduce.
+ *
+ * Workers share the (read-only) window and cached plan; buffers and
+ * accumulators are private. Partial PSDs are added in worker order, so the
+ * result is deterministic for a given thread count and matches the serial
+ * path to floating-point rounding.
+ *
+ * @return 0 on success, -1 if the workers could not be set up (caller falls back to serial).
+ */
+static int welch_run_parallel(welch_state_t* st, const bool* valid, int n_res,
+                              const welch_src_t* src, size_t N_signal,
+                              size_t block, int n_threads)
+{
+    welch_worker_t* workers = (welch_worker_t*)calloc(n_threads, sizeof(welch_worker_t));
+    int started = 0;
+    int result = 0;
 
+    if (workers == NULL) {
+        return -1;
+    }
 
-    const int correction_width = 50;
+    for (int t = 0; t < n_threads; t++) {
+        welch_worker_t* w = &workers[t];
+        w->n_res = n_res;
+        w->src = src;
+        w->N_signal = N_signal;
+        w->block = block;
 
-    if (psd1 == NULL || f1 == NULL || 
-        psd2 == NULL || f2 == NULL) {
-        return false;
+        for (int r = 0; r < n_res; r++) {
+            w->valid[r] = valid[r];
+            if (!valid[r]) {
+                continue;
+            }
+            w->st[r] = st[r];
+            w->st[r].k_next = st[r].k_segments * t / n_threads;
+            w->st[r].k_end = st[r].k_segments * (t + 1) / n_threads;
+            w->st[r].segment = fftw_alloc_complex(st[r].nperseg);
+            w->st[r].x_k_fft = fftw_alloc_complex(st[r].nperseg);
+            w->st[r].P_acc = (double*)calloc(st[r].nperseg, sizeof(double));
+            if (!w->st[r].segment || !w->st[r].x_k_fft || !w->st[r].P_acc) {
+                result = -1;
+            }
+        }
     }
 
-    double center_freq1 =  f1[(int)(length1/2)]; 
-    double center_freq2 =  f2[(int)(length2/2)]; 
-    
-    // Find the center frequency index in both arrays
-    int center_index1 = -1;
-    int center_index2 = -1;
-    
-    // Find the closest index to the center frequency in both arrays
-    double min_diff1 = 1e9;
-    double min_diff2 = 1e9;
-    
-    for (int i = 0; i < length1; i++) {
-        double diff = fabs(f1[i] - center_freq1);
-        if (diff < min_diff1) {
-            min_diff1 = diff;
-            center_index1 = i;
+    if (result == 0) {
+        for (started = 0; started < n_threads; started++) {
+            if (pthread_create(&workers[started].thread, NULL, &welch_worker_main,
+                               &workers[started]) != 0) {
+                fprintf(stderr, "Error: no se pudo crear el hilo Welch %d\n", started);
+                result = -1;
+                break;
+            }
+        }
+        for (int t = 0; t < started; t++) {
+            pthread_join(workers[t].thread, NULL);
         }
     }
-    
-    for (int i = 0; i < length2; i++) {
-        double diff = fabs(f2[i] - center_freq2);
-        if (diff < min_diff2) {
-            min_diff2 = diff;
-            center_index2 = i;
+
+    // Reducción en orden de hilo (o descartar si algo falló: se repite en serie)
+    for (int r = 0; r < n_res; r++) {
+        if (!valid[r]) {
+            continue;
+        }
+        for (int t = 0; t < n_threads; t++) {
+            welch_state_t* ws = &workers[t].st[r];
+            if (result == 0) {
+                for (int i = 0; i < st[r].nperseg; i++) {
+                    st[r].P_acc[i] += ws->P_acc[i];
+                }
+            }
+            fftw_free(ws->segment);
+            fftw_free(ws->x_k_fft);
+            free(ws->P_acc);
+        }
+        if (result == 0) {
+            st[r].k_next = st[r].k_segments;
         }
     }
-    
-    if (center_index1 < 0 || center_index2 < 0) {
-        return false;
+
+    free(workers);
+    return result;
+}
+
+void welch_set_threads(int n_threads)
+{
+    welch_threads = (n_threads > 1) ? n_threads : 1;
+}
+
+/**
+ * @brief Single-pass, optionally threaded Welch engine shared by the complex and CS8 entry points.
+ */
+static void welch_run(const welch_src_t* src, size_t N_signal, double fs,
+                      double overlap, welch_res_t* res, int n_res)
+{
+    welch_state_t st[WELCH_MAX_RES];
+    bool valid[WELCH_MAX_RES];
+    size_t block = 0;
+    long min_segments = 0;
+
+    if (n_res > WELCH_MAX_RES) {
+        fprintf(stderr, "Error: máximo %d resoluciones por pasada.\n", WELCH_MAX_RES);
+        n_res = WELCH_MAX_RES;
     }
-    
-    // Calculate the frequency step in both arrays
-    double freq_step1 = (length1 > 1) ? fabs(f1[1] - f1[0]) : 0;
-    double freq_step2 = (length2 > 1) ? fabs(f2[1] - f2[0]) : 0;
-    
-    if (freq_step1 <= 0 || freq_step2 <= 0) {
-        return false;
+
+    for (int r = 0; r < n_res; r++) {
+        valid[r] = (welch_state_init(&st[r], N_signal, res[r].segment_length,
+                                     res[r].window, overlap, res[r].P_welch_out) == 0);
+        if (valid[r] && (size_t)st[r].nperseg > block) {
+            block = st[r].nperseg;
+        }
+        if (valid[r] && (min_segments == 0 || st[r].k_segments < min_segments)) {
+            min_segments = st[r].k_segments;
+        }
     }
-    
-    // Calculate the number of points to correct on each side
-    int points_to_correct = correction_width;
-    
-    // Replace the DC spike region in psd1 with corresponding values from psd2
-    for (int i = -points_to_correct; i <= points_to_correct; i++) {
-        int idx1 = center_index1 + i;
-        
-        if (idx1 >= 0 && idx1 < length1) {
-            // Calculate the absolute frequency for this point
-            double freq = f1[idx1];
-            
-            // Find the closest frequency in the second array
-            int closest_idx2 = -1;
-            double min_freq_diff = 1e9;
-            
-            for (int j = 0; j < length2; j++) {
-                double diff = fabs(f2[j] - freq);
-                if (diff < min_freq_diff) {
-                    min_freq_diff = diff;
-                    closest_idx2 = j;
-                }
-            }
-            
-            if (closest_idx2 >= 0 && closest_idx2 < length2) {
-                // Aplicar un factor de corrección para ajustar los valores de magnitud
-                // Calculamos la diferencia promedio entre los valores cercanos no afectados por el DC spike
-                double correction_factor = 0.0;
-                int num_samples = 0;
-                
-                // Tomamos muestras fuera de la región del DC spike para calcular el factor de corrección
-                int sample_range = 10; // Número de muestras a considerar
-                int start_sample = points_to_correct + 5; // Comenzamos justo después de la región del DC spike
-                
-                for (int k = 0; k < sample_range; k++) {
-                    int sample_idx1 = center_index1 + start_sample + k;
-                    if (sample_idx1 >= 0 && sample_idx1 < length1) {
-                        // Encontrar la frecuencia correspondiente en el segundo array
-                        double sample_freq = f1[sample_idx1];
-                        int sample_idx2 = -1;
-                        double min_sample_diff = 1e9;
-                        
-                        for (int j = 0; j < length2; j++) {
-                            double diff = fabs(f2[j] - sample_freq);
-                            if (diff < min_sample_diff) {
-                                min_sample_diff = diff;
-                                sample_idx2 = j;
-                            }
-                        }
-                        
-                        if (sample_idx2 >= 0 && sample_idx2 < length2) {
-                            // Calcular la diferencia entre los valores de PSD
-                            // Usamos valores logarítmicos para una mejor comparación
-                            double psd1_db = 10.0 * log10(psd1[sample_idx1]);
-                            double psd2_db = 10.0 * log10(psd2[sample_idx2]);
-                            correction_factor += (psd1_db - psd2_db);
-                            num_samples++;
-                        }
-                    }
-                }
-                
-                // Calcular el factor de corrección promedio
-                if (num_samples > 0) {
-                    correction_factor /= num_samples;
-                }
-                
-                // Aplicar el factor de corrección al valor de PSD2 antes de reemplazar
-                double psd2_db = 10.0 * log10(psd2[closest_idx2]);
-                double corrected_psd_db = psd2_db + correction_factor;
-                double corrected_psd = pow(10.0, corrected_psd_db / 10.0);
-                
-                // Reemplazar el valor en psd1 con el valor corregido de psd2
-                psd1[idx1] = corrected_psd;
-            }
+
+    // Loop principal: una sola pasada por bloques sobre la señal
+    if (block > 0) {
+        int n_threads = welch_threads;
+        if (n_threads > min_segments) {
+            n_threads = (int)min_segments;
+        }
+        if (n_threads <= 1 ||
+            welch_run_parallel(st, valid, n_res, src, N_signal, block, n_threads) != 0) {
+            welch_walk(st, valid, n_res, src, N_signal, block);
+        }
+    }
+
+    for (int r = 0; r < n_res; r++) {
+        if (valid[r]) {
+            // Promediar, escalar, fftshift y frecuencias
+            welch_psd_finalize(res[r].P_welch_out, st[r].nperseg, st[r].k_segments,
+                               fs, st[r].u_norm, res[r].f_out);
+            printf("[welch] PSD computation complete.\n");
         }
+        welch_state_free(&st[r]);
+    }
+}
+
+/**
+ * @brief Compute several Welch PSDs of the same signal in a single pass.
+ *
+ * The input is walked once in blocks of the longest segment length; while a
+ * block is still in cache every resolution consumes the segments that fall
+ * inside it. Each resolution sees its segments in the same order as
+ * `welch_psd_complex`, so results are bit-identical to separate calls.
+ * With `welch_set_threads(n > 1)` the segments are split across n workers.
+ *
+ * @param signal   Pointer to input complex signal array (length = N_signal).
+ * @param N_signal Total number of samples in the input signal.
+ * @param fs       Sampling rate in Hz.
+ * @param overlap  Fractional overlap between segments (0 ≤ overlap < 1).
+ * @param res      Resolutions to compute (segment length and output arrays).
+ * @param n_res    Number of entries in `res`.
+ */
+void welch_psd_multi(complex double* signal, size_t N_signal, double fs,
+                     double overlap, welch_res_t* res, int n_res)
+{
+    welch_src_t src = { signal, NULL, 0.0 };
+    welch_run(&src, N_signal, fs, overlap, res, n_res);
+}
+
+/**
+ * @brief Same as `welch_psd_multi`, reading interleaved CS8 bytes directly.
+ *
+ * Each int8 pair is widened and windowed while the segment is built, so a
+ * mapped capture file never needs a `complex double` copy. Results are
+ * bit-identical to converting the buffer first.
+ *
+ * @param raw      Interleaved I/Q int8 samples (length = 2 * N_signal bytes).
+ * @param N_signal Number of IQ samples in `raw`.
+ * @param fs       Sampling rate in Hz.
+ * @param overlap  Fractional overlap between segments (0 ≤ overlap < 1).
+ * @param res      Resolutions to compute (segment length and output arrays).
+ * @param n_res    Number of entries in `res`.
+ */
+void welch_psd_cs8_multi(const int8_t* raw, size_t N_signal, double fs,
+                         double overlap, welch_res_t* res, int n_res)
+{
+    welch_psd_cs8_dc(raw, N_signal, fs, overlap, 0.0, res, n_res);
+}
+
+/**
+ * @brief `welch_psd_cs8_multi` with a DC estimate removed inside the segment kernel.
+ *
+ * Equivalent to converting the capture, calling `remove_dc` and then
+ * `welch_psd_multi`, but the capture is read once per segment and never
+ * rewritten: load, DC subtraction and windowing happen in `cs8_window_segment`.
+ *
+ * @param raw      Interleaved I/Q int8 samples (length = 2 * N_signal bytes).
+ * @param N_signal Number of IQ samples in `raw`.
+ * @param fs       Sampling rate in Hz.
+ * @param overlap  Fractional overlap between segments (0 ≤ overlap < 1).
+ * @param dc       DC estimate to subtract (see `cs8_mean`).
+ * @param res      Resolutions to compute (segment length and output arrays).
+ * @param n_res    Number of entries in `res`.
+ */
+void welch_psd_cs8_dc(const int8_t* raw, size_t N_signal, double fs, double overlap,
+                      complex double dc, welch_res_t* res, int n_res)
+{
+    welch_src_t src = { NULL, raw, dc };
+    welch_run(&src, N_signal, fs, overlap, res, n_res);
+}
+
+/**
+ * @brief Single-resolution Welch PSD of interleaved CS8 bytes.
+ */
+void welch_psd_cs8(const int8_t* raw, size_t N_signal, double fs,
+                   int segment_length, double overlap,
+                   double* f_out, double* P_welch_out)
+{
+    welch_res_t res = { segment_length, f_out, P_welch_out, WINDOW_HAMMING };
+    welch_psd_cs8_multi(raw, N_signal, fs, overlap, &res, 1);
+}
+
+/**
+ * @brief Compute the PSD of a complex signal using Welch’s method.
+ *
+ * Splits the input into overlapping segments, windows each segment,
+ * executes the FFT, accumulates and averages the spectral power,
+ * and fills output arrays with PSD values and corresponding frequencies.
+ *
+ * @param signal         Pointer to input complex signal array (length = N_signal).
+ * @param N_signal       Total number of samples in the input signal.
+ * @param fs             Sampling rate in Hz.
+ * @param segment_length Number of samples per segment.
+ * @param overlap        Fractional overlap between segments (0 ≤ overlap < 1).
+ * @param f_out          Output array for frequency bins (length = segment_length).
+ * @param P_welch_out    Output array for PSD values (length = segment_length).
+ */
+void welch_psd_complex(complex double* signal, size_t N_signal, double fs, 
+                       int segment_length, double overlap, 
+                       double* f_out, double* P_welch_out) 
+{
+    welch_res_t res = { segment_length, f_out, P_welch_out, WINDOW_HAMMING };
+    welch_psd_multi(signal, N_signal, fs, overlap, &res, 1);
+}
+
+/**
+ * @brief Escala el acumulador |X[k]|^2, aplica fftshift y genera el eje de frecuencias.
+ *
+ * @param P_acc      Acumulador de potencias (length = nfft); se escala en sitio.
+ * @param nfft       Número de puntos de la FFT.
+ * @param k_segments Número de segmentos acumulados.
+ * @param fs         Sampling rate in Hz.
+ * @param u_norm     Factor de normalización de la ventana.
+ * @param f_out      Output array for frequency bins (length = nfft), o NULL.
+ */
+void welch_psd_finalize(double* P_acc, int nfft, long k_segments, double fs,
+                        double u_norm, double* f_out)
+{
+    double scale = 1.0 / (fs * u_norm * k_segments * nfft);
+    for (int i = 0; i < nfft; i++) {
+        P_acc[i] *= scale;
     }
-    
-    return true;
-}
\ No newline at end of file
+
+    // --- fftshift para centrar en [-fs/2, fs/2] ---
+    int half = nfft / 2;
+    for (int i = 0; i < half; i++) {
+        double tmp = P_acc[i];
+        P_acc[i] = P_acc[i + half];
+        P_acc[i + half] = tmp;
+    }
+
+    // Frecuencias asociadas; quien use `spectrum_t` no necesita el arreglo
+    if (f_out == NULL) {
+        return;
+    }
+    double df = fs / nfft;
+    for (int i = 0; i < nfft; i++) {
+        f_out[i] = -fs / 2.0 + i * df;
+    }
+}
+
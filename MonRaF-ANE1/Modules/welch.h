@@ -13,9 +13,31 @@
 #include <stddef.h>   // Para size_t
 #include <complex.h>  // Para el tipo double complex
 #include <stdbool.h>
+#include <stdint.h>
+
+#include "window.h"
 
 #define PI 3.14159265358979323846
 
+/**
+ * @def WELCH_MAX_RES
+ * @brief Número máximo de resoluciones calculadas en una sola pasada por `welch_psd_multi`.
+ */
+#define WELCH_MAX_RES 4
+
+/**
+ * @struct welch_res_t
+ * @brief Una resolución de la PSD de Welch: longitud de segmento, ventana y arreglos de salida.
+ *
+ * `window` puede omitirse en los inicializadores: el valor 0 es `WINDOW_HAMMING`.
+ */
+typedef struct {
+    int segment_length;   /**< Longitud de cada segmento (= nfft). */
+    double* f_out;        /**< Salida de frecuencias (longitud `segment_length`), o NULL. */
+    double* P_welch_out;  /**< Salida de la PSD (longitud `segment_length`). */
+    window_type_t window; /**< Ventana aplicada a cada segmento (registro `window.h`). */
+} welch_res_t;
+
 /**
  * @brief Genera una ventana de Hamming.
  * 
@@ -24,6 +46,8 @@
  *
  * @param window Un puntero al arreglo donde se almacenarán los valores de la ventana de Hamming.
  * @param segment_length La longitud del segmento para la ventana de Hamming.
+ *
+ * @note Welch no la usa: toma la tabla precalculada de `window_get(WINDOW_HAMMING, n)`.
  */
 
 void generate_hamming_window(double* window, int segment_length);
@@ -41,10 +65,10 @@ void generate_hamming_window(double* window, int segment_length);
  * @param fs Frecuencia de muestreo de la señal de entrada.
  * @param segment_length Longitud de cada segmento en el que se divide la señal.
  * @param overlap Factor de solapamiento entre segmentos (0 a 1).
- * @param f_out Puntero al arreglo donde se almacenarán las frecuencias de salida.
+ * @param f_out Puntero al arreglo donde se almacenarán las frecuencias de salida, o NULL si no hacen falta.
  * @param P_welch_out Puntero al arreglo donde se almacenarán los valores calculados de la PSD.
  * 
- * @note Es necesario liberar la memoria reservada para la FFT usando `fftw_destroy_plan` y `fftw_free`.
+ * @note El plan FFT se toma de la caché de `fft_plan.h` (FFTW_MEASURE + wisdom); no se destruye al terminar.
  *
  * @example
  * @code
@@ -64,9 +88,108 @@ void welch_psd_complex(complex double* signal, size_t N_signal, double fs,
 
 
 /**
- * @brief Ejecuta una correcion del pico dc spile cambiando los vectores centrales 
- * de la muestra procesada, con otra muestra tomada 10MHz mas arriba
+ * @brief Calcula varias PSD de Welch de la misma señal en una sola pasada.
+ *
+ * Recorre la señal una vez, en bloques del segmento más largo, y mientras cada
+ * bloque está en caché lo consumen todas las resoluciones pedidas. Sustituye a
+ * llamar `welch_psd_complex` varias veces sobre el mismo buffer (p. ej. 32768 y
+ * 4096 puntos) y entrega resultados idénticos bit a bit.
+ *
+ * @param signal Puntero a la señal de entrada de tipo `complex double`.
+ * @param N_signal Tamaño de la señal de entrada.
+ * @param fs Frecuencia de muestreo de la señal de entrada.
+ * @param overlap Factor de solapamiento entre segmentos (0 a 1).
+ * @param res Resoluciones a calcular.
+ * @param n_res Número de resoluciones (máximo `WELCH_MAX_RES`).
+ *
+ * @example
+ * @code
+ * welch_res_t res[2] = {{32768, f, Pxx}, {4096, f1, Pxx1}};
+ * welch_psd_multi(signal, N_signal, 20000000, 0, res, 2);
+ * @endcode
+ */
+void welch_psd_multi(complex double* signal, size_t N_signal, double fs,
+                     double overlap, welch_res_t* res, int n_res);
+
+/**
+ * @brief Calcula varias PSD de Welch directamente sobre muestras CS8 (I/Q int8 intercalados).
+ *
+ * Igual que `welch_psd_multi`, pero cada segmento se arma convirtiendo y aplicando
+ * la ventana a los bytes originales, sin un arreglo `complex double` intermedio.
+ * Pensado para vistas de archivo mapeadas con `cs8_map_open`.
+ *
+ * @param raw Datos CS8 (longitud 2 * `N_signal` bytes).
+ * @param N_signal Número de muestras IQ.
+ * @param fs Frecuencia de muestreo de la señal de entrada.
+ * @param overlap Factor de solapamiento entre segmentos (0 a 1).
+ * @param res Resoluciones a calcular.
+ * @param n_res Número de resoluciones (máximo `WELCH_MAX_RES`).
+ */
+void welch_psd_cs8_multi(const int8_t* raw, size_t N_signal, double fs,
+                         double overlap, welch_res_t* res, int n_res);
+
+/**
+ * @brief Igual que `welch_psd_cs8_multi`, restando una componente DC dentro del núcleo de segmento.
+ *
+ * La lectura int8, la resta de `dc` y la ventana se hacen en una sola pasada al
+ * armar cada segmento (`cs8_window_segment`), en lugar de convertir la captura,
+ * recorrerla dos veces en `remove_dc` y otra más al aplicar la ventana. El
+ * resultado es idéntico bit a bit a ese camino.
+ *
+ * @param raw Datos CS8 (longitud 2 * `N_signal` bytes).
+ * @param N_signal Número de muestras IQ.
+ * @param fs Frecuencia de muestreo de la señal de entrada.
+ * @param overlap Factor de solapamiento entre segmentos (0 a 1).
+ * @param dc Componente DC a restar (p. ej. `cs8_mean(raw, N_signal)`).
+ * @param res Resoluciones a calcular.
+ * @param n_res Número de resoluciones (máximo `WELCH_MAX_RES`).
+ */
+void welch_psd_cs8_dc(const int8_t* raw, size_t N_signal, double fs, double overlap,
+                      complex double dc, welch_res_t* res, int n_res);
+
+/**
+ * @brief Versión CS8 de `welch_psd_complex` (una sola resolución).
+ *
+ * @param raw Datos CS8 (longitud 2 * `N_signal` bytes).
+ * @param N_signal Número de muestras IQ.
+ * @param fs Frecuencia de muestreo de la señal de entrada.
+ * @param segment_length Longitud de cada segmento.
+ * @param overlap Factor de solapamiento entre segmentos (0 a 1).
+ * @param f_out Arreglo de salida para las frecuencias (longitud `segment_length`), o NULL.
+ * @param P_welch_out Arreglo de salida para la PSD (longitud `segment_length`).
+ */
+void welch_psd_cs8(const int8_t* raw, size_t N_signal, double fs,
+                   int segment_length, double overlap,
+                   double* f_out, double* P_welch_out);
+
+/**
+ * @brief Fija el número de hilos de trabajo usados por `welch_psd_multi` y `welch_psd_complex`.
+ *
+ * Con n > 1 los segmentos de cada resolución se reparten en n porciones contiguas;
+ * cada hilo usa sus propios buffers FFTW y su propio acumulador de PSD, y al final
+ * los acumuladores se suman en orden de hilo. El resultado coincide con el camino
+ * en serie salvo redondeo de punto flotante (~1e-15 relativo).
+ *
+ * @param n_threads Número de hilos (1: procesamiento en serie, valor por defecto).
+ */
+void welch_set_threads(int n_threads);
+
+/**
+ * @brief Escala el acumulador de Welch, aplica fftshift y genera las frecuencias.
+ *
+ * Paso final compartido por `welch_psd_complex` y el motor de streaming
+ * (`welch_stream.h`): divide por (fs * U * K * nfft), centra el espectro en
+ * [-fs/2, fs/2] y llena `f_out`. El eje es uniforme (`-fs/2 + i·fs/nfft`):
+ * con `f_out` NULL no se genera y el llamador lo describe con un `spectrum_t`.
+ *
+ * @param P_acc Acumulador de |X[k]|^2 (se sobrescribe con la PSD final).
+ * @param nfft Número de puntos de la FFT.
+ * @param k_segments Número de segmentos acumulados.
+ * @param fs Frecuencia de muestreo.
+ * @param u_norm Factor de normalización de la ventana.
+ * @param f_out Arreglo de salida para las frecuencias (longitud `nfft`), o NULL.
  */
-bool DC_spike_correction(double* psd1, double* f1, double* psd2, double* f2);
+void welch_psd_finalize(double* P_acc, int nfft, long k_segments, double fs,
+                        double u_norm, double* f_out);
 
 #endif // WELCH_H
@@ -0,0 +1,259 @@
+/**
+ * @file welch_stream.c
+ * @brief Implementación del motor de Welch en streaming.
+ *
+ * Convierte cada buffer CS8 en muestras complejas, arma segmentos de `nperseg`
+ * muestras a medida que llegan y los acumula con la misma ventana, FFT y
+ * normalización que `welch_psd_complex`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <complex.h>
+#include <fftw3.h>
+
+#include "welch.h"
+#include "welch_stream.h"
+#include "fft_plan.h"
+#include "cs8_convert.h"
+#include "window.h"
+
+/**
+ * @brief Ventana, FFT y acumulación |X[k]|^2 del segmento completo en `hist`.
+ */
+static void welch_stream_segment(welch_stream_t* ws)
+{
+    int nperseg = ws->nperseg;
+
+    for (int i = 0; i < nperseg; i++) {
+        ws->segment[i] = ws->hist[i] * ws->window[i];
+    }
+
+    fftw_execute_dft(ws->plan, ws->segment, ws->x_k_fft);
+
+    for (int i = 0; i < nperseg; i++) {
+        double mag = cabs(ws->x_k_fft[i]);
+        ws->P_acc[i] += (mag * mag);
+    }
+    ws->k_segments++;
+
+    for (int c = 0; c < ws->n_channels; c++) {
+        double power = 0.0;
+        for (int b = 0, k = ws->ch_first[c]; b < ws->ch_bins[c]; b++, k = (k + 1) % nperseg) {
+            power += creal(ws->x_k_fft[k]) * creal(ws->x_k_fft[k]) +
+                     cimag(ws->x_k_fft[k]) * cimag(ws->x_k_fft[k]);
+        }
+        ws->ch_sum[c] += power;
+        ws->ch_sum2[c] += power * power;
+    }
+
+    // Conservar las muestras solapadas para el siguiente segmento
+    if (ws->noverlap > 0) {
+        memmove(ws->hist, ws->hist + (nperseg - ws->noverlap),
+                ws->noverlap * sizeof(complex double));
+    }
+    ws->hist_len = ws->noverlap;
+}
+
+int welch_stream_init(welch_stream_t* ws, double fs, int segment_length, double overlap,
+                      window_type_t window)
+{
+    memset(ws, 0, sizeof(*ws));
+
+    int noverlap = (int)(segment_length * overlap);
+    if (segment_length <= 0 || noverlap >= segment_length) {
+        fprintf(stderr, "Error: overlap demasiado grande.\n");
+        return -1;
+    }
+
+    ws->fs = fs;
+    ws->nperseg = segment_length;
+    ws->noverlap = noverlap;
+
+    const window_t* table = window_get(window, segment_length);
+    if (table == NULL) {
+        return -1;
+    }
+    ws->window = table->coeffs;
+    ws->u_norm = table->u_norm;
+
+    ws->hist = fftw_alloc_complex(segment_length);
+    ws->segment = fftw_alloc_complex(segment_length);
+    ws->x_k_fft = fftw_alloc_complex(segment_length);
+    ws->P_acc = (double*)calloc(segment_length, sizeof(double));
+
+    if (!ws->hist || !ws->segment || !ws->x_k_fft || !ws->P_acc) {
+        fprintf(stderr, "Error: No se pudo reservar memoria para el acumulador Welch\n");
+        welch_stream_free(ws);
+        return -1;
+    }
+
+    ws->plan = fft_plan_get(segment_length, FFTW_FORWARD, ws->segment, ws->x_k_fft);
+    if (ws->plan == NULL) {
+        welch_stream_free(ws);
+        return -1;
+    }
+    return 0;
+}
+
+void welch_stream_push_cs8(welch_stream_t* ws, const int8_t* buffer, size_t length)
+{
+    size_t pos = 0;
+
+    // Completar la muestra que quedó partida en el buffer anterior
+    if (ws->has_carry && length > 0) {
+        ws->hist[ws->hist_len++] = ws->carry + buffer[0] * I;
+        ws->has_carry = false;
+        ws->num_samples++;
+        pos = 1;
+        if (ws->hist_len == ws->nperseg) {
+            welch_stream_segment(ws);
+        }
+    }
+
+    while (pos + 1 < length) {
+        size_t pairs = (length - pos) / 2;
+        size_t room = (size_t)(ws->nperseg - ws->hist_len);
+        size_t n = (pairs < room) ? pairs : room;
+
+        cs8_to_complex(buffer + pos, ws->hist + ws->hist_len, n);
+
+        ws->hist_len += (int)n;
+        ws->num_samples += n;
+        pos += 2 * n;
+
+        if (ws->hist_len == ws->nperseg) {
+            welch_stream_segment(ws);
+        }
+    }
+
+    if (pos < length) {
+        ws->carry = buffer[pos];
+        ws->has_carry = true;
+    }
+}
+
+long welch_stream_finish(const welch_stream_t* ws, double* f_out, double* P_welch_out)
+{
+    if (ws->k_segments <= 0) {
+        fprintf(stderr, "Error: Signal is too short for the given segment and overlap settings.\n");
+        return -1;
+    }
+
+    memcpy(P_welch_out, ws->P_acc, ws->nperseg * sizeof(double));
+    welch_psd_finalize(P_welch_out, ws->nperseg, ws->k_segments, ws->fs, ws->u_norm, f_out);
+
+    printf("[welch] PSD streaming complete: %ld segments, %zu samples.\n",
+           ws->k_segments, ws->num_samples);
+    return ws->k_segments;
+}
+
+int welch_stream_track_channels(welch_stream_t* ws, const double* offset_hz,
+                                const double* bandwidth_hz, int n)
+{
+    free(ws->ch_first);
+    free(ws->ch_bins);
+    free(ws->ch_sum);
+    free(ws->ch_sum2);
+    ws->ch_first = NULL;
+    ws->ch_bins = NULL;
+    ws->ch_sum = NULL;
+    ws->ch_sum2 = NULL;
+    ws->n_channels = 0;
+    if (n <= 0) {
+        return 0;
+    }
+
+    ws->ch_first = (int*)malloc((size_t)n * sizeof(int));
+    ws->ch_bins = (int*)malloc((size_t)n * sizeof(int));
+    ws->ch_sum = (double*)calloc((size_t)n, sizeof(double));
+    ws->ch_sum2 = (double*)calloc((size_t)n, sizeof(double));
+    if (!ws->ch_first || !ws->ch_bins || !ws->ch_sum || !ws->ch_sum2) {
+        fprintf(stderr, "Error: No se pudo reservar memoria para los canales\n");
+        return -1;
+    }
+
+    double df = ws->fs / ws->nperseg;
+    int half = ws->nperseg / 2;
+    for (int c = 0; c < n; c++) {
+        // Bins respecto al centro, recortados a la banda capturada
+        int lo = (int)lround((offset_hz[c] - bandwidth_hz[c] / 2) / df);
+        int hi = (int)lround((offset_hz[c] + bandwidth_hz[c] / 2) / df);
+        if (lo < -half) {
+            lo = -half;
+        }
+        if (hi > half - 1) {
+            hi = half - 1;
+        }
+        if (lo > hi) {
+            continue;
+        }
+        ws->ch_first[ws->n_channels] = (lo + ws->nperseg) % ws->nperseg;
+        ws->ch_bins[ws->n_channels] = hi - lo + 1;
+        ws->n_channels++;
+    }
+    return ws->n_channels;
+}
+
+double welch_stream_channel_ci(const welch_stream_t* ws)
+{
+    long k = ws->k_segments;
+    if (ws->n_channels == 0 || k < 2) {
+        return INFINITY;
+    }
+
+    // Con solapamiento los segmentos no son independientes: se cuentan sólo las muestras nuevas
+    double k_eff = (double)k * (ws->nperseg - ws->noverlap) / ws->nperseg;
+    if (k_eff < 1.0) {
+        k_eff = 1.0;
+    }
+
+    double worst = 0.0;
+    for (int c = 0; c < ws->n_channels; c++) {
+        double mean = ws->ch_sum[c] / k;
+        double var = (ws->ch_sum2[c] - k * mean * mean) / (k - 1);
+        if (mean <= 0.0) {
+            return INFINITY;
+        }
+        double ci = WELCH_STREAM_CI_Z * sqrt((var > 0.0 ? var : 0.0) / k_eff) / mean;
+        if (ci > worst) {
+            worst = ci;
+        }
+    }
+    return worst;
+}
+
+void welch_stream_break(welch_stream_t* ws)
+{
+    ws->hist_len = 0;
+    ws->has_carry = false;
+}
+
+void welch_stream_reset(welch_stream_t* ws)
+{
+    memset(ws->P_acc, 0, ws->nperseg * sizeof(double));
+    ws->hist_len = 0;
+    ws->has_carry = false;
+    ws->k_segments = 0;
+    ws->num_samples = 0;
+    if (ws->n_channels > 0) {
+        memset(ws->ch_sum, 0, ws->n_channels * sizeof(double));
+        memset(ws->ch_sum2, 0, ws->n_channels * sizeof(double));
+    }
+}
+
+void welch_stream_free(welch_stream_t* ws)
+{
+    fft_plan_release(ws->plan);
+    fftw_free(ws->hist);
+    fftw_free(ws->segment);
+    fftw_free(ws->x_k_fft);
+    free(ws->P_acc);
+    free(ws->ch_first);
+    free(ws->ch_bins);
+    free(ws->ch_sum);
+    free(ws->ch_sum2);
+    memset(ws, 0, sizeof(*ws));
+}
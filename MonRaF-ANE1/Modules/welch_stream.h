@@ -0,0 +1,152 @@
+/**
+ * @file welch_stream.h
+ * @brief Motor de Welch en streaming alimentado directamente por los buffers de captura.
+ *
+ * Permite acumular la Densidad Espectral de Potencia (PSD) mientras la captura
+ * está en curso: cada buffer CS8 entregado por `rx_callback` se divide en
+ * segmentos con ventana (Hamming por defecto) que se suman a un acumulador Welch. Así no es
+ * necesario escribir `Samples/N` en disco ni volver a cargarlo como un arreglo
+ * `complex double` completo.
+ *
+ * Opcionalmente vigila la potencia de un plan de canales segmento a segmento
+ * (`welch_stream_track_channels`) para saber cuándo la estimación ya es lo
+ * bastante estable y la captura puede terminar antes (`welch_stream_channel_ci`).
+ */
+
+#ifndef WELCH_STREAM_H
+#define WELCH_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <complex.h>
+#include <fftw3.h>
+
+#include "window.h"
+
+/**
+ * @def WELCH_STREAM_CI_Z
+ * @brief Cuantil normal del intervalo de confianza de la convergencia (95 %).
+ */
+#define WELCH_STREAM_CI_Z 1.96
+
+/**
+ * @struct welch_stream_t
+ * @brief Estado de un acumulador Welch en streaming.
+ */
+typedef struct {
+    double fs;                 /**< Frecuencia de muestreo en Hz. */
+    int nperseg;               /**< Longitud de cada segmento (= nfft). */
+    int noverlap;              /**< Muestras compartidas entre segmentos consecutivos. */
+    const double* window;      /**< Coeficientes de la ventana (registro `window.h`). */
+    double u_norm;             /**< Factor de normalización de la ventana. */
+    complex double* hist;      /**< Muestras pendientes hasta completar un segmento. */
+    int hist_len;              /**< Número de muestras válidas en `hist`. */
+    int8_t carry;              /**< Byte I pendiente si un buffer terminó en medio de una muestra. */
+    bool has_carry;            /**< Indica si `carry` es válido. */
+    complex double* segment;   /**< Entrada de la FFT. */
+    complex double* x_k_fft;   /**< Salida de la FFT. */
+    fftw_plan plan;            /**< Plan FFTW del segmento (de la caché `fft_plan.h`). */
+    double* P_acc;             /**< Acumulador de |X[k]|^2. */
+    long k_segments;           /**< Segmentos acumulados. */
+    size_t num_samples;        /**< Muestras IQ recibidas en total. */
+    int n_channels;            /**< Canales vigilados (0: sin vigilancia). */
+    int* ch_first;             /**< Primer bin de cada canal, en el orden de la FFT. */
+    int* ch_bins;              /**< Bins de cada canal. */
+    double* ch_sum;            /**< Suma de la potencia de cada canal por segmento. */
+    double* ch_sum2;           /**< Suma de los cuadrados de esa potencia. */
+} welch_stream_t;
+
+/**
+ * @brief Inicializa un acumulador Welch en streaming.
+ *
+ * @param ws Acumulador a inicializar.
+ * @param fs Frecuencia de muestreo de la señal.
+ * @param segment_length Longitud de cada segmento.
+ * @param overlap Factor de solapamiento entre segmentos (0 a 1).
+ * @param window Ventana aplicada a cada segmento (`WINDOW_HAMMING` para el comportamiento histórico).
+ *
+ * @return 0 si la inicialización fue exitosa, -1 en caso de error.
+ */
+int welch_stream_init(welch_stream_t* ws, double fs, int segment_length, double overlap,
+                      window_type_t window);
+
+/**
+ * @brief Agrega un buffer CS8 (pares I/Q int8 intercalados) al acumulador.
+ *
+ * Los segmentos completos se procesan inmediatamente; las muestras sobrantes se
+ * guardan hasta el siguiente buffer, por lo que el resultado es idéntico al de
+ * `welch_psd_complex` sobre la captura completa.
+ *
+ * @param ws Acumulador.
+ * @param buffer Datos CS8 recibidos.
+ * @param length Número de bytes en `buffer`.
+ */
+void welch_stream_push_cs8(welch_stream_t* ws, const int8_t* buffer, size_t length);
+
+/**
+ * @brief Entrega la PSD acumulada con el mismo formato que `welch_psd_complex`.
+ *
+ * @param ws Acumulador.
+ * @param f_out Arreglo de salida para las frecuencias (longitud `segment_length`), o NULL.
+ * @param P_welch_out Arreglo de salida para la PSD (longitud `segment_length`).
+ *
+ * @return Número de segmentos promediados, o -1 si no se acumuló ninguno.
+ *
+ * @note No modifica el acumulador: se puede consultar la PSD parcial durante la captura.
+ */
+long welch_stream_finish(const welch_stream_t* ws, double* f_out, double* P_welch_out);
+
+/**
+ * @brief Vigila la potencia de un plan de canales para medir la convergencia.
+ *
+ * En cada segmento se suma |X[k]|^2 sobre los bins de cada canal y se acumulan
+ * la media y la varianza de esa potencia. Los canales que caen fuera de la
+ * banda capturada se ignoran.
+ *
+ * @param ws Acumulador inicializado.
+ * @param offset_hz Centro de cada canal respecto a la frecuencia central de la captura.
+ * @param bandwidth_hz Ancho de banda de cada canal.
+ * @param n Número de canales.
+ *
+ * @return Canales vigilados, o -1 si no se pudo reservar memoria.
+ */
+int welch_stream_track_channels(welch_stream_t* ws, const double* offset_hz,
+                                const double* bandwidth_hz, int n);
+
+/**
+ * @brief Semiancho relativo del intervalo de confianza de la potencia de canal.
+ *
+ * Para cada canal vigilado calcula `z * sigma / (sqrt(K_ef) * media)`, donde
+ * `K_ef` descuenta el solapamiento entre segmentos, y devuelve el peor. La
+ * potencia de canal con un semiancho `e` está dentro de ±10·log10(1 + e) dB.
+ *
+ * @return El peor semiancho, o `INFINITY` si no hay canales vigilados o menos de dos segmentos.
+ */
+double welch_stream_channel_ci(const welch_stream_t* ws);
+
+/**
+ * @brief Marca una discontinuidad en la señal (p. ej. un salto de frecuencia).
+ *
+ * Descarta las muestras pendientes para que ningún segmento mezcle datos de
+ * antes y después del corte; lo ya acumulado se conserva.
+ *
+ * @param ws Acumulador.
+ */
+void welch_stream_break(welch_stream_t* ws);
+
+/**
+ * @brief Reinicia el acumulador para una nueva captura conservando sus buffers y plan.
+ *
+ * @param ws Acumulador.
+ */
+void welch_stream_reset(welch_stream_t* ws);
+
+/**
+ * @brief Libera los recursos del acumulador.
+ *
+ * @param ws Acumulador.
+ */
+void welch_stream_free(welch_stream_t* ws);
+
+#endif // WELCH_STREAM_H
@@ -0,0 +1,138 @@
+/**
+ * @file window.c
+ * @brief Implementación del registro de ventanas espectrales.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "window.h"
+
+#define PI 3.14159265358979323846
+
+/** @brief Tablas calculadas hasta ahora. */
+static window_t window_cache[WINDOW_CACHE_SIZE];
+
+/** @brief Número de entradas válidas en `window_cache`. */
+static int window_count = 0;
+
+static pthread_mutex_t window_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char* window_names[WINDOW_COUNT] = {
+    "hamming", "hann", "blackman-harris", "flattop"
+};
+
+/**
+ * @brief Coeficientes de la suma de cosenos a0 - a1 cos(x) + a2 cos(2x) - ... de cada ventana.
+ */
+static const double window_terms[WINDOW_COUNT][5] = {
+    { 0.54, 0.46 },
+    { 0.5, 0.5 },
+    { 0.35875, 0.48829, 0.14128, 0.01168 },
+    { 0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368 },
+};
+
+static void window_fill(window_type_t type, double* w, int length)
+{
+    if (type == WINDOW_HAMMING) {
+        // Misma expresión que generate_hamming_window: resultados idénticos bit a bit
+        for (int n = 0; n < length; n++) {
+            w[n] = 0.54 - 0.46 * cos((2.0 * PI * n) / (length - 1));
+        }
+        return;
+    }
+
+    const double* a = window_terms[type];
+    for (int n = 0; n < length; n++) {
+        double x = (2.0 * PI * n) / (length - 1);
+        w[n] = a[0] - a[1] * cos(x) + a[2] * cos(2.0 * x)
+                    - a[3] * cos(3.0 * x) + a[4] * cos(4.0 * x);
+    }
+}
+
+const window_t* window_get(window_type_t type, int length)
+{
+    const window_t* result = NULL;
+
+    if ((int)type < 0 || type >= WINDOW_COUNT || length < 2) {
+        fprintf(stderr, "Error: ventana inválida (tipo %d, longitud %d)\n", (int)type, length);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&window_lock);
+
+    for (int i = 0; i < window_count; i++) {
+        if (window_cache[i].type == type && window_cache[i].length == length) {
+            result = &window_cache[i];
+            pthread_mutex_unlock(&window_lock);
+            return result;
+        }
+    }
+
+    if (window_count >= WINDOW_CACHE_SIZE) {
+        fprintf(stderr, "Error: caché de ventanas llena (%d)\n", WINDOW_CACHE_SIZE);
+        pthread_mutex_unlock(&window_lock);
+        return NULL;
+    }
+
+    // aligned_alloc exige un tamaño múltiplo de la alineación
+    size_t bytes = ((length * sizeof(double) + 63) / 64) * 64;
+    double* coeffs = (double*)aligned_alloc(64, bytes);
+    if (coeffs == NULL) {
+        fprintf(stderr, "Error: No se pudo reservar memoria para la ventana\n");
+        pthread_mutex_unlock(&window_lock);
+        return NULL;
+    }
+    window_fill(type, coeffs, length);
+
+    // Factor de normalización U
+    double u_norm = 0.0;
+    for (int i = 0; i < length; i++) {
+        u_norm += coeffs[i] * coeffs[i];
+    }
+    u_norm /= length;
+
+    window_t* entry = &window_cache[window_count];
+    entry->type = type;
+    entry->length = length;
+    entry->coeffs = coeffs;
+    entry->u_norm = u_norm;
+    window_count++;
+    result = entry;
+
+    pthread_mutex_unlock(&window_lock);
+    return result;
+}
+
+const char* window_name(window_type_t type)
+{
+    if ((int)type < 0 || type >= WINDOW_COUNT) {
+        return "unknown";
+    }
+    return window_names[type];
+}
+
+int window_from_name(const char* name, window_type_t* type)
+{
+    for (int i = 0; name != NULL && i < WINDOW_COUNT; i++) {
+        if (strcmp(name, window_names[i]) == 0) {
+            *type = (window_type_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void window_cleanup(void)
+{
+    pthread_mutex_lock(&window_lock);
+    for (int i = 0; i < window_count; i++) {
+        free(window_cache[i].coeffs);
+    }
+    memset(window_cache, 0, sizeof(window_cache));
+    window_count = 0;
+    pthread_mutex_unlock(&window_lock);
+}
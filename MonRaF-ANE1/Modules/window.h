@@ -0,0 +1,73 @@
+/**
+ * @file window.h
+ * @brief Registro de ventanas espectrales precalculadas para Welch.
+ *
+ * Cada tabla (tipo, longitud) se calcula una sola vez, se guarda alineada a 64
+ * bytes para los núcleos SIMD y se comparte entre llamadas e hilos junto con su
+ * factor de normalización de potencia U. Todas las ventanas son simétricas
+ * (denominador N - 1), igual que la ventana de Hamming original.
+ */
+
+#ifndef WINDOW_H
+#define WINDOW_H
+
+/**
+ * @def WINDOW_CACHE_SIZE
+ * @brief Número máximo de tablas (tipo, longitud) en caché.
+ */
+#define WINDOW_CACHE_SIZE 16
+
+/**
+ * @enum window_type_t
+ * @brief Ventanas disponibles. El valor 0 (Hamming) es el usado por defecto.
+ */
+typedef enum {
+    WINDOW_HAMMING = 0,      /**< 0.54 - 0.46 cos: la ventana histórica del analizador. */
+    WINDOW_HANN,             /**< 0.5 - 0.5 cos. */
+    WINDOW_BLACKMAN_HARRIS,  /**< Blackman-Harris de 4 términos (lóbulos laterales ~-92 dB). */
+    WINDOW_FLATTOP,          /**< Flat-top de 5 términos: error de amplitud mínimo para potencia de canal. */
+    WINDOW_COUNT
+} window_type_t;
+
+/**
+ * @struct window_t
+ * @brief Tabla de coeficientes de una ventana y su normalización.
+ */
+typedef struct {
+    window_type_t type;   /**< Tipo de ventana. */
+    int length;           /**< Número de coeficientes. */
+    double* coeffs;       /**< Coeficientes (alineados a 64 bytes). */
+    double u_norm;        /**< Potencia media de la ventana: sum(w^2) / length. */
+} window_t;
+
+/**
+ * @brief Obtiene (o calcula) la ventana pedida.
+ *
+ * La tabla pertenece al registro y no debe liberarse ni modificarse. Es seguro
+ * llamar desde varios hilos.
+ *
+ * @param type Tipo de ventana.
+ * @param length Longitud de la ventana (> 1).
+ *
+ * @return Ventana, o NULL si los parámetros son inválidos o no hay memoria.
+ */
+const window_t* window_get(window_type_t type, int length);
+
+/**
+ * @brief Nombre legible de un tipo de ventana ("hamming", "hann", ...).
+ */
+const char* window_name(window_type_t type);
+
+/**
+ * @brief Tipo de ventana por su nombre (el de `window_name`).
+ *
+ * @return 0 si el nombre existe, -1 en caso contrario (`type` no se modifica).
+ */
+int window_from_name(const char* name, window_type_t* type);
+
+/**
+ * @brief Libera todas las tablas del registro.
+ */
+void window_cleanup(void);
+
+#endif // WINDOW_H
@@ -24,51 +24,43 @@ socket.on('connect', () => {
     console.log("Solicitando init al interno:");
 });
 
-tcpClient.on('data', function(serverData) {
-	console.log(`server sent ${serverData}`);
-    const regex = /{(\w+):({.*})}/;
-    const data = `${serverData}`.match(regex);
-    
-    if(data[1] === "initResponse") {
-        socket.emit('init', JSON.parse(data[2] || '{}')); // Enviar init solo una vez al conectar
-    }else if(data[1] === "dataStreaming") {
-        console.log(`server sent ${data[1]}`);
-        const filePath = '../JSON/0'
-        fs.readFile(filePath, 'utf8', 
-            (err,data) => {
-                if(err) {
-                    console.log(err);
-                    return;
-                }
-                try {
-                    const jsonData = JSON.parse(data);
-                    console.log("Streaming Data OK")
-                    socket.emit('dataStreaming', JSON.stringify(jsonData.data));
-                } catch(parseError) {
-                    console.log(parseError);
-                }
+// Lee el JSON de una medición (el archivo viene en el aviso: JSON/0, JSON/tdt_0, ...) y lo reenvía.
+// Sólo se aceptan archivos de ../JSON
+function sendMeasurement(event, payload, label) {
+    const filePath = path.join('..', 'JSON', path.basename(payload.file || 'JSON/0'));
+    fs.readFile(filePath, 'utf8', 
+        (err,data) => {
+            if(err) {
+                console.log(err);
+                return;
             }
-        )    
-    }else if(data[1] === "data") {
-        console.log(`server sent ${data[1]}`);
-        const filePath = '../JSON/0'
-        fs.readFile(filePath, 'utf8', 
-            (err,data) => {
-                if(err) {
-                    console.log(err);
-                    return;
-                }
-                try {
-                    const jsonData = JSON.parse(data);
-                    console.log("REC Data OK")
-                    socket.emit('data', JSON.stringify(jsonData.data));
-                } catch(parseError) {
-                    console.log(parseError);
-                }
+            try {
+                const jsonData = JSON.parse(data);
+                console.log(label)
+                socket.emit(event, JSON.stringify(jsonData.data));
+            } catch(parseError) {
+                console.log(parseError);
             }
-        )    
-    }else {
-        console.log(`server sent ${data[1]}`);
+        }
+    )    
+}
+
+tcpClient.on('data', function(serverData) {
+	console.log(`server sent ${serverData}`);
+    // Varios avisos seguidos pueden llegar en un mismo paquete: se atienden todos
+    const regex = /{(\w+):({[^{}]*})}/g;
+    for (const data of `${serverData}`.matchAll(regex)) {
+        if(data[1] === "initResponse") {
+            socket.emit('init', JSON.parse(data[2] || '{}')); // Enviar init solo una vez al conectar
+        }else if(data[1] === "dataStreaming") {
+            console.log(`server sent ${data[1]}`);
+            sendMeasurement('dataStreaming', JSON.parse(data[2] || '{}'), "Streaming Data OK");
+        }else if(data[1] === "data") {
+            console.log(`server sent ${data[1]}`);
+            sendMeasurement('data', JSON.parse(data[2] || '{}'), "REC Data OK");
+        }else {
+            console.log(`server sent ${data[1]}`);
+        }
     }
 });
 
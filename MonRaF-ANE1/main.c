@@ -13,6 +13,12 @@
 #include "Modules/tdt.h"
 #include "Modules/parameters_rni.h"
 #include "Modules/welch.h"
+#include "Modules/fft_plan.h"
+#include "Modules/psd_archive.h"
+#include "Modules/rf_session.h"
+#include "Modules/measurement.h"
+#include "Modules/band_registry.h"
+#include "Modules/tdt_index.h"
 #include "Drivers/bacn_gpio.h"
 #include "Drivers/bacn_LTE.h"
 #include "Drivers/bacn_RTI.h"
@@ -34,13 +40,12 @@ uint8_t bands = 0;
 char banda[13];
 char Flow[13];
 char Fhigh[13];
-char Tcity[13];
+char Tcity[TDT_CITY_NAME_MAX];
 char Tchan[13];
 char t_start[20];
 char t_stop[20];
 uint8_t net;
 uint8_t getData = 0;
-int64_t central_freq[3]; //No se le asigna nada
 
 bool rfhack = false;
 bool program = false;
@@ -50,15 +55,15 @@ uint8_t times_sample = 0;
 
 static transceiver_mode_t transceiver_mode = TRANSCEIVER_MODE_RX;
 
-double canalisation[2000];
-double bandwidth[2000];
 uint8_t qam[100];
 
+/** @brief Conmutador RF1/RF2 de la placa, manejado por GPIO. */
+static const rf_antenna_switch_t board_antenna = { switch_ANTENNA, release_ANTENNA };
+
 int main(void)
 {
 	time_t t;   
-    int bands_length; 
-    int totalSamples;
+    const band_info_t* band_info;
 
 	// Convert to local time and store in struct tm
     struct tm *currentTime;
@@ -113,6 +118,15 @@ int main(void)
     sleep(5);
     */
    
+    // Canalizaciones de todas las bandas, leídas una sola vez antes de atender peticiones
+    if (band_registry_init() != 0) {
+        printf("Error : some band plans failed to load\r\n");
+    }
+    // Canales TDT de todas las ciudades, indexados por ciudad y canal
+    if (tdt_index_init() < 0) {
+        printf("Error : TDT city index failed to load\r\n");
+    }
+
     if(init_server(&SERVER0) != 0)
     {
         printf("Error : server open failed\r\n");
@@ -120,16 +134,34 @@ int main(void)
     }
 
     printf("RTI module ready\r\n");
+
+    // Planes FFT medidos una sola vez; el wisdom evita volver a medir en cada arranque
+    fft_plan_init(FFT_WISDOM_FILE, FFT_PLAN_FLAGS);
+    // Repartir los segmentos de Welch entre todos los núcleos disponibles
+    welch_set_threads((int)sysconf(_SC_NPROCESSORS_ONLN));
+    // Historial binario de mediciones, con ranuras para la banda más grande; si no se puede abrir sólo se exporta el JSON
+    psd_archive_init(PSD_ARCHIVE_FILE, (uint16_t)band_registry_max_channels());
+    // La sesión de radio selecciona la antena con la GPIO de la placa
+    rf_session_set_antenna_switch(&board_antenna);
+    // El HackRF se abre una vez y queda abierto; si falla, getSamples reintenta
+    if (rf_session_get() == NULL) {
+        printf("HackRF not available yet\r\n");
+    }
+
+    // Captura, PSD, parámetros y publicación en etapas solapadas
+    if (measurement_init(&SERVER0) != 0)
+    {
+        printf("Error : measurement pipeline failed\r\n");
+        return -1;
+    }
+    // Ventana de Welch, captura adaptativa y potencia integrada desde el entorno (MONRAF_WINDOW, MONRAF_ADAPTIVE, MONRAF_INTEGRATED_POWER)
+    measurement_configure_from_env();
     
     memset(Latitude, 0, sizeof(Latitude));
     sprintf(Latitude, "%s", "5.053265");
     memset(Longitude, 0, sizeof(Longitude));
     sprintf(Longitude, "%s", "-75.510462");
 
-    char path_zero_sample[256];
-    char path_one_sample[256];
-    
-    
        
     t = time(NULL);
     currentTime = localtime(&t);
@@ -146,58 +178,49 @@ int main(void)
                         getData = 9;
                     break;
                     case 1:
+                        if (atof(Fhigh) - atof(Flow) > BAND_TILE_SPAN_MHZ) {
+                            // Varias bandas: un solo barrido en lugar de una captura por banda
+                            measurement_submit_sweep(-30, banda, Flow, Fhigh);
+                            break;
+                        }
                         //printf("Bands: %d\r\n", bands);
-                        bands_length = load_bands(bands, canalisation, bandwidth);
-                        printf("Bands length: %d\r\n", bands_length);
-
-                        totalSamples = getSamples(bands, TRANSCEIVER_MODE_RX, 0, 0, 0, true);
-                        printf("Total files: %d\r\n", totalSamples);
-                        
-                        snprintf(path_zero_sample, sizeof(path_zero_sample), "%s0", "Samples/");
-                        snprintf(path_one_sample, sizeof(path_one_sample), "%s1", "Samples/");
-                        rename(path_zero_sample, path_one_sample);
-
-                        totalSamples = getSamples(bands, TRANSCEIVER_MODE_RX, 0, 0, 0, false);
-                        printf("Total files: %d\r\n", totalSamples);                            
+                        band_info = band_registry_get(bands);
+                        if (band_info == NULL) {
+                            printf("Error : band %d not available\r\n", bands);
+                            break;
+                        }
+                        printf("Bands length: %d\r\n", band_info->n_channels);
 
-                        parameter(&SERVER0, -30, canalisation, bandwidth, bands_length, central_freq[0], 0, banda, Flow, Fhigh);
+                        // Captura y análisis siguen en la tubería; el lazo queda libre para el siguiente turno
+                        measurement_submit_rmer(bands, -30, band_info->frequency, band_info->bandwidth, band_info->n_channels, banda, Flow, Fhigh);
                     break;
                     case 2:
                         printf("Channel: %s\r\n", Tchan);
+                        // Las bandas TDT que se midan después derivan los canales de esta ciudad
+                        measurement_set_tdt_city(Tcity);
+                        if (!strcmp(Tchan, MEASURE_TDT_ALL_CHANNELS)) {
+                            measurement_submit_tdt_city(Tcity);
+                            break;
+                        }
                         int Tmodu = 0;
                         uint16_t centralFrec = load_bands_tdt(Tchan, Tcity, &Tmodu);
-                        printf("central frequency: %lu, Channel: %s, modulation: %d\r\n", centralFrec, Tchan, Tmodu);
-
-                        totalSamples = getSamples(bands, TRANSCEIVER_MODE_RX, 0, 0, 0, true);
-                        printf("Total files: %d\r\n", totalSamples);
-                        
-                        snprintf(path_zero_sample, sizeof(path_zero_sample), "%s0", "Samples/");
-                        snprintf(path_one_sample, sizeof(path_one_sample), "%s1", "Samples/");
-                        rename(path_zero_sample, path_one_sample);
-
-                        totalSamples = getSamples(bands, TRANSCEIVER_MODE_RX, 0, 0, 0, false);
-                        printf("Total files: %d\r\n", totalSamples);
+                        printf("central frequency: %u, Channel: %s, modulation: %d\r\n", centralFrec, Tchan, Tmodu);
+                        if (centralFrec == 0) {
+                            break;
+                        }
 
-                        uint64_t c_f=centralFrec*1000000;
-                        printf("frecuencia central %d", c_f);
-                        parameter_tdt(&SERVER0, Tmodu, c_f, 0, Tchan);
+                        measurement_submit_tdt(Tmodu, centralFrec, Tchan);
                     break;
                     case 3:
                         printf("Bands: %d\r\n", bands);
-                        bands_length = load_bands(bands, canalisation, bandwidth);
-                        printf("Bands length: %d\r\n", bands_length);
-
-                        totalSamples = getSamples(bands, TRANSCEIVER_MODE_RX, 0, 0, 0, true);
-                        printf("Total files: %d\r\n", totalSamples);
-                        
-                        snprintf(path_zero_sample, sizeof(path_zero_sample), "%s0", "Samples/");
-                        snprintf(path_one_sample, sizeof(path_one_sample), "%s1", "Samples/");
-                        rename(path_zero_sample, path_one_sample);
-
-                        totalSamples = getSamples(bands, TRANSCEIVER_MODE_RX, 0, 0, 0, false);
-                        printf("Total files: %d\r\n", totalSamples);
-                        
-                        parameter_rni(&SERVER0, 0.0005, canalisation, bandwidth, bands_length, central_freq[0], 0, banda, Flow, Fhigh);
+                        band_info = band_registry_get(bands);
+                        if (band_info == NULL) {
+                            printf("Error : band %d not available\r\n", bands);
+                            break;
+                        }
+                        printf("Bands length: %d\r\n", band_info->n_channels);
+
+                        measurement_submit_rni(bands, 0.0005, band_info->frequency, band_info->bandwidth, band_info->n_channels, banda, Flow, Fhigh);
                     break;
                     case 9:
 
@@ -1,22 +1,159 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <complex.h>
+#include <math.h>
 #include "Modules/capture.h"
 #include "Modules/processing.h"
 #include "Modules/storage.h"
+#include "Modules/cs8_map.h"
+#include "Modules/spectrum.h"
+#include "Modules/bacn_RF.h"
 
-int main(int argc, char *argv[]) {
-    long samples = (argc > 1) ? strtol(argv[1], NULL, 10) : 20000000;
-    uint64_t freq = (argc > 2) ? strtol(argv[2], NULL, 10) : 98;
+// Uso: test_capture [muestras] [frecuencia_MHz] [stream | archivo.cs8]
+//   stream      -> captura acumulando la PSD en streaming (sin Samples/0)
+//   archivo.cs8 -> reproduce el archivo por rx_callback en modo streaming (sin radio)
+//      test_capture [pasadas] [inicio_MHz] sweep [fin_MHz]
+//   sweep       -> barre inicio-fin con una sola captura y guarda el panorama
+//      test_capture [muestras] [frecuencia_MHz] channels [bands/X.csv] [archivo.cs8]
+//   channels    -> potencia y pico por canal del plan con el canalizador PFB
+//      test_capture [muestras] [frecuencia_MHz] dc
+//   dc          -> segunda captura desplazada y corrección del pico de DC, comprobada (código 1 si falla)
+// Ventana de la PSD de Samples/0: MONRAF_WINDOW=hann (hamming, hann, blackman-harris, flattop)
+// Sin radio: MONRAF_IQ_SOURCE=replay-rt:Samples/2M o MONRAF_IQ_SOURCE=synth:tone:1e6:-20,noise:-50
+// Lee un plan de canales "frequency,bandwidth" (MHz). Devuelve el número de canales o -1.
+static int load_plan(const char* path, double** freq, double** bw) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "❌ No se pudo abrir %s\n", path);
+        return -1;
+    }
+    int n = 0, cap = 256;
+    char line[128];
+    *freq = malloc(cap * sizeof(double));
+    *bw = malloc(cap * sizeof(double));
+    fgets(line, sizeof(line), file);  // Cabecera
+    while (*freq && *bw && fgets(line, sizeof(line), file)) {
+        if (n == cap) {
+            cap *= 2;
+            *freq = realloc(*freq, cap * sizeof(double));
+            *bw = realloc(*bw, cap * sizeof(double));
+            if (!*freq || !*bw) break;
+        }
+        if (sscanf(line, "%lf,%lf", &(*freq)[n], &(*bw)[n]) == 2) n++;
+    }
+    fclose(file);
+    return (*freq && *bw) ? n : -1;
+}
 
-    if (capture_signal(samples, freq) != 0) return 1;
+static int run_channels(long samples, uint64_t freq, const char* plan, const char* filename) {
+    double *ch_freq = NULL, *ch_bw = NULL;
+    int n = load_plan(plan, &ch_freq, &ch_bw);
+    if (n <= 0) {
+        free(ch_freq); free(ch_bw);
+        return 1;
+    }
+
+    double* power = malloc(n * sizeof(double));
+    double* peak = malloc(n * sizeof(double));
+    int r = (power && peak)
+                ? capture_channels(filename, samples, freq, ch_freq, ch_bw, n, power, peak)
+                : -1;
+
+    FILE* out = (r >= 0) ? fopen("Outputs/channels.csv", "w") : NULL;
+    if (out) {
+        fprintf(out, "frequency,power_db,peak_db\n");
+        for (int i = 0; i < n; i++) {
+            fprintf(out, "%.4f,%.2f,%.2f\n", ch_freq[i],
+                    10 * log10(power[i] + 1e-20), 10 * log10(peak[i] + 1e-20));
+        }
+        fclose(out);
+    }
+    free(ch_freq); free(ch_bw); free(power); free(peak);
+    return (out != NULL) ? 0 : 1;
+}
 
-    size_t N;
-    complex double* x = convert_cs8("Samples/0", &N);
-    if (!x) return 1;
+// Distancia máxima (dB) entre un bin reparado y la recta entre los niveles vecinos
+#define DC_CHECK_TOL_DB 3.0
 
-    remove_dc(x, N);
+// Comprueba una corrección del DC: los bins de la región quedan cerca de la recta entre el
+// nivel medio de los SPECTRUM_DC_GUARD vecinos de cada lado y los demás bins no cambian.
+// Devuelve 0 si se cumple, 1 si no.
+static int check_dc(const char* name, const spectrum_t* psd, const double* before, int half_width) {
+    int lo = psd->n / 2 - half_width;
+    int hi = psd->n / 2 + half_width;
+    double left = 0.0, right = 0.0;
+    for (int k = 1; k <= SPECTRUM_DC_GUARD; k++) {
+        left += 10.0 * log10(psd->p[lo - k]);
+        right += 10.0 * log10(psd->p[hi + k]);
+    }
+    left /= SPECTRUM_DC_GUARD;
+    right /= SPECTRUM_DC_GUARD;
+    double x_left = lo - (SPECTRUM_DC_GUARD + 1) / 2.0;
+    double x_right = hi + (SPECTRUM_DC_GUARD + 1) / 2.0;
+
+    int failures = 0;
+    for (int i = 0; i < psd->n; i++) {
+        if (i >= lo && i <= hi) {
+            double expected = left + (i - x_left) * (right - left) / (x_right - x_left);
+            double err = 10.0 * log10(psd->p[i]) - expected;
+            if (fabs(err) > DC_CHECK_TOL_DB) {
+                printf("❌ %s: bin %d a %.2f dB del nivel vecino\n", name, i, err);
+                failures++;
+            }
+        } else if (psd->p[i] != before[i]) {
+            printf("❌ %s: bin %d fuera de la región del DC modificado\n", name, i);
+            failures++;
+        }
+    }
+    if (failures == 0) {
+        printf("✅ %s: %d bins del DC a ±%.1f dB de los vecinos (%.1f / %.1f dB), resto intacto\n",
+               name, hi - lo + 1, DC_CHECK_TOL_DB, left, right);
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// Dos PSD en streaming, la segunda desplazada como la segunda captura RMER. El pico de DC de
+// la primera se corrige con spectrum_repair_dc (sobre una copia) y con spectrum_replace_dc, y
+// se comprueban ambas correcciones con check_dc.
+static int run_dc(long samples, uint64_t freq, int segment_length, double overlap) {
+    spectrum_t psd = {0}, ref = {0}, repaired = {0};
+    double fs = DEFAULT_SAMPLE_RATE_HZ;
+    uint64_t freq_ref = freq + SECOND_SAMPLE_OFFSET_HZ / 1000000;
+    double* f = malloc(segment_length * sizeof(double));
+    double* Pxx_dB = malloc(segment_length * sizeof(double));
+    double* before = malloc(segment_length * sizeof(double));
+    int r = (f && Pxx_dB && before &&
+             spectrum_alloc(&psd, segment_length, fs, freq * 1e6) == 0 &&
+             spectrum_alloc(&ref, segment_length, fs, freq_ref * 1e6) == 0 &&
+             spectrum_alloc(&repaired, segment_length, fs, freq * 1e6) == 0 &&
+             capture_psd(samples, freq, segment_length, overlap, f, psd.p) == 0 &&
+             capture_psd(samples, freq_ref, segment_length, overlap, NULL, ref.p) == 0) ? 0 : 1;
+    int half_width = spectrum_dc_half_width(&psd);
+    if (r == 0) {
+        psd_to_db(psd.p, Pxx_dB, segment_length);
+        save_psd_to_csv(f, Pxx_dB, segment_length, "Outputs/resultado_psd_db.csv");
+        memcpy(before, psd.p, segment_length * sizeof(double));
+        memcpy(repaired.p, psd.p, segment_length * sizeof(double));
+        r = (spectrum_repair_dc(&repaired, half_width, SPECTRUM_DC_GUARD) == 0 &&
+             spectrum_replace_dc(&psd, &ref, half_width, SPECTRUM_DC_GUARD) == 0) ? 0 : 1;
+    }
+    if (r == 0) {
+        r |= check_dc("spectrum_repair_dc", &repaired, before, half_width);
+        r |= check_dc("spectrum_replace_dc", &psd, before, half_width);
+        psd_to_db(psd.p, Pxx_dB, segment_length);
+        save_psd_to_csv(f, Pxx_dB, segment_length, "Outputs/dc_psd_db.csv");
+    }
+    spectrum_free(&psd); spectrum_free(&ref); spectrum_free(&repaired);
+    free(f); free(Pxx_dB); free(before);
+    return r;
+}
+
+int main(int argc, char *argv[]) {
+    long samples = (argc > 1) ? strtol(argv[1], NULL, 10) : 20000000;
+    uint64_t freq = (argc > 2) ? strtol(argv[2], NULL, 10) : 98;
+    const char* stream_src = (argc > 3) ? argv[3] : NULL;
 
     int segment_length = 4096;
     double fs = 20000000;
@@ -25,9 +162,60 @@ int main(int argc, char *argv[]) {
     double* f = malloc(segment_length * sizeof(double));
     double* Pxx_dB = malloc(segment_length * sizeof(double));
 
-    compute_welch_psd(x, N, fs, segment_length, overlap, f, Pxx_dB);
+    if (stream_src && strcmp(stream_src, "channels") == 0) {
+        free(f); free(Pxx_dB);
+        return run_channels(samples, freq, (argc > 4) ? argv[4] : "bands/VHF3.csv",
+                            (argc > 5) ? argv[5] : NULL);
+    }
+
+    if (stream_src && strcmp(stream_src, "dc") == 0) {
+        free(f); free(Pxx_dB);
+        return run_dc(samples, freq, segment_length, overlap);
+    }
+
+    if (stream_src && strcmp(stream_src, "sweep") == 0) {
+        uint64_t hi = (argc > 4) ? strtoull(argv[4], NULL, 10) : freq + 20;
+        double* f_sweep = NULL;
+        double* P_sweep = NULL;
+        int bins = capture_sweep(freq, hi, (int)samples, segment_length, overlap,
+                                 &f_sweep, &P_sweep);
+        free(f); free(Pxx_dB);
+        if (bins <= 0) return 1;
+        double* P_sweep_dB = malloc(bins * sizeof(double));
+        psd_to_db(P_sweep, P_sweep_dB, bins);
+        save_psd_to_csv(f_sweep, P_sweep_dB, bins, "Outputs/panorama_psd_db.csv");
+        free(f_sweep); free(P_sweep); free(P_sweep_dB);
+        return 0;
+    }
+
+    if (stream_src) {
+        double* Pxx = malloc(segment_length * sizeof(double));
+        int r = (strcmp(stream_src, "stream") == 0)
+                    ? capture_psd(samples, freq, segment_length, overlap, f, Pxx)
+                    : replay_psd(stream_src, samples, segment_length, overlap, f, Pxx);
+        if (r != 0) {
+            free(Pxx); free(f); free(Pxx_dB);
+            return 1;
+        }
+        psd_to_db(Pxx, Pxx_dB, segment_length);
+        save_psd_to_csv(f, Pxx_dB, segment_length, "Outputs/resultado_psd_db.csv");
+        free(Pxx); free(f); free(Pxx_dB);
+        return 0;
+    }
+
+    if (capture_signal(samples, freq) != 0) return 1;
+
+    cs8_map_t capture;
+    if (cs8_map_open(&capture, "Samples/0") != 0) return 1;
+
+    window_type_t window = WINDOW_HAMMING;
+    if (getenv("MONRAF_WINDOW") && window_from_name(getenv("MONRAF_WINDOW"), &window) != 0) {
+        fprintf(stderr, "❌ Ventana desconocida: %s\n", getenv("MONRAF_WINDOW"));
+    }
+    compute_welch_psd_cs8(capture.data, capture.num_samples, fs, segment_length, overlap, window, f, Pxx_dB);
     save_psd_to_csv(f, Pxx_dB, segment_length, "Outputs/resultado_psd_db.csv");
 
-    free(x); free(f); free(Pxx_dB);
+    cs8_map_close(&capture);
+    free(f); free(Pxx_dB);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "Modules/spectrum.h"
+
+// Uso: test_spectrum
+// Comprobación sin radio de spectrum_repair_dc: un espectro sintético con fondo en
+// rampa (dB) y un pico de DC conocido debe quedar, dentro de la región del DC, sobre
+// la rampa original, y fuera de ella sin cambios. Devuelve 1 si algo falla (CTest).
+
+#define SPECTRUM_TEST_BINS 4096
+#define SPECTRUM_TEST_FS 20e6
+#define SPECTRUM_TEST_SPIKE_DB 40.0
+#define SPECTRUM_TEST_TOL_DB 1e-6
+
+// Fondo en dB del bin canónico i: rampa suave alrededor de -90 dB
+static double floor_db(int i) {
+    return -90.0 + 0.01 * (i - SPECTRUM_TEST_BINS / 2);
+}
+
+// Rellena el espectro con el fondo y suma el pico en [n/2 - hw, n/2 + hw]
+static void fill(spectrum_t* s, int hw) {
+    int dc = s->n / 2;
+    for (int i = 0; i < s->n; i++) {
+        double db = floor_db(i);
+        if (i >= dc - hw && i <= dc + hw) {
+            db += SPECTRUM_TEST_SPIKE_DB;
+        }
+        int k = (s->ordering == SPECTRUM_FFT_ORDER) ? (i + s->n / 2) % s->n : i;
+        s->p[k] = (s->units == SPECTRUM_DB) ? db : pow(10.0, db / 10.0);
+    }
+}
+
+static double at_db(const spectrum_t* s, int i) {
+    double v = spectrum_at(s, i);
+    return (s->units == SPECTRUM_DB) ? v : 10.0 * log10(v);
+}
+
+static int run_case(const char* name, spectrum_order_t ordering, spectrum_units_t units) {
+    spectrum_t s;
+    if (spectrum_alloc(&s, SPECTRUM_TEST_BINS, SPECTRUM_TEST_FS, 100e6) != 0) return 1;
+    s.ordering = ordering;
+    s.units = units;
+
+    int hw = spectrum_dc_half_width(&s);
+    fill(&s, hw);
+    double* before = (double*)malloc((size_t)s.n * sizeof(double));
+    if (before == NULL) {
+        spectrum_free(&s);
+        return 1;
+    }
+    memcpy(before, s.p, (size_t)s.n * sizeof(double));
+
+    int failed = 0;
+    if (spectrum_repair_dc(&s, hw, SPECTRUM_DC_GUARD) != 0) {
+        printf("%s: spectrum_repair_dc falló\n", name);
+        failed = 1;
+    }
+
+    // Dentro de la región: la rampa original, sin rastro del pico
+    int dc = s.n / 2;
+    double worst = 0.0;
+    for (int i = dc - hw; i <= dc + hw && !failed; i++) {
+        double err = fabs(at_db(&s, i) - floor_db(i));
+        if (err > worst) worst = err;
+    }
+    if (worst > SPECTRUM_TEST_TOL_DB) {
+        printf("%s: DC reparado a %.3g dB de la rampa (bins %d..%d)\n", name, worst, dc - hw, dc + hw);
+        failed = 1;
+    }
+
+    // Fuera de la región no se toca nada
+    for (int i = 0; i < s.n && !failed; i++) {
+        if (i >= dc - hw && i <= dc + hw) continue;
+        int k = (ordering == SPECTRUM_FFT_ORDER) ? (i + s.n / 2) % s.n : i;
+        if (s.p[k] != before[k]) {
+            printf("%s: el bin %d fuera de la región del DC cambió\n", name, i);
+            failed = 1;
+        }
+    }
+
+    printf("%s: %s (hw=%d, error máx %.2g dB)\n", name, failed ? "FALLA" : "OK", hw, worst);
+    free(before);
+    spectrum_free(&s);
+    return failed;
+}
+
+// Una región que no cabe se rechaza y deja el espectro intacto
+static int run_no_fit(void) {
+    spectrum_t s;
+    if (spectrum_alloc(&s, 16, SPECTRUM_TEST_FS, 100e6) != 0) return 1;
+    for (int i = 0; i < s.n; i++) s.p[i] = 1.0 + i;
+
+    int failed = (spectrum_repair_dc(&s, 4, SPECTRUM_DC_GUARD) != -1);
+    for (int i = 0; i < s.n; i++) {
+        if (s.p[i] != 1.0 + i) failed = 1;
+    }
+    printf("no cabe: %s\n", failed ? "FALLA" : "OK");
+    spectrum_free(&s);
+    return failed;
+}
+
+int main(void) {
+    int failed = 0;
+    failed |= run_case("lineal centrado", SPECTRUM_CENTERED, SPECTRUM_LINEAR);
+    failed |= run_case("dB centrado", SPECTRUM_CENTERED, SPECTRUM_DB);
+    failed |= run_case("lineal orden FFT", SPECTRUM_FFT_ORDER, SPECTRUM_LINEAR);
+    failed |= run_no_fit();
+    return failed;
+}